@@ -179,7 +179,7 @@ void MapApp::selectGeoTIFF() {
     fileChooser->setSelectCallback([this] (const std::string &selectedUTF8) {
         api().executeLater([this, selectedUTF8] () {
             try {
-                auto geoSource = std::make_shared<maps::GeoTIFFSource>(selectedUTF8);
+                auto geoSource = std::make_shared<maps::GeoTIFFSource>(selectedUTF8, api().getDataPath() + "MapTiles/GeoTIFF-Pyramids/");
                 setTileSource(geoSource);
                 fileChooser.reset();
                 chooserContainer->setVisible(false);
@@ -95,6 +95,7 @@ void RouteApp::onDepartureEntered(const std::string& departure) {
     }
 
     departureNode = ap;
+    ap->prefetchProcedures();
 
     showArrivalPage();
 }
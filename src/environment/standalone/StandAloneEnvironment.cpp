@@ -83,7 +83,12 @@ void StandAloneEnvironment::eventLoop() {
 }
 
 std::shared_ptr<world::LoadManager> StandAloneEnvironment::createParsingWorldManager() {
-    return std::make_shared<xdata::XData>(xplaneRootPath);
+    bool lazyProcedures = false;
+    try {
+        lazyProcedures = getConfig()->getBool("/AviTab/lazyProcedures");
+    } catch (...) {
+    }
+    return std::make_shared<xdata::XData>(xplaneRootPath, getProgramPath() + "NavCache/xdata.snapshot", lazyProcedures);
 }
 
 std::shared_ptr<LVGLToolkit> StandAloneEnvironment::createGUIToolkit() {
@@ -129,7 +129,12 @@ XPLMFlightLoopID XPlaneEnvironment::createFlightLoop() {
 }
 
 std::shared_ptr<world::LoadManager> XPlaneEnvironment::createParsingWorldManager() {
-    return std::make_shared<xdata::XData>(xplaneRootPath);
+    bool lazyProcedures = false;
+    try {
+        lazyProcedures = getConfig()->getBool("/AviTab/lazyProcedures");
+    } catch (...) {
+    }
+    return std::make_shared<xdata::XData>(xplaneRootPath, getProgramPath() + "NavCache/xdata.snapshot", lazyProcedures);
 }
 
 std::shared_ptr<LVGLToolkit> XPlaneEnvironment::createGUIToolkit() {
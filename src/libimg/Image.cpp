@@ -26,14 +26,33 @@
 #include <cmath>
 #include <fstream>
 #include <algorithm>
-#include <array>
+#include <mutex>
 #include "Image.h"
 #include "src/Logger.h"
 #include "src/platform/Platform.h"
 #include "TTFStamper.h"
+#include "PixelKernels.h"
+#include "SpanRasterizer.h"
 
 namespace img {
 
+namespace {
+// all text drawn into images shares one stamper and its glyph and text caches
+std::mutex textStamperMutex;
+
+TTFStamper &getTextStamper() {
+    static TTFStamper textBox("Inconsolata.ttf");
+    return textBox;
+}
+
+// the single shapes drawn into images reuse the cell buffer of one rasterizer per thread
+SpanRasterizer &getShapeRasterizer(int width, int height) {
+    static thread_local SpanRasterizer rasterizer;
+    rasterizer.reset(width, height);
+    return rasterizer;
+}
+}
+
 Image::Image():
     pixels(std::make_unique<std::vector<uint32_t>>())
 {
@@ -100,15 +119,10 @@ void Image::loadEncodedData(const std::vector<uint8_t>& encodedImage, bool keepD
 
 void Image::setPixels(uint8_t* data, int srcWidth, int srcHeight) {
     pixels->resize(srcWidth * srcHeight);
-    uint32_t *dstData = pixels->data();
 
-    for (int i = 0; i < srcWidth * srcHeight * 4; i += 4) {
-        uint32_t argb = (data[i + 3] << 24) |
-                        (data[i + 0] << 16) |
-                        (data[i + 1] << 8)  |
-                        data[i + 2];
-        dstData[i / 4] = argb;
-    }
+    // RGBA bytes in memory to ARGB words
+    const uint32_t *srcData = reinterpret_cast<const uint32_t *>(data);
+    kernels::swapRedBlue(pixels->data(), srcData, srcWidth * srcHeight);
     this->width = srcWidth;
     this->height = srcHeight;
 }
@@ -185,29 +199,8 @@ void Image::blendPixel(int x, int y, uint32_t foreCol) {
         return;
     }
 
-    // background
     uint32_t *data = getPixels();
-    uint32_t color = data[y * width + x];
-    float ba = (int) ((color >> 24) & 0xFF) / 255.0;
-    float br = (int) ((color >> 16) & 0xFF) / 255.0;
-    float bg = (int) ((color >>  8) & 0xFF) / 255.0;
-    float bb = (int) ((color >>  0) & 0xFF) / 255.0;
-
-    // foreground
-    float fa = (int) ((foreCol >> 24) & 0xFF) / 255.0;
-    float fr = (int) ((foreCol >> 16) & 0xFF) / 255.0;
-    float fg = (int) ((foreCol >>  8) & 0xFF) / 255.0;
-    float fb = (int) ((foreCol >>  0) & 0xFF) / 255.0;
-
-    float a = fa + ba * (1 - fa);
-    float r = (fr * fa + br * ba * (1 - fa)) / a;
-    float g = (fg * fa + bg * ba * (1 - fa)) / a;
-    float b = (fb * fa + bb * ba * (1 - fa)) / a;
-
-    data[y * width + x] =  (uint8_t(a * 255) << 24)
-            | (uint8_t(r * 255) << 16)
-            | (uint8_t(g * 255) << 8)
-            | (uint8_t(b * 255) << 0);
+    data[y * width + x] = kernels::blend(data[y * width + x], foreCol);
 }
 
 void Image::drawLine(int x1, int y1, int x2, int y2, uint32_t color) {
@@ -246,173 +239,107 @@ void Image::drawLine(int x1, int y1, int x2, int y2, uint32_t color) {
     }
 }
 
+Rect Rect::intersect(const Rect &other) const {
+    Rect res;
+    res.x0 = std::max(x0, other.x0);
+    res.y0 = std::max(y0, other.y0);
+    res.x1 = std::min(x1, other.x1);
+    res.y1 = std::min(y1, other.y1);
+    return res;
+}
+
+Rect Rect::unite(const Rect &other) const {
+    if (isEmpty()) {
+        return other;
+    } else if (other.isEmpty()) {
+        return *this;
+    }
+
+    Rect res;
+    res.x0 = std::min(x0, other.x0);
+    res.y0 = std::min(y0, other.y0);
+    res.x1 = std::max(x1, other.x1);
+    res.y1 = std::max(y1, other.y1);
+    return res;
+}
+
 void Image::drawImage(const Image& src, int dstX, int dstY) {
-    int srcWidth = src.getWidth();
-    int srcHeight = src.getHeight();
-    if (dstX + srcWidth < 0 || dstX >= width || dstY + srcHeight < 0 || dstY >= height) {
+    drawImage(src, dstX, dstY, Rect{0, 0, width, height});
+}
+
+void Image::drawImage(const Image& src, int dstX, int dstY, const Rect &clip) {
+    Rect area = Rect{dstX, dstY, dstX + src.getWidth(), dstY + src.getHeight()}
+                    .intersect(clip)
+                    .intersect(Rect{0, 0, width, height});
+    if (area.isEmpty()) {
         return;
     }
 
     uint32_t *dstPtr = getPixels();
     const uint32_t *srcPtr = src.getPixels();
+    int srcWidth = src.getWidth();
+    int copyWidth = area.x1 - area.x0;
 
-    for (int srcY = 0; srcY < srcHeight; srcY++) {
-        int dstYClip = dstY + srcY;
-
-        if (dstYClip < 0 || dstYClip >= height) {
-            continue;
-        }
-
-        int copyWidth = srcWidth;
-        int srcX = 0;
-        int dstXClip = dstX;
-        if (dstXClip < 0) {
-            dstXClip = 0;
-            srcX = -dstX;
-            copyWidth -= -dstX;
-        }
-        if (dstXClip + copyWidth > width) {
-            copyWidth = width - dstXClip;
-        }
-
-        if (copyWidth <= 0) {
-            continue;
-        }
-
-        std::memcpy(dstPtr + dstYClip * width + dstXClip,
-                    srcPtr + srcY * srcWidth + srcX,
+    for (int y = area.y0; y < area.y1; y++) {
+        std::memcpy(dstPtr + y * width + area.x0,
+                    srcPtr + (y - dstY) * srcWidth + (area.x0 - dstX),
                     copyWidth * sizeof(uint32_t));
     }
 }
 
-void Image::plot(int x, int y, float brightness) {
-    int alpha = (int)(brightness * 255);
-    int color = (alpha << 24) | (drawLineAAColor & 0x00FFFFFF);
-    blendPixel(x, y, color);
-}
-
-// From https://rosettacode.org/wiki/Xiaolin_Wu%27s_line_algorithm#C.2B.2B
-void Image::drawLineAA(float x0, float y0, float x1, float y1, uint32_t color) {
-    drawLineAAColor = color;
-
-    auto ipart = [](float x) -> int {return int(std::floor(x));};
-    auto round = [](float x) -> float {return std::round(x);};
-    auto fpart = [](float x) -> float {return x - std::floor(x);};
-    auto rfpart = [=](float x) -> float {return 1 - fpart(x);};
-
-    const bool steep = abs(y1 - y0) > abs(x1 - x0);
-    if (steep) {
-        std::swap(x0,y0);
-        std::swap(x1,y1);
-    }
-    if (x0 > x1) {
-        std::swap(x0,x1);
-        std::swap(y0,y1);
-    }
-
-    const float dx = x1 - x0;
-    const float dy = y1 - y0;
-    const float gradient = (dx == 0) ? 1 : dy/dx;
-
-    int xpx11;
-    float intery;
-    {
-        const float xend = round(x0);
-        const float yend = y0 + gradient * (xend - x0);
-        const float xgap = rfpart(x0 + 0.5);
-        xpx11 = int(xend);
-        const int ypx11 = ipart(yend);
-        if (steep) {
-            plot(ypx11,     xpx11, rfpart(yend) * xgap);
-            plot(ypx11 + 1, xpx11,  fpart(yend) * xgap);
-        } else {
-            plot(xpx11, ypx11,    rfpart(yend) * xgap);
-            plot(xpx11, ypx11 + 1, fpart(yend) * xgap);
-        }
-        intery = yend + gradient;
+void Image::shift(int dx, int dy) {
+    // moves the content, the uncovered area keeps its old pixels
+    if (std::abs(dx) >= width || std::abs(dy) >= height || (dx == 0 && dy == 0)) {
+        return;
     }
 
-    int xpx12;
-    {
-        const float xend = round(x1);
-        const float yend = y1 + gradient * (xend - x1);
-        const float xgap = rfpart(x1 + 0.5);
-        xpx12 = int(xend);
-        const int ypx12 = ipart(yend);
-        if (steep) {
-            plot(ypx12,     xpx12, rfpart(yend) * xgap);
-            plot(ypx12 + 1, xpx12,  fpart(yend) * xgap);
-        } else {
-            plot(xpx12, ypx12,    rfpart(yend) * xgap);
-            plot(xpx12, ypx12 + 1, fpart(yend) * xgap);
-        }
-    }
+    uint32_t *ptr = getPixels();
+    int copyWidth = width - std::abs(dx);
+    int srcX = std::max(-dx, 0);
+    int dstX = std::max(dx, 0);
 
-    if (steep) {
-        for (int x = xpx11 + 1; x < xpx12; x++) {
-            plot(ipart(intery),     x, rfpart(intery));
-            plot(ipart(intery) + 1, x,  fpart(intery));
-            intery += gradient;
+    if (dy > 0) {
+        // rows move down: iterate bottom up so that no source row is overwritten before it is read
+        for (int y = height - 1; y >= dy; y--) {
+            std::memmove(ptr + y * width + dstX, ptr + (y - dy) * width + srcX, copyWidth * sizeof(uint32_t));
         }
     } else {
-        for (int x = xpx11 + 1; x < xpx12; x++) {
-            plot(x, ipart(intery),     rfpart(intery));
-            plot(x, ipart(intery) + 1,  fpart(intery));
-            intery += gradient;
+        for (int y = 0; y < height + dy; y++) {
+            std::memmove(ptr + y * width + dstX, ptr + (y - dy) * width + srcX, copyWidth * sizeof(uint32_t));
         }
     }
 }
 
+void Image::drawLineAA(float x0, float y0, float x1, float y1, uint32_t color) {
+    drawThickLine(x0, y0, x1, y1, 1, color);
+}
+
+void Image::drawThickLine(float x0, float y0, float x1, float y1, float lineWidth, uint32_t color) {
+    auto &shape = getShapeRasterizer(width, height);
+    shape.addLine(x0, y0, x1, y1, lineWidth);
+    shape.fill(*this, color);
+}
+
+void Image::drawArc(float x, float y, float radius, float startDegrees, float endDegrees, float lineWidth, uint32_t color) {
+    auto &shape = getShapeRasterizer(width, height);
+    shape.addArc(x, y, radius, startDegrees, endDegrees, lineWidth);
+    shape.fill(*this, color);
+}
+
+void Image::fillPolygon(const std::vector<Point<float>> &points, uint32_t color) {
+    auto &shape = getShapeRasterizer(width, height);
+    shape.addPolygon(points);
+    shape.fill(*this, color);
+}
+
 void Image::drawCircle(int x_centre, int y_centre, int radius, uint32_t color) {
-    // Anti-aliased, by considering all pixels in the enclosing square, but with several
-    // short-cuts so that obvious transparent pixels don't take time.
-    // A lot of pythagoras, but try not to do too many sqrts.
-    float coarseInnerLimitSquared = pow((radius - 1.5), 2);
-    float coarseOuterLimitSquared = pow((radius + 1.5), 2);
-    float fineInnerLimitSquared = pow((radius - 0.5), 2);
-    float fineOuterLimitSquared = pow((radius + 0.5), 2);
-    for (int y = -radius - 1; y <= radius + 1; y++) {
-        int xRange = sqrt(coarseOuterLimitSquared - pow(abs(y),2));
-        for (int x = -xRange; x <= xRange; x++) {
-            float dSquared = (x * x) + (y * y);
-            if ((x < 0) && (dSquared < coarseInnerLimitSquared)) {
-                x = -x; // Shortcut to mirrored right hand side inside ring
-                continue;
-            }
-            // Anti-aliasing : how many of the 4 (2x2) subpixels contain part of the ring
-            int total = 0;
-            for (float ys = y - 0.25; ys <= y + 0.25; ys += 0.5) {
-                for (float xs = x - 0.25; xs <= x + 0.25; xs += 0.5) {
-                    dSquared = (xs * xs) + (ys * ys);
-                    if ((dSquared > fineInnerLimitSquared) && (dSquared < fineOuterLimitSquared)) {
-                        total++;
-                    }
-                }
-            }
-            int alpha = (total * 255) / 4;
-            int colorAA = (alpha << 24) | (color & 0x00FFFFFF);
-            blendPixel(x_centre + x, y_centre + y, colorAA);
-        }
-    }
+    drawArc(x_centre, y_centre, radius, 0, 360, 1, color);
 }
 
 void Image::fillCircleCacheImage(int x_centre, int y_centre, int radius, uint32_t color) {
-    float d;
-    int alpha;
-    for (int y = y_centre - radius; y <= y_centre + radius; y++) {
-        for (int x = x_centre - radius; x <= x_centre + radius; x++) {
-            d = sqrt(pow((x - x_centre), 2) + pow((y - y_centre), 2));
-            if (d > (radius + 0.5)) {
-                alpha = 0; // Definitely outside
-            } else if (d < (radius - 0.5)) {
-                alpha = 255; // Definitely inside
-            } else {
-                alpha = ((radius + 0.5) - d) * 255; // Border, so alpha blend for anti-aliasing
-            }
-            int colorAA = (alpha << 24) | (color & 0x00FFFFFF);
-            blendPixel(x, y, colorAA);
-        }
-    }
+    auto &shape = getShapeRasterizer(width, height);
+    shape.addDisc(x_centre, y_centre, radius);
+    shape.fill(*this, color);
 }
 
 void Image::fillCircle(int x_centre, int y_centre, int radius, uint32_t color) {
@@ -434,109 +361,16 @@ void Image::fillCircle(int x_centre, int y_centre, int radius, uint32_t color) {
     blendImage0(*pImage, x_centre - radius, y_centre - radius);
 }
 
-// This class is a representation of a classic line equation ax + by + c
-// It is used in rectangle fills to determine whether a point is inside or outside
-// a rectangle bounding line. And how far away from the line it is so as to determine
-// appropriate alpha blend for anti-aliasing
-class LineEquation {
-public:
-    LineEquation(int x1, int y1, int x2, int y2, int ref_x, int ref_y) {
-        if ((x1 == x2) && (y1 == y2)) {
-            LOG_WARN("Attempt to construct line with 2 identical points");
-            x1++;
-        }
-        a = y1 - y2;
-        b = x2 - x1;
-        c = x1 * y2 - x2 * y1;
-        normalAdjust = 10 / sqrt(a * a + b * b);
-        refOffsetSign = (computeDistance(ref_x, ref_y) >= 0);
-    }
-    int getIntensity(int x, int y) {
-        // Return a value between 0 and 4, which is the multiplicative
-        // contribution to alphas blend from this line instance.
-        int intensity;
-        int distance = (int)(computeDistance(x, y) * normalAdjust);
-        bool sameSign = ((distance >= 0) == refOffsetSign);
-        bool throughPixel = abs(distance) < 7;
-        if (throughPixel) {
-            int offset = abs(distance);
-            if (sameSign) {
-                intensity = 2 + (offset * 2) / 7;
-            } else {
-                intensity = 2 - (offset * 2) / 7;
-            }
-            return intensity;
-        } else {
-            if (sameSign) {
-                return 4;
-            } else {
-                return 0;
-            }
-        }
-    }
-private:
-    int a;
-    int b;
-    int c;
-    int refOffsetSign;
-    float normalAdjust;
-
-    int computeDistance(int x, int y) {
-        return a * x + b * y + c;
-    }
-};
-
 // Fill rotated rectangle, given 4 points
 // Points must be in an order where successive points create each one of the bounding lines
 void Image::fillRectangle(int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3, uint32_t color) {
-    if (((x0 == x1) && (y0 == y1)) || ((x0 == x2) && (y0 == y2)) || ((x0 == x3) && (y0 == y3)) ||
-        ((x1 == x2) && (y1 == y2)) || ((x1 == x3) && (y1 == y3)) || ((x2 == x3) && (y2 == y3))) {
-        LOG_WARN("Requested with some identical points, skipping, fix calling code");
-        return;
-    }
-    int xCentre = (x0 + x1 + x2 + x3) / 4;
-    int yCentre = (y0 + y1 + y2 + y3) / 4;
-
-    int xMin = std::min({x0, x1, x2, x3});
-    xMin = std::max(0, xMin);
-    int xMax = std::max({x0, x1, x2, x3});
-    xMax = std::min(width, xMax);
-    int yMin = std::min({y0, y1, y2, y3});
-    yMin = std::max(0, yMin);
-    int yMax = std::max({y0, y1, y2, y3});
-    yMax = std::min(width, yMax);
-
-    std::array<LineEquation, 4> lines = {
-        LineEquation(x0, y0, x1, y1, xCentre, yCentre),
-        LineEquation(x1, y1, x2, y2, xCentre, yCentre),
-        LineEquation(x2, y2, x3, y3, xCentre, yCentre),
-        LineEquation(x3, y3, x0, y0, xCentre, yCentre)
+    std::vector<Point<float>> corners = {
+        Point<float>{(float) x0, (float) y0},
+        Point<float>{(float) x1, (float) y1},
+        Point<float>{(float) x2, (float) y2},
+        Point<float>{(float) x3, (float) y3}
     };
-
-    // Loop through all possible pixels and ask each of the 4 LineEquations for a
-    // inside/outside/border multiplicative contribution (0-4) to the alpha blend.
-    bool beenInside;
-    for(int y = yMin - 1; y <= yMax + 1; y++) {
-        beenInside = false;
-        for(int x = xMin - 1; x <= xMax + 1; x++) {
-            int alpha = 1;
-            for (auto line: lines) {
-                alpha *= line.getIntensity(x,y);
-            }
-
-            if (alpha == 0) {
-                if (beenInside) {
-                    break; // Short circuit if done this row
-                }
-            } else {
-                if (alpha == 256) {
-                    alpha = 255;
-                }
-                blendPixel(x, y, (color & 0x00FFFFFF) | (alpha << 24));
-                beenInside = true;
-            }
-        }
-    }
+    fillPolygon(corners, color);
 }
 
 void Image::drawRectangle(int x0, int y0, int x1, int y1, uint32_t color) {
@@ -548,18 +382,20 @@ void Image::drawRectangle(int x0, int y0, int x1, int y1, uint32_t color) {
 
 // Fill aligned rectangle, just given 2 points
 void Image::fillRectangle(int x0, int y0, int x1, int y1, uint32_t color) {
-    int xMin = std::min(x0, x1);
-    xMin = std::max(0, xMin);
-    int xMax = std::max(x0, x1);
-    xMax = std::min(width, xMax);
-    int yMin = std::min(y0, y1);
-    yMin = std::max(0, yMin);
-    int yMax = std::max(y0, y1);
-    yMax = std::min(width, yMax);
-
-    for(int y=yMin; y<=yMax; y++) {
-        for(int x=xMin; x<=xMax; x++) {
-            blendPixel(x, y, color);
+    int xMin = std::max(0, std::min(x0, x1));
+    int xMax = std::min(width - 1, std::max(x0, x1));
+    int yMin = std::max(0, std::min(y0, y1));
+    int yMax = std::min(height - 1, std::max(y0, y1));
+    if (xMin > xMax) {
+        return;
+    }
+
+    uint32_t *data = getPixels();
+    for (int y = yMin; y <= yMax; y++) {
+        if ((color >> 24) == 0xFF) {
+            std::fill_n(data + y * width + xMin, xMax - xMin + 1, color);
+        } else {
+            kernels::blendColor(data + y * width + xMin, xMax - xMin + 1, color);
         }
     }
 }
@@ -602,21 +438,32 @@ void Image::blendImage(const Image& src, int dstX, int dstY, double angle) {
     double cosTheta = std::cos(theta);
     double sinTheta = std::sin(theta);
 
-    for (int y = dstY; y < dstY + srcHeight; y++) {
-        for (int x = dstX; x < dstX + srcWidth; x++) {
-            if (x < 0 || x >= width || y < 0 || y >= height) {
-                continue;
-            }
+    int xStart = std::max(dstX, 0);
+    int xEnd = std::min(dstX + srcWidth, width);
+    int yStart = std::max(dstY, 0);
+    int yEnd = std::min(dstY + srcHeight, height);
 
-            int x2 = cosTheta * (x - dstX - cx) - sinTheta * (y - dstY - cy) + cx;
-            int y2 = sinTheta * (x - dstX - cx) + cosTheta * (y - dstY - cy) + cy;
+    const uint32_t *srcPtr = src.getPixels();
+    uint32_t *dstPtr = getPixels();
+
+    for (int y = yStart; y < yEnd; y++) {
+        // walk the source coordinates incrementally along the destination row
+        double relX = xStart - dstX - cx;
+        double relY = y - dstY - cy;
+        double srcX = cosTheta * relX - sinTheta * relY + cx;
+        double srcY = sinTheta * relX + cosTheta * relY + cy;
+
+        uint32_t *dstRow = dstPtr + y * width;
+        for (int x = xStart; x < xEnd; x++, srcX += cosTheta, srcY += sinTheta) {
+            int x2 = srcX;
+            int y2 = srcY;
             if (x2 < 0 || x2 >= srcWidth || y2 < 0 || y2 >= srcHeight) {
                 continue;
             }
 
-            const uint32_t *s = src.getPixels() + y2 * srcWidth + x2;
-            if (*s & 0xFF000000) {
-                blendPixel(x, y, *s);
+            uint32_t color = srcPtr[y2 * srcWidth + x2];
+            if (color & 0xFF000000) {
+                dstRow[x] = kernels::blend(dstRow[x], color);
             }
         }
     }
@@ -630,17 +477,22 @@ void Image::blendImage270(const Image& src, int dstX, int dstY) {
     }
 
     const uint32_t *srcPtr = src.getPixels();
+    uint32_t *dstPtr = getPixels();
 
-    for (int y = dstY; y < dstY + srcWidth; y++) {
+    // the rotated source covers srcHeight x srcWidth pixels
+    int xStart = std::max(dstX, 0);
+    int xEnd = std::min(dstX + srcHeight, width);
+    int yStart = std::max(dstY, 0);
+    int yEnd = std::min(dstY + srcWidth, height);
+
+    for (int y = yStart; y < yEnd; y++) {
         int srcX = srcWidth - 1 - (y - dstY);
-        for (int x = dstX; x < dstX + srcHeight; x++) {
+        uint32_t *dstRow = dstPtr + y * width;
+        for (int x = xStart; x < xEnd; x++) {
             int srcY = x - dstX;
-            if (srcX < 0 || srcX >= srcWidth|| srcY < 0 || srcY >= srcHeight) {
-                continue;
-            }
             uint32_t srcColor = srcPtr[srcY * srcWidth + srcX];
             if (srcColor & 0xFF000000) {
-                blendPixel(x, y, srcColor);
+                dstRow[x] = kernels::blend(dstRow[x], srcColor);
             }
         }
     }
@@ -653,54 +505,49 @@ void Image::blendImage0(const Image& src, int dstX, int dstY) {
         return;
     }
 
-    //uint32_t *dstPtr = getPixels();
+    int xStart = std::max(dstX, 0);
+    int xEnd = std::min(dstX + srcWidth, width);
+    int yStart = std::max(dstY, 0);
+    int yEnd = std::min(dstY + srcHeight, height);
+    if (xStart >= xEnd) {
+        return;
+    }
+
     const uint32_t *srcPtr = src.getPixels();
+    uint32_t *dstPtr = getPixels();
 
-    for (int y = dstY; y < dstY + srcHeight; y++) {
-        for (int x = dstX; x < dstX + srcWidth; x++) {
-            int srcX = x - dstX;
-            int srcY = y - dstY;
-            if (srcX < 0 || srcX >= srcWidth|| srcY < 0 || srcY >= srcHeight) {
-                continue;
-            }
-            uint32_t srcColor = srcPtr[srcY * srcWidth + srcX];
-            if (srcColor & 0xFF000000) {
-                blendPixel(x, y, srcColor);
+    for (int y = yStart; y < yEnd; y++) {
+        kernels::blendOver(dstPtr + y * width + xStart,
+                           srcPtr + (y - dstY) * srcWidth + (xStart - dstX),
+                           xEnd - xStart);
+    }
+}
+
+void Image::blendCoverage(const uint8_t *coverage, int srcWidth, int srcHeight, int dstX, int dstY, uint32_t color) {
+    int xStart = std::max(dstX, 0);
+    int xEnd = std::min(dstX + srcWidth, width);
+    int yStart = std::max(dstY, 0);
+    int yEnd = std::min(dstY + srcHeight, height);
+    if (xStart >= xEnd) {
+        return;
+    }
+
+    uint32_t rgb = color & 0x00FFFFFF;
+    uint32_t *dstPtr = getPixels();
+    for (int y = yStart; y < yEnd; y++) {
+        const uint8_t *srcRow = coverage + (y - dstY) * srcWidth - dstX;
+        uint32_t *dstRow = dstPtr + y * width;
+        for (int x = xStart; x < xEnd; x++) {
+            if (srcRow[x]) {
+                dstRow[x] = kernels::blend(dstRow[x], srcRow[x] << 24 | rgb);
             }
         }
     }
 }
 
 void Image::alphaBlend(uint32_t color) {
-    // background
-    float ba = (int) ((color >> 24) & 0xFF) / 255.0;
-    float br = (int) ((color >> 16) & 0xFF) / 255.0;
-    float bg = (int) ((color >>  8) & 0xFF) / 255.0;
-    float bb = (int) ((color >>  0) & 0xFF) / 255.0;
-
-
-    for (int y = 0; y < height; y++) {
-        uint32_t *ptr = getPixels() + y * width;
-        for (int x = 0; x < width; x++) {
-            int foreCol = ptr[x];
-
-            // foreground
-            float fa = (int) ((foreCol >> 24) & 0xFF) / 255.0;
-            float fr = (int) ((foreCol >> 16) & 0xFF) / 255.0;
-            float fg = (int) ((foreCol >>  8) & 0xFF) / 255.0;
-            float fb = (int) ((foreCol >>  0) & 0xFF) / 255.0;
-
-            float a = fa + ba * (1 - fa);
-            float r = (fr * fa + br * ba * (1 - fa)) / a;
-            float g = (fg * fa + bg * ba * (1 - fa)) / a;
-            float b = (fb * fa + bb * ba * (1 - fa)) / a;
-
-            ptr[x] =  (uint8_t(a * 255) << 24)
-                    | (uint8_t(r * 255) << 16)
-                    | (uint8_t(g * 255) << 8)
-                    | (uint8_t(b * 255) << 0);
-        }
-    }
+    // blend the image over the given background color
+    kernels::blendOverColor(getPixels(), (size_t) width * height, color);
 }
 
 void Image::rotate0(Image& dst) {
@@ -721,6 +568,10 @@ void Image::rotate0(Image& dst) {
     }
 }
 
+// The 90 and 270 degree rotations read the source column-wise. Processing them in
+// square blocks keeps the touched source and destination lines in the cache.
+constexpr const int ROTATE_BLOCK_SIZE = 32;
+
 void Image::rotate90(Image &dst) {
     uint32_t *srcPtr = getPixels();
     uint32_t *dstPtr = dst.getPixels();
@@ -728,16 +579,23 @@ void Image::rotate90(Image &dst) {
     int xOffset = width / 2 - dst.height / 2;
     int yOffset = height / 2 - dst.width / 2;
 
-    for (int y = 0; y < dst.height; y++) {
-        int srcX = xOffset + y;
-
-        for (int x = 0; x < dst.width; x++) {
-            int srcY = width - 1 - yOffset - x;
-            if (srcX < 0 || srcX >= width || srcY < 0 || srcY >= height) {
-                continue;
+    // dst(x, y) = src(xOffset + y, width - 1 - yOffset - x), clipped to the source
+    int yStart = std::max(0, -xOffset);
+    int yEnd = std::min(dst.height, width - xOffset);
+    int xStart = std::max(0, width - yOffset - height);
+    int xEnd = std::min(dst.width, width - yOffset);
+
+    for (int by = yStart; by < yEnd; by += ROTATE_BLOCK_SIZE) {
+        int byEnd = std::min(by + ROTATE_BLOCK_SIZE, yEnd);
+        for (int bx = xStart; bx < xEnd; bx += ROTATE_BLOCK_SIZE) {
+            int bxEnd = std::min(bx + ROTATE_BLOCK_SIZE, xEnd);
+            for (int y = by; y < byEnd; y++) {
+                int srcX = xOffset + y;
+                uint32_t *dstRow = dstPtr + y * dst.width;
+                for (int x = bx; x < bxEnd; x++) {
+                    dstRow[x] = srcPtr[(width - 1 - yOffset - x) * width + srcX];
+                }
             }
-
-            dstPtr[y * dst.width + x] = srcPtr[srcY * width + srcX];
         }
     }
 }
@@ -749,17 +607,23 @@ void Image::rotate180(Image &dst) {
     uint32_t *srcPtr = getPixels();
     uint32_t *dstPtr = dst.getPixels();
 
+    // dst(x, y) = src(width - 1 - xOffset - x, height - 1 - yOffset - y), clipped to the source
+    int xStart = std::max(0, -xOffset);
+    int xEnd = std::min(dst.width, width - xOffset);
+    if (xStart >= xEnd) {
+        return;
+    }
+
     for (int y = 0; y < dst.height; y++) {
         int srcY = height - 1 - yOffset - y;
-        int startX = xOffset;
-        for (int x = startX; x < dst.width; x++) {
-            int srcX = width - x - 1;
-            if (srcX < 0 || srcX >= width || srcY < 0 || srcY >= height) {
-                continue;
-            }
-
-            dstPtr[y * dst.width + x] = srcPtr[srcY * width + srcX];
+        if (srcY < 0 || srcY >= height) {
+            continue;
         }
+
+        // the source span ends at srcX = width - 1 - xOffset - xStart
+        int srcXEnd = width - 1 - xOffset - xStart;
+        int count = xEnd - xStart;
+        kernels::reverseCopy(dstPtr + y * dst.width + xStart, srcPtr + srcY * width + srcXEnd - count + 1, count);
     }
 }
 
@@ -770,15 +634,23 @@ void Image::rotate270(Image &dst) {
     int xOffset = width / 2 - dst.height / 2;
     int yOffset = height / 2 - dst.width / 2;
 
-    for (int y = 0; y < dst.height; y++) {
-        int srcX = height - 1 - xOffset - y;
-
-        for (int x = 0; x < dst.width; x++) {
-            int srcY = yOffset + x;
-            if (srcX < 0 || srcX >= width || srcY < 0 || srcY >= height) {
-                continue;
+    // dst(x, y) = src(height - 1 - xOffset - y, yOffset + x), clipped to the source
+    int yStart = std::max(0, height - xOffset - width);
+    int yEnd = std::min(dst.height, height - xOffset);
+    int xStart = std::max(0, -yOffset);
+    int xEnd = std::min(dst.width, height - yOffset);
+
+    for (int by = yStart; by < yEnd; by += ROTATE_BLOCK_SIZE) {
+        int byEnd = std::min(by + ROTATE_BLOCK_SIZE, yEnd);
+        for (int bx = xStart; bx < xEnd; bx += ROTATE_BLOCK_SIZE) {
+            int bxEnd = std::min(bx + ROTATE_BLOCK_SIZE, xEnd);
+            for (int y = by; y < byEnd; y++) {
+                int srcX = height - 1 - xOffset - y;
+                uint32_t *dstRow = dstPtr + y * dst.width;
+                for (int x = bx; x < bxEnd; x++) {
+                    dstRow[x] = srcPtr[(yOffset + x) * width + srcX];
+                }
             }
-            dstPtr[y * dst.width + x] = srcPtr[srcY * width + srcX];
         }
     }
 }
@@ -795,11 +667,14 @@ void Image::rotate(Image& dst, int angle) {
 
 void Image::drawText(const std::string &text, int size, int x, int y, uint32_t fgColor, uint32_t bgColor, Align al) {
     // x, y, is top left corner
-    static TTFStamper textBox("Inconsolata.ttf");
-    textBox.setSize(size);
-    textBox.setColor(fgColor & 0x00FFFFFF);
-    textBox.setText(text);
-    auto textWidth = textBox.getTextWidth(text);
+    std::shared_ptr<const TextMask> mask;
+    {
+        std::lock_guard<std::mutex> lock(textStamperMutex);
+        auto &textBox = getTextStamper();
+        textBox.setSize(size);
+        mask = textBox.getTextMask(text);
+    }
+    size_t textWidth = mask->width;
     int xOffset = 0;
     if (al == Align::CENTRE) {
         xOffset = -textWidth / 2;
@@ -809,14 +684,14 @@ void Image::drawText(const std::string &text, int size, int x, int y, uint32_t f
     if (bgColor & 0xFF000000) {
         fillRectangle(x + xOffset - 1, y, x + xOffset + textWidth, y + size, bgColor);
     }
-    textBox.applyStamp(*this, x + xOffset, y);
+    blendCoverage(mask->coverage.data(), mask->width, mask->height, x + xOffset, y, fgColor);
 }
 
 int Image::getTextWidth(const std::string text, int size) {
-    static TTFStamper dummyBox("Inconsolata.ttf");
-    dummyBox.setSize(size);
-    dummyBox.setText(text.c_str());
-    return dummyBox.getTextWidth(text);
+    std::lock_guard<std::mutex> lock(textStamperMutex);
+    auto &textBox = getTextStamper();
+    textBox.setSize(size);
+    return textBox.getTextWidth(text);
 }
 
 } /* namespace img */
@@ -42,6 +42,21 @@ constexpr const uint32_t COLOR_TRANSPARENT_WHITE = 0x80FFFFFF;
 
 constexpr const uint32_t DARKER = -0x00101010;
 
+// Pixel rectangle, x1 and y1 are exclusive
+struct Rect {
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+
+    bool isEmpty() const { return x1 <= x0 || y1 <= y0; }
+    Rect intersect(const Rect &other) const;
+    Rect unite(const Rect &other) const;
+};
+
+template<typename T>
+struct Point {
+    T x {};
+    T y {};
+};
+
 enum class Align {
     LEFT,
     CENTRE,
@@ -74,12 +89,20 @@ public:
     void scale(int newWidth, int newHeight);
     void drawPixel(int x, int y, uint32_t color);
     void drawLine(int x1, int y1, int x2, int y2, uint32_t color);
+    // Anti-aliased shapes, coordinates are pixel centres. Arc angles are clockwise from up.
     void drawLineAA(float x0, float y0, float x1, float y1, uint32_t color);
+    void drawThickLine(float x0, float y0, float x1, float y1, float lineWidth, uint32_t color);
+    void drawArc(float x, float y, float radius, float startDegrees, float endDegrees, float lineWidth, uint32_t color);
+    void fillPolygon(const std::vector<Point<float>> &points, uint32_t color);
     void drawImage(const Image &src, int dstX, int dstY);
+    void drawImage(const Image &src, int dstX, int dstY, const Rect &clip);
+    void shift(int dx, int dy);
     void copyTo(Image &dst, int srcX, int srcY);
     void blendImage(const Image &src, int dstX, int dstY, double angle);
     void blendImage270(const Image &src, int dstX, int dstY);
     void blendImage0(const Image &src, int dstX, int dstY);
+    // Blend a color using one byte of coverage per pixel as its alpha
+    void blendCoverage(const uint8_t *coverage, int srcWidth, int srcHeight, int dstX, int dstY, uint32_t color);
     void alphaBlend(uint32_t color);
     void blendPixel(int x, int y, uint32_t color);
     void fillCircle(int x, int y, int radius, uint32_t color);
@@ -101,14 +124,12 @@ public:
 private:
     int width = 0;
     int height = 0;
-    uint32_t drawLineAAColor = 0;
     std::unique_ptr<std::vector<uint8_t>> encodedData;
     std::unique_ptr<std::vector<uint32_t>> pixels;
 
     std::map<uint64_t, std::shared_ptr<img::Image>> circleCache;
 
     void fillCircleCacheImage(int x_centre, int y_centre, int radius, uint32_t color);
-    void plot(int x, int y, float brightness);
 };
 
 } /* namespace img */
@@ -0,0 +1,552 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "PixelKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace img {
+namespace kernels {
+
+uint32_t blend(uint32_t back, uint32_t fore) {
+    float ba = (int) ((back >> 24) & 0xFF) / 255.0;
+    float br = (int) ((back >> 16) & 0xFF) / 255.0;
+    float bg = (int) ((back >>  8) & 0xFF) / 255.0;
+    float bb = (int) ((back >>  0) & 0xFF) / 255.0;
+
+    float fa = (int) ((fore >> 24) & 0xFF) / 255.0;
+    float fr = (int) ((fore >> 16) & 0xFF) / 255.0;
+    float fg = (int) ((fore >>  8) & 0xFF) / 255.0;
+    float fb = (int) ((fore >>  0) & 0xFF) / 255.0;
+
+    float a = fa + ba * (1 - fa);
+    if (a <= 0) {
+        return 0;
+    }
+    float r = (fr * fa + br * ba * (1 - fa)) / a;
+    float g = (fg * fa + bg * ba * (1 - fa)) / a;
+    float b = (fb * fa + bb * ba * (1 - fa)) / a;
+
+    return (uint8_t(a * 255) << 24)
+         | (uint8_t(r * 255) << 16)
+         | (uint8_t(g * 255) << 8)
+         | (uint8_t(b * 255) << 0);
+}
+
+namespace {
+
+// Plain C++ versions, also used for the tails of the SIMD loops
+
+inline uint32_t swapRedBlue1(uint32_t p) {
+    return (p & 0xFF00FF00) | ((p >> 16) & 0xFF) | ((p & 0xFF) << 16);
+}
+
+inline void blendOver1(uint32_t &dst, uint32_t src) {
+    uint32_t alpha = src >> 24;
+    if (alpha == 0xFF) {
+        dst = src;
+    } else if (alpha != 0) {
+        dst = blend(dst, src);
+    }
+}
+
+void swapRedBlueScalar(uint32_t *dst, const uint32_t *src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = swapRedBlue1(src[i]);
+    }
+}
+
+void blendOverScalar(uint32_t *dst, const uint32_t *src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        blendOver1(dst[i], src[i]);
+    }
+}
+
+void blendOverColorScalar(uint32_t *pixels, size_t count, uint32_t background) {
+    for (size_t i = 0; i < count; i++) {
+        pixels[i] = blend(background, pixels[i]);
+    }
+}
+
+void blendColorScalar(uint32_t *pixels, size_t count, uint32_t color) {
+    for (size_t i = 0; i < count; i++) {
+        pixels[i] = blend(pixels[i], color);
+    }
+}
+
+void reverseCopyScalar(uint32_t *dst, const uint32_t *src, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = src[count - 1 - i];
+    }
+}
+
+#ifdef KERNELS_X86
+
+void swapRedBlueSSE2(uint32_t *dst, const uint32_t *src, size_t count) {
+    const __m128i keep = _mm_set1_epi32(0xFF00FF00);
+    const __m128i low = _mm_set1_epi32(0xFF);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i r = _mm_and_si128(_mm_srli_epi32(p, 16), low);
+        __m128i b = _mm_slli_epi32(_mm_and_si128(p, low), 16);
+        p = _mm_or_si128(_mm_and_si128(p, keep), _mm_or_si128(r, b));
+        _mm_storeu_si128((__m128i *) (dst + i), p);
+    }
+    swapRedBlueScalar(dst + i, src + i, count - i);
+}
+
+void blendOverSSE2(uint32_t *dst, const uint32_t *src, size_t count) {
+    const __m128i opaque = _mm_set1_epi32(0xFF);
+    const __m128i transparent = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i alpha = _mm_srli_epi32(s, 24);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, opaque)) == 0xFFFF) {
+            _mm_storeu_si128((__m128i *) (dst + i), s);
+        } else if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, transparent)) != 0xFFFF) {
+            for (size_t j = i; j < i + 4; j++) {
+                blendOver1(dst[j], src[j]);
+            }
+        }
+    }
+    blendOverScalar(dst + i, src + i, count - i);
+}
+
+void blendOverColorSSE2(uint32_t *pixels, size_t count, uint32_t background) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128 norm = _mm_set1_ps(1.0f / 255.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 tiny = _mm_set1_ps(1e-6f);
+
+    const __m128 ba = _mm_set1_ps(((background >> 24) & 0xFF) / 255.0f);
+    const __m128 br = _mm_set1_ps(((background >> 16) & 0xFF) / 255.0f);
+    const __m128 bg = _mm_set1_ps(((background >>  8) & 0xFF) / 255.0f);
+    const __m128 bb = _mm_set1_ps(((background >>  0) & 0xFF) / 255.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *) (pixels + i));
+        __m128 fa = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(p, 24)), norm);
+        __m128 fr = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 16), mask)), norm);
+        __m128 fg = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 8), mask)), norm);
+        __m128 fb = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(p, mask)), norm);
+
+        __m128 bw = _mm_mul_ps(ba, _mm_sub_ps(one, fa));
+        __m128 a = _mm_add_ps(fa, bw);
+        __m128 invA = _mm_div_ps(scale, _mm_max_ps(a, tiny));
+
+        __m128 r = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(fr, fa), _mm_mul_ps(br, bw)), invA);
+        __m128 g = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(fg, fa), _mm_mul_ps(bg, bw)), invA);
+        __m128 b = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(fb, fa), _mm_mul_ps(bb, bw)), invA);
+
+        __m128i res = _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(a, scale)), 24);
+        res = _mm_or_si128(res, _mm_slli_epi32(_mm_and_si128(_mm_cvttps_epi32(r), mask), 16));
+        res = _mm_or_si128(res, _mm_slli_epi32(_mm_and_si128(_mm_cvttps_epi32(g), mask), 8));
+        res = _mm_or_si128(res, _mm_and_si128(_mm_cvttps_epi32(b), mask));
+        _mm_storeu_si128((__m128i *) (pixels + i), res);
+    }
+    blendOverColorScalar(pixels + i, count - i, background);
+}
+
+void blendColorSSE2(uint32_t *pixels, size_t count, uint32_t color) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128 norm = _mm_set1_ps(1.0f / 255.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 tiny = _mm_set1_ps(1e-6f);
+
+    float alpha = ((color >> 24) & 0xFF) / 255.0f;
+    const __m128 fa = _mm_set1_ps(alpha);
+    const __m128 fInv = _mm_set1_ps(1.0f - alpha);
+    const __m128 fr = _mm_set1_ps(((color >> 16) & 0xFF) / 255.0f * alpha);
+    const __m128 fg = _mm_set1_ps(((color >>  8) & 0xFF) / 255.0f * alpha);
+    const __m128 fb = _mm_set1_ps(((color >>  0) & 0xFF) / 255.0f * alpha);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *) (pixels + i));
+        __m128 ba = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(p, 24)), norm);
+        __m128 br = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 16), mask)), norm);
+        __m128 bg = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 8), mask)), norm);
+        __m128 bb = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(p, mask)), norm);
+
+        __m128 bw = _mm_mul_ps(ba, fInv);
+        __m128 a = _mm_add_ps(fa, bw);
+        __m128 invA = _mm_div_ps(scale, _mm_max_ps(a, tiny));
+
+        __m128 r = _mm_mul_ps(_mm_add_ps(fr, _mm_mul_ps(br, bw)), invA);
+        __m128 g = _mm_mul_ps(_mm_add_ps(fg, _mm_mul_ps(bg, bw)), invA);
+        __m128 b = _mm_mul_ps(_mm_add_ps(fb, _mm_mul_ps(bb, bw)), invA);
+
+        __m128i res = _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(a, scale)), 24);
+        res = _mm_or_si128(res, _mm_slli_epi32(_mm_and_si128(_mm_cvttps_epi32(r), mask), 16));
+        res = _mm_or_si128(res, _mm_slli_epi32(_mm_and_si128(_mm_cvttps_epi32(g), mask), 8));
+        res = _mm_or_si128(res, _mm_and_si128(_mm_cvttps_epi32(b), mask));
+        _mm_storeu_si128((__m128i *) (pixels + i), res);
+    }
+    blendColorScalar(pixels + i, count - i, color);
+}
+
+void reverseCopySSE2(uint32_t *dst, const uint32_t *src, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i *) (src + count - 4 - i));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_shuffle_epi32(p, _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+    reverseCopyScalar(dst + i, src, count - i);
+}
+
+__attribute__((target("avx2")))
+void swapRedBlueAVX2(uint32_t *dst, const uint32_t *src, size_t count) {
+    const __m256i keep = _mm256_set1_epi32(0xFF00FF00);
+    const __m256i low = _mm256_set1_epi32(0xFF);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i p = _mm256_loadu_si256((const __m256i *) (src + i));
+        __m256i r = _mm256_and_si256(_mm256_srli_epi32(p, 16), low);
+        __m256i b = _mm256_slli_epi32(_mm256_and_si256(p, low), 16);
+        p = _mm256_or_si256(_mm256_and_si256(p, keep), _mm256_or_si256(r, b));
+        _mm256_storeu_si256((__m256i *) (dst + i), p);
+    }
+    swapRedBlueScalar(dst + i, src + i, count - i);
+}
+
+// 8 pixels of blend(back, fore). The operations are done in the same order as
+// in the scalar blend, so that the results are identical. The channels are
+// divided by 255 rather than multiplied by its inverse for the same reason.
+__attribute__((target("avx2")))
+inline __m256i blendAVX2(__m256i back, __m256i fore) {
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    const __m256 scale = _mm256_set1_ps(255.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    __m256 ba = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(back, 24)), scale);
+    __m256 br = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(back, 16), mask)), scale);
+    __m256 bg = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(back, 8), mask)), scale);
+    __m256 bb = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(back, mask)), scale);
+
+    __m256 fa = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(fore, 24)), scale);
+    __m256 fr = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(fore, 16), mask)), scale);
+    __m256 fg = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(fore, 8), mask)), scale);
+    __m256 fb = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_and_si256(fore, mask)), scale);
+
+    __m256 rest = _mm256_sub_ps(one, fa);
+    __m256 a = _mm256_add_ps(fa, _mm256_mul_ps(ba, rest));
+    __m256 r = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(fr, fa), _mm256_mul_ps(_mm256_mul_ps(br, ba), rest)), a);
+    __m256 g = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(fg, fa), _mm256_mul_ps(_mm256_mul_ps(bg, ba), rest)), a);
+    __m256 b = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(fb, fa), _mm256_mul_ps(_mm256_mul_ps(bb, ba), rest)), a);
+
+    __m256i res = _mm256_slli_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(a, scale)), 24);
+    res = _mm256_or_si256(res, _mm256_slli_epi32(_mm256_and_si256(_mm256_cvttps_epi32(_mm256_mul_ps(r, scale)), mask), 16));
+    res = _mm256_or_si256(res, _mm256_slli_epi32(_mm256_and_si256(_mm256_cvttps_epi32(_mm256_mul_ps(g, scale)), mask), 8));
+    return _mm256_or_si256(res, _mm256_and_si256(_mm256_cvttps_epi32(_mm256_mul_ps(b, scale)), mask));
+}
+
+__attribute__((target("avx2")))
+void blendOverAVX2(uint32_t *dst, const uint32_t *src, size_t count) {
+    const __m256i opaque = _mm256_set1_epi32(0xFF);
+    const __m256i transparent = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *) (src + i));
+        __m256i alpha = _mm256_srli_epi32(s, 24);
+        __m256i isOpaque = _mm256_cmpeq_epi32(alpha, opaque);
+        __m256i isTransparent = _mm256_cmpeq_epi32(alpha, transparent);
+        if (_mm256_movemask_epi8(isOpaque) == -1) {
+            _mm256_storeu_si256((__m256i *) (dst + i), s);
+        } else if (_mm256_movemask_epi8(isTransparent) != -1) {
+            // blending all lanes here avoids the transitions between AVX and the scalar SSE code
+            __m256i d = _mm256_loadu_si256((const __m256i *) (dst + i));
+            __m256i res = _mm256_blendv_epi8(blendAVX2(d, s), s, isOpaque);
+            res = _mm256_blendv_epi8(res, d, isTransparent);
+            _mm256_storeu_si256((__m256i *) (dst + i), res);
+        }
+    }
+    blendOverScalar(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void blendOverColorAVX2(uint32_t *pixels, size_t count, uint32_t background) {
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    const __m256 norm = _mm256_set1_ps(1.0f / 255.0f);
+    const __m256 scale = _mm256_set1_ps(255.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 tiny = _mm256_set1_ps(1e-6f);
+
+    const __m256 ba = _mm256_set1_ps(((background >> 24) & 0xFF) / 255.0f);
+    const __m256 br = _mm256_set1_ps(((background >> 16) & 0xFF) / 255.0f);
+    const __m256 bg = _mm256_set1_ps(((background >>  8) & 0xFF) / 255.0f);
+    const __m256 bb = _mm256_set1_ps(((background >>  0) & 0xFF) / 255.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i p = _mm256_loadu_si256((const __m256i *) (pixels + i));
+        __m256 fa = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(p, 24)), norm);
+        __m256 fr = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(p, 16), mask)), norm);
+        __m256 fg = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(p, 8), mask)), norm);
+        __m256 fb = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(p, mask)), norm);
+
+        __m256 bw = _mm256_mul_ps(ba, _mm256_sub_ps(one, fa));
+        __m256 a = _mm256_add_ps(fa, bw);
+        __m256 invA = _mm256_div_ps(scale, _mm256_max_ps(a, tiny));
+
+        __m256 r = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(fr, fa), _mm256_mul_ps(br, bw)), invA);
+        __m256 g = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(fg, fa), _mm256_mul_ps(bg, bw)), invA);
+        __m256 b = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(fb, fa), _mm256_mul_ps(bb, bw)), invA);
+
+        __m256i res = _mm256_slli_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(a, scale)), 24);
+        res = _mm256_or_si256(res, _mm256_slli_epi32(_mm256_and_si256(_mm256_cvttps_epi32(r), mask), 16));
+        res = _mm256_or_si256(res, _mm256_slli_epi32(_mm256_and_si256(_mm256_cvttps_epi32(g), mask), 8));
+        res = _mm256_or_si256(res, _mm256_and_si256(_mm256_cvttps_epi32(b), mask));
+        _mm256_storeu_si256((__m256i *) (pixels + i), res);
+    }
+    blendOverColorScalar(pixels + i, count - i, background);
+}
+
+__attribute__((target("avx2")))
+void blendColorAVX2(uint32_t *pixels, size_t count, uint32_t color) {
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    const __m256 norm = _mm256_set1_ps(1.0f / 255.0f);
+    const __m256 scale = _mm256_set1_ps(255.0f);
+    const __m256 tiny = _mm256_set1_ps(1e-6f);
+
+    float alpha = ((color >> 24) & 0xFF) / 255.0f;
+    const __m256 fa = _mm256_set1_ps(alpha);
+    const __m256 fInv = _mm256_set1_ps(1.0f - alpha);
+    const __m256 fr = _mm256_set1_ps(((color >> 16) & 0xFF) / 255.0f * alpha);
+    const __m256 fg = _mm256_set1_ps(((color >>  8) & 0xFF) / 255.0f * alpha);
+    const __m256 fb = _mm256_set1_ps(((color >>  0) & 0xFF) / 255.0f * alpha);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i p = _mm256_loadu_si256((const __m256i *) (pixels + i));
+        __m256 ba = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(p, 24)), norm);
+        __m256 br = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(p, 16), mask)), norm);
+        __m256 bg = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(p, 8), mask)), norm);
+        __m256 bb = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(p, mask)), norm);
+
+        __m256 bw = _mm256_mul_ps(ba, fInv);
+        __m256 a = _mm256_add_ps(fa, bw);
+        __m256 invA = _mm256_div_ps(scale, _mm256_max_ps(a, tiny));
+
+        __m256 r = _mm256_mul_ps(_mm256_add_ps(fr, _mm256_mul_ps(br, bw)), invA);
+        __m256 g = _mm256_mul_ps(_mm256_add_ps(fg, _mm256_mul_ps(bg, bw)), invA);
+        __m256 b = _mm256_mul_ps(_mm256_add_ps(fb, _mm256_mul_ps(bb, bw)), invA);
+
+        __m256i res = _mm256_slli_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(a, scale)), 24);
+        res = _mm256_or_si256(res, _mm256_slli_epi32(_mm256_and_si256(_mm256_cvttps_epi32(r), mask), 16));
+        res = _mm256_or_si256(res, _mm256_slli_epi32(_mm256_and_si256(_mm256_cvttps_epi32(g), mask), 8));
+        res = _mm256_or_si256(res, _mm256_and_si256(_mm256_cvttps_epi32(b), mask));
+        _mm256_storeu_si256((__m256i *) (pixels + i), res);
+    }
+    blendColorScalar(pixels + i, count - i, color);
+}
+
+__attribute__((target("avx2")))
+void reverseCopyAVX2(uint32_t *dst, const uint32_t *src, size_t count) {
+    const __m256i reversed = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i p = _mm256_loadu_si256((const __m256i *) (src + count - 8 - i));
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_permutevar8x32_epi32(p, reversed));
+    }
+    reverseCopyScalar(dst + i, src, count - i);
+}
+
+#endif /* KERNELS_X86 */
+
+#ifdef KERNELS_NEON
+
+void swapRedBlueNEON(uint32_t *dst, const uint32_t *src, size_t count) {
+    const uint32x4_t keep = vdupq_n_u32(0xFF00FF00);
+    const uint32x4_t low = vdupq_n_u32(0xFF);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t p = vld1q_u32(src + i);
+        uint32x4_t r = vandq_u32(vshrq_n_u32(p, 16), low);
+        uint32x4_t b = vshlq_n_u32(vandq_u32(p, low), 16);
+        vst1q_u32(dst + i, vorrq_u32(vandq_u32(p, keep), vorrq_u32(r, b)));
+    }
+    swapRedBlueScalar(dst + i, src + i, count - i);
+}
+
+void blendOverNEON(uint32_t *dst, const uint32_t *src, size_t count) {
+    const uint32x4_t opaque = vdupq_n_u32(0xFF);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t s = vld1q_u32(src + i);
+        uint32x4_t alpha = vshrq_n_u32(s, 24);
+        if (vminvq_u32(vceqq_u32(alpha, opaque)) == 0xFFFFFFFF) {
+            vst1q_u32(dst + i, s);
+        } else if (vmaxvq_u32(alpha) != 0) {
+            for (size_t j = i; j < i + 4; j++) {
+                blendOver1(dst[j], src[j]);
+            }
+        }
+    }
+    blendOverScalar(dst + i, src + i, count - i);
+}
+
+void blendOverColorNEON(uint32_t *pixels, size_t count, uint32_t background) {
+    const uint32x4_t mask = vdupq_n_u32(0xFF);
+    const float32x4_t norm = vdupq_n_f32(1.0f / 255.0f);
+    const float32x4_t scale = vdupq_n_f32(255.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t tiny = vdupq_n_f32(1e-6f);
+
+    const float32x4_t ba = vdupq_n_f32(((background >> 24) & 0xFF) / 255.0f);
+    const float32x4_t br = vdupq_n_f32(((background >> 16) & 0xFF) / 255.0f);
+    const float32x4_t bg = vdupq_n_f32(((background >>  8) & 0xFF) / 255.0f);
+    const float32x4_t bb = vdupq_n_f32(((background >>  0) & 0xFF) / 255.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t p = vld1q_u32(pixels + i);
+        float32x4_t fa = vmulq_f32(vcvtq_f32_u32(vshrq_n_u32(p, 24)), norm);
+        float32x4_t fr = vmulq_f32(vcvtq_f32_u32(vandq_u32(vshrq_n_u32(p, 16), mask)), norm);
+        float32x4_t fg = vmulq_f32(vcvtq_f32_u32(vandq_u32(vshrq_n_u32(p, 8), mask)), norm);
+        float32x4_t fb = vmulq_f32(vcvtq_f32_u32(vandq_u32(p, mask)), norm);
+
+        float32x4_t bw = vmulq_f32(ba, vsubq_f32(one, fa));
+        float32x4_t a = vaddq_f32(fa, bw);
+        float32x4_t invA = vdivq_f32(scale, vmaxq_f32(a, tiny));
+
+        float32x4_t r = vmulq_f32(vmlaq_f32(vmulq_f32(br, bw), fr, fa), invA);
+        float32x4_t g = vmulq_f32(vmlaq_f32(vmulq_f32(bg, bw), fg, fa), invA);
+        float32x4_t b = vmulq_f32(vmlaq_f32(vmulq_f32(bb, bw), fb, fa), invA);
+
+        uint32x4_t res = vshlq_n_u32(vcvtq_u32_f32(vmulq_f32(a, scale)), 24);
+        res = vorrq_u32(res, vshlq_n_u32(vandq_u32(vcvtq_u32_f32(r), mask), 16));
+        res = vorrq_u32(res, vshlq_n_u32(vandq_u32(vcvtq_u32_f32(g), mask), 8));
+        res = vorrq_u32(res, vandq_u32(vcvtq_u32_f32(b), mask));
+        vst1q_u32(pixels + i, res);
+    }
+    blendOverColorScalar(pixels + i, count - i, background);
+}
+
+void blendColorNEON(uint32_t *pixels, size_t count, uint32_t color) {
+    const uint32x4_t mask = vdupq_n_u32(0xFF);
+    const float32x4_t norm = vdupq_n_f32(1.0f / 255.0f);
+    const float32x4_t scale = vdupq_n_f32(255.0f);
+    const float32x4_t tiny = vdupq_n_f32(1e-6f);
+
+    float alpha = ((color >> 24) & 0xFF) / 255.0f;
+    const float32x4_t fa = vdupq_n_f32(alpha);
+    const float32x4_t fInv = vdupq_n_f32(1.0f - alpha);
+    const float32x4_t fr = vdupq_n_f32(((color >> 16) & 0xFF) / 255.0f * alpha);
+    const float32x4_t fg = vdupq_n_f32(((color >>  8) & 0xFF) / 255.0f * alpha);
+    const float32x4_t fb = vdupq_n_f32(((color >>  0) & 0xFF) / 255.0f * alpha);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t p = vld1q_u32(pixels + i);
+        float32x4_t ba = vmulq_f32(vcvtq_f32_u32(vshrq_n_u32(p, 24)), norm);
+        float32x4_t br = vmulq_f32(vcvtq_f32_u32(vandq_u32(vshrq_n_u32(p, 16), mask)), norm);
+        float32x4_t bg = vmulq_f32(vcvtq_f32_u32(vandq_u32(vshrq_n_u32(p, 8), mask)), norm);
+        float32x4_t bb = vmulq_f32(vcvtq_f32_u32(vandq_u32(p, mask)), norm);
+
+        float32x4_t bw = vmulq_f32(ba, fInv);
+        float32x4_t a = vaddq_f32(fa, bw);
+        float32x4_t invA = vdivq_f32(scale, vmaxq_f32(a, tiny));
+
+        float32x4_t r = vmulq_f32(vmlaq_f32(fr, br, bw), invA);
+        float32x4_t g = vmulq_f32(vmlaq_f32(fg, bg, bw), invA);
+        float32x4_t b = vmulq_f32(vmlaq_f32(fb, bb, bw), invA);
+
+        uint32x4_t res = vshlq_n_u32(vcvtq_u32_f32(vmulq_f32(a, scale)), 24);
+        res = vorrq_u32(res, vshlq_n_u32(vandq_u32(vcvtq_u32_f32(r), mask), 16));
+        res = vorrq_u32(res, vshlq_n_u32(vandq_u32(vcvtq_u32_f32(g), mask), 8));
+        res = vorrq_u32(res, vandq_u32(vcvtq_u32_f32(b), mask));
+        vst1q_u32(pixels + i, res);
+    }
+    blendColorScalar(pixels + i, count - i, color);
+}
+
+void reverseCopyNEON(uint32_t *dst, const uint32_t *src, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t p = vrev64q_u32(vld1q_u32(src + count - 4 - i));
+        vst1q_u32(dst + i, vcombine_u32(vget_high_u32(p), vget_low_u32(p)));
+    }
+    reverseCopyScalar(dst + i, src, count - i);
+}
+
+#endif /* KERNELS_NEON */
+
+struct KernelTable {
+    const char *name;
+    void (*swapRedBlue)(uint32_t *, const uint32_t *, size_t);
+    void (*blendOver)(uint32_t *, const uint32_t *, size_t);
+    void (*blendOverColor)(uint32_t *, size_t, uint32_t);
+    void (*blendColor)(uint32_t *, size_t, uint32_t);
+    void (*reverseCopy)(uint32_t *, const uint32_t *, size_t);
+};
+
+KernelTable selectKernels() {
+#if defined(KERNELS_X86)
+    if (__builtin_cpu_supports("avx2")) {
+        return KernelTable{"AVX2", swapRedBlueAVX2, blendOverAVX2, blendOverColorAVX2, blendColorAVX2, reverseCopyAVX2};
+    }
+    return KernelTable{"SSE2", swapRedBlueSSE2, blendOverSSE2, blendOverColorSSE2, blendColorSSE2, reverseCopySSE2};
+#elif defined(KERNELS_NEON)
+    return KernelTable{"NEON", swapRedBlueNEON, blendOverNEON, blendOverColorNEON, blendColorNEON, reverseCopyNEON};
+#else
+    return KernelTable{"scalar", swapRedBlueScalar, blendOverScalar, blendOverColorScalar, blendColorScalar, reverseCopyScalar};
+#endif
+}
+
+const KernelTable &kernelTable() {
+    static const KernelTable table = selectKernels();
+    return table;
+}
+
+} /* anonymous namespace */
+
+void swapRedBlue(uint32_t *dst, const uint32_t *src, size_t count) {
+    kernelTable().swapRedBlue(dst, src, count);
+}
+
+void blendOver(uint32_t *dst, const uint32_t *src, size_t count) {
+    kernelTable().blendOver(dst, src, count);
+}
+
+void blendOverColor(uint32_t *pixels, size_t count, uint32_t background) {
+    kernelTable().blendOverColor(pixels, count, background);
+}
+
+void blendColor(uint32_t *pixels, size_t count, uint32_t color) {
+    kernelTable().blendColor(pixels, count, color);
+}
+
+void reverseCopy(uint32_t *dst, const uint32_t *src, size_t count) {
+    kernelTable().reverseCopy(dst, src, count);
+}
+
+const char *getInstructionSet() {
+    return kernelTable().name;
+}
+
+} /* namespace kernels */
+} /* namespace img */
@@ -0,0 +1,53 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_LIBIMG_PIXELKERNELS_H_
+#define SRC_LIBIMG_PIXELKERNELS_H_
+
+#include <cstdint>
+#include <cstddef>
+
+// Per-pixel loops over ARGB spans. The implementation is selected at runtime:
+// AVX2 or SSE2 on x86, NEON on ARM64 and plain C++ everywhere else.
+namespace img {
+namespace kernels {
+
+// Blend fore over back, both in ARGB
+uint32_t blend(uint32_t back, uint32_t fore);
+
+// Convert RGBA bytes to ARGB pixels by swapping the red and blue channels
+void swapRedBlue(uint32_t *dst, const uint32_t *src, size_t count);
+
+// Blend each src pixel over its dst pixel
+void blendOver(uint32_t *dst, const uint32_t *src, size_t count);
+
+// Blend each pixel over a constant background color
+void blendOverColor(uint32_t *pixels, size_t count, uint32_t background);
+
+// Blend a constant color over each pixel
+void blendColor(uint32_t *pixels, size_t count, uint32_t color);
+
+// Copy count pixels in reverse order, i.e. dst[i] = src[count - 1 - i]
+void reverseCopy(uint32_t *dst, const uint32_t *src, size_t count);
+
+// Name of the selected instruction set, for logging
+const char *getInstructionSet();
+
+} /* namespace kernels */
+} /* namespace img */
+
+#endif /* SRC_LIBIMG_PIXELKERNELS_H_ */
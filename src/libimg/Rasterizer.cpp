@@ -34,9 +34,25 @@ Rasterizer::Rasterizer(const std::vector<uint8_t> &data, const std::string type)
     loadMemory(data, type);
 }
 
+void Rasterizer::lockFitz(void *user, int lock) {
+    auto mutexes = reinterpret_cast<std::mutex *>(user);
+    mutexes[lock].lock();
+}
+
+void Rasterizer::unlockFitz(void *user, int lock) {
+    auto mutexes = reinterpret_cast<std::mutex *>(user);
+    mutexes[lock].unlock();
+}
+
 void Rasterizer::initFitz() {
     logger::verbose("Init fitz in thread %d", std::this_thread::get_id());
-    ctx = fz_new_context(nullptr, nullptr, FZ_STORE_UNLIMITED);
+
+    // locking is required so that the context can be cloned for parallel rendering
+    fitzLocks.user = fitzMutexes;
+    fitzLocks.lock = lockFitz;
+    fitzLocks.unlock = unlockFitz;
+
+    ctx = fz_new_context(nullptr, &fitzLocks, FZ_STORE_UNLIMITED);
     if (!ctx) {
         throw std::runtime_error("Couldn't initialize fitz");
     }
@@ -106,6 +122,10 @@ int Rasterizer::getTileSize() {
     return tileSize;
 }
 
+int Rasterizer::getMaxParallelRenders() const {
+    return MAX_PARALLEL_RENDERS;
+}
+
 double Rasterizer::getAspectRatio(int page) {
     auto &rect = pageRects.at(page);
     return (rect.x1 - rect.x0) / (rect.y1 - rect.y0);
@@ -130,7 +150,8 @@ int Rasterizer::getPageCount() const {
 }
 
 std::unique_ptr<Image> Rasterizer::loadTile(int page, int x, int y, int zoom, bool nightMode) {
-    loadPage(page);
+    fz_context *threadCtx = getThreadContext();
+    fz_display_list *pageList = acquirePageList(threadCtx, page);
 
     if (logLoadTimes) {
         logger::info("Loading tile %d, %d, %d, %d in thread %d", page, x, y, zoom, std::this_thread::get_id());
@@ -145,6 +166,7 @@ std::unique_ptr<Image> Rasterizer::loadTile(int page, int x, int y, int zoom, bo
     int outHeight = image->getHeight();
 
     float scale = zoomToScale(zoom);
+    int rotateAngle = preRotateAngle;
 
     fz_irect clipBox;
     clipBox.x0 = outStartX;
@@ -153,27 +175,28 @@ std::unique_ptr<Image> Rasterizer::loadTile(int page, int x, int y, int zoom, bo
     clipBox.y1 = outStartY + outHeight;
 
     fz_pixmap *pix = nullptr;
-    fz_try(ctx) {
+    fz_try(threadCtx) {
         uint8_t *outBuf = (uint8_t *) image->getPixels();
-        pix = fz_new_pixmap_with_data(ctx, fz_device_bgr(ctx), outWidth, outHeight, nullptr, 1, outWidth * 4, outBuf);
+        pix = fz_new_pixmap_with_data(threadCtx, fz_device_bgr(threadCtx), outWidth, outHeight, nullptr, 1, outWidth * 4, outBuf);
         pix->x = clipBox.x0;
         pix->y = clipBox.y0;
         pix->xres = 72; // fz_bound_page returned pixels with 72 dpi
         pix->yres = 72;
-    } fz_catch(ctx) {
-        throw std::runtime_error("Couldn't create pixmap: " + std::string(fz_caught_message(ctx)));
+    } fz_catch(threadCtx) {
+        fz_drop_display_list(threadCtx, pageList);
+        throw std::runtime_error("Couldn't create pixmap: " + std::string(fz_caught_message(threadCtx)));
     }
 
     fz_device *dev = nullptr;
-    fz_try(ctx) {
-        auto &rect = pageRects.at(currentPageNum);
+    fz_try(threadCtx) {
+        auto &rect = pageRects.at(page);
         int currentPageWidth = rect.x1 - rect.x0;
         int currentPageHeight = rect.y1 - rect.y0;
 
         auto startAt = std::chrono::steady_clock::now();
 
         int translateX = 0, translateY = 0;
-        switch(preRotateAngle) {
+        switch(rotateAngle) {
         case 0:
             translateX = 0;
             translateY = 0;
@@ -191,89 +214,135 @@ std::unique_ptr<Image> Rasterizer::loadTile(int page, int x, int y, int zoom, bo
             translateY = currentPageWidth * scale;
             break;
         default:
-            LOG_ERROR("Invalid preRotateAngle %d", preRotateAngle);
+            LOG_ERROR("Invalid preRotateAngle %d", rotateAngle);
             break;
         }
 
         fz_matrix scaleMatrix = fz_scale(scale, scale);
-        fz_matrix rotateMatrix = fz_rotate(preRotateAngle);
+        fz_matrix rotateMatrix = fz_rotate(rotateAngle);
         fz_matrix rotateAndScaleMatrix = fz_concat(scaleMatrix, rotateMatrix);
         fz_matrix translateMatrix = fz_translate(translateX, translateY);
         fz_matrix transformMatrix = fz_concat(rotateAndScaleMatrix, translateMatrix);
 
-        dev = fz_new_draw_device_with_bbox(ctx, transformMatrix, pix, &clipBox);
+        dev = fz_new_draw_device_with_bbox(threadCtx, transformMatrix, pix, &clipBox);
 
         // pre-fill page with white
-        fz_path *path = fz_new_path(ctx);
-        fz_moveto(ctx, path, 0, 0);
-        fz_lineto(ctx, path, 0, currentPageHeight);
-        fz_lineto(ctx, path, currentPageWidth, currentPageHeight);
-        fz_lineto(ctx, path, currentPageWidth, 0);
-        fz_closepath(ctx, path);
+        fz_path *path = fz_new_path(threadCtx);
+        fz_moveto(threadCtx, path, 0, 0);
+        fz_lineto(threadCtx, path, 0, currentPageHeight);
+        fz_lineto(threadCtx, path, currentPageWidth, currentPageHeight);
+        fz_lineto(threadCtx, path, currentPageWidth, 0);
+        fz_closepath(threadCtx, path);
         float white = 1.0f;
         if (nightMode) {
             white = 0.6f;
         }
-        fz_fill_path(ctx, dev, path, 0, fz_identity, fz_device_gray(ctx), &white, 1.0f, fz_default_color_params);
-        fz_drop_path(ctx, path);
+        fz_fill_path(threadCtx, dev, path, 0, fz_identity, fz_device_gray(threadCtx), &white, 1.0f, fz_default_color_params);
+        fz_drop_path(threadCtx, path);
 
         fz_rect pageRect;
         pageRect.x0 = 0;
         pageRect.y0 = 0;
         pageRect.x1 = currentPageWidth;
         pageRect.y1 = currentPageHeight;
-        fz_run_display_list(ctx, currentPageList, dev, fz_identity, pageRect, nullptr);
-        fz_close_device(ctx, dev);
-        fz_drop_device(ctx, dev);
+        fz_run_display_list(threadCtx, pageList, dev, fz_identity, pageRect, nullptr);
+        fz_close_device(threadCtx, dev);
+        fz_drop_device(threadCtx, dev);
 
         if (logLoadTimes) {
             auto endAt = std::chrono::steady_clock::now();
             auto dur = std::chrono::duration_cast<std::chrono::milliseconds>(endAt - startAt).count();
             logger::info("Tile loaded in %d millis", dur);
         }
-    } fz_catch(ctx) {
+    } fz_catch(threadCtx) {
         if (dev) {
-            fz_drop_device(ctx, dev);
+            fz_drop_device(threadCtx, dev);
         }
-        fz_drop_pixmap(ctx, pix);
-        throw std::runtime_error("Couldn't render page: " + std::string(fz_caught_message(ctx)));
+        fz_drop_pixmap(threadCtx, pix);
+        fz_drop_display_list(threadCtx, pageList);
+        throw std::runtime_error("Couldn't render page: " + std::string(fz_caught_message(threadCtx)));
     }
 
     if (pix) {
-        fz_drop_pixmap(ctx, pix);
+        fz_drop_pixmap(threadCtx, pix);
     }
+    fz_drop_display_list(threadCtx, pageList);
 
     return image;
 }
 
-void Rasterizer::loadPage(int page) {
-    if (page == currentPageNum && currentPageList != nullptr) {
-        return;
+fz_context *Rasterizer::getThreadContext() {
+    std::lock_guard<std::mutex> lock(threadContextMutex);
+
+    auto id = std::this_thread::get_id();
+    auto it = threadContexts.find(id);
+    if (it != threadContexts.end()) {
+        return it->second;
     }
 
-    freeCurrentPage();
+    fz_context *threadCtx = fz_clone_context(ctx);
+    if (!threadCtx) {
+        throw std::runtime_error("Couldn't clone fitz context");
+    }
+    threadContexts[id] = threadCtx;
+    return threadCtx;
+}
+
+fz_display_list *Rasterizer::acquirePageList(fz_context *threadCtx, int page) {
+    // returns a new reference that must be dropped by the caller
+    {
+        std::lock_guard<std::mutex> lock(pageCacheMutex);
+        for (auto it = pageCache.begin(); it != pageCache.end(); ++it) {
+            if (it->page == page) {
+                pageCache.splice(pageCache.begin(), pageCache, it);
+                return fz_keep_display_list(threadCtx, it->list);
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> docLock(documentMutex);
+
+    // another thread might have parsed the page while we were waiting for the document
+    {
+        std::lock_guard<std::mutex> lock(pageCacheMutex);
+        for (auto &entry: pageCache) {
+            if (entry.page == page) {
+                return fz_keep_display_list(threadCtx, entry.list);
+            }
+        }
+    }
 
     logger::verbose("Loading page %d in thread %d", (int) page, std::this_thread::get_id());
 
-    fz_try(ctx) {
-        currentPageList = fz_new_display_list_from_page_number(ctx, doc, page);
-        currentPageNum = page;
-    } fz_catch(ctx) {
-        throw std::runtime_error("Cannot parse page: " + std::string(fz_caught_message(ctx)));
+    fz_display_list *list = nullptr;
+    fz_try(threadCtx) {
+        list = fz_new_display_list_from_page_number(threadCtx, doc, page);
+    } fz_catch(threadCtx) {
+        throw std::runtime_error("Cannot parse page: " + std::string(fz_caught_message(threadCtx)));
     }
 
-    logger::verbose("Page %d rasterized", currentPageNum);
+    std::lock_guard<std::mutex> lock(pageCacheMutex);
+    pageCache.push_front(CachedPage{page, fz_keep_display_list(threadCtx, list)});
+    while (pageCache.size() > PAGE_CACHE_SIZE) {
+        // pages that are still being rendered hold their own reference
+        fz_drop_display_list(threadCtx, pageCache.back().list);
+        pageCache.pop_back();
+    }
+
+    logger::verbose("Page %d rasterized", page);
+    return list;
 }
 
 float Rasterizer::zoomToScale(int zoom) const {
     return std::pow(M_SQRT2, zoom);
 }
 
-void Rasterizer::freeCurrentPage() {
-    if (currentPageList) {
-        fz_drop_display_list(ctx, currentPageList);
-        currentPageList = nullptr;
+void Rasterizer::freePageCache() {
+    std::lock_guard<std::mutex> lock(pageCacheMutex);
+    for (auto &entry: pageCache) {
+        fz_drop_display_list(ctx, entry.list);
     }
+    pageCache.clear();
 }
 
 void Rasterizer::setPreRotate(int angle) {
@@ -281,7 +350,10 @@ void Rasterizer::setPreRotate(int angle) {
 }
 
 Rasterizer::~Rasterizer() {
-    freeCurrentPage();
+    freePageCache();
+    for (auto &it: threadContexts) {
+        fz_drop_context(it.second);
+    }
     fz_drop_document(ctx, doc);
     if (stream) {
         fz_drop_stream(ctx, stream);
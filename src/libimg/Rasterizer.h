@@ -22,6 +22,10 @@
 #include <vector>
 #include <string>
 #include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
 #include <mupdf/fitz.h>
 #include "Image.h"
 
@@ -33,6 +37,7 @@ public:
     Rasterizer(const std::vector<uint8_t> &data, const std::string type);
 
     int getTileSize();
+    int getMaxParallelRenders() const;
     int getPageWidth(int page, int zoom);
     int getPageHeight(int page, int zoom);
     double getAspectRatio(int page);
@@ -43,25 +48,49 @@ public:
 
     ~Rasterizer();
 private:
+    static constexpr const int MAX_PARALLEL_RENDERS = 4;
+    static constexpr const size_t PAGE_CACHE_SIZE = 8;
+
+    struct CachedPage {
+        int page;
+        fz_display_list *list;
+    };
+
     std::vector<uint8_t> dataBuf;
     std::vector<fz_rect> pageRects;
     bool logLoadTimes = false;
     int tileSize = 1024;
     int totalPages = 0;
-    int currentPageNum = 0;
-    int preRotateAngle = 0;
+    std::atomic_int preRotateAngle { 0 };
+
+    // The base context owns the document, each rendering thread uses its own clone
     fz_context *ctx {};
+    fz_locks_context fitzLocks {};
+    std::mutex fitzMutexes[FZ_LOCK_MAX];
+    std::mutex threadContextMutex;
+    std::map<std::thread::id, fz_context *> threadContexts;
+
     fz_stream *stream{};
     fz_document *doc{};
-    fz_display_list *currentPageList {};
+
+    // Display lists of the most recently used pages, most recent in front.
+    // Parsing a page needs exclusive access to the document, running a
+    // display list can be done concurrently.
+    std::mutex documentMutex;
+    std::mutex pageCacheMutex;
+    std::list<CachedPage> pageCache;
+
+    static void lockFitz(void *user, int lock);
+    static void unlockFitz(void *user, int lock);
 
     void initFitz();
     void loadFile(const std::string &file);
     void loadMemory(const std::vector<uint8_t> &data, const std::string type);
     void loadDocument();
-    void loadPage(int page);
+    fz_context *getThreadContext();
+    fz_display_list *acquirePageList(fz_context *threadCtx, int page);
     float zoomToScale(int zoom) const;
-    void freeCurrentPage();
+    void freePageCache();
 };
 
 } /* namespace img */
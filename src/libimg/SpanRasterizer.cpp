@@ -0,0 +1,469 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "SpanRasterizer.h"
+#include "PixelKernels.h"
+
+namespace img {
+
+namespace {
+
+inline uint32_t blendPixel(uint32_t back, uint32_t fore) {
+    // shortcuts for the common opaque and transparent backgrounds, with the same result
+    // as the general blend apart from float rounding
+    uint32_t backAlpha = back >> 24;
+    if (backAlpha == 0) {
+        return fore;
+    } else if (backAlpha != 0xFF) {
+        return kernels::blend(back, fore);
+    }
+    uint32_t a = fore >> 24;
+    uint32_t r = (((fore >> 16) & 0xFF) * a + ((back >> 16) & 0xFF) * (0xFF - a)) / 0xFF;
+    uint32_t g = (((fore >>  8) & 0xFF) * a + ((back >>  8) & 0xFF) * (0xFF - a)) / 0xFF;
+    uint32_t b = (((fore >>  0) & 0xFF) * a + ((back >>  0) & 0xFF) * (0xFF - a)) / 0xFF;
+    return 0xFF000000 | (r << 16) | (g << 8) | b;
+}
+
+void blendSpan(uint32_t *pixels, int count, int coverage, uint32_t color) {
+    if (count <= 0 || coverage == 0) {
+        return;
+    }
+    int alpha = (coverage * (int) (color >> 24) + 127) / 255;
+    if (alpha == 0xFF) {
+        std::fill_n(pixels, count, color | 0xFF000000);
+    } else if (alpha != 0) {
+        uint32_t fore = (alpha << 24) | (color & 0x00FFFFFF);
+        if (count == 1) {
+            // the pixels that edges pass through are blended one by one
+            *pixels = blendPixel(*pixels, fore);
+        } else {
+            kernels::blendColor(pixels, count, fore);
+        }
+    }
+}
+
+}
+
+void SpanRasterizer::reset(int width, int height) {
+    clipWidth = width;
+    clipHeight = height;
+    inContour = false;
+    cells.clear();
+}
+
+void SpanRasterizer::moveTo(float x, float y) {
+    closeContour();
+    // the edges use the pixel corners, i.e. the pixel centres are at .5
+    startX = lastX = x + 0.5f;
+    startY = lastY = y + 0.5f;
+    inContour = true;
+}
+
+void SpanRasterizer::lineTo(float x, float y) {
+    if (!inContour) {
+        moveTo(x, y);
+        return;
+    }
+    x += 0.5f;
+    y += 0.5f;
+    clipEdge(lastX, lastY, x, y);
+    lastX = x;
+    lastY = y;
+}
+
+void SpanRasterizer::closeContour() {
+    if (inContour) {
+        clipEdge(lastX, lastY, startX, startY);
+        inContour = false;
+    }
+}
+
+void SpanRasterizer::addPolygon(const std::vector<Point<float>> &points) {
+    addContour(points.data(), points.size(), false);
+}
+
+void SpanRasterizer::addLine(float x0, float y0, float x1, float y1, float width) {
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float len = std::sqrt(dx * dx + dy * dy);
+    if (len == 0) {
+        return;
+    }
+    float nx = -dy * width / (2 * len);
+    float ny = dx * width / (2 * len);
+    Point<float> corners[4] = {
+        {x0 + nx, y0 + ny},
+        {x1 + nx, y1 + ny},
+        {x1 - nx, y1 - ny},
+        {x0 - nx, y0 - ny}
+    };
+    addContour(corners, 4, false);
+}
+
+void SpanRasterizer::addDisc(float x, float y, float radius) {
+    if (radius <= 0) {
+        return;
+    }
+    int steps = getArcSteps(radius, 360);
+    std::vector<Point<float>> points(steps);
+    for (int i = 0; i < steps; i++) {
+        float a = 2 * M_PI * i / steps;
+        points[i] = Point<float>{x + radius * std::sin(a), y - radius * std::cos(a)};
+    }
+    addContour(points.data(), points.size(), false);
+}
+
+void SpanRasterizer::addArc(float x, float y, float radius, float startDegrees, float endDegrees, float width) {
+    float outer = radius + width / 2;
+    float inner = std::max(radius - width / 2, 0.0f);
+    float sweep = endDegrees - startDegrees;
+    if (sweep < 0) {
+        sweep += 360;
+    }
+    if (outer <= 0 || sweep == 0) {
+        return;
+    }
+
+    int steps = getArcSteps(outer, std::min(sweep, 360.0f));
+    std::vector<Point<float>> outerPoints(steps + 1);
+    std::vector<Point<float>> innerPoints(steps + 1);
+    for (int i = 0; i <= steps; i++) {
+        float a = (startDegrees + sweep * i / steps) * M_PI / 180;
+        float s = std::sin(a);
+        float c = std::cos(a);
+        outerPoints[i] = Point<float>{x + outer * s, y - outer * c};
+        innerPoints[steps - i] = Point<float>{x + inner * s, y - inner * c};
+    }
+
+    if (sweep >= 360) {
+        // a ring: the inner circle is a hole in the outer one
+        outerPoints.pop_back();
+        innerPoints.pop_back();
+        addContour(outerPoints.data(), outerPoints.size(), false);
+        if (inner > 0) {
+            addContour(innerPoints.data(), innerPoints.size(), true);
+        }
+    } else {
+        outerPoints.insert(outerPoints.end(), innerPoints.begin(), innerPoints.end());
+        addContour(outerPoints.data(), outerPoints.size(), false);
+    }
+}
+
+void SpanRasterizer::addContour(const Point<float> *points, size_t count, bool hole) {
+    if (count < 3) {
+        return;
+    }
+    // Coverage is accumulated with the winding direction, so all shapes are added with the
+    // same orientation and holes with the opposite one. Otherwise overlapping shapes cancel.
+    float signedArea = 0;
+    for (size_t i = 0; i < count; i++) {
+        auto &p = points[i];
+        auto &q = points[(i + 1) % count];
+        signedArea += p.x * q.y - q.x * p.y;
+    }
+    bool reverse = (signedArea < 0) != hole;
+    for (size_t i = 0; i < count; i++) {
+        auto &p = points[reverse ? (count - 1 - i) : i];
+        if (i == 0) {
+            moveTo(p.x, p.y);
+        } else {
+            lineTo(p.x, p.y);
+        }
+    }
+    closeContour();
+}
+
+void SpanRasterizer::clipEdge(float x0, float y0, float x1, float y1) {
+    // horizontal edges don't cover anything, neither do edges above or below the clip area
+    if (y0 == y1) {
+        return;
+    }
+    if (std::max(y0, y1) <= 0 || std::min(y0, y1) >= clipHeight) {
+        return;
+    }
+
+    // clip vertically, keeping the direction of the edge
+    float h = clipHeight;
+    float cy0 = std::min(std::max(y0, 0.0f), h);
+    float cy1 = std::min(std::max(y1, 0.0f), h);
+    float cx0 = (cy0 == y0) ? x0 : x0 + (x1 - x0) * (cy0 - y0) / (y1 - y0);
+    float cx1 = (cy1 == y1) ? x1 : x0 + (x1 - x0) * (cy1 - y0) / (y1 - y0);
+
+    // Split the edge where it crosses the left and right borders. Parts on the left still
+    // cover the pixels to their right, so they are moved onto the border. Parts on the
+    // right don't affect any visible pixel.
+    float w = clipWidth;
+    float splits[4] = {0, 1, 1, 1};
+    int numSplits = 1;
+    for (float border: {0.0f, w}) {
+        if ((cx0 - border) * (cx1 - border) < 0) {
+            splits[numSplits++] = (border - cx0) / (cx1 - cx0);
+        }
+    }
+    if ((numSplits == 3) && (splits[2] < splits[1])) {
+        std::swap(splits[1], splits[2]);
+    }
+    splits[numSplits] = 1;
+
+    for (int i = 0; i < numSplits; i++) {
+        float t0 = splits[i];
+        float t1 = splits[i + 1];
+        float ax = cx0 + (cx1 - cx0) * t0;
+        float ay = cy0 + (cy1 - cy0) * t0;
+        float bx = cx0 + (cx1 - cx0) * t1;
+        float by = cy0 + (cy1 - cy0) * t1;
+        float mid = (ax + bx) / 2;
+        if (mid > w) {
+            continue;
+        }
+        // rounding may leave the ends of a split just outside of the borders
+        ax = std::max(ax, 0.0f);
+        bx = std::max(bx, 0.0f);
+        if (mid < 0) {
+            ax = bx = 0;
+        }
+        addEdge(std::lround(ax * SUBPIXEL_SCALE), std::lround(ay * SUBPIXEL_SCALE),
+                std::lround(bx * SUBPIXEL_SCALE), std::lround(by * SUBPIXEL_SCALE));
+    }
+}
+
+void SpanRasterizer::addEdge(int x1, int y1, int x2, int y2) {
+    // Split the edge into the pixel rows that it crosses, stepping x with an exact
+    // remainder so that the fixed-point positions don't drift along long edges.
+    int ey1 = y1 >> SUBPIXEL_SHIFT;
+    int ey2 = y2 >> SUBPIXEL_SHIFT;
+    int fy1 = y1 & SUBPIXEL_MASK;
+    int fy2 = y2 & SUBPIXEL_MASK;
+
+    if (ey1 == ey2) {
+        addRowEdge(ey1, x1, fy1, x2, fy2);
+        return;
+    }
+
+    int64_t dx = x2 - x1;
+    int64_t dy = y2 - y1;
+    int64_t p = (SUBPIXEL_SCALE - fy1) * dx;
+    int first = SUBPIXEL_SCALE;
+    int incr = 1;
+    if (dy < 0) {
+        p = fy1 * dx;
+        first = 0;
+        incr = -1;
+        dy = -dy;
+    }
+
+    int64_t delta = p / dy;
+    int64_t mod = p % dy;
+    if (mod < 0) {
+        delta--;
+        mod += dy;
+    }
+
+    int xFrom = x1 + delta;
+    addRowEdge(ey1, x1, fy1, xFrom, first);
+    ey1 += incr;
+
+    if (ey1 != ey2) {
+        p = SUBPIXEL_SCALE * dx;
+        int64_t lift = p / dy;
+        int64_t rem = p % dy;
+        if (rem < 0) {
+            lift--;
+            rem += dy;
+        }
+        mod -= dy;
+        while (ey1 != ey2) {
+            delta = lift;
+            mod += rem;
+            if (mod >= 0) {
+                mod -= dy;
+                delta++;
+            }
+            int xTo = xFrom + delta;
+            addRowEdge(ey1, xFrom, SUBPIXEL_SCALE - first, xTo, first);
+            xFrom = xTo;
+            ey1 += incr;
+        }
+    }
+    addRowEdge(ey1, xFrom, SUBPIXEL_SCALE - first, x2, fy2);
+}
+
+void SpanRasterizer::addRowEdge(int ey, int x1, int y1, int x2, int y2) {
+    // Add the part of an edge within one pixel row, y1 and y2 are relative to the row.
+    // Each cell gets the height that the edge covers in it and twice the area to its left.
+    if (y1 == y2 || ey < 0 || ey >= clipHeight) {
+        return;
+    }
+
+    int ex1 = x1 >> SUBPIXEL_SHIFT;
+    int ex2 = x2 >> SUBPIXEL_SHIFT;
+    int fx1 = x1 & SUBPIXEL_MASK;
+    int fx2 = x2 & SUBPIXEL_MASK;
+
+    if (ex1 == ex2) {
+        int delta = y2 - y1;
+        addCell(ex1, ey, delta, (fx1 + fx2) * delta);
+        return;
+    }
+
+    int64_t dx = x2 - x1;
+    int64_t p = (SUBPIXEL_SCALE - fx1) * (int64_t) (y2 - y1);
+    int first = SUBPIXEL_SCALE;
+    int incr = 1;
+    if (dx < 0) {
+        p = fx1 * (int64_t) (y2 - y1);
+        first = 0;
+        incr = -1;
+        dx = -dx;
+    }
+
+    int64_t delta = p / dx;
+    int64_t mod = p % dx;
+    if (mod < 0) {
+        delta--;
+        mod += dx;
+    }
+
+    addCell(ex1, ey, delta, (fx1 + first) * delta);
+    ex1 += incr;
+    y1 += delta;
+
+    if (ex1 != ex2) {
+        p = SUBPIXEL_SCALE * (y2 - y1 + delta);
+        int64_t lift = p / dx;
+        int64_t rem = p % dx;
+        if (rem < 0) {
+            lift--;
+            rem += dx;
+        }
+        mod -= dx;
+        while (ex1 != ex2) {
+            delta = lift;
+            mod += rem;
+            if (mod >= 0) {
+                mod -= dx;
+                delta++;
+            }
+            addCell(ex1, ey, delta, SUBPIXEL_SCALE * delta);
+            y1 += delta;
+            ex1 += incr;
+        }
+    }
+
+    delta = y2 - y1;
+    addCell(ex2, ey, delta, (fx2 + SUBPIXEL_SCALE - first) * delta);
+}
+
+void SpanRasterizer::addCell(int ex, int ey, int cover, int area) {
+    if (!cells.empty()) {
+        auto &last = cells.back();
+        if (last.x == ex && last.y == ey) {
+            last.cover += cover;
+            last.area += area;
+            return;
+        }
+        minCellY = std::min(minCellY, ey);
+        maxCellY = std::max(maxCellY, ey);
+    } else {
+        minCellY = maxCellY = ey;
+    }
+    cells.push_back(Cell{ex, ey, cover, area});
+}
+
+int SpanRasterizer::getArcSteps(float radius, float degrees) const {
+    // enough chords to keep the outline within the tolerance of the true arc
+    float step = 2 * std::acos(std::max(1.0f - FLATTENING_TOLERANCE / radius, -1.0f));
+    int steps = std::ceil(degrees * M_PI / 180 / std::max(step, 0.01f));
+    return std::max(steps, (degrees >= 360) ? 8 : 2);
+}
+
+int SpanRasterizer::getAlpha(int area) {
+    // full coverage is one pixel of cover over the whole width, i.e. 2 * 256 * 256
+    int alpha = std::abs(area >> (SUBPIXEL_SHIFT * 2 + 1 - 8));
+    return std::min(alpha, 0xFF);
+}
+
+void SpanRasterizer::fill(Image &dst, uint32_t color) {
+    closeContour();
+    if (cells.empty()) {
+        return;
+    }
+
+    // Sort the cells by row with a counting sort. After the scatter, each entry of
+    // rowEnds is the end of its row, i.e. the start of the next one.
+    int rows = maxCellY - minCellY + 1;
+    rowEnds.assign(rows, 0);
+    for (auto &cell: cells) {
+        rowEnds[cell.y - minCellY]++;
+    }
+    int start = 0;
+    for (int r = 0; r < rows; r++) {
+        int count = rowEnds[r];
+        rowEnds[r] = start;
+        start += count;
+    }
+    sortedCells.resize(cells.size());
+    for (auto &cell: cells) {
+        sortedCells[rowEnds[cell.y - minCellY]++] = cell;
+    }
+
+    int width = std::min(clipWidth, dst.getWidth());
+    int height = std::min(clipHeight, dst.getHeight());
+    uint32_t *pixels = dst.getPixels();
+
+    // Sweep the cells of each row from left to right. The cover of the edges to the left
+    // of a pixel decides its coverage, apart from cells that an edge passes through.
+    for (int y = minCellY; y <= std::min(maxCellY, height - 1); y++) {
+        // rows only have a few cells, so they are sorted by insertion
+        auto rowBegin = sortedCells.begin() + ((y == minCellY) ? 0 : rowEnds[y - minCellY - 1]);
+        auto rowEnd = sortedCells.begin() + rowEnds[y - minCellY];
+        for (auto it = rowBegin + 1; it < rowEnd; ++it) {
+            Cell cell = *it;
+            auto pos = it;
+            while (pos != rowBegin && (pos - 1)->x > cell.x) {
+                *pos = *(pos - 1);
+                --pos;
+            }
+            *pos = cell;
+        }
+
+        uint32_t *row = pixels + (size_t) y * dst.getWidth();
+        int cover = 0;
+        for (auto it = rowBegin; it != rowEnd; ) {
+            int x = it->x;
+            int area = 0;
+            while (it != rowEnd && it->x == x) {
+                cover += it->cover;
+                area += it->area;
+                ++it;
+            }
+            if (x < width) {
+                blendSpan(row + x, 1, getAlpha((cover << (SUBPIXEL_SHIFT + 1)) - area), color);
+            }
+            int next = (it != rowEnd) ? it->x : width;
+            if (cover != 0) {
+                blendSpan(row + x + 1, std::min(next, width) - x - 1, getAlpha(cover << (SUBPIXEL_SHIFT + 1)), color);
+            }
+        }
+    }
+    cells.clear();
+}
+
+} /* namespace img */
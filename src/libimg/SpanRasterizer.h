@@ -0,0 +1,85 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_LIBIMG_SPANRASTERIZER_H_
+#define SRC_LIBIMG_SPANRASTERIZER_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "Image.h"
+
+namespace img {
+
+// Anti-aliased scanline rasterizer for vector shapes. The outlines are converted to
+// 24.8 fixed-point edges which accumulate their coverage in the pixel cells they cross.
+// The cells are then swept row by row, so that each run of pixels with the same coverage
+// is blended as one span. Coordinates are in pixels, with integers at the pixel centres.
+// Shapes that are added before one fill() overlap without darkening each other.
+class SpanRasterizer {
+public:
+    // Start a new set of shapes, clipped to the given size
+    void reset(int width, int height);
+
+    // Outlines, each contour is closed automatically
+    void moveTo(float x, float y);
+    void lineTo(float x, float y);
+    void closeContour();
+
+    // Filled shapes
+    void addPolygon(const std::vector<Point<float>> &points);
+    void addLine(float x0, float y0, float x1, float y1, float width);
+    void addDisc(float x, float y, float radius);
+    // Arcs are centred on radius, angles are clockwise from up
+    void addArc(float x, float y, float radius, float startDegrees, float endDegrees, float width);
+
+    // Blend the shapes in color and remove them
+    void fill(Image &dst, uint32_t color);
+
+private:
+    static constexpr const int SUBPIXEL_SHIFT = 8;
+    static constexpr const int SUBPIXEL_SCALE = 1 << SUBPIXEL_SHIFT;
+    static constexpr const int SUBPIXEL_MASK = SUBPIXEL_SCALE - 1;
+    // maximum distance between an arc and its chords, in pixels
+    static constexpr const float FLATTENING_TOLERANCE = 0.125f;
+
+    struct Cell {
+        int x, y;
+        int cover, area;
+    };
+
+    int clipWidth = 0, clipHeight = 0;
+    float startX = 0, startY = 0;
+    float lastX = 0, lastY = 0;
+    bool inContour = false;
+    std::vector<Cell> cells;
+    int minCellY = 0, maxCellY = 0;
+    std::vector<Cell> sortedCells;
+    std::vector<int> rowEnds;
+
+    void addContour(const Point<float> *points, size_t count, bool hole);
+    void clipEdge(float x0, float y0, float x1, float y1);
+    void addEdge(int x1, int y1, int x2, int y2);
+    void addRowEdge(int ey, int x1, int y1, int x2, int y2);
+    void addCell(int ex, int ey, int cover, int area);
+    int getArcSteps(float radius, float degrees) const;
+    static int getAlpha(int area);
+};
+
+} /* namespace img */
+
+#endif /* SRC_LIBIMG_SPANRASTERIZER_H_ */
@@ -17,6 +17,7 @@
  */
 #include <stdexcept>
 #include <cmath>
+#include <algorithm>
 #include "TTFStamper.h"
 #include "src/Logger.h"
 #include "src/platform/Platform.h"
@@ -65,43 +66,22 @@ void TTFStamper::loadInternalFont() {
 }
 
 void TTFStamper::setSize(float size) {
-    if (size != fontSize) {
-        fontSize = size;
-        FT_Set_Pixel_Sizes(fontFace, 0, size);
-    }
+    fontSize = size;
 }
 
 void TTFStamper::setText(const std::string& newText) {
     text = newText;
-    width = calculateTextWidth();
+    auto mask = getTextMask(text);
+    width = mask->width;
     if (width == 0) {
         stamp.resize(0, 0, 0);
         return;
     }
-    stamp.resize(width, fontSize, COLOR_TRANSPARENT);
-
-    auto slot = fontFace->glyph;
-    double baseline = std::abs(fontFace->descender) * fontSize / fontFace->units_per_EM;
-
-    size_t penX = 0;
-    for (size_t i = 0; i < newText.size(); i++) {
-        auto error = FT_Load_Char(fontFace, newText[i], FT_LOAD_RENDER);
-        if (error) {
-            continue;
-        }
-
-        size_t charWidth = slot->bitmap.width;
-        size_t charHeight = slot->bitmap.rows;
+    stamp.resize(width, mask->height, COLOR_TRANSPARENT);
 
-        for (size_t y = 0; y < charHeight; y++) {
-            for (size_t x = 0; x < charWidth; x++) {
-                auto val = slot->bitmap.buffer[y * charWidth + x];
-                int px = penX + slot->bitmap_left + x;
-                int py = fontSize - slot->bitmap_top - baseline + y;
-                stamp.drawPixel(px, py, val << 24 | color);
-            }
-        }
-        penX += slot->advance.x / 64;
+    uint32_t *pixels = stamp.getPixels();
+    for (size_t i = 0; i < mask->coverage.size(); i++) {
+        pixels[i] = mask->coverage[i] << 24 | color;
     }
 }
 
@@ -109,28 +89,77 @@ void TTFStamper::setColor(uint32_t textColor) {
     color = textColor;
 }
 
-size_t TTFStamper::calculateTextWidth() {
-    if (text.empty()) {
-        return 0;
+GlyphAtlas &TTFStamper::getAtlas() {
+    auto &atlas = atlases[fontSize];
+    if (!atlas) {
+        atlas = std::make_unique<GlyphAtlas>(fontFace, fontSize);
     }
+    return *atlas;
+}
 
+size_t TTFStamper::calculateTextWidth(const std::string &in) {
+    auto &atlas = getAtlas();
     size_t xPos = 0;
-    auto slot = fontFace->glyph;
-
-    for (size_t i = 0; i < text.size(); i++) {
-        FT_UInt glyphIndex = FT_Get_Char_Index(fontFace, text[i]);
-        auto error = FT_Load_Glyph(fontFace, glyphIndex, FT_LOAD_BITMAP_METRICS_ONLY);
-        if (error) {
-            continue;
-        }
-
-        xPos += slot->advance.x / 64;
+    for (char c: in) {
+        xPos += atlas.getGlyph(c).advance;
     }
     return xPos;
 }
 
 size_t TTFStamper::getTextWidth(const std::string &in) {
-    return width;
+    return calculateTextWidth(in);
+}
+
+std::shared_ptr<const TextMask> TTFStamper::getTextMask(const std::string &in) {
+    TextKey key = std::make_pair(fontSize, in);
+    auto it = textIndex.find(key);
+    if (it != textIndex.end()) {
+        textCache.splice(textCache.begin(), textCache, it->second);
+        return it->second->second;
+    }
+
+    std::shared_ptr<const TextMask> mask = renderText(in);
+    textCache.emplace_front(key, mask);
+    textIndex[key] = textCache.begin();
+    if (textCache.size() > MAX_CACHED_TEXTS) {
+        textIndex.erase(textCache.back().first);
+        textCache.pop_back();
+    }
+    return mask;
+}
+
+std::shared_ptr<TextMask> TTFStamper::renderText(const std::string &in) {
+    auto mask = std::make_shared<TextMask>();
+    mask->width = calculateTextWidth(in);
+    if (mask->width == 0) {
+        return mask;
+    }
+    mask->height = fontSize;
+    mask->coverage.resize((size_t) mask->width * mask->height);
+
+    auto &atlas = getAtlas();
+    double baseline = atlas.getBaseline();
+    int penX = 0;
+    for (char c: in) {
+        auto &glyph = atlas.getGlyph(c);
+        const uint8_t *src = atlas.getCoverage(glyph);
+        for (int y = 0; y < glyph.rows; y++) {
+            int py = fontSize - glyph.top - baseline + y;
+            if (py < 0 || py >= mask->height) {
+                continue;
+            }
+            uint8_t *dst = mask->coverage.data() + (size_t) py * mask->width;
+            for (int x = 0; x < glyph.width; x++) {
+                int px = penX + glyph.left + x;
+                if (px >= 0 && px < mask->width) {
+                    // neighbouring glyphs may overlap, keep the stronger coverage
+                    dst[px] = std::max(dst[px], src[y * glyph.width + x]);
+                }
+            }
+        }
+        penX += glyph.advance;
+    }
+    return mask;
 }
 
 void TTFStamper::applyStamp(Image &dst, int angle) {
@@ -146,6 +175,54 @@ void TTFStamper::applyStamp(Image &dst, int x, int y)
     dst.blendImage0(stamp, x, y);
 }
 
+GlyphAtlas::GlyphAtlas(FT_Face face, int size):
+    face(face),
+    size(size),
+    baseline(std::abs(face->descender) * size / face->units_per_EM)
+{
+}
+
+const GlyphAtlas::Glyph &GlyphAtlas::getGlyph(char c) {
+    uint8_t idx = c;
+    Glyph &glyph = glyphs[idx];
+    if (loaded[idx]) {
+        return glyph;
+    }
+    loaded[idx] = true;
+
+    // the face is shared by the atlases of all sizes
+    FT_Set_Pixel_Sizes(face, 0, size);
+    auto error = FT_Load_Char(face, c, FT_LOAD_RENDER);
+    if (error) {
+        return glyph;
+    }
+
+    auto slot = face->glyph;
+    glyph.left = slot->bitmap_left;
+    glyph.top = slot->bitmap_top;
+    glyph.width = slot->bitmap.width;
+    glyph.rows = slot->bitmap.rows;
+    glyph.advance = slot->advance.x / 64;
+    glyph.offset = coverage.size();
+    for (int y = 0; y < glyph.rows; y++) {
+        const uint8_t *row = slot->bitmap.buffer + y * slot->bitmap.pitch;
+        coverage.insert(coverage.end(), row, row + glyph.width);
+    }
+    return glyph;
+}
+
+const uint8_t *GlyphAtlas::getCoverage(const Glyph &glyph) const {
+    return coverage.data() + glyph.offset;
+}
+
+int GlyphAtlas::getSize() const {
+    return size;
+}
+
+double GlyphAtlas::getBaseline() const {
+    return baseline;
+}
+
 TTFStamper::~TTFStamper() {
     FT_Done_Face(fontFace);
     FT_Done_FreeType(ft);
@@ -20,12 +20,48 @@
 
 #include <string>
 #include <vector>
+#include <array>
+#include <list>
+#include <map>
+#include <memory>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include "Image.h"
 
 namespace img {
 
+// Coverage mask of a rendered text, one byte per pixel
+struct TextMask {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> coverage;
+};
+
+// Rendered glyphs and metrics of one font face at one pixel size. The coverage
+// bitmaps of all glyphs are packed into a single buffer.
+class GlyphAtlas {
+public:
+    struct Glyph {
+        int left = 0, top = 0;
+        int width = 0, rows = 0;
+        int advance = 0;
+        size_t offset = 0;
+    };
+
+    GlyphAtlas(FT_Face face, int size);
+    const Glyph &getGlyph(char c);
+    const uint8_t *getCoverage(const Glyph &glyph) const;
+    int getSize() const;
+    double getBaseline() const;
+private:
+    FT_Face face;
+    int size;
+    double baseline;
+    std::array<Glyph, 256> glyphs;
+    std::array<bool, 256> loaded{};
+    std::vector<uint8_t> coverage;
+};
+
 class TTFStamper {
 public:
     TTFStamper(const std::string &fontName);
@@ -36,8 +72,13 @@ public:
     void applyStamp(Image &dst, int x, int y);
     static void setFontDirectory(const std::string &dir);
     size_t getTextWidth(const std::string &in);
+
+    // Rendered text in the current size, cached until it is among the least recently used
+    std::shared_ptr<const TextMask> getTextMask(const std::string &in);
     ~TTFStamper();
 private:
+    static constexpr const size_t MAX_CACHED_TEXTS = 1024;
+
     int fontSize = 28;
     FT_Library ft{};
     FT_Face fontFace{};
@@ -48,7 +89,18 @@ private:
     size_t width = 0;
     Image stamp;
 
-    size_t calculateTextWidth();
+    // glyph atlas for each font size used
+    std::map<int, std::unique_ptr<GlyphAtlas>> atlases;
+
+    // rendered texts by size and text, most recently used in front
+    using TextKey = std::pair<int, std::string>;
+    using CachedText = std::pair<TextKey, std::shared_ptr<const TextMask>>;
+    std::list<CachedText> textCache;
+    std::map<TextKey, std::list<CachedText>::iterator> textIndex;
+
+    GlyphAtlas &getAtlas();
+    size_t calculateTextWidth(const std::string &in);
+    std::shared_ptr<TextMask> renderText(const std::string &in);
     void loadInternalFont();
 };
 
@@ -0,0 +1,75 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <stdexcept>
+#include "TiffTileWriter.h"
+#include "PixelKernels.h"
+#include "src/platform/Platform.h"
+
+namespace img {
+
+TiffTileWriter::TiffTileWriter(const std::string &utf8Path, int width, int height, int tileSize):
+    tileSize(tileSize),
+    buffer((size_t) tileSize * tileSize)
+{
+    auto path = platform::UTF8ToACP(utf8Path);
+    tif = TIFFOpen(path.c_str(), "w");
+    if (!tif) {
+        throw std::runtime_error("Couldn't create TIFF");
+    }
+
+    uint16_t extraSamples[] = {EXTRASAMPLE_UNASSALPHA};
+    TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, (uint32_t) width);
+    TIFFSetField(tif, TIFFTAG_IMAGELENGTH, (uint32_t) height);
+    TIFFSetField(tif, TIFFTAG_TILEWIDTH, (uint32_t) tileSize);
+    TIFFSetField(tif, TIFFTAG_TILELENGTH, (uint32_t) tileSize);
+    TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, 8);
+    TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, 4);
+    TIFFSetField(tif, TIFFTAG_EXTRASAMPLES, 1, extraSamples);
+    TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
+    TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    TIFFSetField(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
+    TIFFSetField(tif, TIFFTAG_COMPRESSION, COMPRESSION_LZW);
+    TIFFSetField(tif, TIFFTAG_PREDICTOR, PREDICTOR_HORIZONTAL);
+}
+
+void TiffTileWriter::writeTile(int tileX, int tileY, const Image &tile) {
+    if (tile.getWidth() != tileSize || tile.getHeight() != tileSize) {
+        throw std::runtime_error("Invalid tile size");
+    }
+
+    // ARGB pixels to RGBA bytes, assuming a little endian machine like the rest of libimg
+    kernels::swapRedBlue(buffer.data(), tile.getPixels(), buffer.size());
+
+    uint32_t tileIndex = TIFFComputeTile(tif, tileX * tileSize, tileY * tileSize, 0, 0);
+    if (TIFFWriteEncodedTile(tif, tileIndex, buffer.data(), buffer.size() * sizeof(uint32_t)) < 0) {
+        throw std::runtime_error("Couldn't write TIFF tile");
+    }
+}
+
+void TiffTileWriter::close() {
+    if (tif) {
+        TIFFClose(tif);
+        tif = nullptr;
+    }
+}
+
+TiffTileWriter::~TiffTileWriter() {
+    close();
+}
+
+} /* namespace img */
@@ -0,0 +1,47 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_LIBIMG_TIFFTILEWRITER_H_
+#define SRC_LIBIMG_TIFFTILEWRITER_H_
+
+#include <string>
+#include <vector>
+#include <tiffio.h>
+#include "Image.h"
+
+namespace img {
+
+// Writes an RGBA image as a compressed, tiled TIFF. The tiles can be
+// written in any order, tiles that are never written read as transparent.
+class TiffTileWriter {
+public:
+    TiffTileWriter(const std::string &utf8Path, int width, int height, int tileSize);
+
+    // the tile image must be tileSize x tileSize
+    void writeTile(int tileX, int tileY, const Image &tile);
+    void close();
+
+    ~TiffTileWriter();
+private:
+    TIFF *tif{};
+    int tileSize;
+    std::vector<uint32_t> buffer;
+};
+
+} /* namespace img */
+
+#endif /* SRC_LIBIMG_TIFFTILEWRITER_H_ */
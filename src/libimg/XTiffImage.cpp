@@ -16,7 +16,9 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include <stdexcept>
+#include <algorithm>
 #include "XTiffImage.h"
+#include "PixelKernels.h"
 #include "src/platform/Platform.h"
 #include "src/Logger.h"
 
@@ -41,56 +43,134 @@ void XTiffImage::loadTIFF(const std::string& utf8Path) {
         throw std::runtime_error("Couldn't open TIFF");
     }
 
-    if (!TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &fullWidth)) {
-        XTIFFClose(tif);
-        throw std::runtime_error("TIFF has no width");
+    reader = XTIFFOpen(path.c_str(), "r");
+    if (!reader) {
+        throw std::runtime_error("Couldn't open TIFF");
     }
 
-    if (!TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &fullHeight)) {
-        XTIFFClose(tif);
-        throw std::runtime_error("TIFF has no height");
+    findLevels();
+    if (levels.empty()) {
+        throw std::runtime_error("TIFF has no dimensions");
     }
+
+    logger::verbose("TIFF %s: %dx%d with %d overviews", utf8Path.c_str(),
+            levels.front().width, levels.front().height, (int) levels.size() - 1);
 }
 
 int XTiffImage::getFullWidth() {
-    return fullWidth;
+    return levels.front().width;
 }
 
 int XTiffImage::getFullHeight() {
-    return fullHeight;
+    return levels.front().height;
 }
 
 void* XTiffImage::getXtiffHandle() {
     return tif;
 }
 
-void XTiffImage::loadFullImage() {
-    if (fullImageLoaded) {
-        return;
+void XTiffImage::findLevels() {
+    // the overviews are stored as additional directories marked as reduced images
+    do {
+        uint32_t subFileType = 0;
+        TIFFGetField(reader, TIFFTAG_SUBFILETYPE, &subFileType);
+        if (subFileType & FILETYPE_MASK) {
+            continue;
+        }
+
+        // level 0 is the first full resolution page, further pages are ignored
+        bool isOverview = (subFileType & FILETYPE_REDUCEDIMAGE) != 0;
+        if (isOverview == levels.empty()) {
+            continue;
+        }
+
+        uint32_t width = 0, height = 0;
+        if (TIFFGetField(reader, TIFFTAG_IMAGEWIDTH, &width) && TIFFGetField(reader, TIFFTAG_IMAGELENGTH, &height)) {
+            levels.push_back(Level{TIFFCurrentDirectory(reader), (int) width, (int) height});
+        }
+    } while (TIFFReadDirectory(reader));
+
+    if (levels.size() > 1) {
+        std::stable_sort(levels.begin() + 1, levels.end(), [] (const Level &a, const Level &b) {
+            return a.width > b.width;
+        });
     }
+}
+
+int XTiffImage::getLevelCount() {
+    return levels.size();
+}
+
+int XTiffImage::getLevelWidth(int level) {
+    return levels.at(level).width;
+}
 
-    resize(fullWidth, fullHeight, 0);
-    if (!TIFFReadRGBAImageOriented(tif, fullWidth, fullHeight, getPixels(), ORIENTATION_TOPLEFT, 0)) {
-        throw std::runtime_error("Couldn't read TIFF");
+int XTiffImage::getLevelHeight(int level) {
+    return levels.at(level).height;
+}
+
+void XTiffImage::readRegion(int level, int x, int y, Image &dst) {
+    const Level &lvl = levels.at(level);
+
+    int x0 = std::max(x, 0);
+    int y0 = std::max(y, 0);
+    int x1 = std::min(x + dst.getWidth(), lvl.width);
+    int y1 = std::min(y + dst.getHeight(), lvl.height);
+    if (x1 <= x0 || y1 <= y0) {
+        return;
     }
 
-    uint8_t *data = (uint8_t *) getPixels();
+    int regionWidth = x1 - x0;
+    int regionHeight = y1 - y0;
+    std::vector<uint32_t> raster((size_t) regionWidth * regionHeight);
 
-    // libtiff actually loads ARGB and there is no easy way to change that
-    for (int y = 0; y < fullHeight; y++) {
-        for (int x = 0; x < fullWidth; x++) {
-            int g = data[4 * x + 2];
-            data[4 * x + 2] = data[4 * x + 0];
-            data[4 * x + 0] = g;
+    {
+        std::lock_guard<std::mutex> lock(readMutex);
+
+        if (!TIFFSetDirectory(reader, lvl.directory)) {
+            throw std::runtime_error("Couldn't select TIFF directory");
+        }
+
+        char msg[1024] = "";
+        TIFFRGBAImage rgba{};
+        if (!TIFFRGBAImageOK(reader, msg) || !TIFFRGBAImageBegin(&rgba, reader, 0, msg)) {
+            throw std::runtime_error(std::string("Unsupported TIFF: ") + msg);
+        }
+
+        // the decoder only touches the strips or tiles of this window
+        rgba.req_orientation = ORIENTATION_TOPLEFT;
+        rgba.row_offset = y0;
+        rgba.col_offset = x0;
+
+        int ok;
+        try {
+            ok = TIFFRGBAImageGet(&rgba, raster.data(), regionWidth, regionHeight);
+        } catch (...) {
+            TIFFRGBAImageEnd(&rgba);
+            throw;
+        }
+        TIFFRGBAImageEnd(&rgba);
+
+        if (!ok) {
+            throw std::runtime_error("Couldn't read TIFF");
         }
-        data += 4 * fullWidth;
     }
 
-    fullImageLoaded = true;
+    // libtiff actually loads ABGR and there is no easy way to change that
+    uint32_t *dstPixels = dst.getPixels();
+    for (int row = 0; row < regionHeight; row++) {
+        uint32_t *dstRow = dstPixels + (size_t) (y0 - y + row) * dst.getWidth() + (x0 - x);
+        kernels::swapRedBlue(dstRow, raster.data() + (size_t) row * regionWidth, regionWidth);
+    }
 }
 
 XTiffImage::~XTiffImage() {
-    XTIFFClose(tif);
+    if (reader) {
+        XTIFFClose(reader);
+    }
+    if (tif) {
+        XTIFFClose(tif);
+    }
 }
 
 } /* namespace img */
@@ -19,12 +19,14 @@
 #define SRC_LIBIMG_XTIFFIMAGE_H_
 
 #include <string>
+#include <vector>
+#include <mutex>
 #include <xtiffio.h>
 #include "Image.h"
 
 namespace img {
 
-class XTiffImage: public Image {
+class XTiffImage {
 public:
     // only loads the meta data
     void loadTIFF(const std::string &utf8Path);
@@ -32,18 +34,37 @@ public:
     // return internal XTIFF handle
     void *getXtiffHandle();
 
-    // these can return the dimensions prior to loading the full image
+    // dimensions of the full resolution image
     int getFullWidth();
     int getFullHeight();
 
-    // loads the whole image into memory if not already done
-    void loadFullImage();
+    // Level 0 is the full image, followed by the reduced resolution images
+    // (overviews) stored in the file, largest first.
+    int getLevelCount();
+    int getLevelWidth(int level);
+    int getLevelHeight(int level);
+
+    // Decodes the part of a level that starts at x, y and has the size of dst.
+    // Only the strips or tiles that intersect the region are read, pixels
+    // outside the level are left unchanged. Can be called from any thread.
+    void readRegion(int level, int x, int y, Image &dst);
 
     ~XTiffImage();
 private:
-    int fullWidth = 0, fullHeight = 0;
-    bool fullImageLoaded = false;
+    struct Level {
+        tdir_t directory;
+        int width, height;
+    };
+
+    std::vector<Level> levels;
     TIFF *tif{};
+
+    // separate handle for decoding so that switching to an overview
+    // directory doesn't affect the meta data read through tif
+    std::mutex readMutex;
+    TIFF *reader{};
+
+    void findLevels();
 };
 
 } /* namespace img */
@@ -33,6 +33,7 @@ Stitcher::Stitcher(std::shared_ptr<Image> dstImage, std::shared_ptr<TileSource>
 
     int max = std::max(dstImage->getWidth(), dstImage->getHeight());
     unrotatedImage = std::make_shared<Image>(max, max, 0);
+    tileLayer.resize(max, max, 0);
 }
 
 void Stitcher::setCacheDirectory(const std::string& utf8Path) {
@@ -62,7 +63,6 @@ img::Point<double> Stitcher::getCenter() const {
 bool Stitcher::nextPage() {
     if (page + 1 < tileSource->getPageCount()) {
         page++;
-        tileCache.cancelPendingRequests();
         updateImage();
         return true;
     }
@@ -72,7 +72,6 @@ bool Stitcher::nextPage() {
 bool Stitcher::prevPage() {
     if (page > 0) {
         page--;
-        tileCache.cancelPendingRequests();
         updateImage();
         return true;
     }
@@ -121,8 +120,7 @@ void Stitcher::setZoomLevel(int level) {
     centerY = newCenterXY.y;
     zoomLevel = level;
 
-    tileCache.cancelPendingRequests();
-
+    // pending requests for other zoom levels are dropped by the next view update
     updateImage();
 }
 
@@ -162,7 +160,7 @@ void Stitcher::rotateRight() {
     updateImage();
 }
 
-void Stitcher::forEachTileInView(std::function<void(int, int, img::Image &)> f) {
+void Stitcher::forEachTileInView(std::function<void(int, int, int, int, img::Image &)> f) {
     auto dim = tileSource->getTileDimensions(zoomLevel);
     int tileEdgeWidth = dim.x;
     int tileEdgeHeight = dim.y;
@@ -185,6 +183,9 @@ void Stitcher::forEachTileInView(std::function<void(int, int, img::Image &)> f)
     loadingTile.resize(tileEdgeWidth, tileEdgeHeight, img::COLOR_BLACK);
 
     pendingTiles = false;
+    viewTileRefs.clear();
+
+    tileCache.setView(page, centerX, centerY, zoomLevel);
 
     for (int y = -radiusY; y <= radiusY; y++) {
         for (int x = -radiusX; x <= radiusX; x++) {
@@ -195,7 +196,7 @@ void Stitcher::forEachTileInView(std::function<void(int, int, img::Image &)> f)
             int tilePosY = centerPosY + y * tileEdgeHeight;
 
             if (!tileSource->isTileValid(page, tileX, tileY, zoomLevel)) {
-                f(tilePosX, tilePosY, emptyTile);
+                f(tileX, tileY, tilePosX, tilePosY, emptyTile);
                 continue;
             }
 
@@ -203,15 +204,16 @@ void Stitcher::forEachTileInView(std::function<void(int, int, img::Image &)> f)
             try {
                 tile = tileCache.getTile(page, tileX, tileY, zoomLevel);
             } catch (const std::exception &e) {
-                f(tilePosX, tilePosY, errorTile);
+                f(tileX, tileY, tilePosX, tilePosY, errorTile);
                 continue;
             }
 
             if (tile) {
-                f(tilePosX, tilePosY, *tile);
+                viewTileRefs.push_back(tile);
+                f(tileX, tileY, tilePosX, tilePosY, *tile);
             } else {
                 pendingTiles = true;
-                f(tilePosX, tilePosY, loadingTile);
+                f(tileX, tileY, tilePosX, tilePosY, loadingTile);
             }
         }
     }
@@ -223,17 +225,87 @@ void Stitcher::forEachTileInView(std::function<void(int, int, img::Image &)> f)
     centerY = ((int) centerY) + yOff / (double) tileEdgeHeight;
 }
 
-void Stitcher::updateImage() {
-    forEachTileInView([this] (int x, int y, img::Image &tile) {
-        unrotatedImage->drawImage(tile, x, y);
+void Stitcher::updateTileLayer() {
+    auto dim = tileSource->getTileDimensions(zoomLevel);
+    int layerWidth = tileLayer.getWidth();
+    int layerHeight = tileLayer.getHeight();
+
+    // Position of the layer's upper left pixel in the pixel space of the current page and zoom level
+    int xOff = (centerX - (int) centerX) * dim.x;
+    int yOff = (centerY - (int) centerY) * dim.y;
+    Point<int> origin{((int) centerX) * dim.x + xOff - layerWidth / 2, ((int) centerY) * dim.y + yOff - layerHeight / 2};
+
+    // Rects that must be redrawn regardless of whether their tiles changed
+    std::vector<Rect> exposed;
+    bool sameView = layerValid && layerPage == page && layerZoom == zoomLevel &&
+                    layerTileDim.x == dim.x && layerTileDim.y == dim.y;
+    int dx = layerOrigin.x - origin.x;
+    int dy = layerOrigin.y - origin.y;
+
+    if (sameView && std::abs(dx) < layerWidth && std::abs(dy) < layerHeight) {
+        // Scroll the existing content and redraw only the newly exposed strips
+        if (dx != 0 || dy != 0) {
+            tileLayer.shift(dx, dy);
+        }
+        if (dx > 0) {
+            exposed.push_back(Rect{0, 0, dx, layerHeight});
+        } else if (dx < 0) {
+            exposed.push_back(Rect{layerWidth + dx, 0, layerWidth, layerHeight});
+        }
+        if (dy > 0) {
+            exposed.push_back(Rect{0, 0, layerWidth, dy});
+        } else if (dy < 0) {
+            exposed.push_back(Rect{0, layerHeight + dy, layerWidth, layerHeight});
+        }
+    } else {
+        exposed.push_back(Rect{0, 0, layerWidth, layerHeight});
+        layerTiles.clear();
+    }
+
+    std::map<std::pair<int, int>, const Image *> drawnTiles;
+    forEachTileInView([this, &exposed, &drawnTiles] (int tileX, int tileY, int x, int y, img::Image &tile) {
+        Rect tileRect{x, y, x + tile.getWidth(), y + tile.getHeight()};
+        auto coords = std::make_pair(tileX, tileY);
+        drawnTiles[coords] = &tile;
+
+        auto it = layerTiles.find(coords);
+        if (it == layerTiles.end() || it->second != &tile) {
+            // new tile or state changed, e.g. from loading to loaded
+            tileLayer.drawImage(tile, x, y);
+            return;
+        }
+
+        for (auto &rect: exposed) {
+            if (!rect.intersect(tileRect).isEmpty()) {
+                tileLayer.drawImage(tile, x, y, rect);
+            }
+        }
     });
 
+    // forEachTileInView snaps the center to the drawn pixels, so the origin computed above is exact
+    layerTiles = std::move(drawnTiles);
+    layerTileRefs.swap(viewTileRefs);
+    layerOrigin = origin;
+    layerPage = page;
+    layerZoom = zoomLevel;
+    layerTileDim = dim;
+    layerValid = true;
+}
+
+void Stitcher::updateImage() {
+    updateTileLayer();
+
     if (onPreRotate) {
+        // the overlays are drawn onto the pre-rotated image anywhere, so it needs
+        // a full fresh copy of the tiles and a full rotation
+        unrotatedImage->drawImage(tileLayer, 0, 0);
         onPreRotate();
+        unrotatedImage->rotate(*dstImage, rotAngle);
+    } else {
+        // nothing is drawn on top of the tiles, so skip the intermediate copy
+        tileLayer.rotate(*dstImage, rotAngle);
     }
 
-    unrotatedImage->rotate(*dstImage, rotAngle);
-
     if (onRedraw) {
         onRedraw();
     }
@@ -246,7 +318,7 @@ void Stitcher::doWork() {
         // when there is nothing to do, load all tiles from the memory
         // cache anyways in order to touch the cache time so that
         // the tiles in sight are not flushed
-        forEachTileInView([] (int x, int y, img::Image &tile) {
+        forEachTileInView([] (int tileX, int tileY, int x, int y, img::Image &tile) {
             // do nothing, just touch the cache
         });
     }
@@ -254,6 +326,7 @@ void Stitcher::doWork() {
 
 void Stitcher::invalidateCache() {
     tileCache.invalidate();
+    layerValid = false;
     updateImage();
 }
 
@@ -20,6 +20,8 @@
 
 #include <memory>
 #include <functional>
+#include <map>
+#include <vector>
 #include "TileSource.h"
 #include "TileCache.h"
 #include "src/libimg/Image.h"
@@ -64,6 +66,7 @@ private:
     int page = 0;
     Image emptyTile, errorTile, loadingTile;
     std::shared_ptr<Image> unrotatedImage;
+    Image tileLayer;
     std::shared_ptr<Image> dstImage;
     std::shared_ptr<TileSource> tileSource;
     TileCache tileCache;
@@ -74,7 +77,16 @@ private:
     bool pendingTiles = true;
     int rotAngle = 0;
 
-    void forEachTileInView(std::function<void(int, int, img::Image &)> f);
+    // State of the tile layer to update it incrementally
+    bool layerValid = false;
+    int layerPage = 0, layerZoom = 0;
+    Point<int> layerOrigin, layerTileDim;
+    std::map<std::pair<int, int>, const Image *> layerTiles;
+    // Keeps the drawn tiles alive so that a reloaded tile can't reuse an address in layerTiles
+    std::vector<std::shared_ptr<Image>> layerTileRefs, viewTileRefs;
+
+    void forEachTileInView(std::function<void(int, int, int, int, img::Image &)> f);
+    void updateTileLayer();
 };
 
 } /* namespace img */
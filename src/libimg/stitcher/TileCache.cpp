@@ -19,15 +19,15 @@
 #include <sstream>
 #include "TileCache.h"
 #include "src/platform/Platform.h"
-#include "src/platform/CrashHandler.h"
 #include "src/Logger.h"
 
 namespace img {
 
-TileCache::TileCache(std::shared_ptr<TileSource> source):
-    tileSource(source)
+TileCache::TileCache(std::shared_ptr<TileSource> source, std::shared_ptr<TileLoaderPool> pool):
+    tileSource(source),
+    loaderPool(pool)
 {
-    loaderThread = std::make_unique<std::thread>(&TileCache::loadLoop, this);
+    loaderPool->addCache(this);
 }
 
 void TileCache::setCacheDirectory(const std::string& utf8Path) {
@@ -37,6 +37,86 @@ void TileCache::setCacheDirectory(const std::string& utf8Path) {
     }
 }
 
+void TileCache::setMemoryBudget(size_t bytes) {
+    memoryBudget = bytes;
+    evictToBudget();
+}
+
+TileCache::Statistics TileCache::getStatistics() const {
+    Statistics stats;
+    stats.hits = hitCount;
+    stats.misses = missCount;
+    stats.evictions = evictionCount;
+    stats.bytes = memoryBytes;
+    stats.budget = memoryBudget;
+    for (auto &shard: shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.entries += shard.index.size();
+    }
+    return stats;
+}
+
+void TileCache::setView(int page, double centerX, double centerY, int zoom) {
+    bool stale = false;
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        if (page == viewPage && zoom == viewZoom && centerX == viewCenterX && centerY == viewCenterY) {
+            return;
+        }
+
+        stale = (page != viewPage || zoom != viewZoom);
+        viewPage = page;
+        viewZoom = zoom;
+        viewCenterX = centerX;
+        viewCenterY = centerY;
+
+        if (stale) {
+            // requests for other pages or zoom levels won't be visible anymore
+            for (auto it = loadSet.begin(); it != loadSet.end(); ) {
+                if (std::get<0>(*it) != page || std::get<3>(*it) != zoom) {
+                    it = loadSet.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            errorSet.clear();
+        }
+    }
+
+    if (stale) {
+        loaderPool->drop(this, [page, zoom] (const TileLoaderPool::Request &req) {
+            return req.page != page || req.zoom != zoom;
+        });
+    } else {
+        loaderPool->reprioritize(this, [centerX, centerY] (const TileLoaderPool::Request &req) {
+            double dx = req.x + 0.5 - centerX;
+            double dy = req.y + 0.5 - centerY;
+            return dx * dx + dy * dy;
+        });
+    }
+}
+
+TileCache::TileKey TileCache::makeKey(int page, int x, int y, int zoom) {
+    // zoom: 8 bits, x and y: 21 bits each (two's complement).
+    // This covers slippy maps up to zoom 20 as well as negative document zoom levels.
+    uint64_t coords = (uint64_t) (zoom & 0xFF) << 42;
+    coords |= (uint64_t) (x & 0x1FFFFF) << 21;
+    coords |= (uint64_t) (y & 0x1FFFFF);
+    return TileKey{page, coords};
+}
+
+size_t TileCache::TileKeyHash::operator()(const TileKey &key) const {
+    // neighbouring tiles only differ in the low bits of x and y, mix them so they spread over
+    // the shards (high bits) and the buckets (low bits)
+    uint64_t h = (key.coords ^ ((uint64_t) (uint32_t) key.page << 50)) * 0x9E3779B97F4A7C15ull;
+    return (size_t) (h ^ (h >> 32));
+}
+
+TileCache::Shard &TileCache::shardFor(const TileKey &key) {
+    uint64_t h = TileKeyHash()(key);
+    return shards[(h >> 58) % SHARD_COUNT];
+}
+
 std::shared_ptr<Image> TileCache::getTile(int page, int x, int y, int zoom) {
     tileSource->constrainXY(x, y, zoom);
     if (!tileSource->isTileValid(page, x, y, zoom)) {
@@ -44,22 +124,21 @@ std::shared_ptr<Image> TileCache::getTile(int page, int x, int y, int zoom) {
         throw std::runtime_error(std::string("Invalid coordinates in ") + __FUNCTION__);
     }
 
-    std::shared_ptr<Image> image;
-
-    std::lock_guard<std::mutex> lock(cacheMutex);
-
-    // First check if this coords had a load error
-    auto errorIt = errorSet.find(TileCoords(page, x, y, zoom));
-    if (errorIt != errorSet.end()) {
-        throw std::runtime_error("Corrupt tile");
-    }
-
-    // Cache strategy: Check memory cache first
-    image = getFromMemory(page, x, y, zoom);
+    // Cache strategy: Check memory cache first, this only locks a single shard
+    std::shared_ptr<Image> image = getFromMemory(makeKey(page, x, y, zoom));
     if (image) {
         return image;
     }
 
+    {
+        // Check if this coords had a load error
+        std::lock_guard<std::mutex> lock(loadMutex);
+        auto errorIt = errorSet.find(TileCoords(page, x, y, zoom));
+        if (errorIt != errorSet.end()) {
+            throw std::runtime_error("Corrupt tile");
+        }
+    }
+
     // Then check file cache
     image = getFromDisk(page, x, y, zoom);
     if (image) {
@@ -71,20 +150,31 @@ std::shared_ptr<Image> TileCache::getTile(int page, int x, int y, int zoom) {
     return nullptr;
 }
 
-std::shared_ptr<Image> TileCache::getFromMemory(int page, int x, int y, int zoom) {
-    // gets called with locked mutex
-    auto it = memoryCache.find(tileSource->getUniqueTileName(page, x, y, zoom));
-    if (it == memoryCache.end()) {
+bool TileCache::isInMemory(const TileKey &key) {
+    Shard &shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.index.find(key) != shard.index.end();
+}
+
+std::shared_ptr<Image> TileCache::getFromMemory(const TileKey &key) {
+    Shard &shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        missCount++;
         return nullptr;
     }
 
-    MemCacheEntry &entry = it->second;
-    std::get<1>(entry) = std::chrono::steady_clock::now();
-    return std::get<0>(entry);
+    // move to front of the LRU list
+    auto entryIt = it->second;
+    entryIt->lastAccess = std::chrono::steady_clock::now();
+    shard.lru.splice(shard.lru.begin(), shard.lru, entryIt);
+    hitCount++;
+    return entryIt->image;
 }
 
 std::shared_ptr<Image> TileCache::getFromDisk(int page, int x, int y, int zoom) {
-    // gets called with locked mutex
     std::string fileName = cacheDir + "/" + tileSource->getUniqueTileName(page, x, y, zoom);
     if (!platform::fileExists(fileName)) {
         return nullptr;
@@ -93,67 +183,52 @@ std::shared_ptr<Image> TileCache::getFromDisk(int page, int x, int y, int zoom)
     // upon loading: insert into memory cache for next access
     auto img = std::make_shared<Image>();
     img->loadImageFile(fileName);
-    enterMemoryCache(page, x, y, zoom, img);
+    enterMemoryCache(makeKey(page, x, y, zoom), img);
 
     return img;
 }
 
 void img::TileCache::enqueue(int page, int x, int y, int zoom) {
-    // gets called with locked mutex
-    TileCoords coords(page, x, y, zoom);
-    loadSet.insert(coords);
-    cacheCondition.notify_one();
-}
-
-bool TileCache::hasWork() {
-    // gets called with locked mutex
-    if (!keepAlive) {
-        return true;
+    double priority;
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        TileCoords coords(page, x, y, zoom);
+        if (!loadSet.insert(coords).second) {
+            // already queued
+            return;
+        }
+        priority = getPriority(page, x, y, zoom);
     }
 
-    return !loadSet.empty();
+    loaderPool->submit(this, TileLoaderPool::Request{page, x, y, zoom}, priority);
 }
 
-void TileCache::loadLoop() {
-    crash::ThreadCookie crashCookie;
-
-    logger::verbose("TileCache spawned thread %d", std::this_thread::get_id());
-    while (keepAlive) {
-        TileCoords coords;
-        bool coordsValid = false;
-        {
-            std::unique_lock<std::mutex> lock(cacheMutex);
-            // also wake up each second to flush cache
-            cacheCondition.wait_for(lock, std::chrono::seconds(1), [this] () { return hasWork(); });
-
-            if (!keepAlive) {
-                break;
-            }
+double TileCache::getPriority(int page, int x, int y, int zoom) {
+    // gets called with locked loadMutex
+    // Tiles closer to the center of the view are loaded first
+    double dx = x + 0.5 - viewCenterX;
+    double dy = y + 0.5 - viewCenterY;
+    double priority = dx * dx + dy * dy;
+    if (page != viewPage || zoom != viewZoom) {
+        priority += 1e6;
+    }
+    return priority;
+}
 
-            auto it = loadSet.begin();
-            if (it != loadSet.end()) {
-                coords = *it;
-                loadSet.erase(it);
-                tileSource->resumeLoading();
-                coordsValid = true;
-            }
-        }
+void TileCache::loadRequestedTile(int page, int x, int y, int zoom) {
+    // gets called by a worker of the loader pool
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        loadSet.erase(TileCoords(page, x, y, zoom));
+    }
 
-        if (coordsValid) {
-            int page = std::get<0>(coords);
-            int x = std::get<1>(coords);
-            int y = std::get<2>(coords);
-            int zoom = std::get<3>(coords);
-            if (!getFromMemory(page, x, y, zoom)) {
-                // some sources load multiple x/y/zoom tiles at once, so it could already
-                // be loaded from another pair
-                loadAndCacheTile(page, x, y, zoom);
-            }
-        }
+    tileSource->resumeLoading();
 
-        flushCache();
+    if (!isInMemory(makeKey(page, x, y, zoom))) {
+        // some sources load multiple x/y/zoom tiles at once, so it could already
+        // be loaded from another pair
+        loadAndCacheTile(page, x, y, zoom);
     }
-    logger::verbose("TileCache ending thread %d", std::this_thread::get_id());
 }
 
 void TileCache::loadAndCacheTile(int page, int x, int y, int zoom) {
@@ -167,62 +242,126 @@ void TileCache::loadAndCacheTile(int page, int x, int y, int zoom) {
     } catch (const std::exception &e) {
         // some error
         logger::verbose("Marking tile %d/%d/%d as error: %s", zoom, x, y, e.what());
+        std::lock_guard<std::mutex> lock(loadMutex);
         errorSet.insert(TileCoords(page, x, y, zoom));
         return;
     }
 
     std::string fileName = tileSource->getUniqueTileName(page, x, y, zoom);
 
-    std::lock_guard<std::mutex> lock(cacheMutex);
-    enterMemoryCache(page, x, y, zoom, image);
+    enterMemoryCache(makeKey(page, x, y, zoom), image);
     image->storeAndClearEncodedData(cacheDir + "/" + fileName);
 }
 
-void TileCache::enterMemoryCache(int page, int x, int y, int zoom, std::shared_ptr<Image> img) {
-    // gets called with locked mutex
-    auto timeStamp = std::chrono::steady_clock::now();
-    MemCacheEntry entry(img, timeStamp);
-    memoryCache.insert(std::make_pair(tileSource->getUniqueTileName(page, x, y, zoom), entry));
+void TileCache::enterMemoryCache(const TileKey &key, std::shared_ptr<Image> img) {
+    size_t bytes = (size_t) img->getWidth() * img->getHeight() * sizeof(uint32_t);
+
+    {
+        Shard &shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            memoryBytes -= it->second->bytes;
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+        }
+
+        shard.lru.push_front(MemCacheEntry{key, img, bytes, std::chrono::steady_clock::now()});
+        shard.index[key] = shard.lru.begin();
+        memoryBytes += bytes;
+    }
+
+    evictToBudget();
+}
+
+void TileCache::evictToBudget() {
+    // Approximates a global LRU: the oldest entry is always at the tail of one of the shards,
+    // so compare the shard tails and evict the oldest one until we are within the budget.
+    // Only one shard lock is held at a time.
+    while (memoryBytes > memoryBudget) {
+        Shard *oldestShard = nullptr;
+        TimeStamp oldest = TimeStamp::max();
+        for (auto &shard: shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (!shard.lru.empty() && shard.lru.back().lastAccess < oldest) {
+                oldest = shard.lru.back().lastAccess;
+                oldestShard = &shard;
+            }
+        }
+
+        if (!oldestShard) {
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(oldestShard->mutex);
+        if (oldestShard->lru.empty()) {
+            continue;
+        }
+        auto &entry = oldestShard->lru.back();
+        memoryBytes -= entry.bytes;
+        oldestShard->index.erase(entry.key);
+        oldestShard->lru.pop_back();
+        evictionCount++;
+    }
 }
 
 void TileCache::cancelPendingRequests() {
-    std::lock_guard<std::mutex> lock(cacheMutex);
-    tileSource->cancelPendingLoads();
-    errorSet.clear();
-    loadSet.clear();
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        tileSource->cancelPendingLoads();
+        errorSet.clear();
+        loadSet.clear();
+    }
+    loaderPool->drop(this, [] (const TileLoaderPool::Request &) { return true; });
 }
 
 void TileCache::flushCache() {
     // gets called unlocked
-    std::lock_guard<std::mutex> lock(cacheMutex);
+    // The entries of each shard are sorted by access time, so only the tails need to be checked
     auto now = std::chrono::steady_clock::now();
-    for (auto it = memoryCache.begin(); it != memoryCache.end(); ) {
-        auto diff = now - std::get<1>(it->second);
-        if (std::chrono::duration_cast<std::chrono::seconds>(diff).count() >= CACHE_SECONDS) {
-            it = memoryCache.erase(it);
-        } else {
-            ++it;
+    for (auto &shard: shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        while (!shard.lru.empty()) {
+            auto &entry = shard.lru.back();
+            auto diff = now - entry.lastAccess;
+            if (std::chrono::duration_cast<std::chrono::seconds>(diff).count() < CACHE_SECONDS) {
+                break;
+            }
+            memoryBytes -= entry.bytes;
+            shard.index.erase(entry.key);
+            shard.lru.pop_back();
         }
     }
 }
 
-void TileCache::invalidate() {
-    // gets called unlocked
-    std::lock_guard<std::mutex> lock(cacheMutex);
-    tileSource->cancelPendingLoads();
-    memoryCache.clear();
-    errorSet.clear();
-    loadSet.clear();
+void TileCache::clearMemoryCache() {
+    for (auto &shard: shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto &entry: shard.lru) {
+            memoryBytes -= entry.bytes;
+        }
+        shard.lru.clear();
+        shard.index.clear();
+    }
 }
 
-TileCache::~TileCache() {
+void TileCache::invalidate() {
+    // gets called unlocked
     {
-        std::lock_guard<std::mutex> lock(cacheMutex);
-        keepAlive = false;
+        std::lock_guard<std::mutex> lock(loadMutex);
         tileSource->cancelPendingLoads();
-        cacheCondition.notify_one();
+        clearMemoryCache();
+        errorSet.clear();
+        loadSet.clear();
     }
-    loaderThread->join();
+    loaderPool->drop(this, [] (const TileLoaderPool::Request &) { return true; });
+}
+
+TileCache::~TileCache() {
+    tileSource->cancelPendingLoads();
+    // blocks until running loads of this cache are finished
+    loaderPool->removeCache(this);
 }
 
 } /* namespace img */
@@ -20,56 +20,108 @@
 
 #include <cstdint>
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <list>
+#include <array>
 #include <memory>
-#include <thread>
 #include <mutex>
-#include <condition_variable>
 #include <atomic>
 #include <set>
 #include <tuple>
 #include <chrono>
 #include "TileSource.h"
+#include "TileLoaderPool.h"
 
 namespace img {
 
 class TileCache {
 public:
-    TileCache(std::shared_ptr<TileSource> source);
+    struct Statistics {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t budget = 0;
+    };
+
+    static constexpr const size_t DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+
+    TileCache(std::shared_ptr<TileSource> source, std::shared_ptr<TileLoaderPool> pool = TileLoaderPool::getShared());
     void setCacheDirectory(const std::string &utf8Path);
+    void setMemoryBudget(size_t bytes);
+    Statistics getStatistics() const;
+    void setView(int page, double centerX, double centerY, int zoom);
     std::shared_ptr<Image> getTile(int page, int x, int y, int zoom);
     void cancelPendingRequests();
     void invalidate();
     ~TileCache();
 private:
+    friend class TileLoaderPool;
+
     static constexpr const int CACHE_SECONDS = 30;
+    static constexpr const size_t SHARD_COUNT = 8;
     using TimeStamp = std::chrono::time_point<std::chrono::steady_clock>;
     using TileCoords = std::tuple<int, int, int, int>;
-    using MemCacheEntry = std::tuple<std::shared_ptr<Image>, TimeStamp>;
+
+    // the page is kept apart from the packed coordinates so that documents of any length can be cached
+    struct TileKey {
+        int page;
+        uint64_t coords;
+        bool operator==(const TileKey &other) const { return page == other.page && coords == other.coords; }
+    };
+    struct TileKeyHash {
+        size_t operator()(const TileKey &key) const;
+    };
+
+    struct MemCacheEntry {
+        TileKey key;
+        std::shared_ptr<Image> image;
+        size_t bytes;
+        TimeStamp lastAccess;
+    };
+
+    // Each shard is an LRU list (most recently used in front) plus an index into it.
+    // A lookup only locks the shard that owns the key, so GUI lookups don't contend
+    // with the loader or with each other unless they hit the same shard.
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<MemCacheEntry> lru;
+        std::unordered_map<TileKey, std::list<MemCacheEntry>::iterator, TileKeyHash> index;
+    };
 
     std::shared_ptr<TileSource> tileSource;
+    std::shared_ptr<TileLoaderPool> loaderPool;
     std::string cacheDir;
-    std::unique_ptr<std::thread> loaderThread;
 
     std::shared_ptr<Image> errorTile;
 
-    std::mutex cacheMutex;
-    std::condition_variable cacheCondition;
-    std::map<std::string, MemCacheEntry> memoryCache;
+    std::array<Shard, SHARD_COUNT> shards;
+    std::atomic<size_t> memoryBudget { DEFAULT_MEMORY_BUDGET };
+    std::atomic<size_t> memoryBytes { 0 };
+    std::atomic<uint64_t> hitCount { 0 }, missCount { 0 }, evictionCount { 0 };
+
+    std::mutex loadMutex;
     std::set<TileCoords> loadSet;
     std::set<TileCoords> errorSet;
+    int viewPage = 0, viewZoom = 0;
+    double viewCenterX = 0, viewCenterY = 0;
 
-    std::atomic_bool keepAlive { true };
+    static TileKey makeKey(int page, int x, int y, int zoom);
+    Shard &shardFor(const TileKey &key);
 
-    std::shared_ptr<Image> getFromMemory(int page, int x, int y, int zoom);
+    bool isInMemory(const TileKey &key);
+    std::shared_ptr<Image> getFromMemory(const TileKey &key);
     std::shared_ptr<Image> getFromDisk(int page, int x, int y, int zoom);
     void enqueue(int page, int x, int y, int zoom);
+    double getPriority(int page, int x, int y, int zoom);
 
-    void loadLoop();
-    bool hasWork();
+    void loadRequestedTile(int page, int x, int y, int zoom);
     void flushCache();
+    void clearMemoryCache();
+    void evictToBudget();
     void loadAndCacheTile(int page, int x, int y, int zoom);
-    void enterMemoryCache(int page, int x, int y, int zoom, std::shared_ptr<Image> img);
+    void enterMemoryCache(const TileKey &key, std::shared_ptr<Image> img);
 };
 
 } /* namespace img */
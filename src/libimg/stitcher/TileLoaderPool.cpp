@@ -0,0 +1,199 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include "TileLoaderPool.h"
+#include "TileCache.h"
+#include "src/platform/CrashHandler.h"
+#include "src/Logger.h"
+
+namespace img {
+
+size_t TileLoaderPool::sharedWorkerCount = 0;
+
+std::shared_ptr<TileLoaderPool> TileLoaderPool::getShared() {
+    // The pool lives as long as there is a cache using it
+    static std::mutex sharedMutex;
+    static std::weak_ptr<TileLoaderPool> sharedPool;
+
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    auto pool = sharedPool.lock();
+    if (!pool) {
+        size_t count = sharedWorkerCount;
+        if (count == 0) {
+            count = std::clamp(std::thread::hardware_concurrency() / 2, 2u, 8u);
+        }
+        pool = std::make_shared<TileLoaderPool>(count);
+        sharedPool = pool;
+    }
+    return pool;
+}
+
+void TileLoaderPool::setSharedWorkerCount(size_t count) {
+    // only affects pools created after this call
+    sharedWorkerCount = count;
+}
+
+TileLoaderPool::TileLoaderPool(size_t workerCount) {
+    for (size_t i = 0; i < std::max(workerCount, (size_t) 1); i++) {
+        // the first worker also expires old tiles from the memory caches
+        workers.emplace_back(&TileLoaderPool::workLoop, this, i == 0);
+    }
+}
+
+void TileLoaderPool::addCache(TileCache *cache) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    caches[cache].maxParallelLoads = std::max(cache->tileSource->getMaxParallelLoads(), 1);
+}
+
+void TileLoaderPool::removeCache(TileCache *cache) {
+    std::unique_lock<std::mutex> lock(poolMutex);
+    queue.erase(std::remove_if(queue.begin(), queue.end(), [cache] (const Job &job) {
+        return job.cache == cache;
+    }), queue.end());
+    std::make_heap(queue.begin(), queue.end(), compareJobs);
+
+    // wait for running loads of this cache to finish
+    idleCondition.wait(lock, [this, cache] () { return caches[cache].activeLoads == 0; });
+    caches.erase(cache);
+}
+
+void TileLoaderPool::submit(TileCache *cache, const Request &request, double priority) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    queue.push_back(Job{cache, request, priority, nextSequence++});
+    std::push_heap(queue.begin(), queue.end(), compareJobs);
+    workCondition.notify_one();
+}
+
+void TileLoaderPool::reprioritize(TileCache *cache, PriorityFunction priority) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    bool changed = false;
+    for (auto &job: queue) {
+        if (job.cache == cache) {
+            job.priority = priority(job.request);
+            changed = true;
+        }
+    }
+    if (changed) {
+        std::make_heap(queue.begin(), queue.end(), compareJobs);
+    }
+}
+
+void TileLoaderPool::drop(TileCache *cache, FilterFunction isStale) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    auto it = std::remove_if(queue.begin(), queue.end(), [cache, &isStale] (const Job &job) {
+        return job.cache == cache && isStale(job.request);
+    });
+    if (it != queue.end()) {
+        queue.erase(it, queue.end());
+        std::make_heap(queue.begin(), queue.end(), compareJobs);
+    }
+}
+
+bool TileLoaderPool::compareJobs(const Job &a, const Job &b) {
+    // std::*_heap builds a max-heap, so invert the comparison to get the lowest priority value on top
+    if (a.priority != b.priority) {
+        return a.priority > b.priority;
+    }
+    return a.sequence > b.sequence;
+}
+
+bool TileLoaderPool::popJob(Job &job) {
+    // gets called with locked mutex
+    // Take the most important job whose cache is below its parallel load limit
+    std::vector<Job> skipped;
+    bool found = false;
+    while (!queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end(), compareJobs);
+        Job candidate = queue.back();
+        queue.pop_back();
+
+        auto &state = caches[candidate.cache];
+        if (state.activeLoads < state.maxParallelLoads) {
+            state.activeLoads++;
+            job = candidate;
+            found = true;
+            break;
+        }
+        skipped.push_back(candidate);
+    }
+
+    for (auto &skippedJob: skipped) {
+        queue.push_back(skippedJob);
+        std::push_heap(queue.begin(), queue.end(), compareJobs);
+    }
+
+    return found;
+}
+
+void TileLoaderPool::workLoop(bool flushCaches) {
+    crash::ThreadCookie crashCookie;
+
+    logger::verbose("TileLoaderPool spawned thread %d", std::this_thread::get_id());
+    auto lastFlush = std::chrono::steady_clock::now();
+    while (true) {
+        Job job;
+        bool haveJob = false;
+        {
+            std::unique_lock<std::mutex> lock(poolMutex);
+            // also wake up each second to flush the caches
+            workCondition.wait_for(lock, std::chrono::seconds(1), [this, &job, &haveJob] () {
+                if (!keepAlive) {
+                    return true;
+                }
+                haveJob = popJob(job);
+                return haveJob;
+            });
+
+            if (!keepAlive) {
+                break;
+            }
+
+            if (flushCaches && std::chrono::steady_clock::now() - lastFlush >= std::chrono::seconds(1)) {
+                for (auto &it: caches) {
+                    it.first->flushCache();
+                }
+                lastFlush = std::chrono::steady_clock::now();
+            }
+        }
+
+        if (haveJob) {
+            auto &req = job.request;
+            job.cache->loadRequestedTile(req.page, req.x, req.y, req.zoom);
+
+            std::lock_guard<std::mutex> lock(poolMutex);
+            caches[job.cache].activeLoads--;
+            idleCondition.notify_all();
+            // a slot for this cache became available, so skipped jobs might be runnable now
+            workCondition.notify_one();
+        }
+    }
+    logger::verbose("TileLoaderPool ending thread %d", std::this_thread::get_id());
+}
+
+TileLoaderPool::~TileLoaderPool() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        keepAlive = false;
+        workCondition.notify_all();
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+} /* namespace img */
@@ -0,0 +1,90 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_LIBIMG_STITCHER_TILELOADERPOOL_H_
+#define SRC_LIBIMG_STITCHER_TILELOADERPOOL_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace img {
+
+class TileCache;
+
+// A pool of worker threads that is shared by all tile caches. Pending tiles
+// are kept in a single priority queue so that the tiles closest to the center
+// of each view get loaded first.
+class TileLoaderPool {
+public:
+    struct Request {
+        int page, x, y, zoom;
+    };
+    using PriorityFunction = std::function<double(const Request &)>;
+    using FilterFunction = std::function<bool(const Request &)>;
+
+    static std::shared_ptr<TileLoaderPool> getShared();
+    static void setSharedWorkerCount(size_t count);
+
+    TileLoaderPool(size_t workerCount);
+
+    void addCache(TileCache *cache);
+    void removeCache(TileCache *cache);
+
+    // lower priority values are loaded first
+    void submit(TileCache *cache, const Request &request, double priority);
+    void reprioritize(TileCache *cache, PriorityFunction priority);
+    void drop(TileCache *cache, FilterFunction isStale);
+
+    ~TileLoaderPool();
+private:
+    struct Job {
+        TileCache *cache;
+        Request request;
+        double priority;
+        uint64_t sequence;
+    };
+
+    struct CacheState {
+        int maxParallelLoads = 1;
+        int activeLoads = 0;
+    };
+
+    static size_t sharedWorkerCount;
+
+    std::vector<std::thread> workers;
+    std::mutex poolMutex;
+    std::condition_variable workCondition;
+    std::condition_variable idleCondition;
+    std::vector<Job> queue;
+    std::map<TileCache *, CacheState> caches;
+    uint64_t nextSequence = 0;
+    bool keepAlive = true;
+
+    static bool compareJobs(const Job &a, const Job &b);
+    bool popJob(Job &job);
+    void workLoop(bool flushCaches);
+};
+
+} /* namespace img */
+
+#endif /* SRC_LIBIMG_STITCHER_TILELOADERPOOL_H_ */
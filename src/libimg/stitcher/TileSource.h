@@ -22,12 +22,6 @@
 
 namespace img {
 
-template<typename T>
-struct Point {
-    T x {};
-    T y {};
-};
-
 class TileSource {
 public:
     // Basic information
@@ -47,6 +41,7 @@ public:
     // Control the underlying loader
     virtual void cancelPendingLoads() = 0;
     virtual void resumeLoading() = 0;
+    virtual int getMaxParallelLoads() { return 1; }
 
     // Query and load tile information
     virtual int getPageCount() = 0;
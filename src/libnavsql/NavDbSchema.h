@@ -19,6 +19,7 @@
 
 #include <string>
 #include <vector>
+#include <utility>
 
 namespace NavDbSchema {
 
@@ -37,6 +38,9 @@ static const char * createSearchTable =
         "airport_id INTEGER,"
         "fix_id INTEGER"
     ") STRICT;"
+;
+
+static const char * createSearchIndexes =
     "CREATE INDEX idx_grid_search_ilonx ON grid_search(ilonx);"
     "CREATE INDEX idx_grid_search_ilaty ON grid_search(ilaty);"
 ;
@@ -47,6 +51,9 @@ static const char * createCountTable =
         "ilaty INTEGER,"
         "nodes INTEGER"
     ") STRICT;"
+;
+
+static const char * createCountIndexes =
     "CREATE INDEX idx_grid_count_ilonx ON grid_count(ilonx);"
     "CREATE INDEX idx_grid_count_ilaty ON grid_count(ilaty);"
 ;
@@ -62,10 +69,25 @@ static const char * createAirportTable =
         "lonx REAL NOT NULL,"
         "laty REAL NOT NULL"
     ") STRICT;"
+;
+
+static const char * createAirportIndexes =
     "CREATE INDEX idx_airport_ident ON airport(ident);"
     "CREATE INDEX idx_airport_name ON airport(name);"
 ;
 
+// full text index of the airport names and idents, filled from the airport table once it is complete
+static const char * createAirportSearchTable =
+    "CREATE VIRTUAL TABLE airport_search USING fts5("
+        "ident,"
+        "name,"
+        "content='airport',"
+        "content_rowid='airport_id',"
+        "tokenize='unicode61 remove_diacritics 2',"
+        "prefix='2 3'"
+    ");"
+;
+
 static const char * createComTable =
     "CREATE TABLE com ("
         "airport_id INTEGER NOT NULL,"
@@ -74,6 +96,9 @@ static const char * createComTable =
         "name TEXT,"
         "FOREIGN KEY(airport_id) REFERENCES airport(airport_id)"
     ") STRICT;"
+;
+
+static const char * createComIndexes =
     "CREATE INDEX idx_com_airport_id ON com(airport_id);"
 ;
 
@@ -94,6 +119,9 @@ static const char * createRunwayTable =
         "laty REAL NOT NULL,"
         "FOREIGN KEY(airport_id) REFERENCES airport(airport_id)"
     ") STRICT;"
+;
+
+static const char * createRunwayIndexes =
     "CREATE INDEX idx_runway_airport_id ON runway(airport_id);"
 ;
 
@@ -106,6 +134,9 @@ static const char * createStartTable =
         "laty REAL NOT NULL,"
         "FOREIGN KEY(airport_id) REFERENCES airport(airport_id)"
     ") STRICT;"
+;
+
+static const char * createStartIndexes =
     "CREATE INDEX idx_start_airport_id ON start(airport_id);"
     "CREATE INDEX idx_start_type ON start(type);"
 ;
@@ -121,6 +152,9 @@ static const char * createFixTable =
         "lonx REAL NOT NULL,"
         "laty REAL NOT NULL"
     ") STRICT;"
+;
+
+static const char * createFixIndexes =
     "CREATE INDEX idx_fix_airport_id ON fix(airport_id);"
     "CREATE INDEX idx_fix_ident ON fix(ident);"
     "CREATE INDEX idx_fix_region ON fix(region);"
@@ -141,6 +175,9 @@ static const char * createILSTable =
         "range INTEGER NOT NULL,"
         "dme_range INTEGER"
     ") STRICT;"
+;
+
+static const char * createILSIndexes =
     "CREATE INDEX idx_ils_ident ON ils(ident);"
     "CREATE INDEX idx_ils_loc_runway_end_id ON ils(runway_id);"
 ;
@@ -160,6 +197,9 @@ static const char * createVORTable =
         "mag_var REAL,"
         "dme_only INTEGER NOT NULL"
     ") STRICT;"
+;
+
+static const char * createVORIndexes =
     "CREATE INDEX idx_vor_ident ON vor(ident);"
     "CREATE INDEX idx_vor_airport_id ON vor(airport_id);"
 ;
@@ -177,6 +217,9 @@ static const char * createNDBTable =
         "range INTEGER,"
         "mag_var REAL"
     ") STRICT;"
+;
+
+static const char * createNDBIndexes =
     "CREATE INDEX idx_ndb_ident ON ndb(ident);"
     "CREATE INDEX idx_ndb_airport_id ON ndb(airport_id);"
 ;
@@ -198,10 +241,14 @@ static const char * createProcedureTable =
         "final_fix_id INTEGER,"     // final fix (or 0 for approach that applies to all runways)
         "via_fixes TEXT"            // intermediate fix IDs, separated by ':', only used for route construction
     ") STRICT;"
+;
+
+static const char * createProcedureIndexes =
     "CREATE INDEX idx_proc_airport ON procedure(airport_id);"
     "CREATE INDEX idx_proc_name ON procedure(name);"
     "CREATE INDEX idx_proc_type ON procedure(type);"
     "CREATE INDEX idx_proc_runway_name ON procedure(runway_name);"
+    "CREATE INDEX idx_proc_initial_fix ON procedure(initial_fix_id);"
 ;
 
 static const char * createTransitionTable =
@@ -213,7 +260,11 @@ static const char * createTransitionTable =
         "final_fix_id INTEGER,"     // final fix
         "via_fixes TEXT"            // intermediate fix IDs, separated by :
     ") STRICT;"
+;
+
+static const char * createTransitionIndexes =
     "CREATE INDEX idx_transition_proc ON transition(procedure_id);"
+    "CREATE INDEX idx_transition_initial_fix ON transition(initial_fix_id);"
 ;
 
 static const char * createAirwayTable =
@@ -225,19 +276,37 @@ static const char * createAirwayTable =
         "final_fix_id INTEGER,"     // final fix
         "via_fixes TEXT"            // intermediate fix IDs, separated by :
     ") STRICT;"
-    "CREATE INDEX idx_airway_name ON airway(name);"
-    "CREATE INDEX idx_airway_fixs ON airway(initial_fix_id);"
-    "CREATE INDEX idx_airway_fixe ON airway(final_fix_id);"
     "CREATE TABLE fix_airway ("
         "fix_id INTEGER,"
         "airway_id INTEGER,"
         "FOREIGN KEY(fix_id) REFERENCES fix(fix_id),"
         "FOREIGN KEY(airway_id) REFERENCES airway(airway_id)"
     ") STRICT;"
+    "CREATE TABLE airway_edge ("
+        "from_fix_id INTEGER,"      // one row per leg that can be flown from this fix
+        "to_fix_id INTEGER,"        // to this fix
+        "airway_id INTEGER,"        // along this airway
+        "FOREIGN KEY(from_fix_id) REFERENCES fix(fix_id),"
+        "FOREIGN KEY(to_fix_id) REFERENCES fix(fix_id),"
+        "FOREIGN KEY(airway_id) REFERENCES airway(airway_id)"
+    ") STRICT;"
+;
+
+static const char * createAirwayIndexes =
+    "CREATE INDEX idx_airway_name ON airway(name);"
+    "CREATE INDEX idx_airway_fixs ON airway(initial_fix_id);"
+    "CREATE INDEX idx_airway_fixe ON airway(final_fix_id);"
+;
+
+static const char * createFixAirwayIndexes =
     "CREATE INDEX idx_fix_id ON fix_airway(fix_id);"
     "CREATE INDEX idx_airway_id ON fix_airway(airway_id);"
 ;
 
+static const char * createAirwayEdgeIndexes =
+    "CREATE INDEX idx_airway_edge_from ON airway_edge(from_fix_id);"
+;
+
 static const char * setDatabaseOptions(
     "PRAGMA foreign_keys = TRUE;"
 );
@@ -248,6 +317,7 @@ static std::vector<const char *> tableCreateCommands = {
     createSearchTable,
     createCountTable,
     createAirportTable,
+    createAirportSearchTable,
     createComTable,
     createRunwayTable,
     createStartTable,
@@ -262,4 +332,23 @@ static std::vector<const char *> tableCreateCommands = {
     setDatabaseOptions
 };
 
+// the indexes are created separately, once each table has been populated
+static std::vector<std::pair<std::string, const char *>> tableIndexCommands = {
+    {"grid_search", createSearchIndexes},
+    {"grid_count", createCountIndexes},
+    {"airport", createAirportIndexes},
+    {"com", createComIndexes},
+    {"runway", createRunwayIndexes},
+    {"start", createStartIndexes},
+    {"fix", createFixIndexes},
+    {"ils", createILSIndexes},
+    {"vor", createVORIndexes},
+    {"ndb", createNDBIndexes},
+    {"procedure", createProcedureIndexes},
+    {"transition", createTransitionIndexes},
+    {"airway", createAirwayIndexes},
+    {"fix_airway", createFixAirwayIndexes},
+    {"airway_edge", createAirwayEdgeIndexes}
+};
+
 } /* namespace NavDbSchema */
\ No newline at end of file
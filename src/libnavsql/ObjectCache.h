@@ -0,0 +1,134 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2023 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+
+namespace sqlnav {
+
+// Identity map from database keys to the objects created for them, shared by the
+// foreground and background loaders. The most recently used objects are kept alive
+// by the cache, older ones are only remembered while something else still holds
+// them, so that a key never maps to two different live objects.
+template<typename T>
+class ObjectCache
+{
+public:
+    ObjectCache(size_t capacity)
+    :   capacity(capacity), nextPurge(capacity * 2)
+    {
+    }
+
+    ObjectCache() = delete;
+
+    // complete, if given, receives whether the object was stored as complete
+    std::shared_ptr<T> find(int key, bool *complete = nullptr)
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            return nullptr;
+        }
+        auto obj = it->second.object.lock();
+        if (!obj) {
+            entries.erase(it);
+            return nullptr;
+        }
+        pin(key, it->second, obj);
+        if (complete) {
+            *complete = it->second.complete;
+        }
+        return obj;
+    }
+
+    // returns the cached object, which is not the one given if another thread stored one first.
+    // complete marks an object that needs no further loading, it only applies to the stored object.
+    std::shared_ptr<T> insert(int key, std::shared_ptr<T> obj, bool complete = false)
+    {
+        if (!obj) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(guard);
+        auto &entry = entries[key];
+        auto existing = entry.object.lock();
+        if (existing) {
+            if (existing == obj) {
+                entry.complete = entry.complete || complete;
+            }
+            obj = existing;
+        } else {
+            entry.object = obj;
+            entry.complete = complete;
+        }
+        pin(key, entry, obj);
+        evict();
+        return obj;
+    }
+
+private:
+    using UseOrder = std::list<int>;
+
+    struct Entry {
+        std::weak_ptr<T> object;
+        std::shared_ptr<T> pinned;
+        typename UseOrder::iterator usePos;
+        bool complete = false;
+    };
+
+    void pin(int key, Entry &entry, std::shared_ptr<T> obj)
+    {
+        if (entry.pinned) {
+            recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, entry.usePos);
+        } else {
+            entry.pinned = obj;
+            entry.usePos = recentlyUsed.insert(recentlyUsed.begin(), key);
+        }
+    }
+
+    void evict()
+    {
+        while (recentlyUsed.size() > capacity) {
+            entries[recentlyUsed.back()].pinned.reset();
+            recentlyUsed.pop_back();
+        }
+
+        // forget objects that have been released by everyone else
+        if (entries.size() >= nextPurge) {
+            for (auto it = entries.begin(); it != entries.end(); ) {
+                if (it->second.object.expired()) {
+                    it = entries.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            nextPurge = std::max(capacity, entries.size()) * 2;
+        }
+    }
+
+    std::mutex guard;
+    size_t const capacity;
+    size_t nextPurge;
+    std::unordered_map<int, Entry> entries;
+    UseOrder recentlyUsed;
+};
+
+}
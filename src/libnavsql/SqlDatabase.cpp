@@ -108,4 +108,18 @@ void SqlDatabase::createTables()
     }
 }
 
+void SqlDatabase::createIndexes(const std::string &table)
+{
+    for (auto &s: NavDbSchema::tableIndexCommands)
+    {
+        if (s.first != table) continue;
+        std::string errMsg;
+        int e = runscript(s.second, errMsg);
+        if (e != 0) {
+            logger::error("Error code %d when creating Avitab NAVdb %s indexes: %s", e, table.c_str(), errMsg.c_str());
+            throw std::runtime_error("Avitab database create error");
+        }
+    }
+}
+
 }
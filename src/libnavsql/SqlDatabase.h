@@ -23,7 +23,7 @@
 
 namespace sqlnav {
 
-static constexpr int NAV_DB_VERSION = 2;
+static constexpr int NAV_DB_VERSION = 4;
 
 class SqlStatement;
 
@@ -37,6 +37,9 @@ public:
     std::shared_ptr<SqlStatement> compile(const std::string &statement);
     int runscript(const std::string &script, std::string &err);
 
+    // indexes are not part of the created tables, they are added once a table is populated
+    void createIndexes(const std::string &table);
+
 private:
     void createTables();
 
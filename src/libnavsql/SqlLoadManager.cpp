@@ -18,20 +18,28 @@
 
 #include "SqlLoadManager.h"
 #include <stdexcept>
+#include <algorithm>
+#include <cctype>
 #include <sstream>
 #include <string>
 #include "loaders/AirportLoader.h"
 #include "loaders/FixLoader.h"
 #include "src/Logger.h"
+#include "src/platform/Platform.h"
 
 namespace sqlnav {
 
 SqlLoadManager::SqlLoadManager(std::string dbdir)
+:   airportCache(AIRPORT_CACHE_SIZE),
+    fixCache(FIX_CACHE_SIZE)
 {
     logger::info("Looking for SQL database file in  %s", dbdir.c_str());
     std::string dbfile = dbdir + "avitab_navdb.sqlite";
 
     database = std::make_shared<SqlDatabase>(dbfile, true);
+    for (int w = 0; w < BACKGROUND_WORKERS; ++w) {
+        workerDatabases.push_back(std::make_shared<SqlDatabase>(dbfile, true));
+    }
 }
 
 void SqlLoadManager::init_or_throw(std::function<bool(const std::string simCode)> fn)
@@ -45,6 +53,7 @@ void SqlLoadManager::init_or_throw(std::function<bool(const std::string simCode)
     prepareSearches();
     checkMetadata(fn);
     populateRegions();
+    populateDensities();
 }
 
 SqlLoadManager::~SqlLoadManager()
@@ -74,83 +83,125 @@ std::shared_ptr<world::Region> SqlLoadManager::getRegion(const std::string &id)
     return sqlworld->getRegion(id);
 }
 
-std::shared_ptr<SqlStatement> SqlLoadManager::GetSQL(Searches name, bool background)
+std::shared_ptr<world::Region> SqlLoadManager::getRegion(const std::string &id, const std::string &name)
+{
+    return sqlworld->getRegion(id, name);
+}
+
+std::shared_ptr<SqlStatement> SqlLoadManager::GetSQL(Searches name, int worker)
 {
-    auto &qtab = background ? backQueries : foreQueries;
+    auto &qtab = (worker == FOREGROUND) ? foreQueries : backQueries.at(worker);
     if (qtab.find(name) == qtab.end()) return nullptr;
     return qtab[name];
 }
 
-void SqlLoadManager::prepareSearches()
+void SqlLoadManager::prepareSearch(Searches name, const char *sql, bool foreground, bool background)
 {
-    foreQueries[METADATA] = database->compile(
-        "SELECT db_version, target_simulator, data_source FROM metadata;");
-
-    foreQueries[REGION_CODES] = database->compile(
-        "SELECT name FROM region;");
+    // statements belong to a connection, so each background worker needs its own copy
+    if (foreground) {
+        foreQueries[name] = database->compile(sql);
+    }
+    if (background) {
+        for (size_t w = 0; w < workerDatabases.size(); ++w) {
+            backQueries[w][name] = workerDatabases[w]->compile(sql);
+        }
+    }
+}
 
-    foreQueries[MAX_NODE_DENISTY] = database->compile(
-        "SELECT MAX(nodes) FROM grid_count WHERE (ilonx BETWEEN ?1 AND ?3) AND (ilaty BETWEEN ?2 AND ?4);");
+void SqlLoadManager::prepareSearches()
+{
+    backQueries.resize(workerDatabases.size());
 
-    backQueries[NODES_IN_GRID] = database->compile(
-        "SELECT airport_id, fix_id FROM grid_search WHERE (ilonx = ?1) AND (ilaty = ?2);");
+    prepareSearch(METADATA,
+        "SELECT db_version, target_simulator, data_source FROM metadata;", true, false);
 
-    const char *airQ = "SELECT airport_id, ident, name, region, country, lonx, laty, altitude FROM airport WHERE airport_id = ?1 ;";
-    backQueries[AIRPORT_BY_ID] = database->compile(airQ);
-    foreQueries[AIRPORT_BY_ID] = database->compile(airQ);
+    prepareSearch(REGION_CODES,
+        "SELECT name FROM region;", true, false);
 
-    foreQueries[AIRPORT_BY_ICAO] = database->compile(
-        "SELECT airport_id, ident, name, region, country, lonx, laty, altitude FROM airport WHERE ident = ?1 ;");
+    prepareSearch(NODE_DENSITIES,
+        "SELECT ilonx, ilaty, nodes FROM grid_count;", true, false);
 
-    foreQueries[AIRPORTS_BY_KEYWORD] = database->compile(
-        "SELECT airport_id FROM airport WHERE ident LIKE ?1 ;");
+    prepareSearch(NODES_IN_GRID,
+        "SELECT airport_id, fix_id FROM grid_search WHERE (ilonx = ?1) AND (ilaty = ?2);", false, true);
 
-    const char *comQ = "SELECT type, frequency, name FROM com WHERE airport_id = ?1 ;";
-    backQueries[COMMS_AT_AIRPORT] = database->compile(comQ);
-    foreQueries[COMMS_AT_AIRPORT] = database->compile(comQ);
+    // most searches take a json list of keys, so that all rows for a set of airports or fixes can
+    // be fetched at once. the results are returned in no particular order, grouped by the key.
+    prepareSearch(AIRPORTS_BY_KEYS,
+        "SELECT airport_id, ident, name, region, country, lonx, laty, altitude FROM airport "
+        "WHERE airport_id IN (SELECT value FROM json_each(?1)) ;", true, true);
 
-    const char *rwyQ = "SELECT runway_id, name, runway_pair_id, length, width, surface, heading, altitude, offset_threshold, lonx, laty "
-        "FROM runway WHERE airport_id = ?1 ;";
-    backQueries[RUNWAYS_AT_AIRPORT] = database->compile(rwyQ);
-    foreQueries[RUNWAYS_AT_AIRPORT] = database->compile(rwyQ);
+    prepareSearch(AIRPORT_BY_ICAO,
+        "SELECT airport_id FROM airport WHERE ident = ?1 ;", true, false);
 
-    const char *heliQ = "SELECT number, lonx, laty FROM start WHERE (airport_id = ?1) AND (type = 'H') ;";
-    backQueries[HELIPADS_AT_AIRPORT] = database->compile(heliQ);
-    foreQueries[HELIPADS_AT_AIRPORT] = database->compile(heliQ);
+    // airport searches are ranked: exact ident, then ident prefix, then words in the name or ident,
+    // then anywhere in the ident. the last one scans the idents, it only runs when the others found too few.
+    prepareSearch(AIRPORTS_BY_IDENT_PREFIX,
+        "SELECT airport_id FROM airport WHERE ident >= ?1 AND ident < ?1 || char(127) ORDER BY ident LIMIT ?2 ;", true, false);
 
-    const char *locQ = "SELECT ident, name, runway_id, lonx, laty, frequency, loc_heading, mag_var, range, dme_range "
-        "FROM ils WHERE airport_id = ?1 ;";
-    backQueries[LOCALIZERS_AT_AIRPORT] = database->compile(locQ);
-    foreQueries[LOCALIZERS_AT_AIRPORT] = database->compile(locQ);
+    prepareSearch(AIRPORTS_BY_NAME,
+        "SELECT rowid FROM airport_search WHERE airport_search MATCH ?1 ORDER BY rank LIMIT ?2 ;", true, false);
 
-    const char *wptaQ = "SELECT fix_id FROM fix WHERE airport_id = ?1 ;";
-    backQueries[FIXES_AT_AIRPORT] = database->compile(wptaQ);
-    foreQueries[FIXES_AT_AIRPORT] = database->compile(wptaQ);
+    prepareSearch(AIRPORTS_BY_IDENT_SUBSTRING,
+        "SELECT airport_id FROM airport WHERE ident LIKE ?1 ESCAPE '\\' ORDER BY ident LIMIT ?2 ;", true, false);
 
-    foreQueries[PROCEDURES_AT_AIRPORT] = database->compile(
-        "SELECT procedure_id, type, name, runway_name, initial_fix_id, final_fix_id, via_fixes FROM procedure WHERE airport_id = ?1 ;");
+    prepareSearch(COMMS_AT_AIRPORTS,
+        "SELECT airport_id, type, frequency, name FROM com "
+        "WHERE airport_id IN (SELECT value FROM json_each(?1)) ;", true, true);
 
-    foreQueries[TRANSITIONS_BY_NAME_IN_PIDS] = database->compile(
-        "SELECT procedure_id, initial_fix_id, final_fix_id, via_fixes FROM transition "
-            "WHERE name = ?1 AND procedure_id IN (SELECT value FROM json_each(?2)) ;");
+    prepareSearch(RUNWAYS_AT_AIRPORTS,
+        "SELECT airport_id, runway_id, name, runway_pair_id, length, width, surface, heading, altitude, offset_threshold, lonx, laty "
+        "FROM runway WHERE airport_id IN (SELECT value FROM json_each(?1)) ;", true, true);
 
-    const char *wptiQ = "SELECT ident, region, type, nav_id, lonx, laty FROM fix WHERE fix_id = ?1 ;";
-    backQueries[FIX_BY_ID] = database->compile(wptiQ);
-    foreQueries[FIX_BY_ID] = database->compile(wptiQ);
+    prepareSearch(HELIPADS_AT_AIRPORTS,
+        "SELECT airport_id, number, lonx, laty FROM start "
+        "WHERE (airport_id IN (SELECT value FROM json_each(?1))) AND (+type = 'H') ;", true, true);
 
-    foreQueries[FIX_BY_NAME] = database->compile(
-        "SELECT ident, region, type, nav_id, lonx, laty FROM fix WHERE region = ?1 AND ident = ?2 ;");
+    prepareSearch(LOCALIZERS_AT_AIRPORTS,
+        "SELECT airport_id, ident, name, runway_id, lonx, laty, frequency, loc_heading, mag_var, range, dme_range "
+        "FROM ils WHERE airport_id IN (SELECT value FROM json_each(?1)) ;", true, true);
 
-    foreQueries[FIXES_BY_KEYS] = database->compile(
-        "SELECT fix_id, ident, region, lonx, laty FROM fix WHERE fix_id IN (SELECT value FROM json_each(?1)) ;");
+    prepareSearch(FIXES_AT_AIRPORTS,
+        "SELECT fix_id, airport_id FROM fix WHERE airport_id IN (SELECT value FROM json_each(?1)) ;", true, true);
 
-    const char *ndbQ = "SELECT name, frequency, range FROM ndb WHERE ndb_id = ?1 ;";
-    backQueries[NDB_BY_ID] = database->compile(ndbQ);
-    foreQueries[NDB_BY_ID] = database->compile(ndbQ);
+    prepareSearch(PROCEDURES_AT_AIRPORTS,
+        "SELECT airport_id, procedure_id, type, name, runway_name, initial_fix_id, final_fix_id, via_fixes FROM procedure "
+            "WHERE airport_id IN (SELECT value FROM json_each(?1)) ;", true, false);
 
-    const char *vorQ = "SELECT name, type, frequency, range, mag_var, dme_only FROM vor WHERE vor_id = ?1 ;";
-    backQueries[VOR_BY_ID] = database->compile(vorQ);
-    foreQueries[VOR_BY_ID] = database->compile(vorQ);
+    prepareSearch(TRANSITIONS_BY_NAME_IN_PIDS,
+        "SELECT procedure_id, initial_fix_id, final_fix_id, via_fixes FROM transition "
+            "WHERE name = ?1 AND procedure_id IN (SELECT value FROM json_each(?2)) ;", true, false);
+
+    prepareSearch(FIX_BY_NAME,
+        "SELECT fix_id FROM fix WHERE region = ?1 AND ident = ?2 ;", true, false);
+
+    prepareSearch(FIXES_BY_KEYS,
+        "SELECT fix_id, ident, region, lonx, laty, type, nav_id FROM fix WHERE fix_id IN (SELECT value FROM json_each(?1)) ;", true, true);
+
+    prepareSearch(NDBS_BY_KEYS,
+        "SELECT ndb_id, name, frequency, range FROM ndb WHERE ndb_id IN (SELECT value FROM json_each(?1)) ;", true, true);
+
+    prepareSearch(VORS_BY_KEYS,
+        "SELECT vor_id, name, type, frequency, range, mag_var, dme_only FROM vor WHERE vor_id IN (SELECT value FROM json_each(?1)) ;", true, true);
+
+    prepareSearch(AIRWAY_EDGES_FROM_FIX,
+        "SELECT e.to_fix_id, a.airway_id, a.name, a.type FROM airway_edge e "
+            "JOIN airway a ON a.airway_id = e.airway_id WHERE e.from_fix_id = ?1 ;", true, false);
+
+    // SIDs leave the airport at the final fix of the procedure and of each of its transitions
+    prepareSearch(DEPARTURES_AT_AIRPORT,
+        "SELECT ?1, p.type, p.name, p.final_fix_id FROM procedure p "
+            "WHERE p.airport_id IN (SELECT airport_id FROM airport WHERE ident = ?1) AND +p.type = 1 "
+        "UNION SELECT ?1, p.type, p.name, t.final_fix_id FROM procedure p "
+            "JOIN transition t ON t.procedure_id = p.procedure_id "
+            "WHERE p.airport_id IN (SELECT airport_id FROM airport WHERE ident = ?1) AND +p.type = 1 ;", true, false);
+
+    // STARs and approaches enter the airport from the initial fix of the procedure and of each of its transitions
+    prepareSearch(ARRIVALS_FROM_FIX,
+        "SELECT a.ident, p.type, p.name, p.initial_fix_id FROM procedure p "
+            "JOIN airport a ON a.airport_id = p.airport_id WHERE p.initial_fix_id = ?1 AND p.type IN (2, 3) "
+        "UNION SELECT a.ident, p.type, p.name, t.initial_fix_id FROM transition t "
+            "JOIN procedure p ON p.procedure_id = t.procedure_id "
+            "JOIN airport a ON a.airport_id = p.airport_id WHERE t.initial_fix_id = ?1 AND p.type IN (2, 3) ;", true, false);
 }
 
 void SqlLoadManager::checkMetadata(std::function<bool(std::string simCode)> checkDbSimulator)
@@ -196,70 +247,121 @@ void SqlLoadManager::populateRegions()
     }
 }
 
-int SqlLoadManager::getMaxInAreas(int lonl, int latl, int lonh, int lath)
+void SqlLoadManager::populateDensities()
 {
-    // this query returns the maximum number of nodes from the set of grid areas
-    // covered by the search area. it typically takes 5-8ms. it could be a target
-    // for future optimisation - loading the table into memory in advance.
-    auto qry = foreQueries[MAX_NODE_DENISTY];
+    // the grid is small enough to be held in memory, so that the map can estimate
+    // the density of any area without a query for each frame
+    auto qry = foreQueries[NODE_DENSITIES];
+
+    // configure the query
     qry->initialize();
-    qry->bind(1, lonl);
-    qry->bind(2, latl);
-    qry->bind(3, lonh);
-    qry->bind(4, lath);
-    if (qry->step()) return 0;
-    auto n = qry->getInt(0);
-    return n;
+
+    // process the results
+    world::DensityGrid grid;
+    while (1) {
+        if (qry->step()) break;
+        grid.addNodes(qry->getInt(0), qry->getInt(1), qry->getInt(2));
+    }
+    grid.update();
+    sqlworld->setDensityGrid(std::move(grid));
 }
 
-void SqlLoadManager::loadNodesInArea(int lonx, int laty)
+void SqlLoadManager::loadNodesInArea(int lonx, int laty, int worker)
 {
     std::vector<int> airports, fixes;
-    identifyNodesInArea(lonx, laty, airports, fixes);
+    identifyNodesInArea(lonx, laty, worker, airports, fixes);
 
-    for (auto id: airports) {
-        auto al = std::make_unique<AirportLoader>(std::dynamic_pointer_cast<SqlLoadManager>(shared_from_this()), id, true);
-        std::vector<std::shared_ptr<world::Fix>> ils_fixes;
-        auto a = al->load(&ils_fixes);
+    // all nodes of the area are loaded in bulk, with a few queries per type of node
+    auto al = std::make_unique<AirportLoader>(std::dynamic_pointer_cast<SqlLoadManager>(shared_from_this()), airports, worker);
+    for (auto a: al->loadAll()) {
         sqlworld->addAirport(a);
-        for (auto f: ils_fixes) {
-            sqlworld->addFix(f);
-        }
+        // the airport might have been created by an earlier search, so find its localizers through the runways
+        a->forEachRunway([this] (const std::shared_ptr<world::Runway> rwy) {
+            auto ils = rwy->getILSData();
+            if (ils) {
+                sqlworld->addFix(ils);
+            }
+        });
     }
-    for (auto id: fixes) {
-        auto fl = std::make_unique<FixLoader>(std::dynamic_pointer_cast<SqlLoadManager>(shared_from_this()), id);
-        auto f = fl->load();
-        sqlworld->addFix(f);
+    if (!fixes.empty()) {
+        auto fl = std::make_unique<FixLoader>(std::dynamic_pointer_cast<SqlLoadManager>(shared_from_this()), worker);
+        for (auto &it: fl->loadByKeys(fixes)) {
+            sqlworld->addFix(it.second);
+        }
     }
 }
 
 std::vector<std::shared_ptr<world::Airport>> SqlLoadManager::getMatchingAirports(const std::string &pattern)
 {
-    std::string srch = std::string("%") + pattern + '%';
+    std::string ident = platform::upper(pattern);
+    ident.erase(std::remove(ident.begin(), ident.end(), ' '), ident.end());
+
+    // every word of the pattern must be the start of a word in the name or ident
+    std::string words;
+    std::string word;
+    for (size_t i = 0; i <= pattern.size(); ++i) {
+        unsigned char c = (i < pattern.size()) ? pattern[i] : ' ';
+        if (std::isalnum(c) || (c >= 0x80)) {
+            word += c;
+        } else if (!word.empty()) {
+            words += (words.empty() ? "\"" : " \"") + word + "\"*";
+            word.clear();
+        }
+    }
+
+    // e.g. LAX for KLAX
+    std::string infix;
+    for (auto c: ident) {
+        if ((c == '%') || (c == '_') || (c == '\\')) {
+            infix += '\\';
+        }
+        infix += c;
+    }
+    if (!infix.empty()) {
+        infix = "%" + infix + "%";
+    }
+
     std::vector<int> ids;
-    auto qry = foreQueries[AIRPORTS_BY_KEYWORD];
+    searchAirports(AIRPORT_BY_ICAO, ident, ids);
+    searchAirports(AIRPORTS_BY_IDENT_PREFIX, ident, ids);
+    searchAirports(AIRPORTS_BY_NAME, words, ids);
+    searchAirports(AIRPORTS_BY_IDENT_SUBSTRING, infix, ids);
+
+    auto al = std::make_unique<AirportLoader>(std::dynamic_pointer_cast<SqlLoadManager>(shared_from_this()), ids, FOREGROUND);
+    return al->loadAll();
+}
+
+void SqlLoadManager::searchAirports(Searches name, const std::string &key, std::vector<int> &ids)
+{
+    // appends the matches that aren't already in the results, until there are enough of them
+    const size_t maxResults = world::World::MAX_SEARCH_RESULTS;
+    if (key.empty() || (ids.size() >= maxResults)) {
+        return;
+    }
+
+    auto qry = foreQueries[name];
     qry->initialize();
-    qry->bind(1, srch);
-    while (1) {
+    qry->bind(1, key);
+    if (name != AIRPORT_BY_ICAO) {
+        qry->bind(2, (int)maxResults);
+    }
+    while (ids.size() < maxResults) {
         if (qry->step()) break;
         auto id = qry->getInt(0);
-        ids.push_back(id);
-    }
-
-    std::vector<std::shared_ptr<world::Airport>> airports;
-    for (auto id: ids) {
-        auto al = std::make_unique<AirportLoader>(std::dynamic_pointer_cast<SqlLoadManager>(shared_from_this()), id, false);
-        auto a = al->load();
-        airports.push_back(a);
+        if (std::find(ids.begin(), ids.end(), id) == ids.end()) {
+            ids.push_back(id);
+        }
     }
-
-    return airports;
 }
 
 std::shared_ptr<world::Airport> SqlLoadManager::getAirport(const std::string &icao)
 {
     auto al = std::make_unique<AirportLoader>(std::dynamic_pointer_cast<SqlLoadManager>(shared_from_this()), icao);
-    return al->load();
+    auto a = al->load();
+    if (a) {
+        sqlworld->trackAirport(a);
+    }
+    return a;
 }
 
 std::shared_ptr<world::Fix> SqlLoadManager::getFix(const std::string &region, const std::string &id)
@@ -268,9 +370,29 @@ std::shared_ptr<world::Fix> SqlLoadManager::getFix(const std::string &region, co
     return fl->load();
 }
 
+std::shared_ptr<world::Airport> SqlLoadManager::findCachedAirport(int key, bool *proceduresLoaded)
+{
+    return airportCache.find(key, proceduresLoaded);
+}
+
+std::shared_ptr<world::Airport> SqlLoadManager::cacheAirport(int key, std::shared_ptr<world::Airport> airport, bool proceduresLoaded)
+{
+    return airportCache.insert(key, airport, proceduresLoaded);
+}
+
+std::shared_ptr<world::Fix> SqlLoadManager::findCachedFix(int key)
+{
+    return fixCache.find(key);
+}
+
+std::shared_ptr<world::Fix> SqlLoadManager::cacheFix(int key, std::shared_ptr<world::Fix> fix)
+{
+    return fixCache.insert(key, fix);
+}
+
 world::NavNodeList SqlLoadManager::getFixList(const std::vector<int> &fixKeys)
 {
-    auto loader = std::make_unique<FixLoader>(std::dynamic_pointer_cast<SqlLoadManager>(shared_from_this()));
+    auto loader = std::make_unique<FixLoader>(std::dynamic_pointer_cast<SqlLoadManager>(shared_from_this()), FOREGROUND);
     auto fixes = loader->loadAll(fixKeys);
     world::NavNodeList nodes;
     for (auto f: fixes) {
@@ -281,19 +403,10 @@ world::NavNodeList SqlLoadManager::getFixList(const std::vector<int> &fixKeys)
 
 std::vector<int> SqlLoadManager::getTransitionFixes(const std::string &ident, const std::vector<int> &pids, int &selectedPid)
 {
-    // create a json fragment to be used in the SQL query for a variable-length selection
-    std::ostringstream json;
-    json << '[';
-    for (auto i: pids) {
-        json << i << ',';
-    }
-    std::string srch = json.str();
-    srch.back() = ']';
-
     auto qry = foreQueries[TRANSITIONS_BY_NAME_IN_PIDS];
     qry->initialize();
     qry->bind(1, ident);
-    qry->bind(2, srch);
+    qry->bind(2, toKeyList(pids));
 
     // process the results - should be maximum of 1, but possibly none
     if (qry->step()) {
@@ -308,9 +421,73 @@ std::vector<int> SqlLoadManager::getTransitionFixes(const std::string &ident, co
     return toVector(f0, fn, vias);
 }
 
-void SqlLoadManager::identifyNodesInArea(int lonx, int laty, std::vector<int> &airports, std::vector<int> &fixes)
+int SqlLoadManager::getFixKey(const std::string &region, const std::string &ident)
+{
+    auto qry = foreQueries[FIX_BY_NAME];
+    qry->initialize();
+    qry->bind(1, region);
+    qry->bind(2, ident);
+    if (qry->step()) return 0;
+    return qry->getInt(0);
+}
+
+std::map<int, std::shared_ptr<world::Fix>> SqlLoadManager::getFixMap(const std::vector<int> &fixKeys)
 {
-    auto qry = backQueries[NODES_IN_GRID];
+    if (fixKeys.empty()) {
+        return std::map<int, std::shared_ptr<world::Fix>>();
+    }
+    auto loader = std::make_unique<FixLoader>(std::dynamic_pointer_cast<SqlLoadManager>(shared_from_this()), FOREGROUND);
+    return loader->loadByKeys(fixKeys);
+}
+
+void SqlLoadManager::getAirwayEdges(int fixKey, std::vector<AirwayEdge> &edges)
+{
+    auto qry = foreQueries[AIRWAY_EDGES_FROM_FIX];
+    qry->initialize();
+    qry->bind(1, fixKey);
+    while (1) {
+        if (qry->step()) break;
+        AirwayEdge e;
+        e.toFixKey = qry->getInt(0);
+        e.airwayKey = qry->getInt(1);
+        e.name = qry->getString(2);
+        e.type = qry->getString(3);
+        edges.push_back(e);
+    }
+}
+
+void SqlLoadManager::getDepartureLinks(const std::string &icao, std::vector<ProcedureLink> &links)
+{
+    auto qry = foreQueries[DEPARTURES_AT_AIRPORT];
+    qry->initialize();
+    qry->bind(1, icao);
+    readProcedureLinks(qry, links);
+}
+
+void SqlLoadManager::getArrivalLinks(int fixKey, std::vector<ProcedureLink> &links)
+{
+    auto qry = foreQueries[ARRIVALS_FROM_FIX];
+    qry->initialize();
+    qry->bind(1, fixKey);
+    readProcedureLinks(qry, links);
+}
+
+void SqlLoadManager::readProcedureLinks(std::shared_ptr<SqlStatement> qry, std::vector<ProcedureLink> &links)
+{
+    while (1) {
+        if (qry->step()) break;
+        ProcedureLink l;
+        l.airport = qry->getString(0);
+        l.type = qry->getInt(1);
+        l.name = qry->getString(2);
+        l.fixKey = qry->getInt(3);
+        if (l.fixKey) links.push_back(l);
+    }
+}
+
+void SqlLoadManager::identifyNodesInArea(int lonx, int laty, int worker, std::vector<int> &airports, std::vector<int> &fixes)
+{
+    auto qry = GetSQL(NODES_IN_GRID, worker);
 
     // configure the query
     qry->initialize();
@@ -345,4 +522,20 @@ std::vector<int> SqlLoadManager::toVector(int f0, int fn, std::string vias)
     return fixIds;
 }
 
+std::string SqlLoadManager::toKeyList(const std::vector<int> &keys)
+{
+    // create a json fragment to be used in the SQL query for a variable-length selection
+    std::ostringstream json;
+    json << '[';
+    for (auto k: keys) {
+        json << k << ',';
+    }
+    if (keys.empty()) {
+        json << ']';
+    }
+    std::string srch = json.str();
+    srch.back() = ']';
+    return srch;
+}
+
 }
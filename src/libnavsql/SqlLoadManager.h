@@ -21,6 +21,7 @@
 #include "SqlWorld.h"
 #include "SqlDatabase.h"
 #include "SqlStatement.h"
+#include "ObjectCache.h"
 
 namespace sqlnav {
 
@@ -38,53 +39,97 @@ public:
     void reloadMetar() override;
 
     std::shared_ptr<world::Region> getRegion(const std::string &id);
+    std::shared_ptr<world::Region> getRegion(const std::string &id, const std::string &name);
 
-    int getMaxInAreas(int lonl, int latl, int lonh, int lath);
-    void loadNodesInArea(int lonx, int laty); // called on background thread
+    // each background worker has its own database connection, so that areas can be loaded concurrently
+    static constexpr const int FOREGROUND = -1;
+    static constexpr const int BACKGROUND_WORKERS = 3;
+
+    void loadNodesInArea(int lonx, int laty, int worker); // called on background thread
 
     std::vector<std::shared_ptr<world::Airport>> getMatchingAirports(const std::string &pattern);
     std::shared_ptr<world::Airport> getAirport(const std::string &id);
     std::shared_ptr<world::Fix> getFix(const std::string &region, const std::string &id);
 
+    // identity maps, so that each airport and fix is only created once
+    std::shared_ptr<world::Airport> findCachedAirport(int key, bool *proceduresLoaded = nullptr);
+    std::shared_ptr<world::Airport> cacheAirport(int key, std::shared_ptr<world::Airport> airport, bool proceduresLoaded);
+    std::shared_ptr<world::Fix> findCachedFix(int key);
+    std::shared_ptr<world::Fix> cacheFix(int key, std::shared_ptr<world::Fix> fix);
+
     world::NavNodeList getFixList(const std::vector<int> &fixKeys);
     std::vector<int> getTransitionFixes(const std::string &ident, const std::vector<int> &pids, int &selectedPid);
 
+    // used by the world to build the airway graph for route finding
+    struct AirwayEdge {
+        int toFixKey;
+        int airwayKey;
+        std::string name;
+        std::string type;
+    };
+    struct ProcedureLink {
+        std::string airport;
+        int type;
+        std::string name;
+        int fixKey;
+    };
+    int getFixKey(const std::string &region, const std::string &ident);
+    std::map<int, std::shared_ptr<world::Fix>> getFixMap(const std::vector<int> &fixKeys);
+    void getAirwayEdges(int fixKey, std::vector<AirwayEdge> &edges);
+    void getDepartureLinks(const std::string &icao, std::vector<ProcedureLink> &links);
+    void getArrivalLinks(int fixKey, std::vector<ProcedureLink> &links);
+
     enum Searches {
         METADATA,
         REGION_CODES,
-        MAX_NODE_DENISTY,
+        NODE_DENSITIES,
         NODES_IN_GRID,
-        AIRPORT_BY_ID,
+        AIRPORTS_BY_KEYS,
         AIRPORT_BY_ICAO,
-        AIRPORTS_BY_KEYWORD,
-        COMMS_AT_AIRPORT,
-        RUNWAYS_AT_AIRPORT,
-        HELIPADS_AT_AIRPORT,
-        LOCALIZERS_AT_AIRPORT,
-        FIXES_AT_AIRPORT,
-        PROCEDURES_AT_AIRPORT,
+        AIRPORTS_BY_IDENT_PREFIX,
+        AIRPORTS_BY_NAME,
+        AIRPORTS_BY_IDENT_SUBSTRING,
+        COMMS_AT_AIRPORTS,
+        RUNWAYS_AT_AIRPORTS,
+        HELIPADS_AT_AIRPORTS,
+        LOCALIZERS_AT_AIRPORTS,
+        FIXES_AT_AIRPORTS,
+        PROCEDURES_AT_AIRPORTS,
         TRANSITIONS_BY_NAME_IN_PIDS,
-        FIX_BY_ID,
         FIX_BY_NAME,
         FIXES_BY_KEYS,
-        NDB_BY_ID,
-        VOR_BY_ID
+        NDBS_BY_KEYS,
+        VORS_BY_KEYS,
+        AIRWAY_EDGES_FROM_FIX,
+        DEPARTURES_AT_AIRPORT,
+        ARRIVALS_FROM_FIX
     };
-    std::shared_ptr<SqlStatement> GetSQL(Searches name, bool background);
+    std::shared_ptr<SqlStatement> GetSQL(Searches name, int worker);
 
     static std::vector<int> toVector(int f0, int fn, std::string vias);
+    static std::string toKeyList(const std::vector<int> &keys);
 
 protected:
     void prepareSearches();
+    void prepareSearch(Searches name, const char *sql, bool foreground, bool background);
     void checkMetadata(std::function<bool(std::string simCode)> fn);
     void populateRegions();
-    void identifyNodesInArea(int lonx, int laty, std::vector<int> &airports, std::vector<int> &fixes);
+    void populateDensities();
+    void identifyNodesInArea(int lonx, int laty, int worker, std::vector<int> &airports, std::vector<int> &fixes);
+    void searchAirports(Searches name, const std::string &key, std::vector<int> &ids);
+    void readProcedureLinks(std::shared_ptr<SqlStatement> qry, std::vector<ProcedureLink> &links);
 
 private:
+    static constexpr const size_t AIRPORT_CACHE_SIZE = 4096;
+    static constexpr const size_t FIX_CACHE_SIZE = 32768;
+
     std::shared_ptr<SqlDatabase> database;
+    std::vector<std::shared_ptr<SqlDatabase>> workerDatabases;
     std::shared_ptr<SqlWorld> sqlworld;
-    std::map<int, std::shared_ptr<SqlStatement>> backQueries;
+    std::vector<std::map<int, std::shared_ptr<SqlStatement>>> backQueries;
     std::map<int, std::shared_ptr<SqlStatement>> foreQueries;
+    ObjectCache<world::Airport> airportCache;
+    ObjectCache<world::Fix> fixCache;
 };
 
 }
@@ -32,7 +32,9 @@ SqlWorld::SqlWorld(std::shared_ptr<SqlLoadManager> db)
 :   world::World(),
     loadManager(db)
 {
-    asyncLoaderState = std::async(std::launch::async, [this] { backgroundLoader(); });
+    for (int w = 0; w < SqlLoadManager::BACKGROUND_WORKERS; ++w) {
+        asyncLoaderStates.push_back(std::async(std::launch::async, [this, w] { backgroundLoader(w); }));
+    }
 }
 
 SqlWorld::~SqlWorld()
@@ -42,50 +44,25 @@ SqlWorld::~SqlWorld()
 
 void SqlWorld::shutdown()
 {
-    // wait for the background loader to become inactive
-    bool running = true;
-    while (running) {
-        {
-            std::unique_lock<std::mutex> lock(navStateGuard);
-            running = (backgroundLoadArea != nullptr);
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    }
-    // now notify the background loader to wake up, but without providing an
-    // area to load. this will cause it to exit from its work loop and terminate.
+    // drop the pending requests and wake up the background loaders. a loader that is
+    // in the middle of an area finishes it, then they all exit from their work loops.
     {
-        std::unique_lock<std::mutex> lock(backgroundLoaderGuard);
-        backgroundLoadControl.notify_one();
+        std::lock_guard<std::mutex> guard(navStateGuard);
+        stopLoading = true;
+        viewRequests.clear();
+        trackRequests.clear();
+    }
+    backgroundLoadControl.notify_all();
+
+    // wait until the futures indicate that the background tasks completed
+    for (auto &state: asyncLoaderStates) {
+        state.wait();
     }
-    // wait until the future indicates that the background task completed
-    asyncLoaderState.wait();
 }
 
 int SqlWorld::maxDensity(const world::Location &bottomLeft, const world::Location &topRight)
 {
-    int d = 0;
-    auto loadMgr = loadManager.lock();
-
-    // nodes are grouped by integer lat/lon 'squares'.
-    int latl = std::max((int)std::floor(bottomLeft.latitude), -90);
-    int lath = std::min((int)std::ceil(topRight.latitude), 89);
-    int lonl = (int)std::floor(bottomLeft.longitude);
-    int lonh = (int)std::ceil(topRight.longitude);
-
-    // the area might span the -180/+180 meridian. if so do 2 searches
-    if (lonl <= lonh) {
-        d = loadMgr->getMaxInAreas(lonl, latl, lonh, lath);
-    } else {
-        d = loadMgr->getMaxInAreas(lonh, latl, 180, lath);
-        d = std::max(d, loadMgr->getMaxInAreas(-180, latl, lonl, lath));
-    }
-
-    // pretend that each grid area has 'max' nodes in it, and report the total number of visible nodes that
-    // would be seen if this was the case.
-    float mapArea = (topRight.longitude > bottomLeft.longitude)
-                    ? (topRight.latitude - bottomLeft.latitude) * (topRight.longitude - bottomLeft.longitude)
-                    : (topRight.latitude - bottomLeft.latitude) * (360 + topRight.longitude - bottomLeft.longitude);
-    return (int)(mapArea * d);
+    return densities.estimateVisibleNodes(bottomLeft, topRight);
 }
 
 inline unsigned distance(int x1, int y1, int x2, int y2) {
@@ -94,6 +71,10 @@ inline unsigned distance(int x1, int y1, int x2, int y2) {
     return (unsigned)std::sqrt((dx * dx) + (dy * dy));
 }
 
+inline int normaliseLongitude(int lonx) {
+    return ((lonx + 540) % 360) - 180;
+}
+
 void SqlWorld::visitNodes(const world::Location &bottomLeft, const world::Location &topRight, NodeAcceptor callback, int filter)
 {
     // make sure nothing updates the NAV data state while we are searching
@@ -108,35 +89,38 @@ void SqlWorld::visitNodes(const world::Location &bottomLeft, const world::Locati
     // the area might span the -180/180 meridian. bias it here, normalise again in iteration
     if (lonh < lonl) { lonh += 360; }
 
+    viewLatl = latl;
+    viewLath = lath;
+    viewLonl = lonl;
+    viewLonh = lonh;
+
     int latc = (lath + latl) / 2;
     int lonc = (lonh + lonl) / 2;
 
-    // create an ordered list of areas to visit starting from the ones nearest the centre of the map
-    std::vector<std::vector<std::pair<int, int>>> visitOrder;
-    for (int laty = latl; laty <= lath; ++laty) {
-        for (int lonx = lonl; lonx <= lonh; ++lonx) {
+    // create an ordered list of areas to visit starting from the ones nearest the centre of the map.
+    // the areas in the margin around the map are only loaded in advance, not visited.
+    std::vector<std::vector<std::pair<Area, bool>>> visitOrder;
+    for (int laty = std::max(latl - PREFETCH_MARGIN, -90); laty <= std::min(lath + PREFETCH_MARGIN, 89); ++laty) {
+        for (int lonx = lonl - PREFETCH_MARGIN; lonx <= lonh + PREFETCH_MARGIN; ++lonx) {
             auto d = distance(lonx, laty, lonc, latc);
             if ((d + 1) > visitOrder.size()) visitOrder.resize(d + 1);
-            int normx = (lonx >= 180) ? (lonx - 360) : lonx;
-            visitOrder[d].push_back(std::make_pair(normx, laty));
+            bool visible = (laty >= latl) && (laty <= lath) && (lonx >= lonl) && (lonx <= lonh);
+            visitOrder[d].push_back(std::make_pair(std::make_pair(normaliseLongitude(lonx), laty), visible));
         }
     }
 
     // iterate through the grid areas, closest ones first, report nodes we already have cached
-    // and trigger an async load of the first area not already loaded (if async loading is not already running)
-    for (auto outer: visitOrder) {
-        for (auto area: outer) {
-            auto cit = areaCached.find(area);
-            if (cit == areaCached.end()) {
-                // area has not been visited before, so we can try and load it
-                if (!backgroundLoadArea) {
-                    // there isn't a background load in progress - start one running
-                    backgroundLoadArea = std::make_unique<std::pair<int,int>>(area);
-                    areaCached[area] = false;
-                    backgroundLoadControl.notify_one();
-                }
+    // and queue the areas not already loaded for the background loaders
+    std::vector<Area> missing;
+    for (auto &outer: visitOrder) {
+        for (auto &it: outer) {
+            auto &area = it.first;
+            auto sit = areaState.find(area);
+            if ((sit == areaState.end()) || (sit->second == AreaState::QUEUED)) {
+                missing.push_back(area);
                 continue; // there won't be any nodes, so try the next area
             }
+            if (!it.second) continue;
 
             // this area has been (or is being) cached, so we can filter and report back to the caller
             auto nit = areaNodes.find(area);
@@ -164,6 +148,170 @@ void SqlWorld::visitNodes(const world::Location &bottomLeft, const world::Locati
             }
         }
     }
+
+    replaceRequests(viewRequests, missing);
+    if (areaState.size() > MAX_CACHED_AREAS) {
+        evictDistantAreas();
+    }
+}
+
+void SqlWorld::setTrackHint(const world::Location &position, double heading)
+{
+    // the areas ahead of the aircraft only change when it enters a new area or turns noticeably
+    Area area = std::make_pair((int)std::floor(position.longitude), (int)std::floor(position.latitude));
+    int octant = ((int)std::round(heading / 45) % 8 + 8) % 8;
+
+    std::lock_guard<std::mutex> guard(navStateGuard);
+    if (hasTrack && (area == trackArea) && (octant == trackHeading)) {
+        return;
+    }
+    trackArea = area;
+    trackHeading = octant;
+    hasTrack = true;
+
+    std::vector<Area> ahead;
+    auto request = [&ahead] (double lat, double lon) {
+        int laty = std::min(std::max((int)std::floor(lat), -90), 89);
+        auto a = std::make_pair(normaliseLongitude((int)std::floor(lon)), laty);
+        if (std::find(ahead.begin(), ahead.end(), a) == ahead.end()) {
+            ahead.push_back(a);
+        }
+    };
+
+    // the areas surrounding the aircraft, then along its track
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            request(position.latitude + dy, position.longitude + dx);
+        }
+    }
+    double track = heading * M_PI / 180;
+    double lonScale = std::max(std::cos(position.latitude * M_PI / 180), 0.1);
+    for (double d = 0.5; d <= PREFETCH_AHEAD; d += 0.5) {
+        request(position.latitude + d * std::cos(track), position.longitude + d * std::sin(track) / lonScale);
+    }
+
+    replaceRequests(trackRequests, ahead);
+}
+
+int SqlWorld::getNodeGeneration() const
+{
+    return nodeGeneration;
+}
+
+void SqlWorld::replaceRequests(std::deque<Area> &requests, const std::vector<Area> &areas)
+{
+    // called with navStateGuard held. areas that are already loaded or being loaded are ignored.
+    std::deque<Area> previous;
+    previous.swap(requests);
+    for (auto &area: areas) {
+        auto it = areaState.find(area);
+        if (it == areaState.end()) {
+            areaState[area] = AreaState::QUEUED;
+            requests.push_back(area);
+        } else if (it->second == AreaState::QUEUED) {
+            requests.push_back(area);
+        }
+    }
+    if (requests == previous) {
+        return;
+    }
+
+    // forget the areas that were queued, but are not wanted by either queue anymore
+    if (!previous.empty()) {
+        std::set<Area> wanted(viewRequests.begin(), viewRequests.end());
+        wanted.insert(trackRequests.begin(), trackRequests.end());
+        for (auto &area: previous) {
+            auto it = areaState.find(area);
+            if ((it != areaState.end()) && (it->second == AreaState::QUEUED) && (wanted.find(area) == wanted.end())) {
+                areaState.erase(it);
+            }
+        }
+    }
+
+    if (!requests.empty()) {
+        backgroundLoadControl.notify_all();
+    }
+}
+
+bool SqlWorld::nextRequestedArea(Area &area)
+{
+    // called with navStateGuard held. the visible areas are loaded before those ahead of the aircraft.
+    for (auto requests: {&viewRequests, &trackRequests}) {
+        while (!requests->empty()) {
+            area = requests->front();
+            requests->pop_front();
+            auto it = areaState.find(area);
+            if ((it != areaState.end()) && (it->second == AreaState::QUEUED)) {
+                it->second = AreaState::LOADING;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void SqlWorld::evictDistantAreas()
+{
+    // called with navStateGuard held
+    int evicted = 0;
+    for (auto it = areaState.begin(); it != areaState.end(); ) {
+        auto &area = it->first;
+        if (it->second != AreaState::LOADED) {
+            ++it;
+            continue;
+        }
+
+        // distance in areas from the last visited area, which might span the -180/180 meridian
+        int viewDist = std::max({0, viewLatl - area.second, area.second - viewLath});
+        int lonDist = 360;
+        for (int lonx: {area.first - 360, area.first, area.first + 360}) {
+            lonDist = std::min(lonDist, std::max({0, viewLonl - lonx, lonx - viewLonh}));
+        }
+        viewDist = std::max(viewDist, lonDist);
+
+        // and from the aircraft
+        int trackDist = 360;
+        if (hasTrack) {
+            int dx = std::abs(area.first - trackArea.first) % 360;
+            trackDist = std::max(std::min(dx, 360 - dx), std::abs(area.second - trackArea.second));
+        }
+
+        if ((viewDist > EVICTION_DISTANCE) && (trackDist > EVICTION_DISTANCE)) {
+            // user fixes are only added once at startup, so they stay
+            auto nit = areaNodes.find(area);
+            if (nit != areaNodes.end()) {
+                auto &nodes = nit->second;
+                nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [] (const std::shared_ptr<world::NavNode> &node) {
+                    return !node->isFix() || !std::dynamic_pointer_cast<world::Fix>(node)->isUserFix();
+                }), nodes.end());
+                if (nodes.empty()) {
+                    areaNodes.erase(nit);
+                }
+            }
+            it = areaState.erase(it);
+            ++evicted;
+        } else {
+            ++it;
+        }
+    }
+    if (evicted > 0) {
+        ++nodeGeneration;
+        logger::verbose("Evicted %d distant NAV areas, %d remain", evicted, (int)areaState.size());
+    }
+}
+
+bool SqlWorld::isInView(const Area &area) const
+{
+    // called with navStateGuard held. the last visited area might span the -180/180 meridian
+    if ((area.second < viewLatl) || (area.second > viewLath)) {
+        return false;
+    }
+    for (int lonx: {area.first - 360, area.first, area.first + 360}) {
+        if ((lonx >= viewLonl) && (lonx <= viewLonh)) {
+            return true;
+        }
+    }
+    return false;
 }
 
 std::shared_ptr<world::Airport> SqlWorld::findAirportByID(const std::string &id) const
@@ -187,18 +335,49 @@ std::vector<std::shared_ptr<world::Airport>> SqlWorld::findAirport(const std::st
     return loadManager.lock()->getMatchingAirports(keyWord);
 }
 
-std::vector<world::World::Connection> &SqlWorld::getConnections(std::shared_ptr<world::NavNode> from)
+world::World::ConnectionRange SqlWorld::getConnections(std::shared_ptr<world::NavNode> from)
 {
-    return noConnection;
+    std::lock_guard<std::mutex> guard(routeGuard);
+
+    // the vectors are never changed once cached and outdated ones are retired
+    // instead of destroyed, so the ranges stay valid
+    auto it = connections.find(from);
+    if (it != connections.end()) {
+        return {it->second.data(), it->second.data() + it->second.size()};
+    }
+
+    std::vector<world::World::Connection> conns;
+    if (from->isAirport()) {
+        loadDepartures(std::dynamic_pointer_cast<world::Airport>(from), conns);
+    } else if (from->isFix()) {
+        int key = findRouteFixKey(std::dynamic_pointer_cast<world::Fix>(from));
+        if (key == 0) {
+            return {};
+        }
+        loadAirways(key, conns);
+        loadArrivals(from, key, conns);
+    } else {
+        return {};
+    }
+
+    auto &cached = connections[from];
+    cached = std::move(conns);
+    return {cached.data(), cached.data() + cached.size()};
 }
 
 bool SqlWorld::areConnected(std::shared_ptr<world::NavNode> from, const std::shared_ptr<world::NavNode> to)
 {
+    for (auto &c: getConnections(from)) {
+        if (c.second == to) {
+            return true;
+        }
+    }
     return false;
 }
 
 void SqlWorld::addRegion(const std::string &code)
 {
+    std::lock_guard<std::mutex> guard(navStateGuard);
     if (regions.find(code) == regions.end()) {
         regions[code] = std::make_shared<world::Region>(code);
     }
@@ -206,6 +385,7 @@ void SqlWorld::addRegion(const std::string &code)
 
 std::shared_ptr<world::Region> SqlWorld::getRegion(const std::string &code)
 {
+    std::lock_guard<std::mutex> guard(navStateGuard);
     if (regions.find(code) == regions.end()) {
         // this really should not happen, since the regions table should have been pre-populated
         // with all the region codes at startup. it suggests a malformed database. fix and continue.
@@ -215,37 +395,56 @@ std::shared_ptr<world::Region> SqlWorld::getRegion(const std::string &code)
     return regions[code];
 }
 
-void SqlWorld::backgroundLoader()
+std::shared_ptr<world::Region> SqlWorld::getRegion(const std::string &code, const std::string &name)
 {
-    // this loop runs in the background, and exits if it is woken up
-    // but given nothing to do
+    auto r = getRegion(code);
+    // regions are shared by all loaders, so the name is only written under the lock
+    std::lock_guard<std::mutex> guard(navStateGuard);
+    r->setName(name);
+    return r;
+}
+
+void SqlWorld::backgroundLoader(int worker)
+{
+    // this loop runs in the background, and exits when the world is shut down
     while (1) {
+        Area area;
         {
             // block until there is something to be done
-            std::unique_lock<std::mutex> lock(backgroundLoaderGuard);
-            backgroundLoadControl.wait(lock);
-        }
-
-        std::pair<int, int> area;
-        {
-            std::lock_guard<std::mutex> guard(navStateGuard);
-            if (!backgroundLoadArea) {
-                // if nothing was requested then exit the loop (thread will finish)
+            std::unique_lock<std::mutex> lock(navStateGuard);
+            backgroundLoadControl.wait(lock, [this] {
+                return stopLoading || !viewRequests.empty() || !trackRequests.empty();
+            });
+            if (stopLoading) {
                 break;
             }
-            area = *backgroundLoadArea;
+            if (!nextRequestedArea(area)) {
+                continue;
+            }
         }
 
-        loadManager.lock()->loadNodesInArea(area.first, area.second);
+        try {
+            loadManager.lock()->loadNodesInArea(area.first, area.second, worker);
+        } catch (const std::exception &e) {
+            logger::warn("Failed to load NAV area %d/%d: %s", area.first, area.second, e.what());
+        }
 
         {
             std::lock_guard<std::mutex> guard(navStateGuard);
-            areaCached[area] = true;
-            backgroundLoadArea.reset();
+            areaState[area] = AreaState::LOADED;
+            // areas that were only prefetched don't change what the map shows
+            if (isInView(area)) {
+                ++nodeGeneration;
+            }
         }
     }
 }
 
+void SqlWorld::setDensityGrid(world::DensityGrid &&grid)
+{
+    densities = std::move(grid);
+}
+
 void SqlWorld::addAirport(std::shared_ptr<world::Airport> a)
 {
     auto &loc = a->getLocation();
@@ -257,12 +456,209 @@ void SqlWorld::addFix(std::shared_ptr<world::Fix> f)
     f->setGlobal(true);
     auto &loc = f->getLocation();
     addNodeToArea(std::floor(loc.longitude), std::floor(loc.latitude), f);
+    if (f->isUserFix()) {
+        // user fixes are added directly rather than by loading an area
+        ++nodeGeneration;
+    }
 }
 
 std::shared_ptr<world::RouteFinder> SqlWorld::getRouteFinder()
 {
-    // TODO: specialise a SqlWorld variant of this
-    return std::make_shared<world::RouteFinder>(shared_from_this());
+    {
+        std::lock_guard<std::mutex> guard(routeGuard);
+        ++activeRouteFinders;
+    }
+    std::weak_ptr<SqlWorld> self = std::static_pointer_cast<SqlWorld>(shared_from_this());
+    return std::shared_ptr<world::RouteFinder>(new world::RouteFinder(shared_from_this()), [self] (world::RouteFinder *finder) {
+        auto world = self.lock();
+        delete finder;
+        if (world) {
+            world->releaseRouteFinder();
+        }
+    });
+}
+
+void SqlWorld::releaseRouteFinder()
+{
+    std::lock_guard<std::mutex> guard(routeGuard);
+    if (--activeRouteFinders > 0) {
+        return;
+    }
+
+    // no connection ranges can be referenced anymore, the next route search loads a fresh graph
+    connections.clear();
+    retiredConnections.clear();
+    arrivalSources.clear();
+    routeFixes.clear();
+    routeFixKeys.clear();
+    routeAirways.clear();
+    for (auto it = routeAirports.begin(); it != routeAirports.end(); ) {
+        if (it->second.expired()) {
+            it = routeAirports.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void SqlWorld::trackAirport(std::shared_ptr<world::Airport> a)
+{
+    std::lock_guard<std::mutex> guard(routeGuard);
+    auto &tracked = routeAirports[a->getID()];
+    if (tracked.lock() == a) {
+        return;
+    }
+    tracked = a;
+
+    // arrivals resolved earlier were connected to a different (or no) object for this airport
+    auto it = arrivalSources.find(a->getID());
+    if (it != arrivalSources.end()) {
+        for (auto &from: it->second) {
+            retireConnections(from);
+        }
+        arrivalSources.erase(it);
+    }
+}
+
+void SqlWorld::retireConnections(std::shared_ptr<world::NavNode> from)
+{
+    auto it = connections.find(from);
+    if (it == connections.end()) {
+        return;
+    }
+    // moving the vector keeps its storage, so ranges handed out earlier remain valid
+    retiredConnections.push_back(std::move(it->second));
+    connections.erase(it);
+}
+
+void SqlWorld::loadDepartures(std::shared_ptr<world::Airport> airport, std::vector<world::World::Connection> &conns)
+{
+    std::vector<SqlLoadManager::ProcedureLink> links;
+    loadManager.lock()->getDepartureLinks(airport->getID(), links);
+
+    std::vector<int> keys;
+    for (auto &l: links) {
+        keys.push_back(l.fixKey);
+    }
+    resolveRouteFixes(keys);
+
+    // background loaded airports have no procedures, so these will only be found for airports from searches
+    std::map<std::string, std::shared_ptr<world::SID>> sids;
+    for (auto &sid: airport->getSIDs()) {
+        sids[sid->getID()] = sid;
+    }
+
+    for (auto &l: links) {
+        auto sit = sids.find(l.name);
+        auto fit = routeFixes.find(l.fixKey);
+        if ((sit == sids.end()) || (fit == routeFixes.end())) continue;
+        conns.push_back(std::make_pair(sit->second, fit->second));
+    }
+}
+
+void SqlWorld::loadAirways(int fixKey, std::vector<world::World::Connection> &conns)
+{
+    std::vector<SqlLoadManager::AirwayEdge> edges;
+    loadManager.lock()->getAirwayEdges(fixKey, edges);
+
+    std::vector<int> keys;
+    for (auto &e: edges) {
+        keys.push_back(e.toFixKey);
+    }
+    resolveRouteFixes(keys);
+
+    for (auto &e: edges) {
+        auto fit = routeFixes.find(e.toFixKey);
+        if (fit == routeFixes.end()) continue;
+        // 'V' = lower airway, 'J' = upper, 'B' = both
+        if (e.type != "J") {
+            conns.push_back(std::make_pair(findOrCreateAirway(e.airwayKey, e.name, world::AirwayLevel::LOWER), fit->second));
+        }
+        if (e.type != "V") {
+            conns.push_back(std::make_pair(findOrCreateAirway(e.airwayKey, e.name, world::AirwayLevel::UPPER), fit->second));
+        }
+    }
+}
+
+void SqlWorld::loadArrivals(std::shared_ptr<world::NavNode> from, int fixKey, std::vector<world::World::Connection> &conns)
+{
+    std::vector<SqlLoadManager::ProcedureLink> links;
+    loadManager.lock()->getArrivalLinks(fixKey, links);
+
+    for (auto &l: links) {
+        arrivalSources[l.airport].insert(from);
+
+        // only airports that are still referenced by a search result can be the arrival of a route
+        auto ait = routeAirports.find(l.airport);
+        if (ait == routeAirports.end()) continue;
+        auto airport = ait->second.lock();
+        if (!airport) continue;
+
+        std::shared_ptr<world::NavEdge> via;
+        if (l.type == 2) {
+            for (auto &star: airport->getSTARs()) {
+                if (star->getID() == l.name) via = star;
+            }
+        } else {
+            for (auto &appr: airport->getApproaches()) {
+                if (appr->getID() == l.name) via = appr;
+            }
+        }
+        if (via) {
+            conns.push_back(std::make_pair(via, airport));
+        }
+    }
+}
+
+int SqlWorld::findRouteFixKey(std::shared_ptr<world::Fix> fix)
+{
+    auto it = routeFixKeys.find(fix.get());
+    if (it != routeFixKeys.end()) {
+        return it->second;
+    }
+
+    // a fix that wasn't reached through the graph, e.g. one from a search or the background loader
+    if (!fix->getRegion()) {
+        return 0;
+    }
+    int key = loadManager.lock()->getFixKey(fix->getRegion()->getId(), fix->getID());
+    if ((key != 0) && (routeFixes.find(key) == routeFixes.end())) {
+        // adopt it, the key map must only reference fixes that are kept alive by the graph
+        routeFixes[key] = fix;
+        routeFixKeys[fix.get()] = key;
+    }
+    return key;
+}
+
+void SqlWorld::resolveRouteFixes(const std::vector<int> &fixKeys)
+{
+    std::vector<int> missing;
+    for (auto k: fixKeys) {
+        if (routeFixes.find(k) == routeFixes.end()) {
+            missing.push_back(k);
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+
+    for (auto &it: loadManager.lock()->getFixMap(missing)) {
+        it.second->setGlobal(true);
+        routeFixes[it.first] = it.second;
+        routeFixKeys[it.second.get()] = it.first;
+    }
+}
+
+std::shared_ptr<world::Airway> SqlWorld::findOrCreateAirway(int airwayKey, const std::string &name, world::AirwayLevel level)
+{
+    auto key = std::make_pair(airwayKey, level);
+    auto it = routeAirways.find(key);
+    if (it != routeAirways.end()) {
+        return it->second;
+    }
+    auto awy = std::make_shared<world::Airway>(name, level);
+    routeAirways[key] = awy;
+    return awy;
 }
 
 void SqlWorld::addNodeToArea(int lonx_idx, int laty_idx, std::shared_ptr<world::NavNode> node)
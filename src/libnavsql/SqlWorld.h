@@ -18,8 +18,14 @@
 #pragma once
 
 #include "src/world/World.h"
+#include "src/world/models/Airway.h"
+#include "src/world/DensityGrid.h"
 #include <future>
+#include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <set>
 
 namespace sqlnav {
 
@@ -34,57 +40,115 @@ public:
 
     int maxDensity(const world::Location &bottomLeft, const world::Location &topRight) override;
     void visitNodes(const world::Location &bottomLeft, const world::Location &topRight, NodeAcceptor callback, int filter) override;
+    void setTrackHint(const world::Location &position, double heading) override;
+    int getNodeGeneration() const override;
 
     std::shared_ptr<world::Airport> findAirportByID(const std::string &id) const override;
     std::shared_ptr<world::Fix> findFixByRegionAndID(const std::string &region, const std::string &id) const override;
     std::vector<std::shared_ptr<world::Airport>> findAirport(const std::string &keyWord) const override;
 
-    std::vector<world::World::Connection> &getConnections(std::shared_ptr<world::NavNode> from) override;
+    world::World::ConnectionRange getConnections(std::shared_ptr<world::NavNode> from) override;
     bool areConnected(std::shared_ptr<world::NavNode> from, const std::shared_ptr<world::NavNode> to) override;
 
     void addRegion(const std::string &code) override;
     std::shared_ptr<world::Region> getRegion(const std::string &id) override;
+    // called by concurrent loaders, names the region the first time it is found
+    std::shared_ptr<world::Region> getRegion(const std::string &id, const std::string &name);
 
     void addFix(std::shared_ptr<world::Fix> fix) override;
 
     std::shared_ptr<world::RouteFinder> getRouteFinder() override;
 
+    void setDensityGrid(world::DensityGrid &&grid);
     void addAirport(std::shared_ptr<world::Airport> a);
+    void trackAirport(std::shared_ptr<world::Airport> a);
 
     void shutdown();
 
 protected:
-    void backgroundLoader();
+    using Area = std::pair<int, int>;
+
+    void backgroundLoader(int worker);
+    bool nextRequestedArea(Area &area);
+    void replaceRequests(std::deque<Area> &requests, const std::vector<Area> &areas);
+    void evictDistantAreas();
+    bool isInView(const Area &area) const;
     void addNodeToArea(int lonx_idx, int laty_idx, std::shared_ptr<world::NavNode> node);
+    void loadDepartures(std::shared_ptr<world::Airport> airport, std::vector<world::World::Connection> &conns);
+    void loadAirways(int fixKey, std::vector<world::World::Connection> &conns);
+    void loadArrivals(std::shared_ptr<world::NavNode> from, int fixKey, std::vector<world::World::Connection> &conns);
+    void retireConnections(std::shared_ptr<world::NavNode> from);
+    void releaseRouteFinder();
+    int findRouteFixKey(std::shared_ptr<world::Fix> fix);
+    void resolveRouteFixes(const std::vector<int> &fixKeys);
+    std::shared_ptr<world::Airway> findOrCreateAirway(int airwayKey, const std::string &name, world::AirwayLevel level);
 
 private:
+    // cells around the visible area and along the aircraft track that are loaded in advance
+    static constexpr const int PREFETCH_MARGIN = 1;
+    static constexpr const int PREFETCH_AHEAD = 3;
+    // once this many cells are cached, those further than EVICTION_DISTANCE cells from
+    // both the visible area and the aircraft are dropped
+    static constexpr const size_t MAX_CACHED_AREAS = 1024;
+    static constexpr const int EVICTION_DISTANCE = 8;
+
+    enum class AreaState { QUEUED, LOADING, LOADED };
+
     // weak pointer prevents circular referencing to this objects owner
     std::weak_ptr<SqlLoadManager> loadManager;
 
     // Regions indexed by their codes
     std::map<std::string, std::shared_ptr<world::Region>> regions;
 
-    // A background thread is used to load NAV items from the SQL database. The in-memory
-    // cache of these nodes is protected from concurrent access by this mutex. In general
-    // the background task will only hold the mutex for short periods to update the collections.
+    // Number of nodes in each lon/lat area, loaded once from the database
+    world::DensityGrid densities;
+
+    // Background threads are used to load NAV items from the SQL database. The in-memory
+    // cache of these nodes and the queues of requested areas are protected from concurrent
+    // access by this mutex. In general the background tasks will only hold the mutex for short
+    // periods to update the collections.
     // The foreground thread (apps) will claim the mutex for the duration of any API calls
     // to obtain node information, giving it priority.
     std::mutex navStateGuard;
 
     // Cache of NavNodes in each lon/lat area on the globe
-    std::map<std::pair<int, int>, std::vector<std::shared_ptr<world::NavNode>>> areaNodes;
-    // If the map has an entry for an area, false means it is being loaded, true means it is available.
-    std::map<std::pair<int, int>, bool> areaCached;
-    // Non-null when an area is being loaded asynchronously, references the lon/lat pair being loaded.
-    std::unique_ptr<std::pair<int, int>> backgroundLoadArea;
-
-    // Connections between nodes (airports, heliports, runways, fixes)
+    std::map<Area, std::vector<std::shared_ptr<world::NavNode>>> areaNodes;
+    // If the map has an entry for an area, it is either waiting in a queue, being loaded or available.
+    std::map<Area, AreaState> areaState;
+    // Areas waiting to be loaded, nearest first. The workers empty the view queue first, each
+    // queue is replaced as a whole when the map is moved or the aircraft enters a new area.
+    std::deque<Area> viewRequests;
+    std::deque<Area> trackRequests;
+    // The last visited area and aircraft position, in whole degrees, used for eviction
+    int viewLatl = 0, viewLath = 0, viewLonl = 0, viewLonh = 0;
+    Area trackArea;
+    int trackHeading = -1;
+    bool hasTrack = false;
+    bool stopLoading = false;
+    // bumped when a visible area finished loading or areas were evicted, read without the mutex
+    std::atomic<int> nodeGeneration { 0 };
+
+    // The route finder's graph is loaded lazily from the database as nodes are expanded.
+    // Fixes and airways reached through the graph are kept unique per database key, so
+    // that a fix reached along different airways is recognised as the same node. The graph
+    // is only used while a route finder exists, so it is dropped when the last one is released.
+    std::mutex routeGuard;
+    int activeRouteFinders = 0;
+    // Connections between nodes (airports, fixes)
     std::map<std::shared_ptr<world::NavNode>, std::vector<world::World::Connection>> connections;
-    std::vector<world::World::Connection> noConnection;
-
-    // used to synchronise with the background worker
-    std::future<void> asyncLoaderState;
-    std::mutex backgroundLoaderGuard;
+    // Connections that became outdated but may still be referenced by a ConnectionRange
+    std::vector<std::vector<world::World::Connection>> retiredConnections;
+    // Nodes whose cached connections contain procedures leading into the airport with the given ID
+    std::map<std::string, std::set<std::shared_ptr<world::NavNode>>> arrivalSources;
+    std::map<int, std::shared_ptr<world::Fix>> routeFixes;
+    std::map<const world::NavNode *, int> routeFixKeys;
+    std::map<std::pair<int, world::AirwayLevel>, std::shared_ptr<world::Airway>> routeAirways;
+    // Airports handed out by searches. Procedures leading into an airport must connect to
+    // the same object that the route finder was given as the arrival.
+    std::map<std::string, std::weak_ptr<world::Airport>> routeAirports;
+
+    // used to synchronise with the background workers
+    std::vector<std::future<void>> asyncLoaderStates;
     std::condition_variable backgroundLoadControl;
 };
 
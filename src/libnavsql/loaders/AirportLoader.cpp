@@ -31,62 +31,125 @@ namespace sqlnav {
 
 // for use during background area loading
 // for foreground searches by keyword (after converting to list of ids)
-AirportLoader::AirportLoader(std::shared_ptr<SqlLoadManager> db, int i, bool b)
-:   loadMgr(db), isBackgroundLoad(b), id_search(i), icao_search(nullptr)
+AirportLoader::AirportLoader(std::shared_ptr<SqlLoadManager> db, const std::vector<int> &ids, int w)
+:   loadMgr(db), worker(w), isBackgroundLoad(w != SqlLoadManager::FOREGROUND), keys(ids), icao_search(nullptr)
 {
 }
 
 // for foreground search by icao ident
 AirportLoader::AirportLoader(std::shared_ptr<SqlLoadManager> db, const std::string &s)
-:   loadMgr(db), isBackgroundLoad(false), id_search(0), icao_search(&s)
+:   loadMgr(db), worker(SqlLoadManager::FOREGROUND), isBackgroundLoad(false), icao_search(&s)
 {
 }
 
-std::shared_ptr<world::Airport> AirportLoader::load(std::vector<std::shared_ptr<world::Fix>> *ils_fixes)
+std::shared_ptr<world::Airport> AirportLoader::load()
 {
-    // one of 2 different searches may be used, both return the same set of columns
-    std::shared_ptr<SqlStatement> q;
     if (icao_search) {
-        q = loadMgr->GetSQL(SqlLoadManager::Searches::AIRPORT_BY_ICAO, isBackgroundLoad);
+        auto q = loadMgr->GetSQL(SqlLoadManager::Searches::AIRPORT_BY_ICAO, worker);
         q->initialize();
         q->bind(1, *icao_search);
-    } else {
-        q = loadMgr->GetSQL(SqlLoadManager::Searches::AIRPORT_BY_ID, isBackgroundLoad);
-        q->initialize();
-        q->bind(1, id_search);
+        if (q->step()) return nullptr;
+        keys.assign(1, q->getInt(0));
     }
 
-    // start with the basic airport information
-    if (q->step()) return nullptr;
-    airport_id = q->getInt(0);
-    this->ident = q->getString(1);
-    auto name = q->getString(2);
-    this->region = q->getString(3);
-    auto country = q->getString(4);
-    auto lonx = q->getDouble(5);
-    auto laty = q->getDouble(6);
-    auto altitude = q->getInt(7);
-
-    auto r = loadMgr->getRegion(region);
-    r->setName(country);
-
-    a = std::make_shared<world::Airport>(ident);
-    a->setName(name);
-    a->setRegion(r);
-    a->setElevation(altitude);
-    a->setLocation(world::Location(laty, lonx));
-
-    // add related info: comms, runways, heliports, navaids, fixes
-    addComms();
-    addRunways();
-    addHeliports();
-    addLocalizers(ils_fixes);
-    addFixes();
+    auto all = loadAll();
+    return all.empty() ? nullptr : all.front();
+}
+
+std::vector<std::shared_ptr<world::Airport>> AirportLoader::loadAll()
+{
+    // airports that have been created before are taken from the cache. those
+    // created by the background loader don't have their procedures yet.
+    std::map<int, std::shared_ptr<world::Airport>> found;
+    std::vector<int> missing;
+    std::vector<int> withoutProcedures;
+    for (auto k: keys) {
+        bool proceduresLoaded = false;
+        auto cached = loadMgr->findCachedAirport(k, &proceduresLoaded);
+        if (!cached) {
+            missing.push_back(k);
+            continue;
+        }
+        found[k] = cached;
+        if (!isBackgroundLoad && !proceduresLoaded) {
+            airports[k].a = cached;
+            airports[k].ident = cached->getID();
+            withoutProcedures.push_back(k);
+        }
+    }
+
+    // a handful of queries fetch the related info of all new airports: comms, runways, heliports, navaids, fixes
+    if (!missing.empty()) {
+        auto srch = SqlLoadManager::toKeyList(missing);
+        addAirports(srch);
+        addComms(srch);
+        addRunways(srch);
+        addHeliports(srch);
+        addLocalizers(srch);
+        addFixes(srch);
+    }
 
     // add procedures: SIDs, STARs, approaches
-    addProcedures();
+    withoutProcedures.insert(withoutProcedures.end(), missing.begin(), missing.end());
+    if (!isBackgroundLoad && !withoutProcedures.empty()) {
+        addProcedures(SqlLoadManager::toKeyList(withoutProcedures));
+    }
 
-    return a;
+    // another thread might have created the same airport in the meantime, the cache keeps the first one
+    for (auto &it: airports) {
+        found[it.first] = loadMgr->cacheAirport(it.first, it.second.a, !isBackgroundLoad);
+    }
+
+    std::vector<std::shared_ptr<world::Airport>> result;
+    for (auto k: keys) {
+        auto it = found.find(k);
+        if (it != found.end()) {
+            result.push_back(it->second);
+        }
+    }
+    return result;
+}
+
+void AirportLoader::addAirports(const std::string &keys)
+{
+    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::AIRPORTS_BY_KEYS, worker);
+    q->initialize();
+    q->bind(1, keys);
+
+    // start with the basic airport information
+    while (1) {
+        if (q->step()) break;
+        auto airport_id = q->getInt(0);
+        auto ident = q->getString(1);
+        auto name = q->getString(2);
+        auto region = q->getString(3);
+        auto country = q->getString(4);
+        auto lonx = q->getDouble(5);
+        auto laty = q->getDouble(6);
+        auto altitude = q->getInt(7);
+
+        auto r = loadMgr->getRegion(region, country);
+
+        auto a = std::make_shared<world::Airport>(ident);
+        a->setName(name);
+        a->setRegion(r);
+        a->setElevation(altitude);
+        a->setLocation(world::Location(laty, lonx));
+
+        Building &b = airports[airport_id];
+        b.a = a;
+        b.ident = ident;
+        b.region = region;
+    }
+}
+
+AirportLoader::Building *AirportLoader::findBuilding(int airport_id)
+{
+    auto it = airports.find(airport_id);
+    if (it == airports.end()) {
+        return nullptr;
+    }
+    return &it->second;
 }
 
 inline world::Airport::ATCFrequency mapToATCclass(const std::string &type) {
@@ -119,20 +182,22 @@ inline world::Airport::ATCFrequency mapToATCclass(const std::string &type) {
     return world::Airport::ATCFrequency::RECORDED;
 }
 
-void AirportLoader::addComms()
+void AirportLoader::addComms(const std::string &keys)
 {
-    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::COMMS_AT_AIRPORT, isBackgroundLoad);
+    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::COMMS_AT_AIRPORTS, worker);
     q->initialize();
-    q->bind(1, airport_id);
+    q->bind(1, keys);
 
-    // process the results, creating a Runway object for each row, and pairing them up
+    // process the results, adding a frequency to the airport for each row
     while (1) {
         if (q->step()) break;
-        auto type = q->getString(0);
-        auto f = q->getInt(1);
-        auto name = q->getString(2);
+        auto b = findBuilding(q->getInt(0));
+        if (!b) continue;
+        auto type = q->getString(1);
+        auto f = q->getInt(2);
+        auto name = q->getString(3);
         world::Frequency frequency(f, 6, world::Frequency::Unit::MHZ, name);
-        a->addATCFrequency(mapToATCclass(type), frequency);
+        b->a->addATCFrequency(mapToATCclass(type), frequency);
     }
 }
 
@@ -167,16 +232,17 @@ inline world::Runway::SurfaceMaterial mapToSurfaceMaterial(const std::string &rw
     return world::Runway::SurfaceMaterial::UNKNOWN;
 }
 
-void AirportLoader::addRunways()
+void AirportLoader::addRunways(const std::string &keys)
 {
-    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::RUNWAYS_AT_AIRPORT, isBackgroundLoad);
+    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::RUNWAYS_AT_AIRPORTS, worker);
     q->initialize();
-    q->bind(1, airport_id);
+    q->bind(1, keys);
 
     struct RunwayPair {
-        RunwayPair() : n(0), offset_sum(0.0f) { }
-        RunwayPair(std::shared_ptr<world::Runway> r, float o) : n(1), forward(r), offset_sum(o) { }
+        RunwayPair() : airport_id(0), n(0), offset_sum(0.0f) { }
+        RunwayPair(int aid, std::shared_ptr<world::Runway> r, float o) : airport_id(aid), n(1), forward(r), offset_sum(o) { }
         void AddReverse(std::shared_ptr<world::Runway> r, float o) { ++n; reverse = r; offset_sum += o; }
+        int airport_id;
         int n;
         std::shared_ptr<world::Runway> forward;
         std::shared_ptr<world::Runway> reverse;
@@ -188,17 +254,18 @@ void AirportLoader::addRunways()
     // process the results, creating a Runway object for each row, and pairing them up
     while (1) {
         if (q->step()) break;
-        auto rid = q->getInt(0);
-        auto name = q->getString(1);
-        auto pairid = q->getInt(2);
-        auto length = q->getInt(3);
-        auto width = q->getInt(4);
-        auto surface = q->getString(5);
-        auto heading = q->getFloat(6);
-        auto altitude = q->getInt(7);
-        auto offset = q->getFloat(8);
-        auto lonx = q->getDouble(9);
-        auto laty = q->getDouble(10);
+        auto aid = q->getInt(0);
+        auto rid = q->getInt(1);
+        auto name = q->getString(2);
+        auto pairid = q->getInt(3);
+        auto length = q->getInt(4);
+        auto width = q->getInt(5);
+        auto surface = q->getString(6);
+        auto heading = q->getFloat(7);
+        auto altitude = q->getInt(8);
+        auto offset = q->getFloat(9);
+        auto lonx = q->getDouble(10);
+        auto laty = q->getDouble(11);
 
         auto r = std::make_shared<world::Runway>(name);
         r->setHeading(heading);
@@ -214,15 +281,18 @@ void AirportLoader::addRunways()
         auto p = pairs.find(pairid);
         if (p == pairs.end()) {
             // not seen the opposite yet, so create a new entry in the map
-            pairs[rid] = RunwayPair(r, offset);
+            pairs[rid] = RunwayPair(aid, r, offset);
         } else {
             // there is an entry for the 'forward' runway, add this as the reverse
             pairs[pairid].AddReverse(r, offset);
         }
     }
 
-    // now add the runways to the airport, as pairs
+    // now add the runways to the airports, as pairs
     for (auto p: pairs) {
+        auto b = findBuilding(p.second.airport_id);
+        if (!b) continue;
+        auto &a = b->a;
         if (p.second.n != 2) {
             logger::info("Ignoring unpaired runway at airport %s", a->getID().c_str());
             continue;
@@ -238,17 +308,19 @@ void AirportLoader::addRunways()
     }
 }
 
-void AirportLoader::addHeliports()
+void AirportLoader::addHeliports(const std::string &keys)
 {
-    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::HELIPADS_AT_AIRPORT, isBackgroundLoad);
+    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::HELIPADS_AT_AIRPORTS, worker);
     q->initialize();
-    q->bind(1, airport_id);
+    q->bind(1, keys);
 
     while (1) {
         if (q->step()) break;
-        auto id = q->getInt(0);
-        auto lonx = q->getDouble(1);
-        auto laty = q->getDouble(2);
+        auto b = findBuilding(q->getInt(0));
+        if (!b) continue;
+        auto id = q->getInt(1);
+        auto lonx = q->getDouble(2);
+        auto laty = q->getDouble(3);
 
         world::Location loc(laty, lonx);
         std::ostringstream name;
@@ -256,57 +328,60 @@ void AirportLoader::addHeliports()
 
         auto h = std::make_shared<world::Heliport>(name.str());
         h->setLocation(loc);
-        a->addHeliport(h);
+        b->a->addHeliport(h);
     }
 }
 
-void AirportLoader::addLocalizers(std::vector<std::shared_ptr<world::Fix>> *fixes)
+void AirportLoader::addLocalizers(const std::string &keys)
 {
     // These XP names count as ILS: "ILS-CAT-I", "ILS-CAT-II", "ILS-CAT-III", "IGS", "LDA"
     // These XP names count as localizer only: "LOC", "SDF"
     // These XP names would seem to be additional navaids we should ignore: LP, LPV, GLS
-    if (fixIsLocOnly.size() == 0) {
-        fixIsLocOnly["ILS"] = false;
-        fixIsLocOnly["IGS"] = false;
-        fixIsLocOnly["LDA"] = false;
-        fixIsLocOnly["LOC"] = true;
-        fixIsLocOnly["SDF"] = true;
-    }
+    static const std::map<std::string, bool> fixIsLocOnly = {
+        {"ILS", false},
+        {"IGS", false},
+        {"LDA", false},
+        {"LOC", true},
+        {"SDF", true},
+    };
 
-    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::LOCALIZERS_AT_AIRPORT, isBackgroundLoad);
+    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::LOCALIZERS_AT_AIRPORTS, worker);
     q->initialize();
-    q->bind(1, airport_id);
+    q->bind(1, keys);
 
     // process the results, creating an ILSLocalizer object for qualifying rows
     while (1) {
         if (q->step()) break;
+        auto b = findBuilding(q->getInt(0));
+        if (!b) continue;
 
         // if we don't recognize the name (first 3 chars) then skip to the next one
-        auto ils_ident = q->getString(0);
-        auto name = q->getString(1);
+        auto ils_ident = q->getString(1);
+        auto name = q->getString(2);
         auto description = name;
         if (description.size() > 3) description.resize(3);
-        if (fixIsLocOnly.find(description) == fixIsLocOnly.end()) {
+        auto locOnly = fixIsLocOnly.find(description);
+        if (locOnly == fixIsLocOnly.end()) {
             logger::warn("Fix %s (%s) is not recognised as ILS or LOC", ils_ident.c_str(), name.c_str());
             continue;
         }
 
         // if we don't have a runway [end] with this ID then skip it
-        auto reid = q->getInt(2);
+        auto reid = q->getInt(3);
         if (rws.find(reid) == rws.end()) {
             logger::warn("ILS/LOC %s has unknown runway end id %d", ils_ident.c_str(), reid);
             continue;
         }
 
-        auto lonx = q->getDouble(3);
-        auto laty = q->getDouble(4);
-        auto freq = q->getInt(5);
-        auto heading = q->getFloat(6);
-        auto magvar = q->getFloat(7);
-        auto range = q->getInt(8);
-        auto dme_range = q->getInt(9);
+        auto lonx = q->getDouble(4);
+        auto laty = q->getDouble(5);
+        auto freq = q->getInt(6);
+        auto heading = q->getFloat(7);
+        auto magvar = q->getFloat(8);
+        auto range = q->getInt(9);
+        auto dme_range = q->getInt(10);
 
-        auto r = loadMgr->getRegion(region);
+        auto r = loadMgr->getRegion(b->region);
         world::Location loc(laty, lonx);
         auto f = std::make_shared<world::Fix>(r, ils_ident, loc);
 
@@ -314,7 +389,7 @@ void AirportLoader::addLocalizers(std::vector<std::shared_ptr<world::Fix>> *fixe
         auto ils = std::make_shared<world::ILSLocalizer>(ilsFrq, range);
         ils->setRunwayHeading(heading);
         ils->setRunwayHeadingMagnetic(heading + magvar);
-        ils->setLocalizerOnly(fixIsLocOnly[description]);
+        ils->setLocalizerOnly(locOnly->second);
         f->attachILSLocalizer(ils);
 
         if (dme_range) {
@@ -326,96 +401,104 @@ void AirportLoader::addLocalizers(std::vector<std::shared_ptr<world::Fix>> *fixe
         rws[reid]->attachILSData(f);
 
         // add the ILS to the list of fixes
-        a->addTerminalFix(f);
-        if (fixes) fixes->push_back(f);
+        b->a->addTerminalFix(f);
     }
 }
 
-void AirportLoader::addFixes()
+void AirportLoader::addFixes(const std::string &keys)
 {
     // don't bother with fixes when loading for a specific airport search
     if (!isBackgroundLoad) return;
 
-    // get a list of fixes associated with this airport ID
+    // get a list of fixes associated with these airport IDs
     std::vector<int> fix_ids;
+    std::vector<int> fix_airports;
 
-    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::FIXES_AT_AIRPORT, isBackgroundLoad);
+    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::FIXES_AT_AIRPORTS, worker);
     q->initialize();
-    q->bind(1, airport_id);
+    q->bind(1, keys);
 
-    // extract the list of fix IDs associated with this airport
     while (1) {
         if (q->step()) break;
-        auto fid = q->getInt(0);
-        fix_ids.push_back(fid);
+        fix_ids.push_back(q->getInt(0));
+        fix_airports.push_back(q->getInt(1));
     }
-
-    // load each fix in turn, and add to the vector of associated fixes
-    for (auto fid: fix_ids) {
-        auto fl = std::make_unique<FixLoader>(loadMgr, fid);
-        auto f = fl->load();
-        a->addTerminalFix(f);
+    if (fix_ids.empty()) return;
+
+    // load all fixes at once, and add them to their airports
+    auto fl = std::make_unique<FixLoader>(loadMgr, worker);
+    auto fixes = fl->loadByKeys(fix_ids);
+    for (size_t i = 0; i < fix_ids.size(); ++i) {
+        auto f = fixes.find(fix_ids[i]);
+        auto b = findBuilding(fix_airports[i]);
+        if ((f != fixes.end()) && b) {
+            b->a->addTerminalFix(f->second);
+        }
     }
 }
 
-void AirportLoader::addProcedures()
+void AirportLoader::addProcedures(const std::string &keys)
 {
     // only bother with procedures when loading for a specific airport search
     if (isBackgroundLoad) return;
 
-    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::PROCEDURES_AT_AIRPORT, isBackgroundLoad);
+    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::PROCEDURES_AT_AIRPORTS, worker);
     q->initialize();
-    q->bind(1, airport_id);
+    q->bind(1, keys);
 
     // process the results, creating SID, STAR or Approaches
     // Avitab world requires procedures to be uniquely named, but the SQL tables may
     // have multiple rows, one for each supported runway. So we need to combine these
     // during the iteration
-    std::map<std::string, std::shared_ptr<SqlSID>> sids;
-    std::map<std::string, std::shared_ptr<SqlSTAR>> stars;
-    std::map<std::string, std::shared_ptr<SqlApproach>> apprs;
+    std::map<std::pair<int, std::string>, std::shared_ptr<SqlSID>> sids;
+    std::map<std::pair<int, std::string>, std::shared_ptr<SqlSTAR>> stars;
+    std::map<std::pair<int, std::string>, std::shared_ptr<SqlApproach>> apprs;
     while (1) {
         if (q->step()) break;
-        // procedure_id, type, name, runway_name, initial_fix, final_fix, via_fixes
-        auto procId = q->getInt(0);
-        auto type = q->getString(1);
-        auto name = q->getString(2);
-        auto runway = q->getString(3);
-        auto f0 = q->getInt(4);
-        auto fn = q->getInt(5);
-        auto vias = q->getString(6);
+        // airport_id, procedure_id, type, name, runway_name, initial_fix, final_fix, via_fixes
+        auto aid = q->getInt(0);
+        auto procId = q->getInt(1);
+        auto type = q->getString(2);
+        auto name = q->getString(3);
+        auto runway = q->getString(4);
+        auto f0 = q->getInt(5);
+        auto fn = q->getInt(6);
+        auto vias = q->getString(7);
+        auto key = std::make_pair(aid, name);
 
         if (type == "1") { // SID
-            if (sids.find(name) == sids.end()) {
-                sids[name] = std::make_shared<SqlSID>(name, loadMgr);
+            if (sids.find(key) == sids.end()) {
+                sids[key] = std::make_shared<SqlSID>(name, loadMgr);
             }
-            sids[name]->addVariant(procId, runway, SqlLoadManager::toVector(f0, fn, vias));
+            sids[key]->addVariant(procId, runway, SqlLoadManager::toVector(f0, fn, vias));
         } else if (type == "2") { // STAR
-            if (stars.find(name) == stars.end()) {
-                stars[name] = std::make_shared<SqlSTAR>(name, loadMgr);
+            if (stars.find(key) == stars.end()) {
+                stars[key] = std::make_shared<SqlSTAR>(name, loadMgr);
             }
-            stars[name]->addVariant(procId, runway, SqlLoadManager::toVector(f0, fn, vias));
+            stars[key]->addVariant(procId, runway, SqlLoadManager::toVector(f0, fn, vias));
         } else if (type == "3") { // approach
-            if (apprs.find(name) == apprs.end()) {
-                apprs[name] = std::make_shared<SqlApproach>(name, loadMgr);
+            if (apprs.find(key) == apprs.end()) {
+                apprs[key] = std::make_shared<SqlApproach>(name, loadMgr);
             }
-            apprs[name]->addVariant(procId, runway, SqlLoadManager::toVector(f0, fn, vias));
+            apprs[key]->addVariant(procId, runway, SqlLoadManager::toVector(f0, fn, vias));
         } else {
-            logger::warn("Procedure %s @ %s has unknown type %s", name.c_str(), ident.c_str(), type.c_str());
+            auto b = findBuilding(aid);
+            logger::warn("Procedure %s @ %s has unknown type %s", name.c_str(), b ? b->ident.c_str() : "?", type.c_str());
         }
     }
 
     for (auto p: sids) {
-        a->addSID(p.second);
+        auto b = findBuilding(p.first.first);
+        if (b) b->a->addSID(p.second);
     }
     for (auto p: stars) {
-        a->addSTAR(p.second);
+        auto b = findBuilding(p.first.first);
+        if (b) b->a->addSTAR(p.second);
     }
     for (auto p: apprs) {
-        a->addApproach(p.second);
+        auto b = findBuilding(p.first.first);
+        if (b) b->a->addApproach(p.second);
     }
 }
 
-std::map<std::string, bool> AirportLoader::fixIsLocOnly;
-
 } /* namespace sqlnav */
@@ -29,31 +29,39 @@ class AirportLoader
 public:
     // for use during background area loading
     // for foreground searches by keyword (after converting to list of ids)
-    AirportLoader(std::shared_ptr<SqlLoadManager> db, int id, bool background);
+    AirportLoader(std::shared_ptr<SqlLoadManager> db, const std::vector<int> &ids, int worker);
     // for foreground search by icao ident
     AirportLoader(std::shared_ptr<SqlLoadManager> db, const std::string &icao);
     AirportLoader() = delete;
 
-    std::shared_ptr<world::Airport> load(std::vector<std::shared_ptr<world::Fix>> *ils_fixes = nullptr);
+    std::shared_ptr<world::Airport> load();
+    std::vector<std::shared_ptr<world::Airport>> loadAll();
 
 private:
-    void addComms();
-    void addRunways();
-    void addHeliports();
-    void addLocalizers(std::vector<std::shared_ptr<world::Fix>> *fixes);
-    void addFixes();
-    void addProcedures();
+    // all airports are loaded together, each query returns the rows for all of them
+    struct Building {
+        std::shared_ptr<world::Airport> a;
+        std::string ident;
+        std::string region;
+    };
+
+    void addAirports(const std::string &keys);
+    void addComms(const std::string &keys);
+    void addRunways(const std::string &keys);
+    void addHeliports(const std::string &keys);
+    void addLocalizers(const std::string &keys);
+    void addFixes(const std::string &keys);
+    void addProcedures(const std::string &keys);
+    Building *findBuilding(int airport_id);
+
 
 private:
-    static std::map<std::string, bool> fixIsLocOnly;
     std::shared_ptr<SqlLoadManager> loadMgr;
+    int const worker;
     bool const isBackgroundLoad;
-    int const id_search;
+    std::vector<int> keys;
     const std::string * const icao_search;
-    std::shared_ptr<world::Airport> a;
-    int airport_id;
-    std::string ident;
-    std::string region;
+    std::map<int, Building> airports;
     std::map<int, std::shared_ptr<world::Runway>> rws;
 };
 
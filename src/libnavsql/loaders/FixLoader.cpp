@@ -25,86 +25,76 @@
 
 namespace sqlnav {
 
-// for use during background area loading
-FixLoader::FixLoader(std::shared_ptr<SqlLoadManager> db, int i)
-:   loadMgr(db), isBackgroundLoad(true), id(i), region(nullptr), ident(nullptr)
-{
-}
-
 // for use during foreground search by name and region
 FixLoader::FixLoader(std::shared_ptr<SqlLoadManager> db, const std::string &rg, const std::string &id)
-:   loadMgr(db), isBackgroundLoad(false), id(0), region(&rg), ident(&id)
+:   loadMgr(db), worker(SqlLoadManager::FOREGROUND), region(&rg), ident(&id)
 {
 }
 
-// for use during foreground load of list of fixes
-FixLoader::FixLoader(std::shared_ptr<SqlLoadManager> db)
-:   loadMgr(db), isBackgroundLoad(false), id(0), region(nullptr), ident(nullptr)
+// for use during background area loading, and foreground load of list of fixes
+FixLoader::FixLoader(std::shared_ptr<SqlLoadManager> db, int w)
+:   loadMgr(db), worker(w), region(nullptr), ident(nullptr)
 {
 }
 
 std::shared_ptr<world::Fix> FixLoader::load()
 {
-    std::shared_ptr<SqlStatement> q;
-    if (ident && region) {
-        q = loadMgr->GetSQL(SqlLoadManager::Searches::FIX_BY_NAME, isBackgroundLoad);
-        q->initialize();
-        q->bind(1, *region);
-        q->bind(2, *ident);
-    } else if (id) {
-        q = loadMgr->GetSQL(SqlLoadManager::Searches::FIX_BY_ID, isBackgroundLoad);
-        q->initialize();
-        q->bind(1, id);
-    } else {
+    if (!ident || !region) {
         return nullptr;
     }
 
+    auto q = loadMgr->GetSQL(SqlLoadManager::Searches::FIX_BY_NAME, worker);
+    q->initialize();
+    q->bind(1, *region);
+    q->bind(2, *ident);
     if (q->step()) {
         return nullptr;
     }
+    int key = q->getInt(0);
+
+    auto fixes = loadByKeys(std::vector<int>(1, key));
+    auto it = fixes.find(key);
+    return (it == fixes.end()) ? nullptr : it->second;
+}
+
+std::vector<std::shared_ptr<world::Fix>> FixLoader::loadAll(const std::vector<int> fixKeys)
+{
+    auto fixes = loadByKeys(fixKeys);
 
-    int nav_id;
-    std::string ident, region, type;
-    double lonx, laty;
-    ident = q->getString(0);
-    region = q->getString(1);
-    type = q->getString(2);
-    nav_id = q->getInt(3);
-    lonx = q->getDouble(4);
-    laty = q->getDouble(5);
-
-    auto r = loadMgr->getRegion(region);
-    world::Location loc(laty, lonx);
-    f = std::make_shared<world::Fix>(r, ident, loc);
-
-    // the fix might have an NDB, VOR, or DME associated with it
-    if (nav_id) {
-        if (type == "N") {
-            addNDB(nav_id);
-        } else if (type == "V") {
-            addVORDME(nav_id);
+    // now create an ordered vector matching the request
+    std::vector<std::shared_ptr<world::Fix>> fixseq;
+    for (auto i: fixKeys) {
+        if (fixes.find(i) != fixes.end()) {
+            fixseq.push_back(fixes[i]);
         }
     }
 
-    return f;
+    return fixseq;
 }
 
-std::vector<std::shared_ptr<world::Fix>> FixLoader::loadAll(const std::vector<int> fixKeys)
+std::map<int, std::shared_ptr<world::Fix>> FixLoader::loadByKeys(const std::vector<int> &fixKeys)
 {
-    // create a json fragment to be used in the SQL query for a variable-length selection
-    std::ostringstream json;
-    json << '[';
+    // fixes which have been created before are taken from the cache
+    std::map<int, std::shared_ptr<world::Fix>> fixes;
+    std::vector<int> missing;
     for (auto k: fixKeys) {
-        json << k << ',';
+        auto cached = loadMgr->findCachedFix(k);
+        if (cached) {
+            fixes[k] = cached;
+        } else {
+            missing.push_back(k);
+        }
+    }
+    if (missing.empty()) {
+        return fixes;
     }
-    std::string srch = json.str();
-    srch.back() = ']';
 
     // retrieve the results - not necessarily in the order we want them!
-    std::map<int, std::shared_ptr<world::Fix>> fixes;
-    auto qry = loadMgr->GetSQL(SqlLoadManager::Searches::FIXES_BY_KEYS, false);
+    std::map<int, std::shared_ptr<world::Fix>> created;
+    NavaidFixes ndbs, vors;
+    auto qry = loadMgr->GetSQL(SqlLoadManager::Searches::FIXES_BY_KEYS, worker);
     qry->initialize();
-    qry->bind(1, srch);
+    qry->bind(1, SqlLoadManager::toKeyList(missing));
     while (1) {
         if (qry->step()) break;
         auto id = qry->getInt(0);
@@ -112,61 +102,93 @@ std::vector<std::shared_ptr<world::Fix>> FixLoader::loadAll(const std::vector<in
         auto region = qry->getString(2);
         auto lonx = qry->getDouble(3);
         auto laty = qry->getDouble(4);
+        auto type = qry->getString(5);
+        auto nav_id = qry->getInt(6);
 
         auto r = loadMgr->getRegion(region);
         world::Location loc(laty, lonx);
-        fixes[id] = std::make_shared<world::Fix>(r, ident, loc);
+        auto f = std::make_shared<world::Fix>(r, ident, loc);
+        created[id] = f;
+
+        // the fix might have an NDB, VOR, or DME associated with it
+        if (nav_id) {
+            if (type == "N") {
+                ndbs[nav_id] = f;
+            } else if (type == "V") {
+                vors[nav_id] = f;
+            }
+        }
     }
 
-    // now create an ordered vector matching the request
-    std::vector<std::shared_ptr<world::Fix>> fixseq;
-    for (auto i: fixKeys) {
-        if (fixes.find(i) != fixes.end()) {
-            fixseq.push_back(fixes[i]);
-        }
+    addNDBs(ndbs);
+    addVORDMEs(vors);
+
+    // the fixes are complete now, so they can be shared
+    for (auto &it: created) {
+        fixes[it.first] = loadMgr->cacheFix(it.first, it.second);
     }
 
-    return fixseq;
+    return fixes;
 }
 
-void FixLoader::addNDB(int id)
+void FixLoader::addNDBs(const NavaidFixes &fixes)
 {
-    auto qry = loadMgr->GetSQL(SqlLoadManager::Searches::NDB_BY_ID, isBackgroundLoad);
+    if (fixes.empty()) return;
+
+    std::vector<int> keys;
+    for (auto &it: fixes) {
+        keys.push_back(it.first);
+    }
+
+    auto qry = loadMgr->GetSQL(SqlLoadManager::Searches::NDBS_BY_KEYS, worker);
     qry->initialize();
-    qry->bind(1, id);
-    if (qry->step()) return;
-    auto name = qry->getString(0);
-    auto freq = qry->getInt(1);
-    auto range = qry->getInt(2);
-
-    world::Frequency ndbFrq = world::Frequency(freq, 0, world::Frequency::Unit::KHZ, name);
-    auto ndb = std::make_shared<world::NDB>(ndbFrq, range);
-    f->attachNDB(ndb);
+    qry->bind(1, SqlLoadManager::toKeyList(keys));
+    while (1) {
+        if (qry->step()) break;
+        auto id = qry->getInt(0);
+        auto name = qry->getString(1);
+        auto freq = qry->getInt(2);
+        auto range = qry->getInt(3);
+
+        world::Frequency ndbFrq = world::Frequency(freq, 0, world::Frequency::Unit::KHZ, name);
+        auto ndb = std::make_shared<world::NDB>(ndbFrq, range);
+        fixes.at(id)->attachNDB(ndb);
+    }
 }
 
-void FixLoader::addVORDME(int id)
+void FixLoader::addVORDMEs(const NavaidFixes &fixes)
 {
-    auto qry = loadMgr->GetSQL(SqlLoadManager::Searches::VOR_BY_ID, isBackgroundLoad);
-    qry->initialize();
-    qry->bind(1, id);
-    if (qry->step()) return;
-    auto name = qry->getString(0);
-    auto type = qry->getString(1);
-    auto freq = qry->getInt(2);
-    auto range = qry->getInt(3);
-    auto mag_var = qry->getFloat(4);
-    auto dme_only = qry->getBool(5);
-
-    world::Frequency frequency = world::Frequency(freq, 2, world::Frequency::Unit::MHZ, name);
-    if (!dme_only) {
-        auto vor = std::make_shared<world::VOR>(frequency, range);
-        vor->setBearing(mag_var);
-        f->attachVOR(vor);
+    if (fixes.empty()) return;
+
+    std::vector<int> keys;
+    for (auto &it: fixes) {
+        keys.push_back(it.first);
     }
 
-    auto dme = std::make_shared<world::DME>(frequency, range);
-    //dme->setPaired(/* not currently used, but how to determine? */);
-    f->attachDME(dme);
+    auto qry = loadMgr->GetSQL(SqlLoadManager::Searches::VORS_BY_KEYS, worker);
+    qry->initialize();
+    qry->bind(1, SqlLoadManager::toKeyList(keys));
+    while (1) {
+        if (qry->step()) break;
+        auto id = qry->getInt(0);
+        auto name = qry->getString(1);
+        auto freq = qry->getInt(3);
+        auto range = qry->getInt(4);
+        auto mag_var = qry->getFloat(5);
+        auto dme_only = qry->getBool(6);
+
+        auto &f = fixes.at(id);
+        world::Frequency frequency = world::Frequency(freq, 2, world::Frequency::Unit::MHZ, name);
+        if (!dme_only) {
+            auto vor = std::make_shared<world::VOR>(frequency, range);
+            vor->setBearing(mag_var);
+            f->attachVOR(vor);
+        }
+
+        auto dme = std::make_shared<world::DME>(frequency, range);
+        //dme->setPaired(/* not currently used, but how to determine? */);
+        f->attachDME(dme);
+    }
 }
 
 }
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "src/world/models/navaids/Fix.h"
+#include <map>
 
 namespace sqlnav {
 
@@ -27,29 +28,29 @@ class SqlWorld;
 class FixLoader
 {
 public:
-    // used by background area loader for all fixes, and foreground airport loader for terminal fixes
-    FixLoader(std::shared_ptr<SqlLoadManager> db, int id);
     // for use during foreground search by name and region
     FixLoader(std::shared_ptr<SqlLoadManager> db, const std::string &region, const std::string &ident);
-    // for use during foreground route operations - multiple fixes
-    FixLoader(std::shared_ptr<SqlLoadManager> db);
+    // used by background area loader for all fixes and the terminal fixes of airports,
+    // and for use during foreground route operations - multiple fixes
+    FixLoader(std::shared_ptr<SqlLoadManager> db, int worker);
 
     FixLoader() = delete;
 
     std::shared_ptr<world::Fix> load();
     std::vector<std::shared_ptr<world::Fix>> loadAll(const std::vector<int> fixKeys);
+    std::map<int, std::shared_ptr<world::Fix>> loadByKeys(const std::vector<int> &fixKeys);
 
 private:
-    void addNDB(int navid);
-    void addVORDME(int navid);
+    // navaids keyed by their ID, mapped to the fix they are attached to
+    using NavaidFixes = std::map<int, std::shared_ptr<world::Fix>>;
+    void addNDBs(const NavaidFixes &fixes);
+    void addVORDMEs(const NavaidFixes &fixes);
 
 private:
     std::shared_ptr<SqlLoadManager> loadMgr;
-    bool const isBackgroundLoad;
-    int const id;
+    int const worker;
     const std::string * const region;
     const std::string * const ident;
-    std::shared_ptr<world::Fix> f;
 };
 
 }
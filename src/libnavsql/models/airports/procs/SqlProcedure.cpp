@@ -56,7 +56,7 @@ world::NavNodeList SqlProcedure::getWaypoints(std::string runway, std::string tr
 
     // get the transition fixes
     int selectedPid = pids.front(); // default to using the first variant
-    auto tfixes = loadMgr->getTransitionFixes(transition, pids, selectedPid);
+    auto tfixes = loadMgr.lock()->getTransitionFixes(transition, pids, selectedPid);
 
     // get the procedure fixes for the transition that was selected
     std::vector<int> fxs;
@@ -81,7 +81,7 @@ world::NavNodeList SqlProcedure::getWaypoints(std::string runway, std::string tr
         }
     }
 
-    return loadMgr->getFixList(clean);
+    return loadMgr.lock()->getFixList(clean);
 }
 
 
@@ -38,7 +38,8 @@ protected:
 
 private:
     std::string name;
-    std::shared_ptr<SqlLoadManager> loadMgr;
+    // weak pointer, procedures may be cached by the load manager's world for route finding
+    std::weak_ptr<SqlLoadManager> loadMgr;
 
 private:
     struct Variant {
@@ -0,0 +1,123 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cctype>
+#include "AirportSearchIndex.h"
+#include "src/platform/Platform.h"
+
+namespace xdata {
+
+void AirportSearchIndex::build(const std::map<std::string, std::shared_ptr<world::Airport>> &airports) {
+    entries.clear();
+    trigrams.clear();
+
+    entries.reserve(airports.size());
+    for (auto &it: airports) {
+        entries.push_back(Entry{it.first, platform::lower(it.second->getName()), it.second});
+    }
+
+    for (uint32_t i = 0; i < entries.size(); i++) {
+        auto &name = entries[i].name;
+        for (size_t pos = 0; pos + 3 <= name.size(); pos++) {
+            auto &postings = trigrams[trigramAt(name, pos)];
+            if (postings.empty() || postings.back() != i) {
+                postings.push_back(i);
+            }
+        }
+    }
+}
+
+std::vector<std::shared_ptr<world::Airport>> AirportSearchIndex::find(const std::string &keyWord, size_t maxResults) const {
+    std::vector<uint32_t> found;
+    auto add = [&found, maxResults] (uint32_t i) {
+        if (found.size() < maxResults && std::find(found.begin(), found.end(), i) == found.end()) {
+            found.push_back(i);
+        }
+    };
+
+    std::string ident = platform::upper(keyWord);
+    ident.erase(std::remove(ident.begin(), ident.end(), ' '), ident.end());
+
+    auto first = std::lower_bound(entries.begin(), entries.end(), ident, [] (const Entry &e, const std::string &id) {
+        return e.ident < id;
+    });
+    for (auto it = first; it != entries.end() && found.size() < maxResults; ++it) {
+        if (it->ident.compare(0, ident.size(), ident) != 0) {
+            break;
+        }
+        add(it - entries.begin());
+    }
+
+    // names are only compared against the entries sharing a trigram with the key, keys
+    // that are too short for a trigram have to be compared against all of them
+    std::string key = platform::lower(keyWord);
+    const std::vector<uint32_t> *candidates = nullptr;
+    size_t count = entries.size();
+    if (key.size() >= 3) {
+        candidates = findCandidates(key);
+        count = candidates ? candidates->size() : 0;
+    }
+
+    std::vector<uint32_t> wordMatches, otherMatches;
+    for (size_t c = 0; c < count && found.size() + wordMatches.size() < maxResults; c++) {
+        uint32_t i = candidates ? (*candidates)[c] : c;
+        auto &name = entries[i].name;
+        size_t pos = name.find(key);
+        if (pos == std::string::npos) {
+            continue;
+        }
+        if (pos == 0 || !std::isalnum((unsigned char) name[pos - 1])) {
+            wordMatches.push_back(i);
+        } else if (found.size() + otherMatches.size() < maxResults) {
+            otherMatches.push_back(i);
+        }
+    }
+    for (auto i: wordMatches) {
+        add(i);
+    }
+    for (auto i: otherMatches) {
+        add(i);
+    }
+
+    std::vector<std::shared_ptr<world::Airport>> res;
+    for (auto i: found) {
+        res.push_back(entries[i].airport);
+    }
+    return res;
+}
+
+uint32_t AirportSearchIndex::trigramAt(const std::string &s, size_t pos) {
+    return ((uint8_t) s[pos] << 16) | ((uint8_t) s[pos + 1] << 8) | (uint8_t) s[pos + 2];
+}
+
+const std::vector<uint32_t> *AirportSearchIndex::findCandidates(const std::string &key) const {
+    // the rarest trigram of the key gives the shortest list, nullptr if some trigram is unknown
+    const std::vector<uint32_t> *shortest = nullptr;
+    for (size_t pos = 0; pos + 3 <= key.size(); pos++) {
+        auto it = trigrams.find(trigramAt(key, pos));
+        if (it == trigrams.end()) {
+            return nullptr;
+        }
+        if (!shortest || it->second.size() < shortest->size()) {
+            shortest = &it->second;
+        }
+    }
+    return shortest;
+}
+
+} /* namespace xdata */
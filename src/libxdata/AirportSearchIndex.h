@@ -0,0 +1,66 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_LIBXDATA_AIRPORTSEARCHINDEX_H_
+#define SRC_LIBXDATA_AIRPORTSEARCHINDEX_H_
+
+#include <vector>
+#include <map>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include "src/world/models/airport/Airport.h"
+
+namespace xdata {
+
+/*
+ * Index to search the airports by ident or name.
+ *
+ * The results are ranked: an exact ident first, then idents starting with
+ * the key, then names with a word starting with the key, then names that
+ * contain the key anywhere. Within a rank the airports are ordered by ident.
+ *
+ * Names are found through a map of the trigrams of the lower case names, so
+ * only the airports sharing the rarest trigram of the key are compared.
+ */
+class AirportSearchIndex {
+public:
+    // replaces the content of the index
+    void build(const std::map<std::string, std::shared_ptr<world::Airport>> &airports);
+
+    std::vector<std::shared_ptr<world::Airport>> find(const std::string &keyWord, size_t maxResults) const;
+
+private:
+    struct Entry {
+        std::string ident;
+        std::string name;
+        std::shared_ptr<world::Airport> airport;
+    };
+
+    // sorted by ident
+    std::vector<Entry> entries;
+    // indices of the entries containing each trigram, in ascending order
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigrams;
+
+    static uint32_t trigramAt(const std::string &s, size_t pos);
+    const std::vector<uint32_t> *findCandidates(const std::string &key) const;
+};
+
+} /* namespace xdata */
+
+#endif /* SRC_LIBXDATA_AIRPORTSEARCHINDEX_H_ */
@@ -0,0 +1,96 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "CIFPSource.h"
+#include "XWorld.h"
+#include "parsers/CIFPParser.h"
+#include "loaders/CIFPLoader.h"
+#include "src/Logger.h"
+
+namespace xdata {
+
+CIFPSource::CIFPSource(std::shared_ptr<world::LoadManager> mgr, const std::string &cifpPath):
+    loadMgr(mgr),
+    cifpPath(cifpPath)
+{
+}
+
+void CIFPSource::load(world::Airport &airport) {
+    std::shared_future<Procedures> staged;
+    {
+        std::lock_guard<std::mutex> lock(prefetchGuard);
+        consumed.insert(airport.getID());
+        auto it = prefetched.find(airport.getID());
+        if (it != prefetched.end()) {
+            staged = it->second;
+            prefetched.erase(it);
+        }
+    }
+
+    Procedures procedures = staged.valid() ? staged.get() : parse(cifpPath + airport.getID() + ".dat");
+    if (procedures.empty()) {
+        return;
+    }
+
+    auto mgr = loadMgr.lock();
+    if (!mgr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mergeGuard);
+    auto ap = mgr->getWorld()->findAirportByID(airport.getID());
+    if (!ap) {
+        return;
+    }
+
+    logger::verbose("Loading %d procedures for %s", (int) procedures.size(), ap->getID().c_str());
+    try {
+        CIFPLoader loader(mgr);
+        for (auto &procedure: procedures) {
+            loader.accept(ap, procedure);
+        }
+    } catch (const std::exception &e) {
+        logger::warn("Couldn't load procedures for %s: %s", ap->getID().c_str(), e.what());
+    }
+}
+
+void CIFPSource::prefetch(const world::Airport &airport) {
+    std::lock_guard<std::mutex> lock(prefetchGuard);
+    if (consumed.count(airport.getID())) {
+        return;
+    }
+    auto &staged = prefetched[airport.getID()];
+    if (!staged.valid()) {
+        staged = std::async(std::launch::async, &CIFPSource::parse, cifpPath + airport.getID() + ".dat").share();
+    }
+}
+
+CIFPSource::Procedures CIFPSource::parse(const std::string &file) {
+    Procedures procedures;
+    try {
+        CIFPParser parser(file);
+        parser.setAcceptor([&procedures] (const CIFPData &data) {
+            procedures.push_back(data);
+        });
+        parser.loadCIFP();
+    } catch (const std::exception &e) {
+        // many airports do not have CIFP data, so ignore silently
+    }
+    return procedures;
+}
+
+} /* namespace xdata */
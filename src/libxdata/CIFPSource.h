@@ -0,0 +1,69 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_LIBXDATA_CIFPSOURCE_H_
+#define SRC_LIBXDATA_CIFPSOURCE_H_
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <future>
+#include "src/world/LoadManager.h"
+#include "src/world/models/airport/Airport.h"
+#include "parsers/objects/CIFPData.h"
+
+namespace xdata {
+
+/*
+ * Loads the procedures of an airport from its CIFP file when they are first
+ * needed, instead of parsing the files of all airports at startup.
+ *
+ * Like when loading all of them, the files are parsed separately from merging
+ * the procedures into the world: a prefetch parses the file on a background
+ * thread, the merge happens on the thread that needs the procedures.
+ */
+class CIFPSource : public world::Airport::ProcedureSource {
+public:
+    CIFPSource(std::shared_ptr<world::LoadManager> mgr, const std::string &cifpPath);
+
+    void load(world::Airport &airport) override;
+    void prefetch(const world::Airport &airport) override;
+
+private:
+    using Procedures = std::vector<CIFPData>;
+
+    // the source is owned by the airports of the world, which the load manager owns
+    std::weak_ptr<world::LoadManager> loadMgr;
+    std::string cifpPath;
+
+    std::mutex prefetchGuard;
+    std::map<std::string, std::shared_future<Procedures>> prefetched;
+    // airports whose procedures were taken, later prefetches for them are ignored
+    std::set<std::string> consumed;
+
+    // merges modify the world, so only one runs at a time
+    std::mutex mergeGuard;
+
+    static Procedures parse(const std::string &file);
+};
+
+} /* namespace xdata */
+
+#endif /* SRC_LIBXDATA_CIFPSOURCE_H_ */
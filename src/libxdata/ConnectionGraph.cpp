@@ -0,0 +1,138 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include "ConnectionGraph.h"
+
+namespace xdata {
+
+void ConnectionGraph::add(const std::shared_ptr<world::NavNode> &from, const std::shared_ptr<world::NavEdge> &via, const std::shared_ptr<world::NavNode> &to) {
+    if (!built) {
+        pending.push_back(PendingConnection{from.get(), std::make_pair(via, to)});
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(lateRowGuard);
+    auto it = lateRows.find(from.get());
+    auto row = findBuiltRow(from.get());
+    if (it != lateRows.end()) {
+        auto late = it->second;
+        if (late->size() < late->capacity()) {
+            // appending without reallocation leaves the connections handed out before untouched
+            late->push_back(std::make_pair(via, to));
+            return;
+        }
+        row = {late->data(), late->data() + late->size()};
+    }
+
+    // the previous row stays where it is, the new one has room to grow
+    std::vector<world::World::Connection> grown;
+    grown.reserve((row.end() - row.begin() + 1) * 2);
+    grown.insert(grown.end(), row.begin(), row.end());
+    grown.push_back(std::make_pair(via, to));
+
+    lateRowStorage.push_back(std::move(grown));
+    lateRows[from.get()] = &lateRowStorage.back();
+    hasLateRows = true;
+}
+
+void ConnectionGraph::build() {
+    // each node keeps its connections in the order they were added
+    std::vector<PendingConnection> all = std::move(pending);
+    pending = std::vector<PendingConnection>();
+
+    std::stable_sort(all.begin(), all.end(), [] (const PendingConnection &a, const PendingConnection &b) {
+        return a.from < b.from;
+    });
+
+    size_t rows = 0;
+    for (size_t i = 0; i < all.size(); i++) {
+        if (i == 0 || all[i].from != all[i - 1].from) {
+            rows++;
+        }
+    }
+
+    size_t slotCount = 16;
+    while (slotCount < rows * 2) {
+        slotCount *= 2;
+    }
+
+    connections.clear();
+    connections.reserve(all.size());
+    rowStart.clear();
+    rowStart.reserve(rows + 1);
+    slots.assign(slotCount, Slot{});
+    size_t mask = slotCount - 1;
+
+    for (size_t i = 0; i < all.size(); i++) {
+        if (i == 0 || all[i].from != all[i - 1].from) {
+            size_t s = hash(all[i].from) & mask;
+            while (slots[s].node) {
+                s = (s + 1) & mask;
+            }
+            slots[s].node = all[i].from;
+            slots[s].row = rowStart.size();
+            rowStart.push_back(connections.size());
+        }
+        connections.push_back(std::move(all[i].connection));
+    }
+    rowStart.push_back(connections.size());
+
+    built = true;
+}
+
+world::World::ConnectionRange ConnectionGraph::find(const world::NavNode *from) const {
+    // the built rows are never changed, so the lock is only needed once there are late rows
+    if (hasLateRows) {
+        std::lock_guard<std::mutex> lock(lateRowGuard);
+        auto it = lateRows.find(from);
+        if (it != lateRows.end()) {
+            return {it->second->data(), it->second->data() + it->second->size()};
+        }
+    }
+    return findBuiltRow(from);
+}
+
+world::World::ConnectionRange ConnectionGraph::findBuiltRow(const world::NavNode *from) const {
+    auto slot = findSlot(from);
+    if (!slot) {
+        return {};
+    }
+    const world::World::Connection *first = connections.data();
+    return {first + rowStart[slot->row], first + rowStart[slot->row + 1]};
+}
+
+uint64_t ConnectionGraph::hash(const world::NavNode *node) {
+    uint64_t h = (uint64_t) (uintptr_t) node;
+    h = (h ^ (h >> 33)) * 0xFF51AFD7ED558CCDULL;
+    return h ^ (h >> 33);
+}
+
+const ConnectionGraph::Slot *ConnectionGraph::findSlot(const world::NavNode *node) const {
+    if (slots.empty()) {
+        return nullptr;
+    }
+    size_t mask = slots.size() - 1;
+    for (size_t s = hash(node) & mask; slots[s].node; s = (s + 1) & mask) {
+        if (slots[s].node == node) {
+            return &slots[s];
+        }
+    }
+    return nullptr;
+}
+
+} /* namespace xdata */
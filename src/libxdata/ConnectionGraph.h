@@ -0,0 +1,87 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_LIBXDATA_CONNECTIONGRAPH_H_
+#define SRC_LIBXDATA_CONNECTIONGRAPH_H_
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include "src/world/World.h"
+
+namespace xdata {
+
+/*
+ * The airways and procedures between the nav nodes.
+ *
+ * While loading, the connections are collected in one flat list. build()
+ * then sorts them by their source node into a single array, so that the
+ * connections of each node are one contiguous row (compressed sparse row
+ * layout). The rows are found through an open addressing table keyed by
+ * the node's address, the nodes themselves are owned by the world.
+ *
+ * Procedures loaded on demand add connections after the build, possibly while
+ * other threads are finding rows. The node's row is then copied into a separate
+ * vector with spare capacity that is used instead from then on. Late rows only
+ * grow into their spare capacity; once that is used up, the row is copied again
+ * and the old vector is kept, so that ranges handed out before stay valid.
+ */
+class ConnectionGraph {
+public:
+    void add(const std::shared_ptr<world::NavNode> &from, const std::shared_ptr<world::NavEdge> &via, const std::shared_ptr<world::NavNode> &to);
+
+    void build();
+
+    world::World::ConnectionRange find(const world::NavNode *from) const;
+
+private:
+    struct PendingConnection {
+        const world::NavNode *from;
+        world::World::Connection connection;
+    };
+
+    struct Slot {
+        const world::NavNode *node = nullptr;
+        uint32_t row = 0;
+    };
+
+    bool built = false;
+    std::vector<PendingConnection> pending;
+
+    // row r is connections[rowStart[r]] up to connections[rowStart[r + 1]]
+    std::vector<world::World::Connection> connections;
+    std::vector<uint32_t> rowStart;
+    std::vector<Slot> slots;
+
+    mutable std::mutex lateRowGuard;
+    std::atomic_bool hasLateRows { false };
+    std::deque<std::vector<world::World::Connection>> lateRowStorage;
+    std::map<const world::NavNode *, std::vector<world::World::Connection> *> lateRows;
+
+    world::World::ConnectionRange findBuiltRow(const world::NavNode *from) const;
+
+    static uint64_t hash(const world::NavNode *node);
+    const Slot *findSlot(const world::NavNode *node) const;
+};
+
+} /* namespace xdata */
+
+#endif /* SRC_LIBXDATA_CONNECTIONGRAPH_H_ */
@@ -0,0 +1,78 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "NavIdentifiers.h"
+
+namespace xdata {
+
+IdentifierPool::IdentifierPool():
+    slots(1024, NONE)
+{
+}
+
+uint32_t IdentifierPool::intern(const std::string &ident) {
+    if ((idents.size() + 1) * 2 > slots.size()) {
+        grow();
+    }
+
+    size_t mask = slots.size() - 1;
+    size_t i = hash(ident) & mask;
+    while (slots[i] != NONE) {
+        if (idents[slots[i]] == ident) {
+            return slots[i];
+        }
+        i = (i + 1) & mask;
+    }
+
+    slots[i] = idents.size();
+    idents.push_back(ident);
+    return slots[i];
+}
+
+uint32_t IdentifierPool::find(const std::string &ident) const {
+    size_t mask = slots.size() - 1;
+    for (size_t i = hash(ident) & mask; slots[i] != NONE; i = (i + 1) & mask) {
+        if (idents[slots[i]] == ident) {
+            return slots[i];
+        }
+    }
+    return NONE;
+}
+
+uint64_t IdentifierPool::hash(const std::string &ident) {
+    // FNV-1a
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (unsigned char c: ident) {
+        h = (h ^ c) * 0x100000001B3ULL;
+    }
+    return h ^ (h >> 32);
+}
+
+void IdentifierPool::grow() {
+    std::vector<uint32_t> bigger(slots.size() * 2, NONE);
+    size_t mask = bigger.size() - 1;
+    for (uint32_t n = 0; n < idents.size(); n++) {
+        size_t i = hash(idents[n]) & mask;
+        while (bigger[i] != NONE) {
+            i = (i + 1) & mask;
+        }
+        bigger[i] = n;
+    }
+    slots = std::move(bigger);
+}
+
+} /* namespace xdata */
@@ -0,0 +1,138 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_LIBXDATA_NAVIDENTIFIERS_H_
+#define SRC_LIBXDATA_NAVIDENTIFIERS_H_
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+namespace xdata {
+
+/*
+ * Interns the identifiers of the nav data, i.e. maps each distinct string
+ * to a small number, so that lookups by several identifiers can be done
+ * in one table keyed by the combination of their numbers.
+ *
+ * Both this and the IdentifierTable below use open addressing with linear
+ * probing in a power of two sized slot array that is kept at most half full.
+ */
+class IdentifierPool {
+public:
+    static constexpr const uint32_t NONE = UINT32_MAX;
+
+    IdentifierPool();
+
+    // returns the number of the identifier, adding it if it's new
+    uint32_t intern(const std::string &ident);
+
+    // returns the number of the identifier or NONE if it's unknown
+    uint32_t find(const std::string &ident) const;
+
+private:
+    std::vector<std::string> idents;
+    std::vector<uint32_t> slots;
+
+    static uint64_t hash(const std::string &ident);
+    void grow();
+};
+
+template <typename T>
+class IdentifierTable {
+public:
+    static uint64_t makeKey(uint32_t first, uint32_t second) {
+        return ((uint64_t) first << 32) | second;
+    }
+
+    IdentifierTable():
+        slots(INITIAL_SLOTS)
+    {
+    }
+
+    std::shared_ptr<T> find(uint64_t key) const {
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(key) & mask; slots[i].value; i = (i + 1) & mask) {
+            if (slots[i].key == key) {
+                return slots[i].value;
+            }
+        }
+        return nullptr;
+    }
+
+    // the first value stored for a key wins, it is returned if there is one
+    std::shared_ptr<T> insert(uint64_t key, std::shared_ptr<T> value) {
+        if ((count + 1) * 2 > slots.size()) {
+            grow();
+        }
+        Slot &slot = findSlot(slots, key);
+        if (!slot.value) {
+            slot.key = key;
+            slot.value = value;
+            count++;
+        }
+        return slot.value;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+private:
+    static constexpr const size_t INITIAL_SLOTS = 1024;
+
+    struct Slot {
+        uint64_t key = 0;
+        std::shared_ptr<T> value;
+    };
+
+    std::vector<Slot> slots;
+    size_t count = 0;
+
+    static uint64_t hash(uint64_t key) {
+        // splitmix64 finalizer, the interned numbers are too regular to be used directly
+        key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+        return key ^ (key >> 31);
+    }
+
+    static Slot &findSlot(std::vector<Slot> &table, uint64_t key) {
+        size_t mask = table.size() - 1;
+        size_t i = hash(key) & mask;
+        while (table[i].value && table[i].key != key) {
+            i = (i + 1) & mask;
+        }
+        return table[i];
+    }
+
+    void grow() {
+        std::vector<Slot> bigger(slots.size() * 2);
+        for (auto &slot: slots) {
+            if (slot.value) {
+                Slot &target = findSlot(bigger, slot.key);
+                target.key = slot.key;
+                target.value = std::move(slot.value);
+            }
+        }
+        slots = std::move(bigger);
+    }
+};
+
+} /* namespace xdata */
+
+#endif /* SRC_LIBXDATA_NAVIDENTIFIERS_H_ */
@@ -0,0 +1,161 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2026 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cmath>
+#include <algorithm>
+#include "NodeGrid.h"
+
+namespace xdata {
+
+NodeGrid::NodeGrid() {
+    // the band's edge closest to the equator is its widest, the cells must not be wider than that
+    bandFirstCell.push_back(0);
+    for (int band = 0; band < BANDS; ++band) {
+        double south = -90 + band * CELL_SIZE;
+        double north = south + CELL_SIZE;
+        double widest = (south < 0 && north > 0) ? 0 : std::min(std::abs(south), std::abs(north));
+        int columns = std::max(1, (int)std::ceil(360 / CELL_SIZE * std::cos(widest * M_PI / 180)));
+        bandFirstCell.push_back(bandFirstCell.back() + columns);
+    }
+    cellFirstRecord.assign(bandFirstCell.back() + 1, 0);
+}
+
+void NodeGrid::build(const std::vector<std::shared_ptr<world::NavNode>> &nodes) {
+    std::vector<Record> unsorted;
+    std::vector<uint32_t> cells;
+    unsorted.reserve(nodes.size());
+    cells.reserve(nodes.size());
+
+    // count the nodes of each cell, then place them in cell order
+    std::fill(cellFirstRecord.begin(), cellFirstRecord.end(), 0);
+    for (auto &node: nodes) {
+        unsorted.push_back(makeRecord(*node));
+        cells.push_back(cellOf(unsorted.back().latitude, unsorted.back().longitude));
+        ++cellFirstRecord[cells.back() + 1];
+    }
+    for (size_t c = 1; c < cellFirstRecord.size(); ++c) {
+        cellFirstRecord[c] += cellFirstRecord[c - 1];
+    }
+
+    std::vector<uint32_t> next(cellFirstRecord.begin(), cellFirstRecord.end() - 1);
+    records.resize(unsorted.size());
+    for (size_t i = 0; i < unsorted.size(); ++i) {
+        records[next[cells[i]]++] = unsorted[i];
+    }
+
+    lateRecords.clear();
+}
+
+void NodeGrid::add(std::shared_ptr<world::NavNode> node) {
+    lateRecords.push_back(makeRecord(*node));
+}
+
+void NodeGrid::visit(const world::Location &bottomLeft, const world::Location &topRight, world::World::NodeAcceptor callback, int filter) const {
+    // bring the longitudes into -180..180, the area might then span the -180/180 meridian
+    double west = bottomLeft.longitude;
+    double east = topRight.longitude;
+    if (east - west >= 360) {
+        west = -180;
+        east = 180;
+    } else {
+        west = std::remainder(west, 360);
+        east = std::remainder(east, 360);
+    }
+    bool wraps = west > east;
+    double south = bottomLeft.latitude;
+    double north = topRight.latitude;
+
+    auto visitRange = [&] (uint32_t first, uint32_t last, const Record *recs) {
+        for (uint32_t i = first; i < last; ++i) {
+            const Record &r = recs[i];
+            if (!(r.visitFlag & filter)) continue;
+            if ((r.latitude < south) || (r.latitude > north)) continue;
+            if (wraps) {
+                if ((r.longitude < west) && (r.longitude > east)) continue;
+            } else {
+                if ((r.longitude < west) || (r.longitude > east)) continue;
+            }
+            callback(r.node);
+        }
+    };
+
+    if (south <= north) {
+        for (int band = bandOf(south); band <= bandOf(north); ++band) {
+            uint32_t bandCell = bandFirstCell[band];
+            int westCol = columnOf(band, west);
+            int eastCol = columnOf(band, east);
+            if (!wraps) {
+                visitRange(cellFirstRecord[bandCell + westCol], cellFirstRecord[bandCell + eastCol + 1], records.data());
+            } else {
+                uint32_t lastCell = bandFirstCell[band + 1];
+                visitRange(cellFirstRecord[bandCell + westCol], cellFirstRecord[lastCell], records.data());
+                visitRange(cellFirstRecord[bandCell], cellFirstRecord[bandCell + eastCol + 1], records.data());
+            }
+        }
+    }
+
+    visitRange(0, lateRecords.size(), lateRecords.data());
+}
+
+NodeGrid::Record NodeGrid::makeRecord(const world::NavNode &node) {
+    auto &loc = node.getLocation();
+    Record r;
+    r.latitude = loc.latitude;
+    r.longitude = loc.longitude;
+    r.visitFlag = getVisitFlag(node);
+    r.node = &node;
+    return r;
+}
+
+int NodeGrid::getVisitFlag(const world::NavNode &node) {
+    if (node.isAirport()) {
+        auto &airport = dynamic_cast<const world::Airport &>(node);
+        if (airport.hasControlTower()) {
+            return world::World::VISIT_TOWERED_AIRPORTS;
+        } else {
+            return world::World::VISIT_OTHER_AIRPORTS;
+        }
+    } else if (node.isFix()) {
+        auto &fix = dynamic_cast<const world::Fix &>(node);
+        if (fix.isNavaid()) {
+            return world::World::VISIT_NAVAIDS;
+        } else if (fix.isUserFix()) {
+            return world::World::VISIT_USER_FIXES;
+        } else {
+            return world::World::VISIT_FIXES;
+        }
+    }
+    return 0;
+}
+
+int NodeGrid::bandOf(double latitude) {
+    int band = (int)std::floor((latitude + 90) / CELL_SIZE);
+    return std::min(std::max(band, 0), BANDS - 1);
+}
+
+int NodeGrid::columnOf(int band, double longitude) const {
+    int columns = bandFirstCell[band + 1] - bandFirstCell[band];
+    int col = (int)std::floor((longitude + 180) / 360 * columns);
+    return std::min(std::max(col, 0), columns - 1);
+}
+
+int NodeGrid::cellOf(double latitude, double longitude) const {
+    int band = bandOf(latitude);
+    return bandFirstCell[band] + columnOf(band, std::remainder(longitude, 360));
+}
+
+} /* namespace xdata */
@@ -0,0 +1,80 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2026 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_LIBXDATA_NODEGRID_H_
+#define SRC_LIBXDATA_NODEGRID_H_
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "src/world/World.h"
+
+namespace xdata {
+
+/*
+ * Spatial index to find the nav nodes in an area of the map.
+ *
+ * The globe is divided into bands of CELL_SIZE degrees of latitude and each
+ * band into as many cells as are needed to keep them about CELL_SIZE degrees
+ * wide at the band's latitude, so all cells cover similar areas and the
+ * bands near the poles don't consist of hundreds of nearly empty cells.
+ *
+ * The records of all nodes are kept in one array ordered by cell, so the
+ * cells of an area within a band are a single contiguous range. Each record
+ * has a copy of the node's coordinates and its VISIT_* flag, so nodes can be
+ * filtered without touching the nodes themselves.
+ */
+class NodeGrid {
+public:
+    NodeGrid();
+
+    // replaces the content of the grid
+    void build(const std::vector<std::shared_ptr<world::NavNode>> &nodes);
+
+    // for the few nodes that are added after the grid was built
+    void add(std::shared_ptr<world::NavNode> node);
+
+    void visit(const world::Location &bottomLeft, const world::Location &topRight, world::World::NodeAcceptor callback, int filter) const;
+
+private:
+    static constexpr const double CELL_SIZE = 0.5;
+    static constexpr const int BANDS = (int)(180 / CELL_SIZE);
+
+    struct Record {
+        float latitude;
+        float longitude;
+        int visitFlag;
+        const world::NavNode *node;
+    };
+
+    // bandFirstCell[b] is the index of the first cell of band b, the last entry is the number of cells
+    std::vector<uint32_t> bandFirstCell;
+    // cellFirstRecord[c] is the index of the first record of cell c, the last entry is the number of records
+    std::vector<uint32_t> cellFirstRecord;
+    std::vector<Record> records;
+    std::vector<Record> lateRecords;
+
+    static Record makeRecord(const world::NavNode &node);
+    static int getVisitFlag(const world::NavNode &node);
+    static int bandOf(double latitude);
+    int columnOf(int band, double longitude) const;
+    int cellOf(double latitude, double longitude) const;
+};
+
+} /* namespace xdata */
+
+#endif /* SRC_LIBXDATA_NODEGRID_H_ */
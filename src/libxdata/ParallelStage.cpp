@@ -0,0 +1,140 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <thread>
+#include "ParallelStage.h"
+#include "src/platform/CrashHandler.h"
+
+namespace xdata {
+
+ParallelStage::ParallelStage(size_t window):
+    window(std::max(window, (size_t) 1))
+{
+}
+
+size_t ParallelStage::getWorkerCount() {
+    // the calling thread is busy merging
+    unsigned int cores = std::thread::hardware_concurrency();
+    return std::clamp(cores > 1 ? cores - 1 : 1u, 1u, 16u);
+}
+
+void ParallelStage::run(size_t count, Work work, Merge merge, Streamed streamed) {
+    if (count == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        started.assign(count, false);
+        done.assign(count, false);
+        errors.assign(count, nullptr);
+        jobCount = count;
+        nextJob = 0;
+        mergedJobs = 0;
+        aborted = false;
+    }
+
+    std::vector<std::thread> workers;
+    size_t workerCount = std::min(getWorkerCount(), count);
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.emplace_back(&ParallelStage::workLoop, this, std::cref(work));
+    }
+
+    auto stopWorkers = [this, &workers] () {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            aborted = true;
+        }
+        condition.notify_all();
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    };
+
+    try {
+        for (size_t i = 0; i < count; i++) {
+            bool isStreamed = streamed && streamed(i);
+            std::exception_ptr error;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this, i, isStreamed] () { return done[i] || (isStreamed && started[i]); });
+                error = errors[i];
+            }
+
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            merge(i);
+
+            if (isStreamed) {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this, i] () { return done[i]; });
+                if (errors[i]) {
+                    std::rethrow_exception(errors[i]);
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                mergedJobs = i + 1;
+            }
+            condition.notify_all();
+        }
+    } catch (...) {
+        stopWorkers();
+        throw;
+    }
+
+    stopWorkers();
+}
+
+void ParallelStage::workLoop(const Work &work) {
+    crash::ThreadCookie crashCookie;
+
+    while (true) {
+        size_t job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] () {
+                return aborted || nextJob >= jobCount || nextJob < mergedJobs + window;
+            });
+            if (aborted || nextJob >= jobCount) {
+                return;
+            }
+            job = nextJob++;
+            started[job] = true;
+        }
+        condition.notify_all();
+
+        std::exception_ptr error;
+        try {
+            work(job);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done[job] = true;
+            errors[job] = error;
+        }
+        condition.notify_all();
+    }
+}
+
+} /* namespace xdata */
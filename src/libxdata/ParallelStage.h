@@ -0,0 +1,149 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_LIBXDATA_PARALLELSTAGE_H_
+#define SRC_LIBXDATA_PARALLELSTAGE_H_
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+
+namespace xdata {
+
+/*
+ * Runs independent jobs on a set of worker threads and merges their
+ * results on the calling thread, strictly in job order.
+ *
+ * The work function of each job must only touch its own staging slot,
+ * the merge function is the only place where shared state such as the
+ * world may be modified. Idle workers take the next unstarted job, so
+ * long jobs like the global apt.dat don't hold up the others. Workers
+ * never run more than a window of jobs ahead of the merge to bound the
+ * memory used by staged results.
+ *
+ * Jobs for which the optional streamed function returns true are merged as
+ * soon as they have started. Their merge function consumes the results while
+ * the work function is still producing them, e.g. through a RecordStream.
+ */
+class ParallelStage {
+public:
+    using Work = std::function<void(size_t)>;
+    using Merge = std::function<void(size_t)>;
+    using Streamed = std::function<bool(size_t)>;
+
+    ParallelStage(size_t window);
+    void run(size_t count, Work work, Merge merge, Streamed streamed = nullptr);
+
+    static size_t getWorkerCount();
+
+private:
+    size_t window;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<bool> started;
+    std::vector<bool> done;
+    std::vector<std::exception_ptr> errors;
+    size_t jobCount = 0;
+    size_t nextJob = 0;
+    size_t mergedJobs = 0;
+    bool aborted = false;
+
+    void workLoop(const Work &work);
+};
+
+/*
+ * Hands records from a worker to the merging thread in chunks. The worker
+ * blocks while too many chunks are waiting, so only a bounded part of a
+ * large file is held in memory.
+ */
+template<typename T>
+class RecordStream {
+public:
+    // worker: throws if the consumer closed the stream
+    void push(T &&record) {
+        pending.push_back(std::move(record));
+        if (pending.size() >= CHUNK_SIZE) {
+            flush();
+        }
+    }
+
+    // worker: must be called when done, also after errors
+    void finish() {
+        try {
+            if (!pending.empty()) {
+                flush();
+            }
+        } catch (const std::exception &e) {
+            // closed, nobody reads the rest
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+        condition.notify_all();
+    }
+
+    // merging thread: returns false once the stream is finished and empty
+    bool pop(std::vector<T> &chunk) {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] () { return finished || !chunks.empty(); });
+        if (chunks.empty()) {
+            return false;
+        }
+        chunk = std::move(chunks.front());
+        chunks.pop_front();
+        condition.notify_all();
+        return true;
+    }
+
+    // merging thread: stop reading and unblock the worker
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        chunks.clear();
+        condition.notify_all();
+    }
+
+private:
+    static constexpr const size_t CHUNK_SIZE = 256;
+    static constexpr const size_t MAX_CHUNKS = 16;
+
+    std::vector<T> pending;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::vector<T>> chunks;
+    bool finished = false;
+    bool closed = false;
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] () { return closed || chunks.size() < MAX_CHUNKS; });
+        if (closed) {
+            throw std::runtime_error("Stream closed");
+        }
+        chunks.push_back(std::move(pending));
+        pending.clear();
+        condition.notify_all();
+    }
+};
+
+} /* namespace xdata */
+
+#endif /* SRC_LIBXDATA_PARALLELSTAGE_H_ */
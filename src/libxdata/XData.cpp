@@ -19,18 +19,55 @@
 #include <thread>
 
 #include "XData.h"
+#include "ParallelStage.h"
+#include "CIFPSource.h"
 #include "loaders/FixLoader.h"
 #include "loaders/NavaidLoader.h"
 #include "loaders/AirwayLoader.h"
 #include "loaders/CIFPLoader.h"
 #include "loaders/MetarLoader.h"
 #include "parsers/CustomSceneryParser.h"
+#include "parsers/AirportParser.h"
+#include "parsers/FixParser.h"
+#include "parsers/NavaidParser.h"
+#include "parsers/AirwayParser.h"
+#include "parsers/CIFPParser.h"
 #include "src/Logger.h"
 
 namespace xdata {
 
-XData::XData(const std::string& dataRootPath):
+// Records of a single nav data file, parsed on a worker thread
+struct StagedFile {
+    enum class Type {
+        CUSTOM_AIRPORTS,
+        AIRPORTS,
+        FIXES,
+        NAVAIDS,
+        AIRWAYS,
+    };
+
+    Type type;
+    std::string path;
+
+    // airports are handed over while the file is still being parsed
+    std::unique_ptr<RecordStream<AirportData>> airportStream;
+    std::vector<FixData> fixes;
+    std::vector<NavaidData> navaids;
+    std::vector<AirwayData> airways;
+    std::exception_ptr error;
+};
+
+namespace {
+
+// Limits the number of airports whose procedures are parsed but not yet merged
+constexpr const size_t CIFP_WINDOW = 1024;
+
+}
+
+XData::XData(const std::string& dataRootPath, const std::string& snapshotFile, bool lazyProcedures):
     xplaneRoot(dataRootPath),
+    snapshotFile(snapshotFile),
+    lazyProcedures(lazyProcedures),
     xworld(std::make_shared<xdata::XWorld>())
 {
     navDataPath = determineNavDataPath();
@@ -44,6 +81,19 @@ std::string XData::determineNavDataPath() {
     }
 }
 
+std::string XData::determineDefaultAptPath() {
+    std::string x11Path = xplaneRoot + "Resources/default scenery/default apt dat/Earth nav data/apt.dat";
+    std::string x12Path = xplaneRoot + "Global Scenery/Global Airports/Earth nav data/apt.dat";
+
+    if (platform::fileExists(x11Path)) {
+        return x11Path;
+    } else if (platform::fileExists(x12Path)) {
+        return x12Path;
+    } else {
+        return "";
+    }
+}
+
 void XData::discoverSceneries() {
     logger::verbose("Discovering user sceneries...");
     try {
@@ -74,16 +124,12 @@ std::shared_ptr<world::World> XData::getWorld() {
 
 void XData::load() {
     auto startAt = std::chrono::steady_clock::now();
-    logger::verbose("Loading airports...");
-    loadAirports();
-    logger::verbose("Loading fixes...");
-    loadFixes();
-    logger::verbose("Loading navaids...");
-    loadNavaids();
-    logger::verbose("Loading airways...");
-    loadAirways();
-    logger::verbose("Loading CIFP...");
-    loadProcedures();
+    if (!loadSnapshot()) {
+        parseNavData();
+    }
+    if (lazyProcedures) {
+        attachProcedureSource();
+    }
     logger::verbose("Attempting to load user fixes...");
     loadUserFixes();
     auto duration = std::chrono::steady_clock::now() - startAt;
@@ -96,62 +142,338 @@ void XData::load() {
     logger::info("Loaded nav data in %.2f seconds", millis / 1000.0f);
 }
 
-void XData::loadAirports() {
-    const AirportLoader loader(shared_from_this());
+std::vector<std::string> XData::getSnapshotSources() {
+    // the order of the custom sceneries matters because the first airport definition wins
+    std::vector<std::string> sources = customSceneries;
+    sources.push_back(determineDefaultAptPath());
+    sources.push_back(navDataPath + "earth_fix.dat");
+    sources.push_back(navDataPath + "earth_nav.dat");
+    sources.push_back(navDataPath + "earth_awy.dat");
+    // the directory changes when procedure files are added or removed. Snapshots taken
+    // while procedures are loaded on demand don't contain any, so they don't depend on it
+    if (!lazyProcedures) {
+        sources.push_back(navDataPath + "CIFP");
+    }
+    return sources;
+}
 
-    loadCustomScenery(loader);
+bool XData::loadSnapshot() {
+    if (snapshotFile.empty()) {
+        return false;
+    }
 
-    logger::verbose("Loading default apt.dat");
+    try {
+        return replaySnapshot();
+    } catch (const std::exception &e) {
+        if (shouldCancelLoading()) {
+            // the loaders stopped the replay, the snapshot itself is fine
+            throw;
+        }
+        logger::warn("Discarding nav data snapshot: %s", e.what());
+    }
 
-    std::string x11Path = xplaneRoot + "Resources/default scenery/default apt dat/Earth nav data/apt.dat";
-    std::string x12Path = xplaneRoot + "Global Scenery/Global Airports/Earth nav data/apt.dat";
+    // a corrupt body is only noticed while replaying, so the world can contain parts of it
+    xworld = std::make_shared<xdata::XWorld>();
+    try {
+        platform::removeFile(snapshotFile);
+    } catch (const std::exception &e) {
+        logger::warn("Couldn't delete nav data snapshot: %s", e.what());
+    }
+    return false;
+}
 
-    if (platform::fileExists(x11Path)) {
-        loader.load(x11Path);
-    } else if (platform::fileExists(x12Path)) {
-        loader.load(x12Path);
-    } else {
-        logger::error("Couldn't find apt.dat");
+bool XData::replaySnapshot() {
+    XDataSnapshot snapshot(snapshotFile);
+    if (!snapshot.open(getSnapshotSources())) {
+        return false;
     }
+
+    logger::verbose("Loading nav data snapshot...");
+
+    const AirportLoader airportLoader(shared_from_this());
+    FixLoader fixLoader(shared_from_this());
+    NavaidLoader navaidLoader(shared_from_this());
+    AirwayLoader airwayLoader(shared_from_this());
+    CIFPLoader cifpLoader(shared_from_this());
+    std::shared_ptr<world::Airport> airport;
+
+    XDataSnapshot::Acceptors acceptors;
+    acceptors.onAirport = [&airportLoader] (const AirportData &data) { airportLoader.accept(data); };
+    acceptors.onFix = [&fixLoader] (const FixData &data) { fixLoader.accept(data); };
+    acceptors.onNavaid = [&navaidLoader] (const NavaidData &data) { navaidLoader.accept(data); };
+    acceptors.onAirway = [&airwayLoader] (const AirwayData &data) { airwayLoader.accept(data); };
+    acceptors.onProcedure = [this, &cifpLoader, &airport] (const std::string &id, const CIFPData &data) {
+        // procedures are stored grouped by airport
+        if (!airport || airport->getID() != id) {
+            airport = xworld->findAirportByID(id);
+        }
+        if (airport) {
+            cifpLoader.accept(airport, data);
+        }
+    };
+    snapshot.replay(acceptors);
+    return true;
 }
 
-void XData::loadCustomScenery(const AirportLoader& loader) {
-    for (auto &aptDatPath: customSceneries) {
+void XData::parseNavData() {
+    std::unique_ptr<XDataSnapshot> snapshot;
+    if (!snapshotFile.empty()) {
         try {
-            logger::info("Loading custom scenery airport for %s", aptDatPath.c_str());
-            loader.load(aptDatPath);
+            snapshot = std::make_unique<XDataSnapshot>(snapshotFile);
+            snapshot->create(getSnapshotSources());
         } catch (const std::exception &e) {
-            logger::warn("Unable to parse custom scenery: %s", e.what());
+            logger::warn("Not creating nav data snapshot: %s", e.what());
+            snapshot.reset();
         }
     }
-}
 
-void XData::loadFixes() {
-    FixLoader loader(shared_from_this());
-    loader.load(navDataPath + "earth_fix.dat");
+    logger::verbose("Loading airports, fixes, navaids and airways...");
+    loadNavFiles(snapshot.get());
+    if (!lazyProcedures) {
+        logger::verbose("Loading CIFP...");
+        loadProcedures(snapshot.get());
+    }
+
+    if (snapshot) {
+        try {
+            snapshot->commit();
+            logger::verbose("Created nav data snapshot %s", snapshotFile.c_str());
+        } catch (const std::exception &e) {
+            logger::warn("Couldn't save nav data snapshot: %s", e.what());
+        }
+    }
 }
 
-void XData::loadNavaids() {
-    NavaidLoader loader(shared_from_this());
-    loader.load(navDataPath + "earth_nav.dat");
+void XData::loadNavFiles(XDataSnapshot *snapshot) {
+    // merge order matters: custom sceneries first because the first airport definition wins,
+    // airways last because they reference fixes and navaids
+    std::vector<StagedFile> files;
+    for (auto &aptDatPath: customSceneries) {
+        files.push_back(StagedFile{StagedFile::Type::CUSTOM_AIRPORTS, aptDatPath});
+        files.back().airportStream = std::make_unique<RecordStream<AirportData>>();
+    }
+
+    std::string aptPath = determineDefaultAptPath();
+    if (!aptPath.empty()) {
+        files.push_back(StagedFile{StagedFile::Type::AIRPORTS, aptPath});
+        files.back().airportStream = std::make_unique<RecordStream<AirportData>>();
+    } else {
+        logger::error("Couldn't find apt.dat");
+    }
+
+    files.push_back(StagedFile{StagedFile::Type::FIXES, navDataPath + "earth_fix.dat"});
+    files.push_back(StagedFile{StagedFile::Type::NAVAIDS, navDataPath + "earth_nav.dat"});
+    files.push_back(StagedFile{StagedFile::Type::AIRWAYS, navDataPath + "earth_awy.dat"});
+
+    AirportLoader airportLoader(shared_from_this());
+    FixLoader fixLoader(shared_from_this());
+    NavaidLoader navaidLoader(shared_from_this());
+    AirwayLoader airwayLoader(shared_from_this());
+
+    if (snapshot) {
+        airportLoader.setRecorder([snapshot] (const AirportData &data) { snapshot->record(data); });
+        fixLoader.setRecorder([snapshot] (const FixData &data) { snapshot->record(data); });
+        navaidLoader.setRecorder([snapshot] (const NavaidData &data) { snapshot->record(data); });
+        airwayLoader.setRecorder([snapshot] (const AirwayData &data) { snapshot->record(data); });
+    }
+
+    auto stageFile = [this, &files] (size_t i) {
+        parseNavFile(files[i]);
+    };
+
+    auto acceptAirports = [&airportLoader] (StagedFile &file) {
+        std::vector<AirportData> chunk;
+        while (file.airportStream->pop(chunk)) {
+            for (auto &data: chunk) {
+                airportLoader.accept(data);
+            }
+        }
+        if (file.error) {
+            std::rethrow_exception(file.error);
+        }
+    };
+
+    auto closeStreams = [&files] () {
+        // releases workers that are blocked on a full stream
+        for (auto &file: files) {
+            if (file.airportStream) {
+                file.airportStream->close();
+            }
+        }
+    };
+
+    auto mergeFile = [&] (size_t i) {
+        switch (files[i].type) {
+        case StagedFile::Type::CUSTOM_AIRPORTS:
+            try {
+                logger::info("Loading custom scenery airport for %s", files[i].path.c_str());
+                acceptAirports(files[i]);
+            } catch (const std::exception &e) {
+                files[i].airportStream->close();
+                logger::warn("Unable to parse custom scenery: %s", e.what());
+            }
+            return;
+        case StagedFile::Type::AIRPORTS:
+            logger::verbose("Loading default apt.dat");
+            try {
+                acceptAirports(files[i]);
+            } catch (...) {
+                closeStreams();
+                throw;
+            }
+            return;
+        default:
+            break;
+        }
+
+        StagedFile file = std::move(files[i]);
+
+        switch (file.type) {
+        case StagedFile::Type::FIXES:
+            for (auto &data: file.fixes) {
+                fixLoader.accept(data);
+            }
+            break;
+        case StagedFile::Type::NAVAIDS:
+            for (auto &data: file.navaids) {
+                navaidLoader.accept(data);
+            }
+            break;
+        case StagedFile::Type::AIRWAYS:
+            for (auto &data: file.airways) {
+                airwayLoader.accept(data);
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (file.error) {
+            std::rethrow_exception(file.error);
+        }
+    };
+
+    auto isStreamed = [&files] (size_t i) {
+        return files[i].airportStream != nullptr;
+    };
+
+    ParallelStage stage(files.size());
+    stage.run(files.size(), stageFile, mergeFile, isStreamed);
 }
 
-void XData::loadAirways() {
-    AirwayLoader loader(shared_from_this());
-    loader.load(navDataPath + "earth_awy.dat");
+void XData::parseNavFile(StagedFile &file) {
+    // runs on a worker thread, so it must not touch the world
+    auto checkCancel = [this] () {
+        if (shouldCancelLoading()) {
+            throw std::runtime_error("Cancelled");
+        }
+    };
+
+    try {
+        switch (file.type) {
+        case StagedFile::Type::CUSTOM_AIRPORTS:
+        case StagedFile::Type::AIRPORTS: {
+            AirportParser parser(file.path);
+            parser.setAcceptor([&file, &checkCancel] (const AirportData &data) {
+                file.airportStream->push(AirportData(data));
+                checkCancel();
+            });
+            parser.loadAirports();
+            break;
+        }
+        case StagedFile::Type::FIXES: {
+            FixParser parser(file.path);
+            parser.setAcceptor([&file, &checkCancel] (const FixData &data) {
+                file.fixes.push_back(data);
+                checkCancel();
+            });
+            parser.loadFixes();
+            break;
+        }
+        case StagedFile::Type::NAVAIDS: {
+            NavaidParser parser(file.path);
+            parser.setAcceptor([&file, &checkCancel] (const NavaidData &data) {
+                file.navaids.push_back(data);
+                checkCancel();
+            });
+            parser.loadNavaids();
+            break;
+        }
+        case StagedFile::Type::AIRWAYS: {
+            AirwayParser parser(file.path);
+            parser.setAcceptor([&file, &checkCancel] (const AirwayData &data) {
+                file.airways.push_back(data);
+                checkCancel();
+            });
+            parser.loadAirways();
+            break;
+        }
+        }
+    } catch (...) {
+        // records parsed before the error are still merged, like when loading sequentially
+        file.error = std::current_exception();
+    }
+
+    if (file.airportStream) {
+        file.airportStream->finish();
+    }
 }
 
-void XData::loadProcedures() {
+void XData::loadProcedures(XDataSnapshot *snapshot) {
+    std::vector<std::shared_ptr<world::Airport>> airports;
+    std::vector<std::string> paths;
+    xworld->forEachAirport([this, &airports, &paths] (std::shared_ptr<world::Airport> ap) {
+        airports.push_back(ap);
+        paths.push_back(navDataPath + "CIFP/" + ap->getID() + ".dat");
+    });
+
     CIFPLoader loader(shared_from_this());
-    xworld->forEachAirport([this, &loader] (std::shared_ptr<world::Airport> ap) {
+    if (snapshot) {
+        loader.setRecorder([snapshot] (std::shared_ptr<world::Airport> ap, const CIFPData &data) {
+            snapshot->record(ap->getID(), data);
+        });
+    }
+
+    std::vector<std::vector<CIFPData>> staged(airports.size());
+
+    auto stageAirport = [this, &paths, &staged] (size_t i) {
+        if (shouldCancelLoading()) {
+            throw std::runtime_error("Cancelled");
+        }
+
         try {
-            loader.load(ap, navDataPath + "CIFP/" + ap->getID() + ".dat");
+            CIFPParser parser(paths[i]);
+            parser.setAcceptor([&staged, i] (const CIFPData &data) {
+                staged[i].push_back(data);
+            });
+            parser.loadCIFP();
         } catch (const std::exception &e) {
             // many airports do not have CIFP data, so ignore silently
         }
-        if (shouldCancelLoading()) {
-            throw std::runtime_error("Cancelled");
+    };
+
+    auto mergeAirport = [this, &airports, &paths, &staged, &loader, snapshot] (size_t i) {
+        std::vector<CIFPData> procedures = std::move(staged[i]);
+
+        // only files that actually contain procedures are tracked as snapshot sources
+        if (snapshot && !procedures.empty()) {
+            snapshot->addSource(paths[i]);
+        }
+
+        for (auto &procedure: procedures) {
+            loader.accept(airports[i], procedure);
         }
+    };
+
+    ParallelStage stage(CIFP_WINDOW);
+    stage.run(airports.size(), stageAirport, mergeAirport);
+}
+
+void XData::attachProcedureSource() {
+    logger::verbose("Procedures will be loaded on demand");
+    auto source = std::make_shared<CIFPSource>(shared_from_this(), navDataPath + "CIFP/");
+    xworld->forEachAirport([&source] (std::shared_ptr<world::Airport> ap) {
+        ap->setProcedureSource(source);
     });
 }
 
@@ -24,12 +24,15 @@
 #include "src/world/LoadManager.h"
 #include "src/libxdata/XWorld.h"
 #include "src/libxdata/loaders/AirportLoader.h"
+#include "src/libxdata/XDataSnapshot.h"
 
 namespace xdata {
 
+struct StagedFile;
+
 class XData : public world::LoadManager {
 public:
-    XData(const std::string &dataRootPath);
+    XData(const std::string &dataRootPath, const std::string &snapshotFile, bool lazyProcedures = false);
     virtual ~XData() = default;
     std::shared_ptr<world::World> getWorld() override;
     void discoverSceneries() override;
@@ -38,19 +41,24 @@ public:
 private:
     std::string xplaneRoot;
     std::string navDataPath;
+    std::string snapshotFile;
+    bool lazyProcedures;
     std::shared_ptr<xdata::XWorld> xworld;
     std::vector<std::string> customSceneries;
     std::string userFixesFilename;
 
     std::string determineNavDataPath();
+    std::string determineDefaultAptPath();
+    std::vector<std::string> getSnapshotSources();
 
-    void loadAirports();
-    void loadFixes();
-    void loadNavaids();
-    void loadAirways();
-    void loadProcedures();
+    bool loadSnapshot();
+    bool replaySnapshot();
+    void parseNavData();
+    void loadNavFiles(XDataSnapshot *snapshot);
+    void parseNavFile(StagedFile &file);
+    void loadProcedures(XDataSnapshot *snapshot);
+    void attachProcedureSource();
     void loadMetar();
-    void loadCustomScenery(const AirportLoader& loader);
 
 };
 
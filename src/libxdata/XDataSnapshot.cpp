@@ -0,0 +1,609 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstring>
+#include <stdexcept>
+#include "XDataSnapshot.h"
+#include "src/Logger.h"
+
+namespace xdata {
+
+namespace {
+// magic, version, offset of the source table, length of the record body
+constexpr const uint64_t HEADER_SIZE = 4 + 4 + 8 + 8;
+}
+
+XDataSnapshot::XDataSnapshot(const std::string& utf8Path):
+    path(utf8Path)
+{
+}
+
+XDataSnapshot::~XDataSnapshot() {
+    if (writing) {
+        discard();
+    }
+}
+
+XDataSnapshot::Source XDataSnapshot::statSource(const std::string& utf8Path) {
+    Source src;
+    src.path = utf8Path;
+
+    std::error_code ec;
+    auto p = fs::u8path(utf8Path);
+    if (fs::is_directory(p, ec)) {
+        src.size = 0;
+    } else {
+        auto size = fs::file_size(p, ec);
+        if (ec) {
+            return src;
+        }
+        src.size = (int64_t) size;
+    }
+
+    auto modified = fs::last_write_time(p, ec);
+    if (ec) {
+        src.size = -1;
+        return src;
+    }
+    src.modified = (int64_t) modified.time_since_epoch().count();
+    return src;
+}
+
+bool XDataSnapshot::open(const std::vector<std::string>& primarySources) {
+    if (!platform::fileExists(path)) {
+        return false;
+    }
+
+    try {
+        file.open(fs::u8path(path), std::ios::in | std::ios::binary);
+        if (!file) {
+            return false;
+        }
+
+        uint64_t sourcesOffset = 0;
+        if (!readHeader(sourcesOffset)) {
+            logger::info("Nav data snapshot has an incompatible format");
+            file.close();
+            return false;
+        }
+
+        file.seekg(sourcesOffset);
+        buffer.resize(BUFFER_SIZE);
+        bufferPos = bufferFill = 0;
+
+        primaryCount = readU32();
+        uint32_t count = readU32();
+        sources.clear();
+        sources.reserve(count);
+        for (uint32_t i = 0; i < count; i++) {
+            Source src;
+            src.path = readString();
+            src.size = (int64_t) readU64();
+            src.modified = (int64_t) readU64();
+            sources.push_back(src);
+        }
+    } catch (const std::exception &e) {
+        logger::warn("Nav data snapshot is damaged: %s", e.what());
+        file.close();
+        return false;
+    }
+
+    if (primaryCount != primarySources.size() || primaryCount > sources.size()) {
+        logger::info("Nav data sources changed, snapshot is stale");
+        file.close();
+        return false;
+    }
+
+    for (size_t i = 0; i < primaryCount; i++) {
+        if (sources[i].path != primarySources[i]) {
+            logger::info("Nav data source %s changed, snapshot is stale", primarySources[i].c_str());
+            file.close();
+            return false;
+        }
+    }
+
+    for (auto &src: sources) {
+        Source current = statSource(src.path);
+        if (current.size != src.size || current.modified != src.modified) {
+            logger::info("Nav data source %s changed, snapshot is stale", src.path.c_str());
+            file.close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void XDataSnapshot::replay(const Acceptors& acceptors) {
+    file.clear();
+    file.seekg(HEADER_SIZE);
+    bufferPos = bufferFill = 0;
+
+    while (true) {
+        RecordType type = (RecordType) readU8();
+        switch (type) {
+        case RecordType::END:
+            file.close();
+            return;
+        case RecordType::AIRPORT:
+            acceptors.onAirport(readAirport());
+            break;
+        case RecordType::FIX:
+            acceptors.onFix(readFix());
+            break;
+        case RecordType::NAVAID:
+            acceptors.onNavaid(readNavaid());
+            break;
+        case RecordType::AIRWAY:
+            acceptors.onAirway(readAirway());
+            break;
+        case RecordType::PROCEDURE: {
+            std::string airportId = readString();
+            acceptors.onProcedure(airportId, readProcedure());
+            break;
+        }
+        default:
+            throw std::runtime_error("Invalid record in nav data snapshot");
+        }
+    }
+}
+
+void XDataSnapshot::create(const std::vector<std::string>& primarySources) {
+    sources.clear();
+    for (auto &src: primarySources) {
+        sources.push_back(statSource(src));
+    }
+    primaryCount = sources.size();
+
+    platform::mkpath(platform::getDirNameFromPath(path));
+    file.open(fs::u8path(path + ".tmp"), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Couldn't create nav data snapshot");
+    }
+
+    buffer.clear();
+    buffer.reserve(BUFFER_SIZE);
+    bodyLength = 0;
+    writing = true;
+
+    // placeholder, the real header is written when committing
+    writeHeader();
+}
+
+void XDataSnapshot::addSource(const std::string& utf8Path) {
+    sources.push_back(statSource(utf8Path));
+}
+
+void XDataSnapshot::commit() {
+    writeU8((uint8_t) RecordType::END);
+    flush();
+    bodyLength = (uint64_t) file.tellp() - HEADER_SIZE;
+
+    writeSources();
+    flush();
+
+    file.seekp(0);
+    writeHeader();
+    file.close();
+    writing = false;
+
+    if (file.fail()) {
+        platform::removeFile(path + ".tmp");
+        throw std::runtime_error("Couldn't write nav data snapshot");
+    }
+
+    std::error_code ec;
+    fs::rename(fs::u8path(path + ".tmp"), fs::u8path(path), ec);
+    if (ec) {
+        platform::removeFile(path + ".tmp");
+        throw std::runtime_error("Couldn't replace nav data snapshot: " + ec.message());
+    }
+}
+
+void XDataSnapshot::discard() {
+    file.close();
+    writing = false;
+    std::error_code ec;
+    fs::remove(fs::u8path(path + ".tmp"), ec);
+}
+
+void XDataSnapshot::writeHeader() {
+    uint64_t sourcesOffset = HEADER_SIZE + bodyLength;
+    file.write(reinterpret_cast<const char *>(&MAGIC), sizeof(MAGIC));
+    file.write(reinterpret_cast<const char *>(&VERSION), sizeof(VERSION));
+    file.write(reinterpret_cast<const char *>(&sourcesOffset), sizeof(sourcesOffset));
+    file.write(reinterpret_cast<const char *>(&bodyLength), sizeof(bodyLength));
+}
+
+bool XDataSnapshot::readHeader(uint64_t& sourcesOffset) {
+    uint32_t magic = 0, version = 0;
+    file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    file.read(reinterpret_cast<char *>(&sourcesOffset), sizeof(sourcesOffset));
+    file.read(reinterpret_cast<char *>(&bodyLength), sizeof(bodyLength));
+    if (!file || magic != MAGIC || version != VERSION) {
+        return false;
+    }
+    return sourcesOffset == HEADER_SIZE + bodyLength;
+}
+
+void XDataSnapshot::writeSources() {
+    writeU32((uint32_t) primaryCount);
+    writeU32((uint32_t) sources.size());
+    for (auto &src: sources) {
+        writeString(src.path);
+        writeU64((uint64_t) src.size);
+        writeU64((uint64_t) src.modified);
+    }
+}
+
+void XDataSnapshot::record(const AirportData& airport) {
+    writeU8((uint8_t) RecordType::AIRPORT);
+    writeString(airport.id);
+    writeString(airport.name);
+    writeI32(airport.elevation);
+    writeString(airport.icaoCode);
+    writeF64(airport.latitude);
+    writeF64(airport.longitude);
+    writeString(airport.region);
+    writeString(airport.country);
+
+    writeU32((uint32_t) airport.frequencies.size());
+    for (auto &frq: airport.frequencies) {
+        writeI32(frq.code);
+        writeString(frq.desc);
+        writeI32(frq.frq);
+    }
+
+    writeU32((uint32_t) airport.runways.size());
+    for (auto &rwy: airport.runways) {
+        writeF32(rwy.width);
+        writeI32((int32_t) rwy.surfaceTypeCode);
+        writeU32((uint32_t) rwy.ends.size());
+        for (auto &end: rwy.ends) {
+            writeString(end.name);
+            writeF64(end.latitude);
+            writeF64(end.longitude);
+            writeF32(end.displace);
+        }
+    }
+
+    writeU32((uint32_t) airport.heliports.size());
+    for (auto &heli: airport.heliports) {
+        writeString(heli.name);
+        writeF64(heli.latitude);
+        writeF64(heli.longitude);
+        writeI32((int32_t) heli.surfaceTypeCode);
+    }
+}
+
+AirportData XDataSnapshot::readAirport() {
+    AirportData airport;
+    airport.id = readString();
+    airport.name = readString();
+    airport.elevation = readI32();
+    airport.icaoCode = readString();
+    airport.latitude = readF64();
+    airport.longitude = readF64();
+    airport.region = readString();
+    airport.country = readString();
+
+    airport.frequencies.resize(readU32());
+    for (auto &frq: airport.frequencies) {
+        frq.code = readI32();
+        frq.desc = readString();
+        frq.frq = readI32();
+    }
+
+    airport.runways.resize(readU32());
+    for (auto &rwy: airport.runways) {
+        rwy.width = readF32();
+        rwy.surfaceTypeCode = (AirportData::SurfaceCode) readI32();
+        rwy.ends.resize(readU32());
+        for (auto &end: rwy.ends) {
+            end.name = readString();
+            end.latitude = readF64();
+            end.longitude = readF64();
+            end.displace = readF32();
+        }
+    }
+
+    airport.heliports.resize(readU32());
+    for (auto &heli: airport.heliports) {
+        heli.name = readString();
+        heli.latitude = readF64();
+        heli.longitude = readF64();
+        heli.surfaceTypeCode = (AirportData::SurfaceCode) readI32();
+    }
+    return airport;
+}
+
+void XDataSnapshot::record(const FixData& fix) {
+    writeU8((uint8_t) RecordType::FIX);
+    writeString(fix.id);
+    writeF64(fix.latitude);
+    writeF64(fix.longitude);
+    writeString(fix.terminalAreaId);
+    writeString(fix.icaoRegion);
+    writeU8((uint8_t) fix.col27);
+    writeU8((uint8_t) fix.col28);
+    writeU8((uint8_t) fix.col29);
+}
+
+FixData XDataSnapshot::readFix() {
+    FixData fix;
+    fix.id = readString();
+    fix.latitude = readF64();
+    fix.longitude = readF64();
+    fix.terminalAreaId = readString();
+    fix.icaoRegion = readString();
+    fix.col27 = (char) readU8();
+    fix.col28 = (char) readU8();
+    fix.col29 = (char) readU8();
+    return fix;
+}
+
+void XDataSnapshot::record(const NavaidData& navaid) {
+    writeU8((uint8_t) RecordType::NAVAID);
+    writeI32((int32_t) navaid.type);
+    writeF64(navaid.latitude);
+    writeF64(navaid.longitude);
+    writeI32(navaid.elevation);
+    writeI32(navaid.radio);
+    writeI32(navaid.range);
+    writeF64(navaid.bearing);
+    writeF64(navaid.bearingMagnetic);
+    writeString(navaid.id);
+    writeString(navaid.terminalRegion);
+    writeString(navaid.icaoRegion);
+    writeString(navaid.name);
+}
+
+NavaidData XDataSnapshot::readNavaid() {
+    NavaidData navaid;
+    navaid.type = (NavaidData::Type) readI32();
+    navaid.latitude = readF64();
+    navaid.longitude = readF64();
+    navaid.elevation = readI32();
+    navaid.radio = readI32();
+    navaid.range = readI32();
+    navaid.bearing = readF64();
+    navaid.bearingMagnetic = readF64();
+    navaid.id = readString();
+    navaid.terminalRegion = readString();
+    navaid.icaoRegion = readString();
+    navaid.name = readString();
+    return navaid;
+}
+
+void XDataSnapshot::record(const AirwayData& airway) {
+    writeU8((uint8_t) RecordType::AIRWAY);
+    writeString(airway.beginID);
+    writeString(airway.beginIcaoRegion);
+    writeI32((int32_t) airway.beginType);
+    writeString(airway.endID);
+    writeString(airway.endIcaoRegion);
+    writeI32((int32_t) airway.endType);
+    writeI32((int32_t) airway.dirRestriction);
+    writeI32((int32_t) airway.level);
+    writeI32(airway.base);
+    writeI32(airway.top);
+    writeString(airway.name);
+}
+
+AirwayData XDataSnapshot::readAirway() {
+    AirwayData airway;
+    airway.beginID = readString();
+    airway.beginIcaoRegion = readString();
+    airway.beginType = (AirwayData::NavType) readI32();
+    airway.endID = readString();
+    airway.endIcaoRegion = readString();
+    airway.endType = (AirwayData::NavType) readI32();
+    airway.dirRestriction = (AirwayData::DirectionRestriction) readI32();
+    airway.level = (AirwayData::AltitudeLevel) readI32();
+    airway.base = readI32();
+    airway.top = readI32();
+    airway.name = readString();
+    return airway;
+}
+
+void XDataSnapshot::record(const std::string& airportId, const CIFPData& procedure) {
+    writeU8((uint8_t) RecordType::PROCEDURE);
+    writeString(airportId);
+    writeI32((int32_t) procedure.type);
+    writeString(procedure.id);
+    writeFixMap(procedure.runwayTransitions);
+    writeFixMap(procedure.commonRoutes);
+    writeFixMap(procedure.enrouteTransitions);
+    writeFixMap(procedure.approachTransitions);
+    writeFixes(procedure.approach);
+    writeI32(procedure.rwyInfo.elevation);
+    writeI32(procedure.rwyInfo.ilsCategory);
+}
+
+CIFPData XDataSnapshot::readProcedure() {
+    CIFPData procedure;
+    procedure.type = (CIFPData::ProcedureType) readI32();
+    procedure.id = readString();
+    readFixMap(procedure.runwayTransitions);
+    readFixMap(procedure.commonRoutes);
+    readFixMap(procedure.enrouteTransitions);
+    readFixMap(procedure.approachTransitions);
+    procedure.approach = readFixes();
+    procedure.rwyInfo.elevation = readI32();
+    procedure.rwyInfo.ilsCategory = readI32();
+    return procedure;
+}
+
+void XDataSnapshot::writeFixes(const std::vector<CIFPData::FixInRegion>& fixes) {
+    writeU32((uint32_t) fixes.size());
+    for (auto &fix: fixes) {
+        writeString(fix.id);
+        writeString(fix.region);
+        writeString(fix.sectionCode);
+        writeString(fix.subSectionCode);
+    }
+}
+
+std::vector<CIFPData::FixInRegion> XDataSnapshot::readFixes() {
+    std::vector<CIFPData::FixInRegion> fixes(readU32());
+    for (auto &fix: fixes) {
+        fix.id = readString();
+        fix.region = readString();
+        fix.sectionCode = readString();
+        fix.subSectionCode = readString();
+    }
+    return fixes;
+}
+
+template<typename T>
+void XDataSnapshot::writeFixMap(const std::map<std::string, T>& routes) {
+    writeU32((uint32_t) routes.size());
+    for (auto &it: routes) {
+        writeString(it.first);
+        writeFixes(it.second.fixes);
+    }
+}
+
+template<typename T>
+void XDataSnapshot::readFixMap(std::map<std::string, T>& routes) {
+    uint32_t count = readU32();
+    for (uint32_t i = 0; i < count; i++) {
+        std::string key = readString();
+        routes[key].fixes = readFixes();
+    }
+}
+
+void XDataSnapshot::flush() {
+    if (!buffer.empty()) {
+        file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+        buffer.clear();
+    }
+}
+
+void XDataSnapshot::writeBytes(const void* data, size_t len) {
+    auto bytes = reinterpret_cast<const uint8_t *>(data);
+    buffer.insert(buffer.end(), bytes, bytes + len);
+    if (buffer.size() >= BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void XDataSnapshot::writeU8(uint8_t v) {
+    writeBytes(&v, sizeof(v));
+}
+
+void XDataSnapshot::writeI32(int32_t v) {
+    writeBytes(&v, sizeof(v));
+}
+
+void XDataSnapshot::writeU32(uint32_t v) {
+    writeBytes(&v, sizeof(v));
+}
+
+void XDataSnapshot::writeU64(uint64_t v) {
+    writeBytes(&v, sizeof(v));
+}
+
+void XDataSnapshot::writeF32(float v) {
+    writeBytes(&v, sizeof(v));
+}
+
+void XDataSnapshot::writeF64(double v) {
+    writeBytes(&v, sizeof(v));
+}
+
+void XDataSnapshot::writeString(const std::string& s) {
+    writeU32((uint32_t) s.size());
+    writeBytes(s.data(), s.size());
+}
+
+void XDataSnapshot::fill() {
+    size_t remaining = bufferFill - bufferPos;
+    std::memmove(buffer.data(), buffer.data() + bufferPos, remaining);
+    file.read(reinterpret_cast<char *>(buffer.data() + remaining), buffer.size() - remaining);
+    bufferFill = remaining + (size_t) file.gcount();
+    bufferPos = 0;
+    if (file.eof()) {
+        file.clear();
+    }
+}
+
+void XDataSnapshot::readBytes(void* data, size_t len) {
+    auto out = reinterpret_cast<uint8_t *>(data);
+    while (len > 0) {
+        if (bufferPos == bufferFill) {
+            fill();
+            if (bufferFill == 0) {
+                throw std::runtime_error("Unexpected end of nav data snapshot");
+            }
+        }
+        size_t n = std::min(len, bufferFill - bufferPos);
+        std::memcpy(out, buffer.data() + bufferPos, n);
+        bufferPos += n;
+        out += n;
+        len -= n;
+    }
+}
+
+uint8_t XDataSnapshot::readU8() {
+    uint8_t v;
+    readBytes(&v, sizeof(v));
+    return v;
+}
+
+int32_t XDataSnapshot::readI32() {
+    int32_t v;
+    readBytes(&v, sizeof(v));
+    return v;
+}
+
+uint32_t XDataSnapshot::readU32() {
+    uint32_t v;
+    readBytes(&v, sizeof(v));
+    return v;
+}
+
+uint64_t XDataSnapshot::readU64() {
+    uint64_t v;
+    readBytes(&v, sizeof(v));
+    return v;
+}
+
+float XDataSnapshot::readF32() {
+    float v;
+    readBytes(&v, sizeof(v));
+    return v;
+}
+
+double XDataSnapshot::readF64() {
+    double v;
+    readBytes(&v, sizeof(v));
+    return v;
+}
+
+std::string XDataSnapshot::readString() {
+    uint32_t len = readU32();
+    if (len > bodyLength) {
+        throw std::runtime_error("Invalid string in nav data snapshot");
+    }
+    std::string s(len, '\0');
+    readBytes(&s[0], len);
+    return s;
+}
+
+} /* namespace xdata */
@@ -0,0 +1,147 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_LIBXDATA_XDATASNAPSHOT_H_
+#define SRC_LIBXDATA_XDATASNAPSHOT_H_
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include "src/platform/Platform.h"
+#include "parsers/objects/AirportData.h"
+#include "parsers/objects/FixData.h"
+#include "parsers/objects/NavaidData.h"
+#include "parsers/objects/AirwayData.h"
+#include "parsers/objects/CIFPData.h"
+
+namespace xdata {
+
+/*
+ * Binary snapshot of the records produced by the nav data parsers.
+ *
+ * The records are stored in the order they were passed to the loaders, so
+ * replaying them through the same loaders builds the same world without
+ * parsing the text files again. A snapshot is only used if all of the source
+ * files it was created from still have the same size and modification time
+ * and if the list of primary sources (e.g. the scenery_packs.ini order) is
+ * unchanged.
+ *
+ * The file is a flat sequence of length-prefixed records without any
+ * pointers or padding and is read sequentially through a large buffer.
+ */
+class XDataSnapshot {
+public:
+    struct Acceptors {
+        std::function<void(const AirportData &)> onAirport;
+        std::function<void(const FixData &)> onFix;
+        std::function<void(const NavaidData &)> onNavaid;
+        std::function<void(const AirwayData &)> onAirway;
+        std::function<void(const std::string &, const CIFPData &)> onProcedure;
+    };
+
+    XDataSnapshot(const std::string &utf8Path);
+    ~XDataSnapshot();
+
+    // Reading: returns false if the snapshot doesn't exist or is stale
+    bool open(const std::vector<std::string> &primarySources);
+    void replay(const Acceptors &acceptors);
+
+    // Writing: the file is only replaced once commit() is called
+    void create(const std::vector<std::string> &primarySources);
+    void addSource(const std::string &utf8Path);
+    void record(const AirportData &airport);
+    void record(const FixData &fix);
+    void record(const NavaidData &navaid);
+    void record(const AirwayData &airway);
+    void record(const std::string &airportId, const CIFPData &procedure);
+    void commit();
+    void discard();
+
+private:
+    static constexpr const uint32_t MAGIC = 0x53584156; // "VAXS"
+    static constexpr const uint32_t VERSION = 1;
+    static constexpr const size_t BUFFER_SIZE = 1024 * 1024;
+
+    enum class RecordType: uint8_t {
+        END = 0,
+        AIRPORT = 1,
+        FIX = 2,
+        NAVAID = 3,
+        AIRWAY = 4,
+        PROCEDURE = 5,
+    };
+
+    struct Source {
+        std::string path;
+        int64_t size = -1;
+        int64_t modified = -1;
+    };
+
+    std::string path;
+    std::vector<Source> sources;
+    size_t primaryCount = 0;
+
+    fs::fstream file;
+    std::vector<uint8_t> buffer;
+    size_t bufferPos = 0;
+    size_t bufferFill = 0;
+    uint64_t bodyLength = 0;
+    bool writing = false;
+
+    static Source statSource(const std::string &utf8Path);
+
+    void flush();
+    void writeBytes(const void *data, size_t len);
+    void writeU8(uint8_t v);
+    void writeI32(int32_t v);
+    void writeU32(uint32_t v);
+    void writeU64(uint64_t v);
+    void writeF32(float v);
+    void writeF64(double v);
+    void writeString(const std::string &s);
+    void writeFixes(const std::vector<CIFPData::FixInRegion> &fixes);
+    template<typename T>
+    void writeFixMap(const std::map<std::string, T> &routes);
+
+    void fill();
+    void readBytes(void *data, size_t len);
+    uint8_t readU8();
+    int32_t readI32();
+    uint32_t readU32();
+    uint64_t readU64();
+    float readF32();
+    double readF64();
+    std::string readString();
+    std::vector<CIFPData::FixInRegion> readFixes();
+    template<typename T>
+    void readFixMap(std::map<std::string, T> &routes);
+
+    AirportData readAirport();
+    FixData readFix();
+    NavaidData readNavaid();
+    AirwayData readAirway();
+    CIFPData readProcedure();
+
+    void writeHeader();
+    void writeSources();
+    bool readHeader(uint64_t &sourcesOffset);
+};
+
+} /* namespace xdata */
+
+#endif /* SRC_LIBXDATA_XDATASNAPSHOT_H_ */
@@ -44,38 +44,22 @@ std::shared_ptr<world::Airport> XWorld::findAirportByID(const std::string& id) c
 }
 
 std::vector<std::shared_ptr<world::Airport>> XWorld::findAirport(const std::string& keyWord) const {
-    std::vector<std::shared_ptr<world::Airport>> res;
-
-    std::string key = platform::lower(keyWord);
-
-    auto directfind = findAirportByID(key);
-    if (directfind) {
-        res.push_back(directfind);
-    }
-
-    for (auto &it: airports) {
-        if (platform::lower(it.second->getName()).find(key) != std::string::npos) {
-            res.push_back(it.second);
-            if (res.size() >= MAX_SEARCH_RESULTS) {
-                break;
-            }
-        }
-    }
-
-    return res;
+    return airportIndex.find(keyWord, MAX_SEARCH_RESULTS);
 }
 
 std::shared_ptr<world::Fix> XWorld::findFixByRegionAndID(const std::string& region, const std::string& id) const {
-    auto range = fixes.equal_range(id);
+    return findFix(identifiers.find(region), id);
+}
 
-    for (auto it = range.first; it != range.second; ++it) {
-        auto r = it->second->getRegion();
-        if (r && (r->getId() == region)) {
-            return it->second;
-        }
+std::shared_ptr<world::Fix> XWorld::findFix(uint32_t region, const std::string& id) const {
+    if (region == IdentifierPool::NONE) {
+        return nullptr;
     }
-
-    return nullptr;
+    uint32_t ident = identifiers.find(id);
+    if (ident == IdentifierPool::NONE) {
+        return nullptr;
+    }
+    return fixTable.find(IdentifierTable<world::Fix>::makeKey(region, ident));
 }
 
 void XWorld::forEachAirport(std::function<void(std::shared_ptr<world::Airport>)> f) {
@@ -105,26 +89,18 @@ std::shared_ptr<world::Airport> XWorld::findOrCreateAirport(const std::string& i
 }
 
 std::shared_ptr<world::Airway> XWorld::findOrCreateAirway(const std::string& name, world::AirwayLevel lvl) {
-    auto range = airways.equal_range(name);
-
-    for (auto it = range.first; it != range.second; ++it) {
-        if (it->second->getLevel() == lvl) {
-            return it->second;
-        }
+    auto key = IdentifierTable<world::Airway>::makeKey(identifiers.intern(name), (uint32_t) lvl);
+    auto awy = airwayTable.find(key);
+    if (awy) {
+        return awy;
     }
 
     // not found -> insert
-    auto awy = std::make_shared<world::Airway>(name, lvl);
-    airways.insert(std::make_pair(name, awy));
-    return awy;
+    return airwayTable.insert(key, std::make_shared<world::Airway>(name, lvl));
 }
 
-std::vector<world::World::Connection> &XWorld::getConnections(std::shared_ptr<world::NavNode> from) {
-    auto iter = connections.find(from);
-    if (iter != connections.end()) {
-        return iter->second;
-    }
-    return noConnection;
+world::World::ConnectionRange XWorld::getConnections(std::shared_ptr<world::NavNode> from) {
+    return connections.find(from.get());
 }
 
 bool XWorld::areConnected(std::shared_ptr<world::NavNode> from, const std::shared_ptr<world::NavNode> to) {
@@ -149,17 +125,18 @@ std::shared_ptr<world::Region> XWorld::getRegion(const std::string &id) {
 }
 
 void XWorld::connectTo(std::shared_ptr<world::NavNode> from, std::shared_ptr<world::NavEdge> via, std::shared_ptr<world::NavNode> to) {
-    auto iter = connections.find(from);
-    if (iter == connections.end()) {
-        connections[from] = std::vector<world::World::Connection>();
-        iter = connections.find(from);
-    }
-    (iter->second).push_back(std::make_pair(via, to));
+    connections.add(from, via, to);
 }
 
 void XWorld::addFix(std::shared_ptr<world::Fix> fix) {
     fix->setGlobal(true);
-    fixes.insert(std::make_pair(fix->getID(), fix));
+    fixes.push_back(fix);
+    // the first fix with a region and ID is the one that's found
+    auto region = fix->getRegion();
+    if (region) {
+        auto key = IdentifierTable<world::Fix>::makeKey(identifiers.intern(region->getId()), identifiers.intern(fix->getID()));
+        fixTable.insert(key, fix);
+    }
     // fixes may be added after the initial loading of the NAV world.
     // if so, register the node independently here
     if (allNodesRegistered) {
@@ -173,91 +150,44 @@ std::shared_ptr<world::RouteFinder> XWorld::getRouteFinder() {
 
 void XWorld::registerNavNodes() {
     if (allNodesRegistered) return;
-    for (auto it: airports) {
-        registerNode(it.second);
+    std::vector<std::shared_ptr<world::NavNode>> nodes;
+    nodes.reserve(airports.size() + fixes.size());
+    for (auto &it: airports) {
+        nodes.push_back(it.second);
     }
-    for (auto it: fixes) {
-        registerNode(it.second);
+    for (auto &fix: fixes) {
+        nodes.push_back(fix);
     }
+    for (auto &n: nodes) {
+        auto &loc = n->getLocation();
+        densities.addNodes(std::floor(loc.longitude), std::floor(loc.latitude), 1);
+    }
+    nodeGrid.build(nodes);
+    connections.build();
+    densities.update();
+    airportIndex.build(airports);
     allNodesRegistered = true;
+    ++nodeGeneration;
 }
 
 void XWorld::registerNode(std::shared_ptr<world::NavNode> n) {
     auto &loc = n->getLocation();
-    int lat = (int) loc.latitude;
-    int lon = (int) loc.longitude;
-    allNodes[std::make_pair(lat, lon)].push_back(n);
+    nodeGrid.add(n);
+    densities.addNodes(std::floor(loc.longitude), std::floor(loc.latitude), 1);
+    densities.update();
+    ++nodeGeneration;
 }
 
-int XWorld::maxDensity(const world::Location &bottomLeft, const world::Location &topRight) {
-    int m = 0;
-
-    // nodes are grouped by integer lat/lon 'squares'.
-    int latl = std::max((int)std::floor(bottomLeft.latitude), -90);
-    int lath = std::min((int)std::ceil(topRight.latitude), 89);
-    int lonl = (int)std::floor(bottomLeft.longitude);
-    int lonh = (int)std::ceil(topRight.longitude);
-
-    // the area might span the -180/180 meridian. bias it here, normalise again in the iteration
-    if (lonh < lonl) { lonh += 360; }
-    for (int laty = latl; laty <= lath; ++laty) {
-        for (int lonx = lonl; lonx <= lonh; ++lonx) {
-            int normx = (lonx >= 180) ? (lonx - 360) : lonx;
-            auto it = allNodes.find(std::make_pair(laty, normx));
-            if (it == allNodes.end()) continue;
-            m = std::max(m, (int)it->second.size());
-        }
-    }
+int XWorld::getNodeGeneration() const {
+    return nodeGeneration;
+}
 
-    // pretend that each grid area has 'max' nodes in it, and report the total number of visible nodes that
-    // would be seen if this was the case.
-    float mapArea = (topRight.longitude > bottomLeft.longitude)
-                    ? (topRight.latitude - bottomLeft.latitude) * (topRight.longitude - bottomLeft.longitude)
-                    : (topRight.latitude - bottomLeft.latitude) * (360 + topRight.longitude - bottomLeft.longitude);
-    return (int)(mapArea * m);
+int XWorld::maxDensity(const world::Location &bottomLeft, const world::Location &topRight) {
+    return densities.estimateVisibleNodes(bottomLeft, topRight);
 }
 
 void XWorld::visitNodes(const world::Location& bottomLeft, const world::Location &topRight, NodeAcceptor callback, int filter) {
-    // nodes are grouped by integer lat/lon 'squares'.
-    int latl = std::min((int)std::floor(bottomLeft.latitude), -90);
-    int lath = std::min((int)std::ceil(topRight.latitude), 89);
-    int lonl = (int)std::floor(bottomLeft.longitude);
-    int lonh = (int)std::ceil(topRight.longitude);
-
-    // the area might span the -180/180 meridian. bias it here, normalise again in iteration
-    if (lonh < lonl) { lonh += 360; }
-
-    for (int laty = latl; laty <= lath; ++laty) {
-        for (int lonx = lonl; lonx <= lonh; ++lonx) {
-            int normx = (lonx >= 180) ? (lonx - 360) : lonx;
-            std::pair<int, int> key = std::make_pair(laty, normx);
-            auto it = allNodes.find(key);
-            if (it == allNodes.end()) {
-                continue;
-            }
-            for (auto node: it->second) {
-                if (!node->getLocation().isInArea(bottomLeft, topRight)) continue;
-                bool accept = false;
-                if (node->isAirport()) {
-                    if (std::dynamic_pointer_cast<world::Airport>(node)->hasControlTower()) {
-                        accept = (filter & world::World::VISIT_TOWERED_AIRPORTS);
-                    } else {
-                        accept = (filter & world::World::VISIT_OTHER_AIRPORTS);
-                    }
-                } else if (node->isFix()) {
-                    auto f = std::dynamic_pointer_cast<world::Fix>(node);
-                    if (f->isNavaid()) {
-                        accept = (filter & world::World::VISIT_NAVAIDS);
-                    } else if (f->isUserFix()) {
-                        accept = (filter & world::World::VISIT_USER_FIXES);
-                    } else {
-                        accept = (filter & world::World::VISIT_FIXES);
-                    }
-                }
-                if (accept) callback(node.get());
-            }
-        }
-    }
+    nodeGrid.visit(bottomLeft, topRight, callback, filter);
 }
 
 } /* namespace xdata */
@@ -22,6 +22,11 @@
 #include <functional>
 #include <atomic>
 #include "src/world/World.h"
+#include "src/world/DensityGrid.h"
+#include "NodeGrid.h"
+#include "AirportSearchIndex.h"
+#include "NavIdentifiers.h"
+#include "ConnectionGraph.h"
 
 namespace xdata {
 
@@ -33,12 +38,15 @@ public:
 
     int maxDensity(const world::Location &bottomLeft, const world::Location &topRight) override;
     void visitNodes(const world::Location &bottomLeft, const world::Location &topRight, NodeAcceptor callback, int filter) override;
+    int getNodeGeneration() const override;
 
     std::shared_ptr<world::Airport> findAirportByID(const std::string &id) const override;
     std::shared_ptr<world::Fix> findFixByRegionAndID(const std::string &region, const std::string &id) const override;
+    template <typename FixRef>
+    std::vector<std::shared_ptr<world::Fix>> findFixesByRegionAndID(const std::vector<FixRef> &refs) const;
     std::vector<std::shared_ptr<world::Airport>> findAirport(const std::string &keyWord) const override;
 
-    std::vector<world::World::Connection> &getConnections(std::shared_ptr<world::NavNode> from) override;
+    world::World::ConnectionRange getConnections(std::shared_ptr<world::NavNode> from) override;
     bool areConnected(std::shared_ptr<world::NavNode> from, const std::shared_ptr<world::NavNode> to) override;
 
     void addRegion(const std::string &code) override;
@@ -58,26 +66,54 @@ public:
 
 private:
     void registerNode(std::shared_ptr<world::NavNode> n);
+    std::shared_ptr<world::Fix> findFix(uint32_t region, const std::string &id) const;
 
 private:
     bool allNodesRegistered { false };
+    std::atomic<int> nodeGeneration { 0 };
 
     // Unique IDs
     std::map<std::string, std::shared_ptr<world::Region>> regions;
     std::map<std::string, std::shared_ptr<world::Airport>> airports;
 
-    // Unique only within region
-    std::multimap<std::string, std::shared_ptr<world::Fix>> fixes;
+    // All fixes, including those shadowed by an earlier fix with the same region and ID
+    std::vector<std::shared_ptr<world::Fix>> fixes;
 
-    // Unique within airway level
-    std::multimap<std::string, std::shared_ptr<world::Airway>> airways;
+    // Fixes are unique within region, airways within level. Both are found
+    // by the interned numbers of their identifiers
+    IdentifierPool identifiers;
+    IdentifierTable<world::Fix> fixTable;
+    IdentifierTable<world::Airway> airwayTable;
+
+    // To search by ident or name
+    AirportSearchIndex airportIndex;
 
     // To search by location
-    std::map<std::pair<int, int>, world::NavNodeList> allNodes;
+    NodeGrid nodeGrid;
+    world::DensityGrid densities;
 
     // Connections between nodes (airports, heliports, runways, fixes)
-    std::map<std::shared_ptr<world::NavNode>, std::vector<world::World::Connection>> connections;
-    std::vector<world::World::Connection> noConnection;
+    ConnectionGraph connections;
 };
 
+// resolves a list of references that have region and id members at once, e.g. the
+// fixes of a procedure. The result has a nullptr for each fix that doesn't exist
+template <typename FixRef>
+std::vector<std::shared_ptr<world::Fix>> XWorld::findFixesByRegionAndID(const std::vector<FixRef> &refs) const {
+    std::vector<std::shared_ptr<world::Fix>> res;
+    res.reserve(refs.size());
+
+    // consecutive fixes are mostly in the same region
+    const std::string *lastRegion = nullptr;
+    uint32_t region = IdentifierPool::NONE;
+    for (auto &ref: refs) {
+        if (!lastRegion || ref.region != *lastRegion) {
+            lastRegion = &ref.region;
+            region = identifiers.find(ref.region);
+        }
+        res.push_back(findFix(region, ref.id));
+    }
+    return res;
+}
+
 } /* namespace xdata */
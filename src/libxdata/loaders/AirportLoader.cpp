@@ -52,21 +52,33 @@ AirportLoader::AirportLoader(std::shared_ptr<world::LoadManager> mgr):
 {
 }
 
+void AirportLoader::setRecorder(Recorder r) {
+    recorder = r;
+}
+
 void AirportLoader::load(const std::string& file) const {
     AirportParser parser(file);
     parser.setAcceptor([this] (const AirportData &data) {
-        try {
-            onAirportLoaded(data);
-        } catch (const std::exception &e) {
-            logger::warn("Can't parse airport %s: %s", data.id.c_str(), e.what());
-        }
-        if (loadMgr->shouldCancelLoading()) {
-            throw std::runtime_error("Cancelled");
-        }
+        accept(data);
     });
     parser.loadAirports();
 }
 
+void AirportLoader::accept(const AirportData& data) const {
+    if (recorder) {
+        recorder(data);
+    }
+
+    try {
+        onAirportLoaded(data);
+    } catch (const std::exception &e) {
+        logger::warn("Can't parse airport %s: %s", data.id.c_str(), e.what());
+    }
+    if (loadMgr->shouldCancelLoading()) {
+        throw std::runtime_error("Cancelled");
+    }
+}
+
 void AirportLoader::onAirportLoaded(const AirportData& port) const {
     if (std::isnan(port.latitude) || std::isnan(port.longitude)) {
         if (port.runways.empty() && port.heliports.empty()) {
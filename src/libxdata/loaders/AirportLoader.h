@@ -19,6 +19,7 @@
 #define SRC_LIBXDATA_LOADERS_AIRPORTLOADER_H_
 
 #include <memory>
+#include <functional>
 #include "src/world/LoadManager.h"
 #include "../parsers/AirportParser.h"
 #include "../XWorld.h"
@@ -27,11 +28,16 @@ namespace xdata {
 
 class AirportLoader {
 public:
+    using Recorder = std::function<void(const AirportData &)>;
+
     AirportLoader(std::shared_ptr<world::LoadManager> mgr);
+    void setRecorder(Recorder r);
     void load(const std::string &file) const;
+    void accept(const AirportData &data) const;
 private:
     std::shared_ptr<world::LoadManager> const loadMgr;
     std::shared_ptr<XWorld> world;
+    Recorder recorder;
 
     void onAirportLoaded(const AirportData &port) const;
 
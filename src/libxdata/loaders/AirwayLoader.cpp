@@ -26,21 +26,33 @@ AirwayLoader::AirwayLoader(std::shared_ptr<world::LoadManager> mgr):
 {
 }
 
+void AirwayLoader::setRecorder(Recorder r) {
+    recorder = r;
+}
+
 void AirwayLoader::load(const std::string& file) {
     AirwayParser parser(file);
     parser.setAcceptor([this] (const AirwayData &data) {
-        try {
-            onAirwayLoaded(data);
-        } catch (const std::exception &e) {
-            logger::warn("Can't parse airway %s: %s", data.name.c_str(), e.what());
-        }
-        if (loadMgr->shouldCancelLoading()) {
-            throw std::runtime_error("Cancelled");
-        }
+        accept(data);
     });
     parser.loadAirways();
 }
 
+void AirwayLoader::accept(const AirwayData& data) {
+    if (recorder) {
+        recorder(data);
+    }
+
+    try {
+        onAirwayLoaded(data);
+    } catch (const std::exception &e) {
+        logger::warn("Can't parse airway %s: %s", data.name.c_str(), e.what());
+    }
+    if (loadMgr->shouldCancelLoading()) {
+        throw std::runtime_error("Cancelled");
+    }
+}
+
 void AirwayLoader::onAirwayLoaded(const AirwayData& airway) {
     auto fromFix = world->findFixByRegionAndID(airway.beginIcaoRegion, airway.beginID);
     auto toFix = world->findFixByRegionAndID(airway.endIcaoRegion, airway.endID);
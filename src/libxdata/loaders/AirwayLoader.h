@@ -19,6 +19,7 @@
 #define SRC_LIBXDATA_LOADERS_AIRWAYLOADER_H_
 
 #include <memory>
+#include <functional>
 #include "src/world/LoadManager.h"
 #include "../parsers/objects/AirwayData.h"
 #include "../XWorld.h"
@@ -27,11 +28,16 @@ namespace xdata {
 
 class AirwayLoader {
 public:
+    using Recorder = std::function<void(const AirwayData &)>;
+
     AirwayLoader(std::shared_ptr<world::LoadManager> mgr);
+    void setRecorder(Recorder r);
     void load(const std::string &file);
+    void accept(const AirwayData &data);
 private:
     std::shared_ptr<world::LoadManager> const loadMgr;
     std::shared_ptr<XWorld> world;
+    Recorder recorder;
 
     void onAirwayLoaded(const AirwayData &airway);
 };
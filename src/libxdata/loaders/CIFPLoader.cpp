@@ -29,21 +29,33 @@ CIFPLoader::CIFPLoader(std::shared_ptr<world::LoadManager> mgr):
 {
 }
 
+void CIFPLoader::setRecorder(Recorder r) {
+    recorder = r;
+}
+
 void CIFPLoader::load(std::shared_ptr<world::Airport> airport, const std::string& file) {
     CIFPParser parser(file);
     parser.setAcceptor([this, airport] (const CIFPData &cifp) {
-        try {
-            onProcedureLoaded(airport, cifp);
-        } catch (const std::exception &e) {
-            logger::warn("CIFP error in %s: %s", cifp.id.c_str(), e.what());
-        }
-        if (loadMgr->shouldCancelLoading()) {
-            throw std::runtime_error("Cancelled");
-        }
+        accept(airport, cifp);
     });
     parser.loadCIFP();
 }
 
+void CIFPLoader::accept(std::shared_ptr<world::Airport> airport, const CIFPData& cifp) {
+    if (recorder) {
+        recorder(airport, cifp);
+    }
+
+    try {
+        onProcedureLoaded(airport, cifp);
+    } catch (const std::exception &e) {
+        logger::warn("CIFP error in %s: %s", cifp.id.c_str(), e.what());
+    }
+    if (loadMgr->shouldCancelLoading()) {
+        throw std::runtime_error("Cancelled");
+    }
+}
+
 void CIFPLoader::onProcedureLoaded(std::shared_ptr<world::Airport> airport, const CIFPData& procedure) {
     switch (procedure.type) {
     case CIFPData::ProcedureType::RUNWAY:
@@ -205,8 +217,10 @@ void CIFPLoader::forEveryMatchingRunway(const std::string& rwSpec, const std::sh
 world::NavNodeList CIFPLoader::convertFixes(std::shared_ptr<world::Airport> airport, const std::vector<CIFPData::FixInRegion>& fixes) const {
     world::NavNodeList res;
 
-    for (auto &fix: fixes) {
-        std::shared_ptr<world::NavNode> node = world->findFixByRegionAndID(fix.region, fix.id);
+    auto globalFixes = world->findFixesByRegionAndID(fixes);
+    for (size_t i = 0; i < fixes.size(); i++) {
+        auto &fix = fixes[i];
+        std::shared_ptr<world::NavNode> node = globalFixes[i];
         if (!node) {
             node = airport->getTerminalFix(fix.id);
             if (!node) {
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <memory>
+#include <functional>
 #include "src/world/LoadManager.h"
 #include "src/world/models/airport/Airport.h"
 #include "../parsers/objects/CIFPData.h"
@@ -30,11 +31,16 @@ class XApproach;
 
 class CIFPLoader {
 public:
+    using Recorder = std::function<void(std::shared_ptr<world::Airport>, const CIFPData &)>;
+
     CIFPLoader(std::shared_ptr<world::LoadManager> mgr);
+    void setRecorder(Recorder r);
     void load(std::shared_ptr<world::Airport> airport, const std::string &file);
+    void accept(std::shared_ptr<world::Airport> airport, const CIFPData &cifp);
 private:
     std::shared_ptr<world::LoadManager> const loadMgr;
     std::shared_ptr<XWorld> world;
+    Recorder recorder;
 
     void onProcedureLoaded(std::shared_ptr<world::Airport> airport, const CIFPData &procedure);
 
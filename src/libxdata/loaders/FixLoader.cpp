@@ -26,21 +26,33 @@ FixLoader::FixLoader(std::shared_ptr<world::LoadManager> mgr):
 {
 }
 
+void FixLoader::setRecorder(Recorder r) {
+    recorder = r;
+}
+
 void FixLoader::load(const std::string& file) {
     FixParser parser(file);
     parser.setAcceptor([this] (const FixData &data) {
-        try {
-            onFixLoaded(data);
-        } catch (const std::exception &e) {
-            logger::warn("Can't parse fix %s: %s", data.id.c_str(), e.what());
-        }
-        if (loadMgr->shouldCancelLoading()) {
-            throw std::runtime_error("Cancelled");
-        }
+        accept(data);
     });
     parser.loadFixes();
 }
 
+void FixLoader::accept(const FixData& data) {
+    if (recorder) {
+        recorder(data);
+    }
+
+    try {
+        onFixLoaded(data);
+    } catch (const std::exception &e) {
+        logger::warn("Can't parse fix %s: %s", data.id.c_str(), e.what());
+    }
+    if (loadMgr->shouldCancelLoading()) {
+        throw std::runtime_error("Cancelled");
+    }
+}
+
 void FixLoader::onFixLoaded(const FixData& fix) {
     if (fix.terminalAreaId == "ENRT") {
         loadEnrouteFix(fix);
@@ -50,22 +62,18 @@ void FixLoader::onFixLoaded(const FixData& fix) {
 }
 
 void FixLoader::loadEnrouteFix(const FixData& fix) {
-    auto fixModel = world->findFixByRegionAndID(fix.icaoRegion, fix.id);
-
     auto region = world->findOrCreateRegion(fix.icaoRegion);
     world::Location loc(fix.latitude, fix.longitude);
 
-    fixModel = std::make_shared<world::Fix>(region, fix.id, loc);
+    auto fixModel = std::make_shared<world::Fix>(region, fix.id, loc);
     world->addFix(fixModel);
 }
 
 void FixLoader::loadTerminalFix(const FixData& fix) {
-    auto fixModel = world->findFixByRegionAndID(fix.icaoRegion, fix.id);
-
     auto region = world->findOrCreateRegion(fix.icaoRegion);
     world::Location loc(fix.latitude, fix.longitude);
 
-    fixModel = std::make_shared<world::Fix>(region, fix.id, loc);
+    auto fixModel = std::make_shared<world::Fix>(region, fix.id, loc);
 
     auto airport = world->findAirportByID(fix.terminalAreaId);
     if (!airport) {
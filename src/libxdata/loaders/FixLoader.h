@@ -19,6 +19,7 @@
 #define SRC_LIBXDATA_LOADERS_FIXLOADER_H_
 
 #include <memory>
+#include <functional>
 #include "src/world/LoadManager.h"
 #include "../XWorld.h"
 #include "src/libxdata/parsers/objects/FixData.h"
@@ -27,11 +28,16 @@ namespace xdata {
 
 class FixLoader {
 public:
+    using Recorder = std::function<void(const FixData &)>;
+
     FixLoader(std::shared_ptr<world::LoadManager> mgr);
+    void setRecorder(Recorder r);
     void load(const std::string &file);
+    void accept(const FixData &data);
 private:
     std::shared_ptr<world::LoadManager> const loadMgr;
     std::shared_ptr<XWorld> world;
+    Recorder recorder;
 
     void onFixLoaded(const FixData &fix);
     void loadEnrouteFix(const FixData &fix);
@@ -27,21 +27,33 @@ NavaidLoader::NavaidLoader(std::shared_ptr<world::LoadManager> mgr):
 {
 }
 
+void NavaidLoader::setRecorder(Recorder r) {
+    recorder = r;
+}
+
 void NavaidLoader::load(const std::string& file) {
     NavaidParser parser(file);
     parser.setAcceptor([this] (const NavaidData &data) {
-        try {
-            onNavaidLoaded(data);
-        } catch (const std::exception &e) {
-            logger::warn("Can't parse navaid %s: %s", data.id.c_str(), e.what());
-        }
-        if (loadMgr->shouldCancelLoading()) {
-            throw std::runtime_error("Cancelled");
-        }
+        accept(data);
     });
     parser.loadNavaids();
 }
 
+void NavaidLoader::accept(const NavaidData& data) {
+    if (recorder) {
+        recorder(data);
+    }
+
+    try {
+        onNavaidLoaded(data);
+    } catch (const std::exception &e) {
+        logger::warn("Can't parse navaid %s: %s", data.id.c_str(), e.what());
+    }
+    if (loadMgr->shouldCancelLoading()) {
+        throw std::runtime_error("Cancelled");
+    }
+}
+
 void NavaidLoader::onNavaidLoaded(const NavaidData& navaid) {
     bool new_dme = (navaid.type == NavaidData::Type::DME_SINGLE || navaid.type == NavaidData::Type::DME_COMP);
     bool new_vor = (navaid.type == NavaidData::Type::VOR);
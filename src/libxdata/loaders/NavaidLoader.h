@@ -19,6 +19,7 @@
 #define SRC_LIBXDATA_LOADERS_NAVAIDLOADER_H_
 
 #include <memory>
+#include <functional>
 #include "src/world/LoadManager.h"
 #include "../XWorld.h"
 #include "../parsers/NavaidParser.h"
@@ -27,11 +28,16 @@ namespace xdata {
 
 class NavaidLoader {
 public:
+    using Recorder = std::function<void(const NavaidData &)>;
+
     NavaidLoader(std::shared_ptr<world::LoadManager> mgr);
+    void setRecorder(Recorder r);
     void load(const std::string &file);
+    void accept(const NavaidData &data);
 private:
     std::shared_ptr<world::LoadManager> const loadMgr;
     std::shared_ptr<XWorld> world;
+    Recorder recorder;
 
     void onNavaidLoaded(const NavaidData &navaid);
 };
@@ -35,7 +35,7 @@ void Downloader::setHideURLs(bool hide) {
     hideURLs = hide;
 }
 
-std::vector<uint8_t> Downloader::download(const std::string& url, bool &cancel) {
+std::vector<uint8_t> Downloader::download(const std::string& url, std::atomic_bool &cancel) {
     if (!hideURLs) {
         logger::verbose("Downloading '%s'", url.c_str());
     } else {
@@ -88,8 +88,8 @@ size_t Downloader::onData(void* buffer, size_t size, size_t nmemb, void* vecPtr)
 }
 
 int Downloader::onProgress(void* client, curl_off_t dlTotal, curl_off_t dlNow, curl_off_t ulTotal, curl_off_t ulNow) {
-    bool *cancel = reinterpret_cast<bool *>(client);
-    return *cancel;
+    std::atomic_bool *cancel = reinterpret_cast<std::atomic_bool *>(client);
+    return cancel->load();
 }
 
 Downloader::~Downloader() {
@@ -22,6 +22,7 @@
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <atomic>
 #include <curl/curl.h>
 
 namespace maps {
@@ -30,7 +31,7 @@ class Downloader {
 public:
     Downloader();
     void setHideURLs(bool hide);
-    std::vector<uint8_t> download(const std::string &url, bool &cancel);
+    std::vector<uint8_t> download(const std::string &url, std::atomic_bool &cancel);
     ~Downloader();
 private:
     CURL *curl = nullptr;
@@ -20,12 +20,10 @@
 
 namespace maps {
 
-static constexpr const int FAR_FAR_AWAY = 1 << 15;
-
 void OverlayHighlight::reset()
 {
     active = false;
-    distance = FAR_FAR_AWAY;
+    node.reset();
 }
 
 void OverlayHighlight::activate(int x, int y)
@@ -35,14 +33,10 @@ void OverlayHighlight::activate(int x, int y)
     refY = y;
 }
 
-void OverlayHighlight::update(std::shared_ptr<OverlayedNode> on)
+void OverlayHighlight::find(const OverlaySpatialHash &hash)
 {
     if (!active) return;
-    auto d = on->getHotspotDistance(refX, refY);
-    if (d < distance) {
-        distance = d;
-        node = on;
-    }
+    node = hash.findNearest(refX, refY);
 }
 
 void OverlayHighlight::select()
@@ -51,6 +45,11 @@ void OverlayHighlight::select()
     node->setHighlighted();
 }
 
+const OverlayedNode *OverlayHighlight::getSelected() const
+{
+    return active ? node.get() : nullptr;
+}
+
 void OverlayHighlight::highlight()
 {
     if (!active || !node) return;
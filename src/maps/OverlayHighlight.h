@@ -18,6 +18,7 @@
 #pragma once
 
 #include "OverlayedNode.h"
+#include "OverlaySpatialHash.h"
 
 namespace maps {
 
@@ -26,16 +27,16 @@ class OverlayHighlight
 public:
     void reset();
     void activate(int x, int y);
-    void update(std::shared_ptr<OverlayedNode> on);
+    void find(const OverlaySpatialHash &hash);
     void select();
     void highlight();
+    const OverlayedNode *getSelected() const;
 
     virtual ~OverlayHighlight() = default;
 
 private:
     bool active;
     int refX, refY;
-    int distance;
     std::shared_ptr<OverlayedNode> node;
 
 };
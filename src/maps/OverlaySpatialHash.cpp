@@ -0,0 +1,128 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include "OverlaySpatialHash.h"
+
+namespace maps {
+
+void OverlaySpatialHash::clear() {
+    hotspotCells.clear();
+    labelCells.clear();
+    minCellX = minCellY = 0;
+    maxCellX = maxCellY = -1;
+}
+
+void OverlaySpatialHash::addHotspot(std::shared_ptr<OverlayedNode> node) {
+    auto hs = node->getClickHotspot();
+    int cx = toCell(hs.first);
+    int cy = toCell(hs.second);
+    if (hotspotCells.empty()) {
+        minCellX = maxCellX = cx;
+        minCellY = maxCellY = cy;
+    } else {
+        minCellX = std::min(minCellX, cx);
+        maxCellX = std::max(maxCellX, cx);
+        minCellY = std::min(minCellY, cy);
+        maxCellY = std::max(maxCellY, cy);
+    }
+    hotspotCells[makeKey(cx, cy)].push_back(node);
+}
+
+std::shared_ptr<OverlayedNode> OverlaySpatialHash::findNearest(int x, int y, int maxDistance) const {
+    std::shared_ptr<OverlayedNode> nearest;
+    if (hotspotCells.empty()) {
+        return nearest;
+    }
+
+    int cx = toCell(x);
+    int cy = toCell(y);
+    int maxRing = std::max({cx - minCellX, maxCellX - cx, cy - minCellY, maxCellY - cy});
+    int best = maxDistance;
+
+    // Search rings of cells around the point. Any hotspot in ring r is more than
+    // (r - 1) cells away, so the search stops once that can't beat the best match.
+    for (int r = 0; r <= maxRing; ++r) {
+        if ((r - 1) * CELL_SIZE >= best) {
+            break;
+        }
+        for (int j = cy - r; j <= cy + r; ++j) {
+            if ((j < minCellY) || (j > maxCellY)) continue;
+            bool edgeRow = (j == cy - r) || (j == cy + r);
+            int step = edgeRow ? 1 : 2 * r;
+            for (int i = cx - r; i <= cx + r; i += step) {
+                if ((i < minCellX) || (i > maxCellX)) continue;
+                auto it = hotspotCells.find(makeKey(i, j));
+                if (it == hotspotCells.end()) continue;
+                for (auto &node: it->second) {
+                    int d = node->getHotspotDistance(x, y);
+                    if (d < best) {
+                        best = d;
+                        nearest = node;
+                    }
+                }
+            }
+        }
+    }
+    return nearest;
+}
+
+void OverlaySpatialHash::clearLabels() {
+    labelCells.clear();
+}
+
+bool OverlaySpatialHash::placeLabel(const img::Rect &bounds) {
+    if (bounds.isEmpty()) {
+        return false;
+    }
+
+    int cx0 = toCell(bounds.x0);
+    int cy0 = toCell(bounds.y0);
+    int cx1 = toCell(bounds.x1 - 1);
+    int cy1 = toCell(bounds.y1 - 1);
+
+    for (int j = cy0; j <= cy1; ++j) {
+        for (int i = cx0; i <= cx1; ++i) {
+            auto it = labelCells.find(makeKey(i, j));
+            if (it == labelCells.end()) continue;
+            for (auto &other: it->second) {
+                if (!bounds.intersect(other).isEmpty()) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    for (int j = cy0; j <= cy1; ++j) {
+        for (int i = cx0; i <= cx1; ++i) {
+            labelCells[makeKey(i, j)].push_back(bounds);
+        }
+    }
+    return true;
+}
+
+int OverlaySpatialHash::toCell(int v) {
+    // round towards negative infinity, hotspots may be just off-screen
+    return (v >= 0) ? (v / CELL_SIZE) : -((CELL_SIZE - 1 - v) / CELL_SIZE);
+}
+
+uint64_t OverlaySpatialHash::makeKey(int cellX, int cellY) {
+    return ((uint64_t)(uint32_t) cellX << 32) | (uint32_t) cellY;
+}
+
+} /* namespace maps */
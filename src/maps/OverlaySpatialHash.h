@@ -0,0 +1,58 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2018 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_MAPS_OVERLAY_SPATIAL_HASH_H_
+#define SRC_MAPS_OVERLAY_SPATIAL_HASH_H_
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "OverlayedNode.h"
+
+namespace maps {
+
+// Buckets the visible overlays by their screen position, so that the node nearest to
+// a point and the labels that collide with a new label are found without scanning
+// every overlay.
+class OverlaySpatialHash {
+public:
+    static constexpr const int FAR_FAR_AWAY = 1 << 15;
+
+    void clear();
+    void addHotspot(std::shared_ptr<OverlayedNode> node);
+    // the node with the hotspot nearest to x, y (taxicab distance), if closer than maxDistance
+    std::shared_ptr<OverlayedNode> findNearest(int x, int y, int maxDistance = FAR_FAR_AWAY) const;
+
+    void clearLabels();
+    // reserves the area for a label, returns false if it overlaps an already placed label
+    bool placeLabel(const img::Rect &bounds);
+
+private:
+    static constexpr const int CELL_SIZE = 64;
+
+    std::unordered_map<uint64_t, std::vector<std::shared_ptr<OverlayedNode>>> hotspotCells;
+    std::unordered_map<uint64_t, std::vector<img::Rect>> labelCells;
+    int minCellX = 0, minCellY = 0, maxCellX = -1, maxCellY = -1;
+
+    static int toCell(int v);
+    static uint64_t makeKey(int cellX, int cellY);
+};
+
+} /* namespace maps */
+
+#endif /* SRC_MAPS_OVERLAY_SPATIAL_HASH_H_ */
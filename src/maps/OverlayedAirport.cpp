@@ -66,6 +66,41 @@ void OverlayedAirport::drawText(bool detailed) {
     if (isBlob() && !detailed) {
         return;
     }
+    int yOffset = getTextTop();
+    auto mapImage = overlayHelper->getMapImage();
+
+    if (detailed) {
+        std::string nameAndID, airportInfo;
+        getDetailedText(nameAndID, airportInfo);
+        mapImage->drawText(nameAndID,   14, posX, yOffset,      color, img::COLOR_TRANSPARENT_WHITE, img::Align::CENTRE);
+        mapImage->drawText(airportInfo, 12, posX, yOffset + 14, color, img::COLOR_TRANSPARENT_WHITE, img::Align::CENTRE);
+    } else {
+        mapImage->drawText(airport->getID(), 14, posX, yOffset, color, img::COLOR_TRANSPARENT_WHITE, img::Align::CENTRE);
+    }
+}
+
+img::Rect OverlayedAirport::getTextBounds(bool detailed) {
+    if (isBlob() && !detailed) {
+        return img::Rect{};
+    }
+    int yOffset = getTextTop();
+
+    if (detailed) {
+        std::string nameAndID, airportInfo;
+        getDetailedText(nameAndID, airportInfo);
+        auto bounds = getTextRect(nameAndID, 14, posX, yOffset, img::Align::CENTRE);
+        bounds = bounds.unite(getTextRect(airportInfo, 12, posX, yOffset + 14, img::Align::CENTRE));
+        return bounds;
+    } else {
+        return getTextRect(airport->getID(), 14, posX, yOffset, img::Align::CENTRE);
+    }
+}
+
+OverlayedNode::LabelPriority OverlayedAirport::getLabelPriority() const {
+    return airport->hasControlTower() ? LabelPriority::TOWERED_AIRPORT : LabelPriority::AIRPORT;
+}
+
+int OverlayedAirport::getTextTop() {
     // Place text below southern airport boundary and below symbol
     int yOffset = posY + ICAO_CIRCLE_RADIUS;
     auto &locDownRight = airport->getLocationDownRight();
@@ -74,21 +109,16 @@ void OverlayedAirport::drawText(bool detailed) {
         overlayHelper->positionToPixel(locDownRight.latitude, locDownRight.longitude, xIgnored, yOffset);
         yOffset += ICAO_CIRCLE_RADIUS;
     }
+    return yOffset;
+}
 
-    auto mapImage = overlayHelper->getMapImage();
-
-    if (detailed) {
-        std::string nameAndID = airport->getName() + " (" + airport->getID() + ")";
-        std::string elevationFeet = std::to_string(airport->getElevation());
-        int rwyLengthHundredsFeet = (airport->getLongestRunwayLength() * world::M_TO_FT) / 100.0;
-        std::string rwyLength = (rwyLengthHundredsFeet == 0) ? "" : (" " + std::to_string(rwyLengthHundredsFeet));
-        std::string atcInfo = airport->getInitialATCContactInfo();
-        std::string airportInfo = " " + elevationFeet + rwyLength + " " + atcInfo + " ";
-        mapImage->drawText(nameAndID,   14, posX, yOffset,      color, img::COLOR_TRANSPARENT_WHITE, img::Align::CENTRE);
-        mapImage->drawText(airportInfo, 12, posX, yOffset + 14, color, img::COLOR_TRANSPARENT_WHITE, img::Align::CENTRE);
-    } else {
-        mapImage->drawText(airport->getID(), 14, posX, yOffset, color, img::COLOR_TRANSPARENT_WHITE, img::Align::CENTRE);
-    }
+void OverlayedAirport::getDetailedText(std::string &nameAndID, std::string &airportInfo) {
+    nameAndID = airport->getName() + " (" + airport->getID() + ")";
+    std::string elevationFeet = std::to_string(airport->getElevation());
+    int rwyLengthHundredsFeet = (airport->getLongestRunwayLength() * world::M_TO_FT) / 100.0;
+    std::string rwyLength = (rwyLengthHundredsFeet == 0) ? "" : (" " + std::to_string(rwyLengthHundredsFeet));
+    std::string atcInfo = airport->getInitialATCContactInfo();
+    airportInfo = " " + elevationFeet + rwyLength + " " + atcInfo + " ";
 }
 
 OverlayedAirport::AerodromeType OverlayedAirport::getAerodromeType() {
@@ -149,7 +179,8 @@ void OverlayedAirport::drawAirportICAOGeographicRunways() {
 }
 
 void OverlayedAirport::drawRunwayRectangles(float size, uint32_t rectColor) {
-    airport->forEachRunwayPair([this, size, rectColor](const std::shared_ptr<world::Runway> rwy1, const std::shared_ptr<world::Runway> rwy2) {
+    auto &runways = beginShapes();
+    airport->forEachRunwayPair([this, size, &runways](const std::shared_ptr<world::Runway> rwy1, const std::shared_ptr<world::Runway> rwy2) {
         auto loc1 = rwy1->getLocation();
         auto loc2 = rwy2->getLocation();
         int x1, y1, x2, y2;
@@ -162,9 +193,10 @@ void OverlayedAirport::drawRunwayRectangles(float size, uint32_t rectColor) {
         int yc = size * sin(angleClockwiseCorner * M_PI / 180.0);
         int xa = size * cos(angleAnticlockwiseCorner * M_PI / 180.0);
         int ya = size * sin(angleAnticlockwiseCorner * M_PI / 180.0);
-        auto mapImage = overlayHelper->getMapImage();
-        mapImage->fillRectangle(x2 + xc, y2 + yc, x2 + xa, y2 + ya, x1 - xc, y1 - yc, x1 - xa, y1 - ya, rectColor);
+        runways.addPolygon({{(float) (x2 + xc), (float) (y2 + yc)}, {(float) (x2 + xa), (float) (y2 + ya)},
+                            {(float) (x1 - xc), (float) (y1 - yc)}, {(float) (x1 - xa), (float) (y1 - ya)}});
     });
+    runways.fill(*overlayHelper->getMapImage(), rectColor);
 }
 
 void OverlayedAirport::drawAirportICAORing() {
@@ -231,7 +263,8 @@ void OverlayedAirport::drawAirportICAOCircleAndRwyPattern() {
     xCentre /= scale;
     yCentre /= scale;
 
-    airport->forEachRunwayPair([this, mapImage, xCentre, yCentre, scale](const std::shared_ptr<world::Runway> rwy1, const std::shared_ptr<world::Runway> rwy2) {
+    auto &pattern = beginShapes();
+    airport->forEachRunwayPair([this, &pattern, xCentre, yCentre, scale](const std::shared_ptr<world::Runway> rwy1, const std::shared_ptr<world::Runway> rwy2) {
         auto loc1 = rwy1->getLocation();
         auto loc2 = rwy2->getLocation();
         int px1, py1, px2, py2;
@@ -241,8 +274,9 @@ void OverlayedAirport::drawAirportICAOCircleAndRwyPattern() {
         px2 /= scale;
         py1 /= scale;
         py2 /= scale;
-        mapImage->drawLineAA(px1 - xCentre + posX, py1 - yCentre + posY, px2 - xCentre + posX, py2 - yCentre + posY, img::COLOR_WHITE);
+        pattern.addLine(px1 - xCentre + posX, py1 - yCentre + posY, px2 - xCentre + posX, py2 - yCentre + posY, 1);
     });
+    pattern.fill(*mapImage, img::COLOR_WHITE);
 }
 
 } /* namespace maps */
@@ -32,6 +32,8 @@ public:
     std::string getID() const override;
     void drawGraphic() override;
     void drawText(bool detailed) override;
+    img::Rect getTextBounds(bool detailed) override;
+    LabelPriority getLabelPriority() const override;
 
 private:
 
@@ -58,6 +60,8 @@ private:
     int getMaxRunwayDistanceFromCentre(int zoomLevel, int xCentre, int yCentre);
     void drawRunwayRectangles(float size, uint32_t rectColor);
     bool isBlob();
+    int getTextTop();
+    void getDetailedText(std::string &nameAndID, std::string &airportInfo);
 
     static constexpr const int ICAO_CIRCLE_RADIUS = 15;
     static constexpr const int DRAW_BLOB_RUNWAYS_AT_MAPWIDTHNM = 200;
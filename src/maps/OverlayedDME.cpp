@@ -59,6 +59,19 @@ void OverlayedDME::drawText(bool detailed)
     }
 }
 
+img::Rect OverlayedDME::getTextBounds(bool detailed)
+{
+    if (!enabled) return img::Rect{};
+
+    if (detailed) {
+        auto freqString = navDME->getFrequency().getFrequencyString(false);
+        return getNavTextBoxBounds("DME", getID(), freqString, posX - 47, posY - 37);
+    } else {
+        auto hs = getClickHotspot();
+        return getTextRect(getID(), 12, hs.first, hs.second, img::Align::CENTRE);
+    }
+}
+
 OverlayedNode::Hotspot OverlayedDME::getClickHotspot() const {
     return Hotspot(posX - 20, posY - 20);
 }
@@ -30,6 +30,8 @@ public:
     void configure(const OverlayConfig &cfg, const world::Location &loc) override;
     void drawGraphic() override;
     void drawText(bool detailed) override;
+    img::Rect getTextBounds(bool detailed) override;
+    LabelPriority getLabelPriority() const override { return LabelPriority::NAVAID; }
 
     Hotspot getClickHotspot() const override;
 
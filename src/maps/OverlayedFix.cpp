@@ -34,21 +34,35 @@ std::string OverlayedFix::getID() const {
     return fix->getID();
 }
 
-void OverlayedFix::drawNavTextBox(const std::string &type, const std::string &id, const std::string &freq, int x, int y, uint32_t color, const std::string &ilsHeadingMagnetic) {
+void OverlayedFix::getNavTextBoxSize(const std::string &type, const std::string &id, const std::string &freq,
+                                     const std::string &ilsHeadingMagnetic, int &textWidth, int &boxWidth, int &boxHeight) {
     auto mapImage = overlayHelper->getMapImage();
-    // x, y is top left corner of rectangular border. If type is not required, pass in as ""
-    const int MORSE_SIZE = 2;
-    const int XBORDER = 2;
     // If type is required, id and freq text and bottom of rectangular border drop by half text height
     int yo = ((type == "") ? 0 : (TEXT_SIZE / 2));
-    int textWidth = std::max(mapImage->getTextWidth(id, TEXT_SIZE), mapImage->getTextWidth(freq, TEXT_SIZE));
+    textWidth = std::max(mapImage->getTextWidth(id, TEXT_SIZE), mapImage->getTextWidth(freq, TEXT_SIZE));
     int morseWidth = 0;
     for (char const &c: id) {
         morseWidth = std::max(morseWidth, morse.getLength(c) * MORSE_SIZE);
     }
-    int boxWidth = textWidth + morseWidth + (XBORDER * 4);
+    boxWidth = textWidth + morseWidth + (XBORDER * 4);
     int numLines = (ilsHeadingMagnetic == "") ? 2 : 3;
-    int boxHeight = (TEXT_SIZE * numLines) + yo + 2;
+    boxHeight = (TEXT_SIZE * numLines) + yo + 2;
+}
+
+img::Rect OverlayedFix::getNavTextBoxBounds(const std::string &type, const std::string &id, const std::string &freq, int x, int y, const std::string &ilsHeadingMagnetic) {
+    int textWidth, boxWidth, boxHeight;
+    getNavTextBoxSize(type, id, freq, ilsHeadingMagnetic, textWidth, boxWidth, boxHeight);
+    // the type is written over the top border
+    int yo = ((type == "") ? 0 : (TEXT_SIZE / 2));
+    return img::Rect{x, y - yo, x + boxWidth + 1, y + boxHeight + 1};
+}
+
+void OverlayedFix::drawNavTextBox(const std::string &type, const std::string &id, const std::string &freq, int x, int y, uint32_t color, const std::string &ilsHeadingMagnetic) {
+    auto mapImage = overlayHelper->getMapImage();
+    // x, y is top left corner of rectangular border. If type is not required, pass in as ""
+    int yo = ((type == "") ? 0 : (TEXT_SIZE / 2));
+    int textWidth, boxWidth, boxHeight;
+    getNavTextBoxSize(type, id, freq, ilsHeadingMagnetic, textWidth, boxWidth, boxHeight);
     int xTextCentre = x + textWidth / 2 + XBORDER + 1;
 
     mapImage->fillRectangle(x + 1, y + 1, x + boxWidth, y + boxHeight, img::COLOR_WHITE);
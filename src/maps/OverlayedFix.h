@@ -36,6 +36,8 @@ protected:
     void drawNavTextBox(const std::string &type, const std::string &id, const std::string &freq,
                                 int x, int y, uint32_t color,
                                 const std::string &ilsHeadingMagnetic = "");
+    img::Rect getNavTextBoxBounds(const std::string &type, const std::string &id, const std::string &freq,
+                                int x, int y, const std::string &ilsHeadingMagnetic = "");
 
 protected:
     const world::Fix *fix;
@@ -44,7 +46,11 @@ protected:
 
 private:
     static world::Morse morse;
+    static constexpr const int MORSE_SIZE = 2;
+    static constexpr const int XBORDER = 2;
 
+    void getNavTextBoxSize(const std::string &type, const std::string &id, const std::string &freq,
+                                const std::string &ilsHeadingMagnetic, int &textWidth, int &boxWidth, int &boxHeight);
     void drawMorse(int x, int y, std::string text, int size, uint32_t color);
 };
 
@@ -55,12 +55,13 @@ void OverlayedILSLocalizer::drawGraphic()
 
     if (!enabled) return;
 
-    auto mapImage = overlayHelper->getMapImage();
-    mapImage->drawLineAA(posX, posY, lx, ly, color);
-    mapImage->drawLineAA(posX, posY, cx, cy, color);
-    mapImage->drawLineAA(posX, posY, rx, ry, color);
-    mapImage->drawLineAA(cx, cy, lx, ly, color);
-    mapImage->drawLineAA(cx, cy, rx, ry, color);
+    auto &feather = beginShapes();
+    feather.addLine(posX, posY, lx, ly, 1);
+    feather.addLine(posX, posY, cx, cy, 1);
+    feather.addLine(posX, posY, rx, ry, 1);
+    feather.addLine(cx, cy, lx, ly, 1);
+    feather.addLine(cx, cy, rx, ry, 1);
+    feather.fill(*overlayHelper->getMapImage(), color);
 }
 
 void OverlayedILSLocalizer::drawText(bool detailed)
@@ -85,6 +86,25 @@ void OverlayedILSLocalizer::drawText(bool detailed)
     }
 }
 
+img::Rect OverlayedILSLocalizer::getTextBounds(bool detailed)
+{
+    if (!enabled) return img::Rect{};
+
+    if (detailed) {
+        std::string type = navILS->isLocalizerOnly() ? "LOC" : "ILS";
+        type = linkedDME ? type + "/DME" : type;
+        auto freqString = navILS->getFrequency().getFrequencyString(false);
+        double headingMagnetic = navILS->getRunwayHeadingMagnetic();
+        std::ostringstream str;
+        if (!std::isnan(headingMagnetic)) {
+            str << std::setfill('0') << std::setw(3) << int(std::floor(headingMagnetic + 0.5));
+        }
+        return getNavTextBoxBounds(type, getID(), freqString, textLocationX, textLocationY, str.str());
+    } else {
+        return getTextRect(getID(), 12, textLocationX, textLocationY, img::Align::CENTRE);
+    }
+}
+
 OverlayedNode::Hotspot OverlayedILSLocalizer::getClickHotspot() const {
     return Hotspot(textLocationX, textLocationY);
 }
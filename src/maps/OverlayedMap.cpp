@@ -18,6 +18,7 @@
 #include <cstring>
 #include <algorithm>
 #include <cmath>
+#include <tuple>
 #include "OverlayedMap.h"
 #include "OverlayedAirport.h"
 #include "OverlayedDME.h"
@@ -35,6 +36,7 @@ namespace maps {
 
 OverlayedMap::OverlayedMap(std::shared_ptr<img::Stitcher> stitchedMap, std::shared_ptr<OverlayConfig> overlays):
     mapImage(stitchedMap->getPreRotatedImage()),
+    overlayTarget(mapImage),
     tileSource(stitchedMap->getTileSource()),
     stitcher(stitchedMap),
     overlayConfig(overlays),
@@ -73,6 +75,7 @@ OverlayedMap::OverlayedMap(std::shared_ptr<img::Stitcher> stitchedMap, std::shar
     otherAircraftColors[RelativeHeight::above] = overlayConfig->colorOtherAircraftAbove;
 
     overlayNodeCache = std::make_shared<NavNodeToOverlayMap>();
+    navLayer = std::make_shared<img::Image>();
 }
 
 void OverlayedMap::setRedrawCallback(OverlaysDrawnCallback cb) {
@@ -128,6 +131,10 @@ void OverlayedMap::setPlaneLocations(std::vector<avitab::Location> &locs) {
     planeLocations = locs;
 
     if (movement) {
+        if (navWorld && !planeLocations.empty()) {
+            world::Location position(planeLocations[0].latitude, planeLocations[0].longitude);
+            navWorld->setTrackHint(position, planeLocations[0].heading);
+        }
         stitcher->updateImage();
     }
 }
@@ -166,6 +173,10 @@ bool OverlayedMap::mouse(int x, int y, bool down)
             lastClickX = x;
             lastClickY = y;
             stitcher->convertSourceImageToRenderedCoords(lastClickX, lastClickY);
+            // only keep the click for highlighting if it hit one of the overlays
+            if (!overlayHash.findNearest(lastClickX, lastClickY, CLICK_HIT_DISTANCE)) {
+                lastClickX = lastClickY = INVALID_CLICK;
+            }
             wasClick = true;
         } else {
             lastClickX = lastClickY = INVALID_CLICK;
@@ -296,6 +307,65 @@ void OverlayedMap::drawCalibrationOverlay() {
 }
 
 void OverlayedMap::drawNavWorldOverlays() {
+    // The NAV overlays are only collected again when the view, the overlay configuration or
+    // the NAV data changed. The highlights follow the aircraft and the last click, so they are
+    // selected on each frame, but the layer is only rendered again if they picked other nodes.
+    NavLayerState state = getNavLayerState();
+    bool changed = !navLayerValid || !(state == navLayerState);
+    if (changed) {
+        collectNavWorldOverlays();
+        navLayerState = state;
+        navLayerValid = true;
+    }
+    changed |= selectHighlights();
+    if (changed) {
+        renderNavLayer();
+    }
+
+    if (!navLayerEmpty) {
+        mapImage->blendImage0(*navLayer, 0, 0);
+    }
+    for (size_t i = 0; i < NUM_HIGHLIGHT_NODES; ++i) {
+        highlights[i].highlight();
+    }
+}
+
+OverlayedMap::NavLayerState OverlayedMap::getNavLayerState() const {
+    NavLayerState state;
+    auto center = stitcher->getCenter();
+    state.centerX = center.x;
+    state.centerY = center.y;
+    state.zoomLevel = stitcher->getZoomLevel();
+    state.page = stitcher->getCurrentPage();
+    state.width = mapImage->getWidth();
+    state.height = mapImage->getHeight();
+    state.northOffset = getNorthOffset();
+    state.configFlags = (overlayConfig->drawAirports << 0) |
+                        (overlayConfig->drawAirstrips << 1) |
+                        (overlayConfig->drawHeliportsSeaports << 2) |
+                        (overlayConfig->drawVORs << 3) |
+                        (overlayConfig->drawNDBs << 4) |
+                        (overlayConfig->drawILSs << 5) |
+                        (overlayConfig->drawWaypoints << 6) |
+                        (overlayConfig->drawPOIs << 7) |
+                        (overlayConfig->drawVRPs << 8) |
+                        (overlayConfig->drawMarkers << 9);
+    state.world = navWorld.get();
+    state.worldGeneration = navWorld ? navWorld->getNodeGeneration() : 0;
+    return state;
+}
+
+bool OverlayedMap::NavLayerState::operator==(const NavLayerState &other) const {
+    return std::tie(centerX, centerY, zoomLevel, page, width, height, northOffset, configFlags, world, worldGeneration) ==
+           std::tie(other.centerX, other.centerY, other.zoomLevel, other.page, other.width, other.height,
+                    other.northOffset, other.configFlags, other.world, other.worldGeneration);
+}
+
+void OverlayedMap::collectNavWorldOverlays() {
+    visibleFixes.clear();
+    visibleAerodromes.clear();
+    overlayHash.clear();
+
     if (!navWorld) {
         return;
     }
@@ -375,6 +445,26 @@ void OverlayedMap::drawNavWorldOverlays() {
                         },
                         nodeFilter);
 
+    // split the collection of nodes into fixes and aerodromes, for drawing order
+    for (auto on: *nodes) {
+        if (on.second->isAirfield()) {
+            visibleAerodromes.push_back(on.second);
+        } else {
+            visibleFixes.push_back(on.second);
+        }
+        overlayHash.addHotspot(on.second);
+    }
+
+    LOG_INFO(DBG_OVERLAYS, "zoom = %2d, nm/pix = %0.3f, mapWidth = %0.1f nm, maxNodes = %d, actual = %d (%d/%d from cache)",
+        stitcher->getZoomLevel(), mapScaleNMperPixel, mapWidthNM, maxNodeDensity, nodes->size(), reusedOverlays, overlayNodeCache->size());
+
+    // Keep this frame's overlays for next time. The previous cache will be disposed of and
+    // and the overlay shared pointers released, which will result in the overlay being destroyed
+    // if it wasn't reused in this frame.
+    overlayNodeCache = nodes;
+}
+
+bool OverlayedMap::selectHighlights() {
     // decide whether all nodes should show their detailed text, this will be based
     // on the reported node density
     const bool showDetailedText = (maxNodeDensity < DENSITY_LIMIT_DETAILED_TEXT);
@@ -395,52 +485,75 @@ void OverlayedMap::drawNavWorldOverlays() {
         highlights[MAP_CENTER].activate(mapImage->getWidth() / 2, mapImage->getHeight() / 2);
     }
 
-    // split the collection of nodes into fixes and aerodromes, and find the ones to be highlighted
-    std::vector<std::shared_ptr<OverlayedNode>> fixes;
-    std::vector<std::shared_ptr<OverlayedNode>> aerodromes;
-    for (auto on: *nodes) {
-        if (on.second->isAirfield()) {
-            aerodromes.push_back(on.second);
-        } else {
-            fixes.push_back(on.second);
-        }
-        for (size_t i = 0; i < NUM_HIGHLIGHT_NODES; ++i) {
-            highlights[i].update(on.second);
-        }
+    // find the nodes nearest to each highlight
+    for (size_t i = 0; i < NUM_HIGHLIGHT_NODES; ++i) {
+        highlights[i].find(overlayHash);
     }
 
-    // the nearest nodes have been identified, now mark them as selected
+    // the nearest nodes have been identified, now mark them as selected. the layer
+    // leaves out the normal text of these nodes, so it is stale if they changed.
+    bool changed = false;
     for (size_t i = 0; i < NUM_HIGHLIGHT_NODES; ++i) {
         highlights[i].select();
+        auto node = highlights[i].getSelected();
+        changed |= (node != layerHighlights[i]);
+        layerHighlights[i] = node;
+    }
+    return changed;
+}
+
+void OverlayedMap::renderNavLayer() {
+    bool wasEmpty = navLayerEmpty;
+    navLayerEmpty = visibleFixes.empty() && visibleAerodromes.empty();
+    if ((navLayer->getWidth() != mapImage->getWidth()) || (navLayer->getHeight() != mapImage->getHeight())) {
+        navLayer->resize(mapImage->getWidth(), mapImage->getHeight(), img::COLOR_TRANSPARENT);
+    } else if (!wasEmpty) {
+        navLayer->clear(img::COLOR_TRANSPARENT);
+    }
+    if (navLayerEmpty) {
+        return;
     }
 
-    // Render the list of visible OverlayedNodes:
-    // Fix graphics, aerodrome graphics, then fix text and aerodrome text, then highlighted text
-    for (auto on: fixes) {
+    const bool showDetailedText = (maxNodeDensity < DENSITY_LIMIT_DETAILED_TEXT);
+
+    // Render the list of visible OverlayedNodes into the layer:
+    // Fix graphics, aerodrome graphics, then the text that has room.
+    // The highlighted text is drawn over the map on each frame.
+    overlayTarget = navLayer;
+    for (auto &on: visibleFixes) {
         on->drawGraphic();
     }
-    for (auto on: aerodromes) {
+    for (auto &on: visibleAerodromes) {
         on->drawGraphic();
     }
     if (maxNodeDensity < DENSITY_LIMIT_SHOW_TEXT) {
-        for (auto on: fixes) {
-            if (!on->isHighlighted()) on->drawText(showDetailedText);
-        }
-        for (auto on: aerodromes) {
-            if (!on->isHighlighted()) on->drawText(showDetailedText);
-        }
-    }
-    for (size_t i = 0; i < NUM_HIGHLIGHT_NODES; ++i) {
-        highlights[i].highlight();
+        drawNavLabels(showDetailedText);
     }
+    overlayTarget = mapImage;
+}
 
-    LOG_INFO(DBG_OVERLAYS, "zoom = %2d, nm/pix = %0.3f, mapWidth = %0.1f nm, maxNodes = %d, actual = %d (%d/%d from cache)",
-        stitcher->getZoomLevel(), mapScaleNMperPixel, mapWidthNM, maxNodeDensity, nodes->size(), reusedOverlays, overlayNodeCache->size());
+void OverlayedMap::drawNavLabels(bool detailed) {
+    // Labels are placed in order of priority, and any label that would overlap one that
+    // was already placed is left out. Busy areas then show the most useful subset of labels.
+    std::vector<std::shared_ptr<OverlayedNode>> labelled;
+    labelled.reserve(visibleFixes.size() + visibleAerodromes.size());
+    for (auto &on: visibleFixes) {
+        if (!on->isHighlighted()) labelled.push_back(on);
+    }
+    for (auto &on: visibleAerodromes) {
+        if (!on->isHighlighted()) labelled.push_back(on);
+    }
+    std::stable_sort(labelled.begin(), labelled.end(),
+        [] (const std::shared_ptr<OverlayedNode> &a, const std::shared_ptr<OverlayedNode> &b) {
+            return a->getLabelPriority() > b->getLabelPriority();
+        });
 
-    // Keep this frame's overlays for next time. The previous cache will be disposed of and
-    // and the overlay shared pointers released, which will result in the overlay being destroyed
-    // if it wasn't reused in this frame.
-    overlayNodeCache = nodes;
+    overlayHash.clearLabels();
+    for (auto &on: labelled) {
+        if (overlayHash.placeLabel(on->getTextBounds(detailed))) {
+            on->drawText(detailed);
+        }
+    }
 }
 
 int OverlayedMap::getMapDensity() const {
@@ -621,6 +734,7 @@ void OverlayedMap::beginCalibration() {
 void OverlayedMap::setCalibrationPoint1(double lat, double lon) {
     auto center = stitcher->getCenter();
     tileSource->attachCalibration1(center.x, center.y, lat, lon, stitcher->getZoomLevel());
+    navLayerValid = false;
 
     calibrationStep = 2;
     updateImage();
@@ -629,6 +743,7 @@ void OverlayedMap::setCalibrationPoint1(double lat, double lon) {
 void OverlayedMap::setCalibrationPoint2(double lat, double lon) {
     auto center = stitcher->getCenter();
     tileSource->attachCalibration2(center.x, center.y, lat, lon, stitcher->getZoomLevel());
+    navLayerValid = false;
 
     calibrationStep = 3;
     updateImage();
@@ -637,12 +752,14 @@ void OverlayedMap::setCalibrationPoint2(double lat, double lon) {
 void OverlayedMap::setCalibrationPoint3(double lat, double lon) {
     auto center = stitcher->getCenter();
     tileSource->attachCalibration3Point(center.x, center.y, lat, lon, stitcher->getZoomLevel());
+    navLayerValid = false;
     calibrationStep = 0;
     updateImage();
 }
 
 void OverlayedMap::setCalibrationAngle(double angle) {
     tileSource->attachCalibration3Angle(angle);
+    navLayerValid = false;
     calibrationStep = 0;
     updateImage();
 }
@@ -652,7 +769,7 @@ int OverlayedMap::getCalibrationStep() const {
 }
 
 std::shared_ptr<img::Image> OverlayedMap::getMapImage() {
-    return mapImage;
+    return overlayTarget;
 }
 
 void OverlayedMap::drawRoute() {
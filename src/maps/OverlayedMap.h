@@ -29,6 +29,7 @@
 #include "OverlayedNode.h"
 #include "OverlayedRoute.h"
 #include "OverlayHighlight.h"
+#include "OverlaySpatialHash.h"
 
 namespace maps {
 
@@ -85,8 +86,22 @@ private:
     enum { LAST_CLICK, USER_PLANE, MAP_CENTER, NUM_HIGHLIGHT_NODES }; // last click, user's plane, map-center
     OverlayHighlight highlights[NUM_HIGHLIGHT_NODES]; // last click, user's plane, map-center
 
+    // Everything the NAV overlay layer depends on, apart from the highlighted nodes
+    struct NavLayerState {
+        double centerX = 0, centerY = 0;
+        int zoomLevel = 0, page = 0;
+        int width = 0, height = 0;
+        double northOffset = 0;
+        int configFlags = 0;
+        const world::World *world = nullptr;
+        int worldGeneration = 0;
+        bool operator==(const NavLayerState &other) const;
+    };
+
 private:
     std::shared_ptr<img::Image> mapImage;
+    // the image that overlay nodes draw into, either the map or the NAV layer
+    std::shared_ptr<img::Image> overlayTarget;
     std::shared_ptr<img::TileSource> tileSource;
     std::shared_ptr<img::Stitcher> stitcher;
     std::shared_ptr<OverlayConfig> overlayConfig;
@@ -107,6 +122,19 @@ private:
     using NavNodeToOverlayMap = std::map<const world::NavNode *, std::shared_ptr<OverlayedNode>>;
     std::shared_ptr<NavNodeToOverlayMap> overlayNodeCache;
 
+    // The NAV overlays are rendered into a transparent layer that is kept until the view,
+    // the overlay configuration, the NAV data or the highlighted nodes change. Other frames,
+    // e.g. when only the aircraft moved, just blend the layer over the stitched tiles.
+    std::shared_ptr<img::Image> navLayer;
+    NavLayerState navLayerState;
+    bool navLayerValid = false;
+    bool navLayerEmpty = true;
+    std::vector<std::shared_ptr<OverlayedNode>> visibleFixes;
+    std::vector<std::shared_ptr<OverlayedNode>> visibleAerodromes;
+    const OverlayedNode *layerHighlights[NUM_HIGHLIGHT_NODES] {};
+    // screen positions of the visible overlays' hotspots and placed labels
+    OverlaySpatialHash overlayHash;
+
     std::unique_ptr<OverlayedRoute> overlayedRoute;
     GetRouteCallback getRoute;
 
@@ -125,6 +153,11 @@ private:
     void drawAircraftOverlay();
     void drawOtherAircraftOverlay();
     void drawNavWorldOverlays();
+    NavLayerState getNavLayerState() const;
+    void collectNavWorldOverlays();
+    bool selectHighlights();
+    void renderNavLayer();
+    void drawNavLabels(bool detailed);
     void drawCalibrationOverlay();
     void drawScale();
     void drawCompass();
@@ -146,12 +179,15 @@ private:
     static constexpr const int DENSITY_LIMIT_AIRFIELDS = 15000;
     static constexpr const int DENSITY_LIMIT_NAVAIDS = 6000;
     static constexpr const int DENSITY_LIMIT_FIXES = 3000;
-    static constexpr const int DENSITY_LIMIT_SHOW_TEXT = 400;
+    static constexpr const int DENSITY_LIMIT_SHOW_TEXT = 3000;
     static constexpr const int DENSITY_LIMIT_DETAILED_TEXT = 200;
     // user fixes are generally shown unless significantly zoomed out
     static constexpr const int MAPWIDTH_LIMIT_USERFIXES = 2000;
 
     static constexpr const int MAX_NM_PER_DEGREE = 60; // at the equator, OK for our needs
+    // a click further than this (taxicab distance) from any hotspot doesn't select a node
+    static constexpr const int CLICK_HIT_DISTANCE = 40;
+
     static constexpr const int MAX_ILS_RANGE_NM = 18; // 18nm is max ILS range in XP11 dataset
 };
 
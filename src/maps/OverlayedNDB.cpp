@@ -81,6 +81,19 @@ void OverlayedNDB::drawText(bool detailed)
     }
 }
 
+img::Rect OverlayedNDB::getTextBounds(bool detailed)
+{
+    if (!enabled) return img::Rect{};
+
+    if (detailed) {
+        auto freqString = navNDB->getFrequency().getFrequencyString(false);
+        return getNavTextBoxBounds("", getID(), freqString, posX + radius, posY - radius - 10);
+    } else {
+        auto hs = getClickHotspot();
+        return getTextRect(getID(), 12, hs.first, hs.second, img::Align::CENTRE);
+    }
+}
+
 OverlayedNode::Hotspot OverlayedNDB::getClickHotspot() const {
     return Hotspot(posX + radius + 5, posY - radius - 5);
 }
@@ -42,5 +42,25 @@ int OverlayedNode::getHotspotDistance(int x, int y) const {
     return std::abs(x - hs.first) + std::abs(y - hs.second);
 }
 
+img::SpanRasterizer &OverlayedNode::beginShapes() {
+    // reused to keep its buffers, maps can be drawn on more than one thread
+    thread_local img::SpanRasterizer shapes;
+    auto mapImage = overlayHelper->getMapImage();
+    shapes.reset(mapImage->getWidth(), mapImage->getHeight());
+    return shapes;
+}
+
+img::Rect OverlayedNode::getTextRect(const std::string &text, int size, int x, int y, img::Align align) const {
+    // the same placement as Image::drawText, including the margin of its background
+    int width = overlayHelper->getMapImage()->getTextWidth(text, size);
+    int xOffset = 0;
+    if (align == img::Align::CENTRE) {
+        xOffset = -width / 2;
+    } else if (align == img::Align::RIGHT) {
+        xOffset = -width;
+    }
+    return img::Rect{x + xOffset - 1, y, x + xOffset + width + 1, y + size + 1};
+}
+
 } /* namespace maps */
 
@@ -21,6 +21,7 @@
 #include "OverlayHelper.h"
 #include "src/world/graph/NavNode.h"
 #include "src/libimg/Image.h"
+#include "src/libimg/SpanRasterizer.h"
 #include "src/Logger.h"
 
 namespace maps {
@@ -32,9 +33,15 @@ public:
 
     virtual std::string getID() const = 0;
 
+    // Labels are placed in the order of their priority, lower ones are culled if they overlap
+    enum class LabelPriority { FIX, NAVAID, AIRPORT, TOWERED_AIRPORT };
+
     virtual void configure(const OverlayConfig &cfg, const world::Location &loc);
     virtual void drawGraphic() = 0;
     virtual void drawText(bool detailed) = 0;
+    // The area that drawText will cover, empty if there is no text to draw
+    virtual img::Rect getTextBounds(bool detailed) = 0;
+    virtual LabelPriority getLabelPriority() const { return LabelPriority::FIX; }
 
     void setHighlighted() { highlight = true; }
     void clearHighlighted() { highlight = false; }
@@ -44,10 +51,14 @@ public:
 
     int getHotspotDistance(int x, int y) const;
 
-protected:
     using Hotspot = std::pair<int, int>;
     virtual Hotspot getClickHotspot() const { return Hotspot(posX, posY); }
 
+protected:
+    img::Rect getTextRect(const std::string &text, int size, int x, int y, img::Align align) const;
+    // Shapes that are filled in one pass over the map image, shared by the nodes drawn on a thread
+    img::SpanRasterizer &beginShapes();
+
 protected:
     OverlayedNode() = delete;
     OverlayedNode(IOverlayHelper *helper, bool airfield);
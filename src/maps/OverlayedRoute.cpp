@@ -129,14 +129,10 @@ std::pair<int, int> OverlayedRoute::drawLeg(int x0, int y0, int x1, int y1) {
         return std::pair<int, int>(0,0);
     }
 
-    // Draw leg graphic
+    // Draw leg graphic, a yellow band with black edges
     auto mapImage = overlayHelper->getMapImage();
-    int s = (std::abs(y1 - y0) > std::abs(x1 - x0)) ? 1 : 0;
-    mapImage->drawLine(x0 + s * -3, y0 + !s * -3, x1 + s * -3, y1 + !s * -3, img::COLOR_BLACK);
-    for (int i = -2; i <= 2; i++) {
-        mapImage->drawLine(x0 + s * i, y0 + !s * i, x1 + s * i, y1 + !s * i, img::COLOR_YELLOW);
-    }
-    mapImage->drawLine(x0 + s * 3, y0 + !s * 3, x1 + s * 3, y1 + !s * 3, img::COLOR_BLACK);
+    mapImage->drawThickLine(x0, y0, x1, y1, 7, img::COLOR_BLACK);
+    mapImage->drawThickLine(x0, y0, x1, y1, 5, img::COLOR_YELLOW);
 
     return std::pair<int, int>(xmax - xmin, ymax - ymin);
 }
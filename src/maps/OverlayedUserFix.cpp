@@ -71,22 +71,15 @@ void OverlayedUserFix::drawGraphic() {
 }
 
 void OverlayedUserFix::drawText(bool detailed) {
-    if (!detailed) {
+    if (!detailed || !hasText()) {
         return;
     }
     auto type = fix->getUserFix()->getType();
-    if ((type != world::UserFix::Type::POI && type != world::UserFix::Type::VRP
-      && type != world::UserFix::Type::MARKER)) {
-        return;
-    }
 
     splitNameToLines();
 
     auto mapImage = overlayHelper->getMapImage();
-    int textWidth = mapImage->getTextWidth(textLines[0], TEXT_SIZE);
-    if (textLines.size() == 2) {
-        textWidth = std::max(mapImage->getTextWidth(textLines[1], TEXT_SIZE), textWidth);
-    }
+    int textWidth = getTextLinesWidth();
     int x = posX + DIAG + 1;
     int y = posY + DIAG + 1;
     int yo = TEXT_SIZE / 2;
@@ -119,6 +112,37 @@ void OverlayedUserFix::drawText(bool detailed) {
     mapImage->drawText(typeString, TEXT_SIZE, x + borderWidth / 2, y - yo + 1, color, img::COLOR_WHITE, img::Align::CENTRE);
 }
 
+img::Rect OverlayedUserFix::getTextBounds(bool detailed) {
+    if (!detailed || !hasText()) {
+        return img::Rect{};
+    }
+
+    splitNameToLines();
+
+    int textWidth = getTextLinesWidth();
+    int x = posX + DIAG + 1;
+    int y = posY + DIAG + 1;
+    int yo = TEXT_SIZE / 2;
+    int borderWidth = textWidth + 4;
+    int borderHeight = (TEXT_SIZE * (textLines.size() + 0.5)) + 1;
+    return img::Rect{x, y - yo, x + borderWidth + 1, y + borderHeight + 1};
+}
+
+bool OverlayedUserFix::hasText() const {
+    auto type = fix->getUserFix()->getType();
+    return (type == world::UserFix::Type::POI) || (type == world::UserFix::Type::VRP)
+        || (type == world::UserFix::Type::MARKER);
+}
+
+int OverlayedUserFix::getTextLinesWidth() {
+    auto mapImage = overlayHelper->getMapImage();
+    int textWidth = mapImage->getTextWidth(textLines[0], TEXT_SIZE);
+    if (textLines.size() == 2) {
+        textWidth = std::max(mapImage->getTextWidth(textLines[1], TEXT_SIZE), textWidth);
+    }
+    return textWidth;
+}
+
 void OverlayedUserFix::splitNameToLines() {
     // Split the description into 1 or 2 lines
     std::string full_text = fix->getUserFix()->getName();
@@ -31,9 +31,13 @@ public:
 
     void drawGraphic() override;
     void drawText(bool detailed) override;
+    img::Rect getTextBounds(bool detailed) override;
+    LabelPriority getLabelPriority() const override { return LabelPriority::NAVAID; }
 
 private:
     void splitNameToLines();
+    bool hasText() const;
+    int getTextLinesWidth();
 
     static void createIcons();
 
@@ -58,7 +58,9 @@ void OverlayedVOR::drawGraphic()
     mapImage->drawLine(posX - r, posY, posX - r / 2, posY - r, img::COLOR_ICAO_VOR_DME);
     mapImage->drawLine(posX - r / 2, posY - r, posX + r / 2, posY - r, img::COLOR_ICAO_VOR_DME);
 
-    mapImage->drawCircle(posX, posY, CIRCLE_RADIUS, img::COLOR_ICAO_VOR_DME);
+    // The compass rose and its ticks are filled together
+    auto &rose = beginShapes();
+    rose.addArc(posX, posY, CIRCLE_RADIUS, 0, 360, 1);
 
     // Draw ticks
     const float BIG_TICK_SCALE = 0.84;
@@ -72,20 +74,21 @@ void OverlayedVOR::drawGraphic()
         overlayHelper->fastPolarToCartesian(CIRCLE_RADIUS, deg + bearing, outer_x, outer_y);
 
         if (deg == 0) {
-            mapImage->drawLineAA(posX, posY, posX + outer_x, posY + outer_y, img::COLOR_ICAO_VOR_DME);
+            rose.addLine(posX, posY, posX + outer_x, posY + outer_y, 1);
         } else {
-            mapImage->drawLineAA(posX + inner_x, posY + inner_y, posX + outer_x, posY + outer_y, img::COLOR_ICAO_VOR_DME);
+            rose.addLine(posX + inner_x, posY + inner_y, posX + outer_x, posY + outer_y, 1);
         }
 
         if ((deg % 90) == 0) {
             double inner1_x, inner1_y, inner2_x, inner2_y;
             overlayHelper->fastPolarToCartesian(CIRCLE_RADIUS * BIG_TICK_SCALE, deg + bearing - 2, inner1_x, inner1_y);
             overlayHelper->fastPolarToCartesian(CIRCLE_RADIUS * BIG_TICK_SCALE, deg + bearing + 2, inner2_x, inner2_y);
-            mapImage->drawLineAA(posX + inner1_x, posY + inner1_y, posX + outer_x,  posY + outer_y,  img::COLOR_ICAO_VOR_DME);
-            mapImage->drawLineAA(posX + inner2_x, posY + inner2_y, posX + outer_x,  posY + outer_y,  img::COLOR_ICAO_VOR_DME);
-            mapImage->drawLineAA(posX + inner1_x, posY + inner1_y, posX + inner2_x, posY + inner2_y, img::COLOR_ICAO_VOR_DME);
+            rose.addLine(posX + inner1_x, posY + inner1_y, posX + outer_x,  posY + outer_y,  1);
+            rose.addLine(posX + inner2_x, posY + inner2_y, posX + outer_x,  posY + outer_y,  1);
+            rose.addLine(posX + inner1_x, posY + inner1_y, posX + inner2_x, posY + inner2_y, 1);
         }
     }
+    rose.fill(*mapImage, img::COLOR_ICAO_VOR_DME);
 }
 
 void OverlayedVOR::drawText(bool detailed)
@@ -104,6 +107,20 @@ void OverlayedVOR::drawText(bool detailed)
     }
 }
 
+img::Rect OverlayedVOR::getTextBounds(bool detailed)
+{
+    if (!enabled) return img::Rect{};
+
+    if (detailed) {
+        std::string type = linkedDME ? "VOR/DME" : "VOR";
+        auto freqString = navVOR->getFrequency().getFrequencyString(false);
+        return getNavTextBoxBounds(type, getID(), freqString, posX - 47, posY - 37);
+    } else {
+        auto hs = getClickHotspot();
+        return getTextRect(getID(), 12, hs.first, hs.second, img::Align::CENTRE);
+    }
+}
+
 OverlayedNode::Hotspot OverlayedVOR::getClickHotspot() const {
     return Hotspot(posX - 20, posY - 20);
 }
@@ -37,4 +37,8 @@ void OverlayedWaypoint::drawText(bool detailed) {
     mapImage->drawText(fix->getID(), 10, posX + 6, posY - 6, color, 0, img::Align::LEFT);
 }
 
+img::Rect OverlayedWaypoint::getTextBounds(bool detailed) {
+    return getTextRect(fix->getID(), 10, posX + 6, posY - 6, img::Align::LEFT);
+}
+
 } /* namespace maps */
@@ -29,6 +29,7 @@ public:
 
     void drawGraphic() override;
     void drawText(bool detailed) override;
+    img::Rect getTextBounds(bool detailed) override;
 
 private:
     static constexpr const uint32_t color = img::COLOR_BLACK;
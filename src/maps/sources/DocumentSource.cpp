@@ -132,6 +132,10 @@ void DocumentSource::cancelPendingLoads() {
 void DocumentSource::resumeLoading() {
 }
 
+int DocumentSource::getMaxParallelLoads() {
+    return rasterizer.getMaxParallelRenders();
+}
+
 img::Point<int> DocumentSource::getPageDimensions(int page, int zoom) {
     return img::Point<int>{rasterizer.getPageWidth(page, zoom), rasterizer.getPageHeight(page, zoom)};
 }
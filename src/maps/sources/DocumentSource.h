@@ -47,6 +47,7 @@ public:
     std::unique_ptr<img::Image> loadTileImage(int page, int x, int y, int zoom) override;
     void cancelPendingLoads() override;
     void resumeLoading() override;
+    int getMaxParallelLoads() override;
 
     bool supportsWorldCoords() override;
     std::string getCalibrationReport() override;
@@ -17,15 +17,127 @@
  */
 #include <stdexcept>
 #include <sstream>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <geovalues.h>
 #include "GeoTIFFSource.h"
+#include "src/libimg/TiffTileWriter.h"
 #include "src/Logger.h"
 #include "src/platform/Platform.h"
 
 namespace maps {
 
-GeoTIFFSource::GeoTIFFSource(const std::string &utf8File) {
+namespace {
+
+// Halves the first rows of an image by averaging 2x2 pixel blocks
+img::Image halve(const img::Image &src, int rows) {
+    int srcWidth = src.getWidth();
+    int width = (srcWidth + 1) / 2;
+    int height = (rows + 1) / 2;
+    img::Image dst(width, height, 0);
+
+    const uint32_t *srcPixels = src.getPixels();
+    uint32_t *dstPixels = dst.getPixels();
+    for (int y = 0; y < height; y++) {
+        const uint32_t *row0 = srcPixels + (size_t) 2 * y * srcWidth;
+        const uint32_t *row1 = (2 * y + 1 < rows) ? row0 + srcWidth : row0;
+        for (int x = 0; x < width; x++) {
+            int x0 = 2 * x;
+            int x1 = std::min(x0 + 1, srcWidth - 1);
+            uint32_t res = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                uint32_t sum = ((row0[x0] >> shift) & 0xFF) + ((row0[x1] >> shift) & 0xFF) +
+                               ((row1[x0] >> shift) & 0xFF) + ((row1[x1] >> shift) & 0xFF);
+                res |= ((sum + 2) / 4) << shift;
+            }
+            dstPixels[y * width + x] = res;
+        }
+    }
+    return dst;
+}
+
+// Receives the full image from top to bottom and writes each zoomed out level
+// as soon as a row of its tiles is complete, so only a band of each level is in memory
+class PyramidBuilder {
+public:
+    PyramidBuilder(int fullWidth, int fullHeight, int tileSize, const std::vector<std::string> &files):
+        tileSize(tileSize)
+    {
+        int width = fullWidth, height = fullHeight;
+        for (auto &file: files) {
+            width = (width + 1) / 2;
+            height = (height + 1) / 2;
+            Level level;
+            level.writer = std::make_unique<img::TiffTileWriter>(file, width, height, tileSize);
+            level.band = img::Image(width, tileSize, 0);
+            levels.push_back(std::move(level));
+        }
+    }
+
+    void addRows(const img::Image &rows) {
+        append(0, halve(rows, rows.getHeight()));
+    }
+
+    void finish() {
+        for (size_t i = 0; i < levels.size(); i++) {
+            if (levels[i].filled > 0) {
+                flush(i);
+            }
+            levels[i].writer->close();
+        }
+    }
+
+private:
+    struct Level {
+        std::unique_ptr<img::TiffTileWriter> writer;
+        img::Image band;
+        int filled = 0;
+        int tileRow = 0;
+    };
+
+    int tileSize;
+    std::vector<Level> levels;
+
+    void append(size_t i, const img::Image &rows) {
+        Level &level = levels[i];
+        int width = level.band.getWidth();
+        int srcRow = 0;
+        while (srcRow < rows.getHeight()) {
+            int count = std::min(rows.getHeight() - srcRow, tileSize - level.filled);
+            std::memcpy(level.band.getPixels() + (size_t) level.filled * width,
+                        rows.getPixels() + (size_t) srcRow * width,
+                        (size_t) count * width * sizeof(uint32_t));
+            level.filled += count;
+            srcRow += count;
+            if (level.filled == tileSize) {
+                flush(i);
+            }
+        }
+    }
+
+    void flush(size_t i) {
+        Level &level = levels[i];
+        img::Image tile(tileSize, tileSize, 0);
+        for (int x = 0; x * tileSize < level.band.getWidth(); x++) {
+            tile.clear(0);
+            level.band.copyTo(tile, x * tileSize, 0);
+            level.writer->writeTile(x, level.tileRow, tile);
+        }
+
+        if (i + 1 < levels.size()) {
+            append(i + 1, halve(level.band, level.filled));
+        }
+
+        level.band.clear(0);
+        level.filled = 0;
+        level.tileRow++;
+    }
+};
+
+}
+
+GeoTIFFSource::GeoTIFFSource(const std::string &utf8File, const std::string &utf8CacheDir) {
     tiff.loadTIFF(utf8File);
     gtif = GTIFNew(tiff.getXtiffHandle());
     if (!gtif) {
@@ -36,6 +148,14 @@ GeoTIFFSource::GeoTIFFSource(const std::string &utf8File) {
         GTIFFree(gtif);
         throw std::runtime_error("No DEFN");
     }
+
+    // the pyramid is rebuilt when the file is replaced
+    std::error_code ec;
+    auto path = fs::u8path(utf8File);
+    auto fileSize = fs::file_size(path, ec);
+    auto modified = fs::last_write_time(path, ec).time_since_epoch().count();
+    pyramidDir = utf8CacheDir + platform::getFileNameFromPath(utf8File) + "-" +
+                 std::to_string(fileSize) + "-" + std::to_string(modified) + "/";
 }
 
 int GeoTIFFSource::getMinZoomLevel() {
@@ -126,21 +246,205 @@ std::unique_ptr<img::Image> GeoTIFFSource::loadTileImage(int page, int x, int y,
         throw std::runtime_error("Invalid page for GeoTIFFSource");
     }
 
+    int generation = cancelGeneration;
+
+    if (zoom < 0 && pyramidReady) {
+        return loadPyramidTile(x, y, zoom);
+    }
+
+    // the smallest level that has at least the resolution of the tile
     auto scale = zoomToScale(zoom);
+    int fullWidth = tiff.getFullWidth();
+    int level = 0;
+    for (int i = 1; i < tiff.getLevelCount(); i++) {
+        if (tiff.getLevelWidth(i) >= fullWidth * scale) {
+            level = i;
+        }
+    }
+
+    double levelScale = (double) tiff.getLevelWidth(level) / fullWidth;
+    int regionSize = std::round(tileSize / scale * levelScale);
+    if (regionSize > tileSize * MAX_DIRECT_REDUCTION) {
+        if (loadPyramid(generation)) {
+            return loadPyramidTile(x, y, zoom);
+        }
+        // another load is building the pyramid or it couldn't be built
+        return loadReducedTile(level, x, y, regionSize, generation);
+    }
+
+    auto img = std::make_unique<img::Image>(regionSize, regionSize, 0);
+    tiff.readRegion(level, x * regionSize, y * regionSize, *img);
+    if (regionSize != tileSize) {
+        img->scale(tileSize, tileSize);
+    }
+
+    return img;
+}
+
+void GeoTIFFSource::checkCancelled(int generation) {
+    if (cancelGeneration != generation) {
+        // the tile cache treats this as a cancelled load rather than an error
+        throw std::out_of_range("Cancelled");
+    }
+}
+
+std::unique_ptr<img::Image> GeoTIFFSource::loadReducedTile(int level, int x, int y, int regionSize, int generation) {
+    // averages the level pixels that fall into each tile pixel, reading the region in bands
+    // so that only a few rows of it are in memory
+    int left = x * regionSize;
+    int top = y * regionSize;
+    int width = std::min(regionSize, tiff.getLevelWidth(level) - left);
+    int height = std::min(regionSize, tiff.getLevelHeight(level) - top);
+
+    auto img = std::make_unique<img::Image>(tileSize, tileSize, 0);
+    if (width <= 0 || height <= 0) {
+        return img;
+    }
 
-    tiff.loadFullImage();
+    std::vector<int> column(width);
+    for (int bx = 0; bx < width; bx++) {
+        column[bx] = (int64_t) bx * tileSize / regionSize;
+    }
 
-    auto img = std::make_unique<img::Image>(tileSize / scale, tileSize / scale, 0);
-    tiff.copyTo(*img, x * tileSize / scale, y * tileSize / scale);
-    img->scale(tileSize, tileSize);
+    std::vector<uint32_t> sums((size_t) tileSize * tileSize * 4, 0);
+    std::vector<uint32_t> counts((size_t) tileSize * tileSize, 0);
+    for (int row = 0; row < height; row += PYRAMID_BAND_ROWS) {
+        checkCancelled(generation);
+        img::Image band(width, std::min(PYRAMID_BAND_ROWS, height - row), 0);
+        tiff.readRegion(level, left, top + row, band);
+
+        const uint32_t *pixels = band.getPixels();
+        for (int by = 0; by < band.getHeight(); by++) {
+            size_t tileRow = (size_t) ((int64_t) (row + by) * tileSize / regionSize) * tileSize;
+            for (int bx = 0; bx < width; bx++) {
+                uint32_t pixel = *pixels++;
+                size_t i = tileRow + column[bx];
+                uint32_t *sum = &sums[i * 4];
+                sum[0] += (pixel >> 24) & 0xFF;
+                sum[1] += (pixel >> 16) & 0xFF;
+                sum[2] += (pixel >> 8) & 0xFF;
+                sum[3] += pixel & 0xFF;
+                counts[i]++;
+            }
+        }
+    }
 
+    uint32_t *dst = img->getPixels();
+    for (size_t i = 0; i < counts.size(); i++) {
+        uint32_t n = counts[i];
+        if (n == 0) {
+            continue;
+        }
+        const uint32_t *sum = &sums[i * 4];
+        dst[i] = (((sum[0] + n / 2) / n) << 24) | (((sum[1] + n / 2) / n) << 16) |
+                 (((sum[2] + n / 2) / n) << 8) | ((sum[3] + n / 2) / n);
+    }
     return img;
 }
 
+std::unique_ptr<img::Image> GeoTIFFSource::loadPyramidTile(int x, int y, int zoom) {
+    auto img = std::make_unique<img::Image>(tileSize, tileSize, 0);
+    pyramid.at(-zoom - 1)->readRegion(0, x * tileSize, y * tileSize, *img);
+    return img;
+}
+
+bool GeoTIFFSource::loadPyramid(int generation) {
+    {
+        // only the first load that needs the pyramid builds it, the others don't wait for it
+        std::lock_guard<std::mutex> lock(pyramidMutex);
+        if (pyramidState != PyramidState::MISSING) {
+            return pyramidState == PyramidState::READY;
+        }
+        pyramidState = PyramidState::BUILDING;
+    }
+
+    std::vector<std::string> levelFiles;
+    bool complete = true;
+    for (int zoom = -1; zoom >= getMinZoomLevel(); zoom--) {
+        levelFiles.push_back(pyramidDir + "zoom" + std::to_string(zoom) + ".tif");
+        complete = complete && platform::fileExists(levelFiles.back());
+    }
+
+    std::vector<std::unique_ptr<img::XTiffImage>> levels;
+    PyramidState result = PyramidState::FAILED;
+    try {
+        if (!complete) {
+            buildPyramid(levelFiles, generation);
+        }
+
+        for (auto &file: levelFiles) {
+            auto level = std::make_unique<img::XTiffImage>();
+            level->loadTIFF(file);
+            levels.push_back(std::move(level));
+        }
+        result = PyramidState::READY;
+    } catch (const std::out_of_range &e) {
+        // cancelled, the next load that needs the pyramid starts over
+        std::lock_guard<std::mutex> lock(pyramidMutex);
+        pyramidState = PyramidState::MISSING;
+        throw;
+    } catch (const std::exception &e) {
+        logger::warn("Couldn't create GeoTIFF pyramid in %s: %s", pyramidDir.c_str(), e.what());
+    }
+
+    std::lock_guard<std::mutex> lock(pyramidMutex);
+    if (result == PyramidState::READY) {
+        pyramid = std::move(levels);
+        pyramidReady = true;
+    }
+    pyramidState = result;
+    return pyramidReady;
+}
+
+void GeoTIFFSource::buildPyramid(const std::vector<std::string> &levelFiles, int generation) {
+    logger::info("Building GeoTIFF pyramid in %s", pyramidDir.c_str());
+    auto startAt = platform::measureTime();
+
+    platform::mkpath(pyramidDir);
+
+    // the files only get their final names once all levels are complete
+    std::vector<std::string> partFiles;
+    for (auto &file: levelFiles) {
+        partFiles.push_back(file + ".part");
+    }
+
+    try {
+        int fullWidth = tiff.getFullWidth();
+        int fullHeight = tiff.getFullHeight();
+        PyramidBuilder builder(fullWidth, fullHeight, tileSize, partFiles);
+        for (int y = 0; y < fullHeight; y += PYRAMID_BAND_ROWS) {
+            checkCancelled(generation);
+            img::Image band(fullWidth, std::min(PYRAMID_BAND_ROWS, fullHeight - y), 0);
+            tiff.readRegion(0, 0, y, band);
+            builder.addRows(band);
+        }
+        builder.finish();
+    } catch (...) {
+        for (auto &file: partFiles) {
+            if (platform::fileExists(file)) {
+                platform::removeFile(file);
+            }
+        }
+        throw;
+    }
+
+    for (size_t i = 0; i < levelFiles.size(); i++) {
+        fs::rename(fs::u8path(partFiles[i]), fs::u8path(levelFiles[i]));
+    }
+
+    logger::info("GeoTIFF pyramid built in %d ms", platform::getElapsedMillis(startAt));
+}
+
 void GeoTIFFSource::cancelPendingLoads() {
+    ++cancelGeneration;
 }
 
 void GeoTIFFSource::resumeLoading() {
+    // loads started after a cancel compare against the new generation
+}
+
+int GeoTIFFSource::getMaxParallelLoads() {
+    return MAX_PARALLEL_LOADS;
 }
 
 bool GeoTIFFSource::supportsWorldCoords() {
@@ -20,6 +20,9 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
 #include <geotiff.h>
 #include <geo_normalize.h>
 #include "src/libimg/XTiffImage.h"
@@ -30,7 +33,8 @@ namespace maps {
 
 class GeoTIFFSource: public img::TileSource {
 public:
-    GeoTIFFSource(const std::string &utf8File);
+    // reduced resolution tiles that the file doesn't provide are cached below utf8CacheDir
+    GeoTIFFSource(const std::string &utf8File, const std::string &utf8CacheDir);
 
     int getMinZoomLevel() override;
     int getMaxZoomLevel() override;
@@ -46,6 +50,7 @@ public:
     std::unique_ptr<img::Image> loadTileImage(int page, int x, int y, int zoom) override;
     void cancelPendingLoads() override;
     void resumeLoading() override;
+    int getMaxParallelLoads() override;
 
     bool supportsWorldCoords() override;
     img::Point<double> worldToXY(double lon, double lat, int zoom) override;
@@ -53,13 +58,45 @@ public:
 
     ~GeoTIFFSource();
 private:
+    // a tile is read from a level of the file if that needs at most this many level pixels
+    // per tile pixel, otherwise it comes from the pyramid
+    static constexpr const int MAX_DIRECT_REDUCTION = 2;
+    // rows decoded at once while building the pyramid or reducing a tile directly
+    static constexpr const int PYRAMID_BAND_ROWS = 128;
+    // one load can build the pyramid while others read tiles directly
+    static constexpr const int MAX_PARALLEL_LOADS = 2;
+
     int tileSize = 512;
 
     img::XTiffImage tiff;
     GTIF *gtif{};
     GTIFDefn defn{};
 
+    // The pyramid holds the zoomed out levels in tiled TIFFs, pyramid[0] for zoom -1.
+    // It's built by the first load that needs it and kept on disk. Until it is
+    // ready, or if it can't be built, tiles are reduced from the file directly.
+    enum class PyramidState {
+        MISSING,
+        BUILDING,
+        READY,
+        FAILED,
+    };
+
+    std::string pyramidDir;
+    std::mutex pyramidMutex;
+    PyramidState pyramidState = PyramidState::MISSING;
+    std::vector<std::unique_ptr<img::XTiffImage>> pyramid;
+    std::atomic_bool pyramidReady { false };
+
+    // loads compare it to the value at their start to notice a cancel
+    std::atomic_int cancelGeneration { 0 };
+
     float zoomToScale(int zoom);
+    void checkCancelled(int generation);
+    std::unique_ptr<img::Image> loadReducedTile(int level, int x, int y, int regionSize, int generation);
+    std::unique_ptr<img::Image> loadPyramidTile(int x, int y, int zoom);
+    bool loadPyramid(int generation);
+    void buildPyramid(const std::vector<std::string> &levelFiles, int generation);
 };
 
 } /* namespace maps */
@@ -189,13 +189,9 @@ std::string OnlineSlippySource::getTileURL(bool randomHost, int x, int y, int zo
     searchAndReplace(tileUrl, "{x}", std::to_string(x));
     searchAndReplace(tileUrl, "{y}", std::to_string(y));
 
-    if (++hostIndex == tileServers.size()) {
-        hostIndex = 0;
-    }
-
     std::ostringstream nameStream;
     if (randomHost) {
-        nameStream << tileServers[hostIndex];
+        nameStream << tileServers[hostIndex++ % tileServers.size()];
     } else {
         std::regex replaceChars("[=/#]");
         tileUrl = tileUrl.replace(0, 1, ""); // Remove leading '/'
@@ -226,20 +222,61 @@ std::string OnlineSlippySource::getUniqueTileName(int page, int x, int y, int zo
 }
 
 std::unique_ptr<img::Image> OnlineSlippySource::loadTileImage(int page, int x, int y, int zoom) {
-    cancelToken = false;
     std::string path = getTileURL(true, x, y, zoom);
-    auto data = downloader.download(protocol + "://" + path, cancelToken);
+
+    // each curl handle can only be used by one thread at a time
+    std::unique_ptr<Downloader> downloader;
+    {
+        std::lock_guard<std::mutex> lock(downloaderMutex);
+        if (!idleDownloaders.empty()) {
+            downloader = std::move(idleDownloaders.back());
+            idleDownloaders.pop_back();
+        }
+    }
+    if (!downloader) {
+        downloader = std::make_unique<Downloader>();
+    }
+
+    std::atomic_bool cancelToken { false };
+    {
+        std::lock_guard<std::mutex> lock(downloaderMutex);
+        activeLoads.insert(&cancelToken);
+    }
+
+    std::vector<uint8_t> data;
+    try {
+        data = downloader->download(protocol + "://" + path, cancelToken);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(downloaderMutex);
+        activeLoads.erase(&cancelToken);
+        idleDownloaders.push_back(std::move(downloader));
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(downloaderMutex);
+        activeLoads.erase(&cancelToken);
+        idleDownloaders.push_back(std::move(downloader));
+    }
+
     auto image = std::make_unique<img::Image>();
     image->loadEncodedData(data, true);
     return image;
 }
 
 void OnlineSlippySource::cancelPendingLoads() {
-    cancelToken = true;
+    std::lock_guard<std::mutex> lock(downloaderMutex);
+    for (auto token: activeLoads) {
+        *token = true;
+    }
 }
 
 void OnlineSlippySource::resumeLoading() {
-    cancelToken = false;
+    // loads started after a cancel use new tokens
+}
+
+int OnlineSlippySource::getMaxParallelLoads() {
+    return MAX_PARALLEL_DOWNLOADS;
 }
 
 std::string OnlineSlippySource::getCopyrightInfo() {
@@ -18,6 +18,9 @@
 #ifndef SRC_MAPS_OPENTOPOSOURCE_H_
 #define SRC_MAPS_OPENTOPOSOURCE_H_
 
+#include <mutex>
+#include <atomic>
+#include <set>
 #include "src/libimg/stitcher/TileSource.h"
 #include "src/maps/Downloader.h"
 
@@ -43,6 +46,7 @@ public:
     // Control the underlying loader
     void cancelPendingLoads() override;
     void resumeLoading() override;
+    int getMaxParallelLoads() override;
 
     // Query and load tile information
     int getPageCount() override;
@@ -59,9 +63,14 @@ public:
     std::string getCopyrightInfo() override;
     const std::string name;
 private:
-    bool cancelToken = false;
-    uint8_t hostIndex = 0;
-    Downloader downloader;
+    static constexpr const int MAX_PARALLEL_DOWNLOADS = 4;
+
+    std::atomic<unsigned int> hostIndex { 0 };
+    // protects the idle downloaders and the cancel tokens of the running loads,
+    // each load has its own token so that starting a load can't undo a cancel
+    std::mutex downloaderMutex;
+    std::vector<std::unique_ptr<Downloader>> idleDownloaders;
+    std::set<std::atomic_bool *> activeLoads;
     std::vector<std::string> tileServers;
     std::string url;
     size_t minZoom;
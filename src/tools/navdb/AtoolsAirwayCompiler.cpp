@@ -17,33 +17,26 @@
  */
 
 #include "AtoolsAirwayCompiler.h"
-#include "AtoolsNavTranslator.h"
 #include "src/Logger.h"
+#include <sstream>
 
-AtoolsDbAirwayCompiler::AtoolsDbAirwayCompiler(std::shared_ptr<sqlnav::SqlDatabase> targ, std::shared_ptr<AtoolsDbNavTranslator> o)
-:   db(targ), owner(o), nextAirwayId(1)
+AtoolsDbAirwayCompiler::AtoolsDbAirwayCompiler(std::shared_ptr<sqlnav::SqlDatabase> targ)
+:   db(targ), nextAirwayId(1),
+    airwayRows(targ, "airway", 6), fixAirwayRows(targ, "fix_airway", 2), edgeRows(targ, "airway_edge", 3)
 {
-    awyvals = std::make_unique<std::ostringstream>();
-    fixawyvals = std::make_unique<std::ostringstream>();
 }
 
 AtoolsDbAirwayCompiler::~AtoolsDbAirwayCompiler()
 {
-    // generate insertion values for the previous airway
+    // insert the rows for the previous airway
     generate(forwardFixes);
     generate(reverseFixes);
-    // commit everything to the database
-    update();
 }
 
 void AtoolsDbAirwayCompiler::startAirway(const std::string &n, const std::string &t)
 {
     generate(forwardFixes);
     generate(reverseFixes);
-    if (rowCount > 1000) {
-        update();
-        rowCount = 0;
-    }
     name = n;
     type = t;
 }
@@ -100,34 +93,26 @@ void AtoolsDbAirwayCompiler::generate(FixSequence &legs)
 
     auto id = nextAirwayId++;
 
-    // generate fix->airway indices (will be used by route-finder)
-    for (auto f: legs) {
-        *fixawyvals << "(" << f << "," << id << "),";
-    }
-
-    // code here to generate value insertions for the tables
+    // the airway row is inserted first, the other tables reference it
     auto initialFix = legs.front();
-    legs.pop_front();
     auto finalFix = legs.back();
-    legs.pop_back();
     std::ostringstream vias;
-    for (auto v: legs) {
-        vias << v << ":";
+    for (auto v = std::next(legs.begin()); v != std::prev(legs.end()); ++v) {
+        vias << *v << ":";
     }
     auto vstr = vias.str();
     if (!vstr.empty()) vstr.pop_back();
-    *awyvals << "(" << id << ",'" << name << "','" << type << "'," << initialFix << "," << finalFix << ",'" << vstr << "'),";
+    airwayRows.insert(id, name, type, initialFix, finalFix, vstr);
 
-    ++rowCount;
-    legs.clear();
-}
+    // generate fix->airway indices (will be used by route-finder)
+    for (auto f: legs) {
+        fixAirwayRows.insert(f, id);
+    }
 
-void AtoolsDbAirwayCompiler::update()
-{
-    auto o = owner.lock();
+    // generate the directed legs of the airway (used by the route-finder's adjacency loading)
+    for (auto f1 = legs.begin(), f2 = std::next(legs.begin()); f2 != legs.end(); ++f1, ++f2) {
+        edgeRows.insert(*f1, *f2, id);
+    }
 
-    o->exec_insert("airway", awyvals->str());
-    awyvals = std::make_unique<std::ostringstream>();
-    o->exec_insert("fix_airway", fixawyvals->str());
-    fixawyvals = std::make_unique<std::ostringstream>();
+    legs.clear();
 }
@@ -22,15 +22,13 @@
 #include <map>
 #include <list>
 #include <vector>
-#include <sstream>
 #include "src/libnavsql/SqlDatabase.h"
-
-class AtoolsDbNavTranslator;
+#include "SqlTableInserter.h"
 
 class AtoolsDbAirwayCompiler
 {
 public:
-    AtoolsDbAirwayCompiler(std::shared_ptr<sqlnav::SqlDatabase> targ, std::shared_ptr<AtoolsDbNavTranslator> owner);
+    AtoolsDbAirwayCompiler(std::shared_ptr<sqlnav::SqlDatabase> targ);
     ~AtoolsDbAirwayCompiler();
 
     void startAirway(const std::string &name, const std::string &type);
@@ -41,16 +39,14 @@ public:
 private:
     using FixSequence = std::list<int>;
     void generate(FixSequence &legs);
-    void update();
 
 private:
     std::shared_ptr<sqlnav::SqlDatabase> db;
-    std::weak_ptr<AtoolsDbNavTranslator> owner;
 
     int nextAirwayId;
-    int rowCount;
-    std::unique_ptr<std::ostringstream> awyvals;
-    std::unique_ptr<std::ostringstream> fixawyvals;
+    SqlTableInserter airwayRows;
+    SqlTableInserter fixAirwayRows;
+    SqlTableInserter edgeRows;
 
     std::string name;
     std::string type;
@@ -19,18 +19,15 @@
 #include <iostream>
 #include <map>
 #include <cmath>
-#include <sstream>
-#include <iomanip>
 #include <vector>
 #include <algorithm>
 #include "AtoolsNavTranslator.h"
 #include "AtoolsProcCompiler.h"
 #include "AtoolsAirwayCompiler.h"
+#include "SqlTableInserter.h"
 #include "src/libnavsql/SqlStatement.h"
 #include "src/Logger.h"
 
-static inline std::string quoted(std::string &s);
-
 AtoolsDbNavTranslator::AtoolsDbNavTranslator(std::shared_ptr<sqlnav::SqlDatabase> o, std::shared_ptr<sqlnav::SqlDatabase> i)
 :   avi(o), lnm(i), next_fix_id(1)
 {
@@ -38,39 +35,65 @@ AtoolsDbNavTranslator::AtoolsDbNavTranslator(std::shared_ptr<sqlnav::SqlDatabase
 
 void AtoolsDbNavTranslator::translate()
 {
+    begin_build();
     compile_metadata();
     extract_waypoints();
     extract_airports();
+    compile_airport_search();
     extract_comms();
     extract_runways();
     extract_starts();
     extract_ilss();
     extract_vors();
     extract_ndbs();
+    // the procedure compiler looks up runways and fixes, so these are indexed first
+    create_indexes({"fix", "runway"});
     compile_procedures();
     compile_airways();
     compile_regions();
     compile_grid_counts();
+    create_indexes({"grid_search", "grid_count", "airport", "com", "start", "ils", "vor", "ndb",
+                    "procedure", "transition", "airway", "fix_airway", "airway_edge"});
+    end_build();
     optimize();
 }
 
-void AtoolsDbNavTranslator::exec_insert(const std::string &table, const std::string &values)
+void AtoolsDbNavTranslator::exec_script(const std::string &script, const std::string &action)
 {
-    if (values.size() == 0) return;
-    std::string script = "INSERT INTO ";
-    script += table;
-    script += " VALUES";
-    script += values;
-    script.back() = ';';
     std::string errMsg;
     int e = avi->runscript(script, errMsg);
     if (e != 0) {
-        std::cerr << "Error code " << e << " when writing to Avitab " << table << " table" << std::endl;
+        std::cerr << "Error code " << e << " when " << action << std::endl;
         std::cerr << "Message was: " << errMsg << std::endl;
         throw std::runtime_error("Avitab database write error");
     }
 }
 
+void AtoolsDbNavTranslator::begin_build()
+{
+    // the builder deletes the output of a failed build, so there is no need for a
+    // rollback journal or for syncing to disk. all of the tables are then populated in a single transaction.
+    exec_script("PRAGMA journal_mode = OFF;"
+                "PRAGMA synchronous = OFF;"
+                "PRAGMA temp_store = MEMORY;"
+                "PRAGMA cache_size = -262144;"
+                "BEGIN TRANSACTION;",
+                "preparing Avitab database for building");
+}
+
+void AtoolsDbNavTranslator::create_indexes(const std::vector<std::string> &tables)
+{
+    for (auto &t: tables) {
+        avi->createIndexes(t);
+    }
+    std::cout << "Indexed " << tables.size() << " tables." << std::endl;
+}
+
+void AtoolsDbNavTranslator::end_build()
+{
+    exec_script("COMMIT TRANSACTION;", "committing Avitab database");
+}
+
 void AtoolsDbNavTranslator::compile_metadata()
 {
     // read the LNM metadata to make sure we recognise the version,
@@ -96,9 +119,8 @@ void AtoolsDbNavTranslator::compile_metadata()
         throw std::runtime_error("Unsupported LNM database source");
     }
 
-    std::ostringstream sql;
-    sql << "(2,'" << source << "','LNM');";
-    exec_insert("metadata", sql.str());
+    SqlTableInserter metadata(avi, "metadata", 3);
+    metadata.insert(sqlnav::NAV_DB_VERSION, source, std::string("LNM"));
 }
 
 void AtoolsDbNavTranslator::extract_waypoints()
@@ -108,8 +130,8 @@ void AtoolsDbNavTranslator::extract_waypoints()
     // is used by Avitab for all non-airport point locations.
 
     std::cout << "Will extract waypoints (fixes) ..." << std::endl;
-    std::unique_ptr<std::ostringstream> fixvals = std::make_unique<std::ostringstream>();
-    std::unique_ptr<std::ostringstream> gsvals = std::make_unique<std::ostringstream>();
+    SqlTableInserter fixes(avi, "fix", 8);
+    SqlTableInserter gridSearch(avi, "grid_search", 4);
     int rows = 0;
     int max_fix_id = 0;
 
@@ -135,9 +157,7 @@ void AtoolsDbNavTranslator::extract_waypoints()
 
         if (fix_id > max_fix_id) { max_fix_id = fix_id; }
 
-        *fixvals << std::setprecision(8)
-            << "(" << fix_id << "," << airport_id << "," << nav_id << ",'"
-            << quoted(ident) << "','" << quoted(region) << "','" << quoted(type) << "'," << lonx << "," << laty << "),";
+        fixes.insert(fix_id, airport_id, nav_id, ident, region, type, lonx, laty);
 
         if (airport_id) {
             add_airport_fix(airport_id, ident, fix_id);
@@ -147,21 +167,12 @@ void AtoolsDbNavTranslator::extract_waypoints()
             // only fixes that are not associated with an airport are returned in the grid searches.
             int ilonx = (int)std::floor(lonx);
             int ilaty = (int)std::floor(laty);
-            *gsvals << "(" << ilonx << "," << ilaty << ",0," << fix_id << "),";
+            gridSearch.insert(ilonx, ilaty, 0, fix_id);
 
             add_grid_area_node(ilonx, ilaty);
         }
-
-        if ((++rows % 1000) == 0) {
-            exec_insert("fix", fixvals->str());
-            fixvals = std::make_unique<std::ostringstream>();
-            exec_insert("grid_search", gsvals->str());
-            gsvals = std::make_unique<std::ostringstream>();
-            //std::cout << "Copied " << rows << " rows from fixes table" << std::endl;
-        }
+        ++rows;
     }
-    exec_insert("fix", fixvals->str());
-    exec_insert("grid_search", gsvals->str());
     next_fix_id = max_fix_id + 1;
     std::cout << "Extracted " << rows << " waypoints. (Next fix id will be " << next_fix_id << ")" << std::endl;
 }
@@ -172,9 +183,9 @@ void AtoolsDbNavTranslator::extract_airports()
     // into the Avitab DB. Also add an entry to the grid_search table, and a fix (may be used in procedures).
 
     std::cout << "Will extract airports ..." << std::endl;
-    std::unique_ptr<std::ostringstream> avals = std::make_unique<std::ostringstream>();
-    std::unique_ptr<std::ostringstream> fixvals = std::make_unique<std::ostringstream>();
-    std::unique_ptr<std::ostringstream> gsvals = std::make_unique<std::ostringstream>();
+    SqlTableInserter airports(avi, "airport", 8);
+    SqlTableInserter fixes(avi, "fix", 8);
+    SqlTableInserter gridSearch(avi, "grid_search", 4);
     int rows = 0;
 
     auto lnm_qry = lnm->compile(
@@ -199,43 +210,40 @@ void AtoolsDbNavTranslator::extract_airports()
         int ilonx = (int)std::floor(lonx);
         int ilaty = (int)std::floor(laty);
 
-        *avals << std::setprecision(8)
-            << "(" << id << ",'" << quoted(ident) << "','" << quoted(name) << "','"
-            << quoted(region) << "','" << quoted(country) << "'," << altitude << "," << lonx << "," << laty << "),";
+        airports.insert(id, ident, name, region, country, altitude, lonx, laty);
 
         auto fix_id = next_fix_id++;
         add_global_region_fix(region, ident, fix_id);
-        *fixvals << "(" << fix_id << "," << id << ",0,'"
-            << quoted(ident) << "','" << quoted(region) << "','A'," << lonx << "," << laty << "),";
+        fixes.insert(fix_id, id, 0, ident, region, std::string("A"), lonx, laty);
 
-        *gsvals << "(" << ilonx << "," << ilaty << "," << id << ",0),";
+        gridSearch.insert(ilonx, ilaty, id, 0);
 
         add_grid_area_node(ilonx, ilaty);
-
-        if ((++rows % 1000) == 0) {
-            // insert every 1000 transactions
-            exec_insert("airport", avals->str());
-            avals = std::make_unique<std::ostringstream>();
-            exec_insert("fix", fixvals->str());
-            fixvals = std::make_unique<std::ostringstream>();
-            exec_insert("grid_search", gsvals->str());
-            gsvals = std::make_unique<std::ostringstream>();
-            //std::cout << "Copied " << rows << " rows from airports table" << std::endl;
-        }
+        ++rows;
     }
-    exec_insert("airport", avals->str());
-    exec_insert("fix", fixvals->str());
-    exec_insert("grid_search", gsvals->str());
     std::cout << "Extracted " << rows << " airports. (Next fix id will be " << next_fix_id << ")" << std::endl;
 }
 
+void AtoolsDbNavTranslator::compile_airport_search()
+{
+    // the search table only indexes the airport table, it doesn't hold a copy of the text
+    std::string errMsg;
+    int e = avi->runscript("INSERT INTO airport_search(airport_search) VALUES('rebuild');", errMsg);
+    if (e != 0) {
+        std::cerr << "Error code " << e << " when building Avitab airport search index" << std::endl;
+        std::cerr << "Message was: " << errMsg << std::endl;
+        throw std::runtime_error("Avitab database write error");
+    }
+    std::cout << "Compiled airport search index." << std::endl;
+}
+
 void AtoolsDbNavTranslator::extract_comms()
 {
     // read all of the LNM com table records and copy required columns only
     // into the Avitab DB.
 
     std::cout << "Will extract comms ..." << std::endl;
-    std::unique_ptr<std::ostringstream> vals = std::make_unique<std::ostringstream>();
+    SqlTableInserter coms(avi, "com", 4);
     int rows = 0;
 
     auto lnm_qry = lnm->compile("SELECT airport_id, type, frequency, name FROM com;");
@@ -257,15 +265,9 @@ void AtoolsDbNavTranslator::extract_comms()
             continue;
         }
 
-        *vals << "(" << id << ",'" << type << "'," << frequency << ",'" << quoted(name) << "'),";
-
-        if ((++rows % 1000) == 0) {
-            exec_insert("com", vals->str());
-            vals = std::make_unique<std::ostringstream>();
-            //std::cout << "Copied " << rows << " rows from coms table" << std::endl;
-        }
+        coms.insert(id, type, frequency, name);
+        ++rows;
     }
-    exec_insert("com", vals->str());
     std::cout << "Extracted " << rows << " com entries." << std::endl;
 }
 
@@ -284,8 +286,8 @@ void AtoolsDbNavTranslator::extract_runways()
     // into the Avitab DB.
 
     std::cout << "Will extract runways ..." << std::endl;
-    std::unique_ptr<std::ostringstream> rvals = std::make_unique<std::ostringstream>();
-    std::unique_ptr<std::ostringstream> fixvals = std::make_unique<std::ostringstream>();
+    SqlTableInserter runways(avi, "runway", 13);
+    SqlTableInserter fixes(avi, "fix", 8);
     int rows = 0;
 
     auto lnm_qry = lnm->compile(
@@ -334,37 +336,20 @@ void AtoolsDbNavTranslator::extract_runways()
         auto primaryFixId = next_fix_id++;
         std::string primaryFixName = std::string("RW") + primaryName;
         add_airport_fix(airportId, primaryFixName, primaryFixId);
-        *fixvals << std::setprecision(8)
-            << "(" << primaryFixId << "," << airportId << ",0,'"
-            << primaryFixName << "','" << quoted(region) << "','R'," << primaryLonx << "," << primaryLaty << "),";
+        fixes.insert(primaryFixId, airportId, 0, primaryFixName, region, std::string("R"), primaryLonx, primaryLaty);
 
         auto oppositeFixId = next_fix_id++;
         std::string oppositeFixName = std::string("RW") + oppositeName;
         add_airport_fix(airportId, oppositeFixName, oppositeFixId);
-        *fixvals << std::setprecision(8)
-            << "(" << oppositeFixId << "," << airportId << ",0,'"
-            << oppositeFixName << "','" << quoted(region) << "','R'," << oppositeLonx << "," << oppositeLaty << "),";
+        fixes.insert(oppositeFixId, airportId, 0, oppositeFixName, region, std::string("R"), oppositeLonx, oppositeLaty);
 
         // create 2 rows in the Avitab runway database, 1 for each runway direction
-        *rvals << std::setprecision(8)
-            << "(" << primaryId << ",'" << primaryName << "'," << airportId << "," << oppositeId << "," << primaryFixId << ","
-            << length << "," << width << ",'" << surface << "',"
-            << primaryHeading << "," << primaryAltitude << "," << primaryOffset << "," << primaryLonx << "," << primaryLaty << "),";
-        *rvals << std::setprecision(8)
-            << "(" << oppositeId << ",'" << oppositeName << "'," << airportId << "," << primaryId << "," << oppositeFixId << ","
-            << length << "," << width << ",'" << surface << "',"
-            << oppositeHeading << "," << oppositeAltitude << "," << oppositeOffset << "," << oppositeLonx << "," << oppositeLaty << "),";
-
-        if ((++rows % 500) == 0) {
-            exec_insert("runway", rvals->str());
-            rvals = std::make_unique<std::ostringstream>();
-            exec_insert("fix", fixvals->str());
-            fixvals = std::make_unique<std::ostringstream>();
-            //std::cout << "Copied " << rows << " rows from runways table" << std::endl;
-        }
+        runways.insert(primaryId, primaryName, airportId, oppositeId, primaryFixId, length, width, surface,
+                       primaryHeading, primaryAltitude, primaryOffset, primaryLonx, primaryLaty);
+        runways.insert(oppositeId, oppositeName, airportId, primaryId, oppositeFixId, length, width, surface,
+                       oppositeHeading, oppositeAltitude, oppositeOffset, oppositeLonx, oppositeLaty);
+        ++rows;
     }
-    exec_insert("runway", rvals->str());
-    exec_insert("fix", fixvals->str());
     std::cout << "Extracted " << rows << " runways pairs. (Next fix id will be " << next_fix_id << ")" << std::endl;
 }
 
@@ -374,7 +359,7 @@ void AtoolsDbNavTranslator::extract_starts()
     // into the Avitab DB.
 
     std::cout << "Will extract starts ..." << std::endl;
-    std::unique_ptr<std::ostringstream> vals = std::make_unique<std::ostringstream>();
+    SqlTableInserter starts(avi, "start", 5);
     int rows = 0;
 
     auto lnm_qry = lnm->compile(
@@ -399,15 +384,9 @@ void AtoolsDbNavTranslator::extract_starts()
             continue;
         }
 
-        *vals << std::setprecision(8) << "(" << airport_id << ",'" << type << "'," << number << "," << lonx << "," << laty << "),";
-
-        if ((++rows % 1000) == 0) {
-            exec_insert("start", vals->str());
-            vals = std::make_unique<std::ostringstream>();
-            //std::cout << "Copied " << rows << " rows from starts table" << std::endl;
-        }
+        starts.insert(airport_id, type, number, lonx, laty);
+        ++rows;
     }
-    exec_insert("start", vals->str());
     std::cout << "Extracted " << rows << " starts." << std::endl;
 }
 
@@ -420,7 +399,7 @@ void AtoolsDbNavTranslator::extract_ilss()
     std::vector<int> floatingILS;
 
     std::cout << "Will extract ILSs ..." << std::endl;
-    std::unique_ptr<std::ostringstream> vals = std::make_unique<std::ostringstream>();
+    SqlTableInserter ilss(avi, "ils", 12);
     int rows = 0;
 
     auto lnm_qry = lnm->compile(
@@ -451,23 +430,15 @@ void AtoolsDbNavTranslator::extract_ilss()
         auto dme_range = lnm_qry->getInt(12);
 
         // insert the ILS record even if it is incomplete, it will be updated later
-        *vals << std::setprecision(8)
-            << "(" << ils_id << ",'" << ident << "','" << name << "'," << airport_id << ","
-            << loc_runway_end_id << "," << lonx << "," << laty << "," << frequency << "," << loc_heading << ","
-            << mag_var << "," << range << "," << dme_range << "),";
+        ilss.insert(ils_id, ident, name, airport_id, loc_runway_end_id, lonx, laty, frequency, loc_heading,
+                    mag_var, range, dme_range);
 
         // if the table links are incomplete add this to the list for later fxing up
         if (!airport_id || !loc_runway_end_id) {
             floatingILS.push_back(ils_id);
         }
-
-        if ((++rows % 1000) == 0) {
-            exec_insert("ils", vals->str());
-            vals = std::make_unique<std::ostringstream>();
-            //std::cout << "Copied " << rows << " rows from ILS table" << std::endl;
-        }
+        ++rows;
     }
-    exec_insert("ils", vals->str());
     std::cout << "Looking for airports for " << floatingILS.size() << " orphaned ILSs ..." << std::endl;
     logger::info("ILS source data has %d orphans (no airport) - will attempt adoptions.", floatingILS.size());
     int fixed = 0;
@@ -485,9 +456,9 @@ void AtoolsDbNavTranslator::extract_vors()
     // into the Avitab DB.
 
     std::cout << "Will extract VORs ..." << std::endl;
-    std::unique_ptr<std::ostringstream> vals = std::make_unique<std::ostringstream>();
-    std::unique_ptr<std::ostringstream> fixvals = std::make_unique<std::ostringstream>();
-    std::unique_ptr<std::ostringstream> gsvals = std::make_unique<std::ostringstream>();
+    SqlTableInserter navaids(avi, "vor", 12);
+    SqlTableInserter fixes(avi, "fix", 8);
+    SqlTableInserter gridSearch(avi, "grid_search", 4);
     int rows = 0;
 
     auto lnm_qry = lnm->compile(
@@ -514,42 +485,26 @@ void AtoolsDbNavTranslator::extract_vors()
         auto mag_var = lnm_qry->getDouble(10);
         auto dme_only = lnm_qry->getInt(11);
 
-        *vals << std::setprecision(8)
-            << "(" << id << ",'" << ident << "','" << quoted(name) << "','"
-            << region << "'," << airport_id << ",'" << type << "'," << lonx << "," << laty << ","
-            << frequency << "," << range << "," << mag_var << "," << dme_only << "),";
+        navaids.insert(id, ident, name, region, airport_id, type, lonx, laty, frequency, range, mag_var, dme_only);
 
         if (!global_region_fix(region, ident)) {
             // create a new fix for this VOR - it isn't associated with a waypoint
             auto fix_id = next_fix_id++;
-            *fixvals << std::setprecision(8)
-                << "(" << fix_id << "," << airport_id << "," << id << ",'"
-                << quoted(ident) << "','" << quoted(region) << "','V'," << lonx << "," << laty << "),";
+            fixes.insert(fix_id, airport_id, id, ident, region, std::string("V"), lonx, laty);
             add_global_region_fix(region, ident, fix_id);
 
             if (airport_id == 0) {
                 // only fixes that are not associated with an airport are returned in the grid searches.
                 int ilonx = (int)std::floor(lonx);
                 int ilaty = (int)std::floor(laty);
-                *gsvals << "(" << ilonx << "," << ilaty << ",0," << fix_id << "),";
+                gridSearch.insert(ilonx, ilaty, 0, fix_id);
 
                 add_grid_area_node(ilonx, ilaty);
             }
         }
 
-        if ((++rows % 1000) == 0) {
-            exec_insert("vor", vals->str());
-            vals = std::make_unique<std::ostringstream>();
-            exec_insert("fix", fixvals->str());
-            fixvals = std::make_unique<std::ostringstream>();
-            exec_insert("grid_search", gsvals->str());
-            gsvals = std::make_unique<std::ostringstream>();
-            //std::cout << "Copied " << rows << " rows from VOR/DME table" << std::endl;
-        }
+        ++rows;
     }
-    exec_insert("vor", vals->str());
-    exec_insert("fix", fixvals->str());
-    exec_insert("grid_search", gsvals->str());
     std::cout << "Extracted " << rows << " VOR/DMEs. (Next fix id will be " << next_fix_id << ")" << std::endl;
 }
 
@@ -559,9 +514,9 @@ void AtoolsDbNavTranslator::extract_ndbs()
     // into the Avitab DB.
 
     std::cout << "Will extract NDBs ..." << std::endl;
-    std::unique_ptr<std::ostringstream> vals = std::make_unique<std::ostringstream>();
-    std::unique_ptr<std::ostringstream> fixvals = std::make_unique<std::ostringstream>();
-    std::unique_ptr<std::ostringstream> gsvals = std::make_unique<std::ostringstream>();
+    SqlTableInserter navaids(avi, "ndb", 10);
+    SqlTableInserter fixes(avi, "fix", 8);
+    SqlTableInserter gridSearch(avi, "grid_search", 4);
     int rows = 0;
 
     auto lnm_qry = lnm->compile(
@@ -586,42 +541,26 @@ void AtoolsDbNavTranslator::extract_ndbs()
         auto range = lnm_qry->getInt(8);
         auto mag_var = lnm_qry->getDouble(9);
 
-        *vals << std::setprecision(8)
-            << "(" << id << ",'" << ident << "','" << quoted(name) << "','"
-            << region << "'," << airport_id << "," << lonx << "," << laty << ","
-            << frequency << "," << range << "," << mag_var << "),";
+        navaids.insert(id, ident, name, region, airport_id, lonx, laty, frequency, range, mag_var);
 
         if (!global_region_fix(region, ident)) {
             // create a new fix for this NDB - it isn't associated with a waypoint
             auto fix_id = next_fix_id++;
-            *fixvals << std::setprecision(8)
-                << "(" << fix_id << "," << airport_id << "," << id << ",'"
-                << quoted(ident) << "','" << quoted(region) << "','V'," << lonx << "," << laty << "),";
+            fixes.insert(fix_id, airport_id, id, ident, region, std::string("V"), lonx, laty);
             add_global_region_fix(region, ident, fix_id);
 
             if (airport_id == 0) {
                 // only fixes that are not associated with an airport are returned in the grid searches.
                 int ilonx = (int)std::floor(lonx);
                 int ilaty = (int)std::floor(laty);
-                *gsvals << "(" << ilonx << "," << ilaty << ",0," << fix_id << "),";
+                gridSearch.insert(ilonx, ilaty, 0, fix_id);
 
                 add_grid_area_node(ilonx, ilaty);
             }
         }
 
-        if ((++rows % 1000) == 0) {
-            exec_insert("ndb", vals->str());
-            vals = std::make_unique<std::ostringstream>();
-            exec_insert("fix", fixvals->str());
-            fixvals = std::make_unique<std::ostringstream>();
-            exec_insert("grid_search", gsvals->str());
-            gsvals = std::make_unique<std::ostringstream>();
-            //std::cout << "Copied " << rows << " rows from NDB table" << std::endl;
-        }
+        ++rows;
     }
-    exec_insert("ndb", vals->str());
-    exec_insert("fix", fixvals->str());
-    exec_insert("grid_search", gsvals->str());
     std::cout << "Extracted " << rows << " NDBs. (Next fix id will be " << next_fix_id << ")" << std::endl;
 }
 
@@ -668,7 +607,7 @@ void AtoolsDbNavTranslator::compile_procedures()
     // iterate transitions for procedure.
     // for each transition, get all legs.
 
-    AtoolsDbProcedureCompiler pc(avi, shared_from_this());
+    AtoolsDbProcedureCompiler pc(avi);
     int proc_count = 0;
 
     for (auto a: airports) {
@@ -793,7 +732,7 @@ void AtoolsDbNavTranslator::compile_airways()
                             "FROM airway "
                             "ORDER BY airway_name, airway_fragment_no, sequence_no ;");
 
-    AtoolsDbAirwayCompiler ac(avi, shared_from_this());
+    AtoolsDbAirwayCompiler ac(avi);
 
     int prevseqnum = 0, prevfragnum = 0;
     std::string prevname;
@@ -838,29 +777,23 @@ void AtoolsDbNavTranslator::compile_airways()
 
 void AtoolsDbNavTranslator::compile_regions()
 {
-    std::ostringstream sql;
+    SqlTableInserter regions(avi, "region", 1);
     int rows = 0;
-    for (auto ri: global_region_fix_ids) {
-        sql << "('" << ri.first << "'),";
+    for (auto &ri: global_region_fix_ids) {
+        regions.insert(ri.first);
         ++rows;
     }
-    exec_insert("region", sql.str());
     std::cout << "Compiled " << rows << " regions." << std::endl;
 }
 
 void AtoolsDbNavTranslator::compile_grid_counts()
 {
-    std::unique_ptr<std::ostringstream> vals = std::make_unique<std::ostringstream>();
+    SqlTableInserter gridCounts(avi, "grid_count", 3);
     int rows = 0;
-    for (auto gci: grid_totals) {
-        *vals << "(" << gci.first.first << "," << gci.first.second << "," << gci.second << "),";
-        if ((++rows % 1000) == 0) {
-            exec_insert("grid_count", vals->str());
-            vals = std::make_unique<std::ostringstream>();
-            //std::cout << "Written " << rows << " rows to grid_count table" << std::endl;
-        }
+    for (auto &gci: grid_totals) {
+        gridCounts.insert(gci.first.first, gci.first.second, gci.second);
+        ++rows;
     }
-    exec_insert("grid_count", vals->str());
     std::cout << "Compiled " << rows << " grid area counts." << std::endl;
 }
 
@@ -956,16 +889,12 @@ int AtoolsDbNavTranslator::fixup_ils(int ils_id)
         double rclaty = (i->laty + j->laty) / 2;
         double dsq_from_rc = ((rclonx - i->lonx) * (rclonx - i->lonx)) + ((rclaty - i->laty) * (rclaty - i->laty));
         if (dsq_from_rc < rlsq) {
-            std::ostringstream update;
-            update << "UPDATE ils SET airport_id = " << i->aid << ", runway_id = " << i->rid
-            << " WHERE ils_id = " << ils_id << ";";
-            std::string errMsg;
-            int e = avi->runscript(update.str(), errMsg);
-            if (e != 0) {
-                std::cerr << "Error code " << e << " when updating Avitab ils table" << std::endl;
-                std::cerr << "Message was: " << errMsg << std::endl;
-                throw std::runtime_error("Avitab database update error");
-            }
+            auto update = avi->compile("UPDATE ils SET airport_id = ?1, runway_id = ?2 WHERE ils_id = ?3;");
+            update->initialize();
+            update->bind(1, i->aid);
+            update->bind(2, i->rid);
+            update->bind(3, ils_id);
+            update->step();
             logger::info("Attached ILS %s at [%f,%f] to airport, id=%d", ilsident.c_str(), lonx, laty, i->aid);
             return 1;
         }
@@ -1067,20 +996,3 @@ void AtoolsDbNavTranslator::add_grid_area_node(int ilonx, int ilaty)
     }
     ++grid_totals[k];
 }
-
-static inline std::string quoted(std::string &s)
-{
-    if (s.find('\'') == std::string::npos) return s;
-    std::string p, q(s);
-    while (q.size()) {
-        auto i = q.find('\'');
-        if (i == std::string::npos) {
-            p += q;
-            return p;
-        }
-        p += q.substr(0, i+1);
-        p += '\'';
-        q.erase(0, i+1);
-    }
-    return p;
-}
@@ -20,6 +20,7 @@
 #include <memory>
 #include <string>
 #include <map>
+#include <vector>
 #include "src/libnavsql/SqlDatabase.h"
 
 class AtoolsDbNavTranslator : public std::enable_shared_from_this<AtoolsDbNavTranslator>
@@ -28,12 +29,16 @@ public:
     AtoolsDbNavTranslator(std::shared_ptr<sqlnav::SqlDatabase> targ, std::shared_ptr<sqlnav::SqlDatabase> src);
     void translate();
 
-    void exec_insert(const std::string &table, const std::string &values);
-
 private:
+    void exec_script(const std::string &script, const std::string &action);
+    void begin_build();
+    void create_indexes(const std::vector<std::string> &tables);
+    void end_build();
+
     void compile_metadata();
     void extract_waypoints();
     void extract_airports();
+    void compile_airport_search();
     void extract_comms();
     void extract_runways();
     void extract_starts();
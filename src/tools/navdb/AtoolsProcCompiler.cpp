@@ -17,32 +17,25 @@
  */
 
 #include "AtoolsProcCompiler.h"
-#include "AtoolsNavTranslator.h"
 #include "src/Logger.h"
 #include <iostream>
+#include <sstream>
 
-AtoolsDbProcedureCompiler::AtoolsDbProcedureCompiler(std::shared_ptr<sqlnav::SqlDatabase> targ, std::shared_ptr<AtoolsDbNavTranslator> o)
-:   db(targ), owner(o), nextProcId(1), nextTransId(1)
+AtoolsDbProcedureCompiler::AtoolsDbProcedureCompiler(std::shared_ptr<sqlnav::SqlDatabase> targ)
+:   db(targ), nextProcId(1), nextTransId(1),
+    procedureRows(targ, "procedure", 8), transitionRows(targ, "transition", 6)
 {
-    procvals = std::make_unique<std::ostringstream>();
-    transvals = std::make_unique<std::ostringstream>();
 }
 
 AtoolsDbProcedureCompiler::~AtoolsDbProcedureCompiler()
 {
-    // generate insertion values for the previous procedure
+    // insert the rows for the previous procedure
     generate();
-    // commit everything to the database
-    update();
 }
 
 void AtoolsDbProcedureCompiler::startAirport(int id)
 {
     generate();
-    if (rowCount > 1000) {
-        update();
-        rowCount = 0;
-    }
     airportId = id;
     fixes = std::make_unique<std::map<int, std::string>>();
     runways = std::make_unique<std::map<int, Runway>>();
@@ -171,9 +164,7 @@ int AtoolsDbProcedureCompiler::generateSid(const std::string &ident, Runway depa
     std::string vdbg;
     auto vstr = viasToString(vias, vdbg);
     //std::cout << "SID " << ident << " from RW (id=" << departing_runway << ") to " << (*fixes)[fn] << " via " << vdbg << std::endl;
-    *procvals << "(" << id << "," << airportId << ",1,'" << ident << "','"
-            << departing_runway.name << "'," << departing_runway.fixId << "," << fn << ",'" << vstr << "'),";
-    ++rowCount;
+    procedureRows.insert(id, airportId, 1, ident, departing_runway.name, departing_runway.fixId, fn, vstr);
 
     return id;
 }
@@ -189,9 +180,7 @@ int AtoolsDbProcedureCompiler::generateStar(const std::string &ident, Runway arr
     std::string vdbg;
     auto vstr = viasToString(vias, vdbg);
     //std::cout << "STAR " << ident << " from " << (*fixes)[f0] << " to RW (id=" << arrival_runway << ") via " << vdbg << std::endl;
-    *procvals << "(" << id << "," << airportId << ",2,'" << ident << "','"
-            << arrival_runway.name << "'," << f0 << "," << fn << ",'" << vstr << "'),";
-    ++rowCount;
+    procedureRows.insert(id, airportId, 2, ident, arrival_runway.name, f0, fn, vstr);
 
     return id;
 }
@@ -203,9 +192,7 @@ int AtoolsDbProcedureCompiler::generateApproach(const std::string &ident, Runway
     std::string vdbg;
     auto vstr = viasToString(vias, vdbg);
     //std::cout << "Approach " << ident << " from " << (*fixes)[f0] << " to RW (id=" << landing_runway << ") via " << vdbg << std::endl;
-    *procvals << "(" << id << "," << airportId << ",3,'" << ident << "','"
-            << landing_runway.name << "'," << f0 << "," << landing_runway.fixId << ",'" << vstr << "'),";
-    ++rowCount;
+    procedureRows.insert(id, airportId, 3, ident, landing_runway.name, f0, landing_runway.fixId, vstr);
 
     return id;
 }
@@ -221,9 +208,7 @@ void AtoolsDbProcedureCompiler::generateTransition(int procId, const std::string
     std::string vdbg;
     auto vstr = viasToString(vias, vdbg);
     //std::cout << "Transition " << ident << " from " << (*fixes)[f0] << " to " << (*fixes)[fn] << " via " << vdbg << std::endl;
-    *transvals << "(" << id << "," << procId << ",'" << ident << "',"
-            << f0 << "," << fn << ",'" << vstr << "'),";
-    ++rowCount;
+    transitionRows.insert(id, procId, ident, f0, fn, vstr);
 }
 
 std::string AtoolsDbProcedureCompiler::viasToString(std::list<int> vias, std::string &dbg)
@@ -316,13 +301,3 @@ void AtoolsDbProcedureCompiler::debug_runways()
         logger::info(sstr.str().c_str());
     }
 }
-
-void AtoolsDbProcedureCompiler::update()
-{
-    auto o = owner.lock();
-
-    o->exec_insert("procedure", procvals->str());
-    procvals = std::make_unique<std::ostringstream>();
-    o->exec_insert("transition", transvals->str());
-    transvals = std::make_unique<std::ostringstream>();
-}
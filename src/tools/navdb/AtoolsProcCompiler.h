@@ -22,15 +22,13 @@
 #include <map>
 #include <list>
 #include <vector>
-#include <sstream>
 #include "src/libnavsql/SqlDatabase.h"
-
-class AtoolsDbNavTranslator;
+#include "SqlTableInserter.h"
 
 class AtoolsDbProcedureCompiler
 {
 public:
-    AtoolsDbProcedureCompiler(std::shared_ptr<sqlnav::SqlDatabase> targ, std::shared_ptr<AtoolsDbNavTranslator> owner);
+    AtoolsDbProcedureCompiler(std::shared_ptr<sqlnav::SqlDatabase> targ);
     ~AtoolsDbProcedureCompiler();
 
     void startAirport(int id);
@@ -61,7 +59,6 @@ private:
     std::string viasToString(std::list<int> vias, std::string &dbg);
     std::vector<Runway> matchingRunways(std::string name);
     void debug_runways();
-    void update();
 
 private:
     struct Transition {
@@ -84,7 +81,6 @@ private:
 
 private:
     std::shared_ptr<sqlnav::SqlDatabase> db;
-    std::weak_ptr<AtoolsDbNavTranslator> owner;
 
     int airportId;
     std::string apt_ident;
@@ -100,9 +96,8 @@ private:
     bool debug_runways_done;
 
 private:
-    // used for building row value insert statements for each of the procedures tables
-    int rowCount;
-    std::unique_ptr<std::ostringstream> procvals;
-    std::unique_ptr<std::ostringstream> transvals;
+    // prepared insert statements for each of the procedures tables
+    SqlTableInserter procedureRows;
+    SqlTableInserter transitionRows;
 
 };
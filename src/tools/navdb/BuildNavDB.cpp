@@ -53,7 +53,16 @@ int main(int argc, char *argv[])
     // database from a LNM/atools database.
 
     std::shared_ptr<AtoolsDbNavTranslator> worker = std::make_shared<AtoolsDbNavTranslator>(navdb, srcdb);
-    worker->translate();
+    try {
+        worker->translate();
+    } catch (const std::exception &e) {
+        // the build runs without a journal, so don't leave a partial database behind
+        std::cerr << "Build failed: " << e.what() << std::endl;
+        worker.reset();
+        navdb.reset();
+        std::remove(outfile.c_str());
+        return 1;
+    }
 
     return 0;
 }
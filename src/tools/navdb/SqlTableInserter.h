@@ -0,0 +1,64 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2024 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <iostream>
+#include <stdexcept>
+#include "src/libnavsql/SqlDatabase.h"
+#include "src/libnavsql/SqlStatement.h"
+
+// Inserts rows into one table of the Avitab NAV database through a prepared
+// statement. The values are bound in column order, so they must be passed as
+// int, double or std::string to match the available SqlStatement::bind types.
+class SqlTableInserter
+{
+public:
+    SqlTableInserter(std::shared_ptr<sqlnav::SqlDatabase> db, const std::string &t, int columns)
+    :   table(t)
+    {
+        std::string sql = "INSERT INTO " + table + " VALUES(";
+        for (int c = 1; c <= columns; ++c) {
+            sql += "?" + std::to_string(c) + ((c < columns) ? "," : ");");
+        }
+        stmt = db->compile(sql);
+    }
+
+    template<class... ARGTYPES>
+    void insert(const ARGTYPES &... values)
+    {
+        stmt->initialize();
+        int col = 0;
+        (stmt->bind(++col, values), ...);
+        try {
+            stmt->step();
+        } catch (const std::exception &) {
+            std::cerr << "Error when writing to Avitab " << table << " table" << std::endl;
+            throw std::runtime_error("Avitab database write error");
+        }
+        ++rows;
+    }
+
+    int count() const { return rows; }
+
+private:
+    const std::string table;
+    std::shared_ptr<sqlnav::SqlStatement> stmt;
+    int rows = 0;
+};
@@ -0,0 +1,127 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2024 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "DensityGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace world {
+
+DensityGrid::DensityGrid():
+    counts(ROWS * COLUMNS),
+    maxima(LEVELS * ROWS * COLUMNS),
+    dirtyRows(ROWS)
+{
+}
+
+int DensityGrid::rowOf(int laty) {
+    return std::min(std::max(laty, -90), 89) + 90;
+}
+
+int DensityGrid::columnOf(int lonx) {
+    return (((lonx + 180) % COLUMNS) + COLUMNS) % COLUMNS;
+}
+
+void DensityGrid::addNodes(int lonx, int laty, int count) {
+    int row = rowOf(laty);
+    counts[row * COLUMNS + columnOf(lonx)] += count;
+    dirtyRows[row] = true;
+    dirty = true;
+}
+
+void DensityGrid::update() {
+    if (!dirty) {
+        return;
+    }
+    for (int row = 0; row < ROWS; ++row) {
+        if (dirtyRows[row]) {
+            updateRow(row);
+            dirtyRows[row] = false;
+        }
+    }
+    dirty = false;
+}
+
+void DensityGrid::updateRow(int row) {
+    const int limit = std::numeric_limits<uint16_t>::max();
+
+    uint16_t *level0 = &maxima[row * COLUMNS];
+    for (int col = 0; col < COLUMNS; ++col) {
+        level0[col] = std::min(counts[row * COLUMNS + col], limit);
+    }
+
+    for (int level = 1; level < LEVELS; ++level) {
+        const uint16_t *prev = &maxima[((level - 1) * ROWS + row) * COLUMNS];
+        uint16_t *cur = &maxima[(level * ROWS + row) * COLUMNS];
+        int half = 1 << (level - 1);
+        for (int col = 0; col + (1 << level) <= COLUMNS; ++col) {
+            cur[col] = std::max(prev[col], prev[col + half]);
+        }
+    }
+}
+
+int DensityGrid::maxInRow(int row, int first, int last) const {
+    int len = last - first + 1;
+    int level = 0;
+    while ((2 << level) <= len) {
+        ++level;
+    }
+    const uint16_t *table = &maxima[(level * ROWS + row) * COLUMNS];
+    return std::max(table[first], table[last - (1 << level) + 1]);
+}
+
+int DensityGrid::maxInAreas(int lonl, int latl, int lonh, int lath) const {
+    int width = lonh - lonl + 1;
+    if (width <= 0) {
+        width += COLUMNS;
+    }
+
+    int first = columnOf(lonl);
+    int last = first + std::min(width, COLUMNS) - 1;
+
+    int m = 0;
+    for (int row = std::max(latl, -90) + 90; row <= std::min(lath, 89) + 90; ++row) {
+        if (last < COLUMNS) {
+            m = std::max(m, maxInRow(row, first, last));
+        } else {
+            // wraps around the -180/180 meridian
+            m = std::max(m, maxInRow(row, first, COLUMNS - 1));
+            m = std::max(m, maxInRow(row, 0, last - COLUMNS));
+        }
+    }
+    return m;
+}
+
+int DensityGrid::estimateVisibleNodes(const Location &bottomLeft, const Location &topRight) const {
+    // nodes are grouped by integer lat/lon 'squares'.
+    int latl = (int)std::floor(bottomLeft.latitude);
+    int lath = (int)std::ceil(topRight.latitude);
+    int lonl = (int)std::floor(bottomLeft.longitude);
+    int lonh = (int)std::ceil(topRight.longitude);
+
+    int m = maxInAreas(lonl, latl, lonh, lath);
+
+    // pretend that each grid area has 'max' nodes in it, and report the total number of visible nodes that
+    // would be seen if this was the case.
+    float mapArea = (topRight.longitude > bottomLeft.longitude)
+                    ? (topRight.latitude - bottomLeft.latitude) * (topRight.longitude - bottomLeft.longitude)
+                    : (topRight.latitude - bottomLeft.latitude) * (360 + topRight.longitude - bottomLeft.longitude);
+    return (int)(mapArea * m);
+}
+
+} /* namespace world */
@@ -0,0 +1,69 @@
+/*
+ *   AviTab - Aviator's Virtual Tablet
+ *   Copyright (C) 2024 Folke Will <folko@solhost.org>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Affero General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Affero General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Affero General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef SRC_WORLD_DENSITYGRID_H_
+#define SRC_WORLD_DENSITYGRID_H_
+
+#include <vector>
+#include <cstdint>
+#include "models/Location.h"
+
+namespace world {
+
+/*
+ * Number of nodes in each 1x1 degree area of the globe, indexed by the
+ * integer longitude and latitude of the south-west corner of the area.
+ *
+ * Each row of latitude keeps a sparse table of maxima, so that the densest
+ * area in a rectangle is found with two lookups per row instead of a scan
+ * over all of its areas.
+ */
+class DensityGrid {
+public:
+    DensityGrid();
+
+    void addNodes(int lonx, int laty, int count);
+
+    // must be called after adding nodes, before the next query
+    void update();
+
+    // the bounds are inclusive, lonh can be less than lonl if the areas span the -180/180 meridian
+    int maxInAreas(int lonl, int latl, int lonh, int lath) const;
+
+    // the number of nodes that would be visible if every area had as many nodes as the densest one
+    int estimateVisibleNodes(const Location &bottomLeft, const Location &topRight) const;
+
+private:
+    static constexpr const int COLUMNS = 360;
+    static constexpr const int ROWS = 180;
+    static constexpr const int LEVELS = 9; // 2^8 <= COLUMNS < 2^9
+
+    std::vector<int> counts;
+    // maxima[(level * ROWS + row) * COLUMNS + col] is the maximum of 2^level areas starting at col
+    std::vector<uint16_t> maxima;
+    std::vector<bool> dirtyRows;
+    bool dirty = false;
+
+    static int rowOf(int laty);
+    static int columnOf(int lonx);
+    int maxInRow(int row, int first, int last) const;
+    void updateRow(int row);
+};
+
+} /* namespace world */
+
+#endif /* SRC_WORLD_DENSITYGRID_H_ */
@@ -51,14 +51,28 @@ public:
     using NodeAcceptor = std::function<void(const world::NavNode *)>;
     using Connection = std::pair<std::shared_ptr<NavEdge>, std::shared_ptr<NavNode>>;
 
+    // The connections leaving a node, kept in one piece of the world's storage
+    struct ConnectionRange {
+        const Connection *first = nullptr;
+        const Connection *last = nullptr;
+        const Connection *begin() const { return first; }
+        const Connection *end() const { return last; }
+    };
+
     virtual int maxDensity(const world::Location &bottomLeft, const world::Location &topRight) = 0;
     virtual void visitNodes(const world::Location &bottomLeft, const world::Location &topRight, NodeAcceptor calllback, int filter) = 0;
+    // where the user's aircraft is and where it is heading, worlds that load nodes on demand can prepare ahead of it
+    virtual void setTrackHint(const world::Location &position, double heading) { }
+    // changes whenever nodes are added to or removed from the world, so that views can tell when to refresh
+    virtual int getNodeGeneration() const = 0;
 
     virtual std::shared_ptr<Airport> findAirportByID(const std::string &id) const = 0;
     virtual std::shared_ptr<Fix> findFixByRegionAndID(const std::string &region, const std::string &id) const = 0;
+    // ranked: exact ident, then ident prefix, then names, then anywhere in the ident. the search
+    // stops once it has MAX_SEARCH_RESULTS airports, so the cost doesn't grow with the number of matches.
     virtual std::vector<std::shared_ptr<Airport>> findAirport(const std::string &keyWord) const = 0;
 
-    virtual std::vector<Connection> &getConnections(std::shared_ptr<NavNode> from) = 0;
+    virtual ConnectionRange getConnections(std::shared_ptr<NavNode> from) = 0;
     virtual bool areConnected(std::shared_ptr<NavNode> from, const std::shared_ptr<NavNode> to) = 0;
 
     virtual void addRegion(const std::string &code) = 0;
@@ -66,8 +66,8 @@ void FMSLoader::onFMSLoaded(const FlightPlanNodeData &node) {
         case FlightPlanNodeData::Type::DESRWY:    arrivalRwyName = stripRWPrefix(node.id); break;
         case FlightPlanNodeData::Type::APPTRANS:  approachTransName = node.id; break;
         case FlightPlanNodeData::Type::APP:       approachName = node.id; break;
-        case FlightPlanNodeData::Type::ADEP:      departureAirportName = node.id; break;
-        case FlightPlanNodeData::Type::ADES:      arrivalAirportName = node.id; break;
+        case FlightPlanNodeData::Type::ADEP:      departureAirportName = node.id; prefetchProcedures(node.id); break;
+        case FlightPlanNodeData::Type::ADES:      arrivalAirportName = node.id; prefetchProcedures(node.id); break;
         case FlightPlanNodeData::Type::DEPRWY:    departureRwyName = stripRWPrefix(node.id); break;
 
         case FlightPlanNodeData::Type::NDB:
@@ -92,6 +92,15 @@ void FMSLoader::onFMSLoaded(const FlightPlanNodeData &node) {
     }
 }
 
+void FMSLoader::prefetchProcedures(const std::string &airportName) {
+    // the header names the airports before the waypoints, so their procedures
+    // can be prepared while the route is read
+    auto airport = world->findAirportByID(airportName);
+    if (airport) {
+        airport->prefetchProcedures();
+    }
+}
+
 void FMSLoader::appendDeparture() {
     departureAirport = world->findAirportByID(departureAirportName);
     if (departureAirport) {
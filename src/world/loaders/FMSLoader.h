@@ -32,6 +32,7 @@ public:
     NavNodeList load(const std::string &fmsFilename);
 private:
     void onFMSLoaded(const FlightPlanNodeData &node);
+    void prefetchProcedures(const std::string &airportName);
     void appendDeparture();
     void appendArrival();
     void appendDepartureAirportOrRwy();
@@ -248,7 +248,28 @@ void Airport::addApproach(std::shared_ptr<Approach> approach) {
     approaches.insert(std::make_pair(approach->getID(), approach));
 }
 
-std::vector<std::shared_ptr<SID>> Airport::getSIDs() const {
+void Airport::setProcedureSource(std::shared_ptr<ProcedureSource> source) {
+    procedureSource = source;
+}
+
+void Airport::loadProcedures() {
+    if (!procedureSource) {
+        return;
+    }
+    std::call_once(proceduresRequested, [this] () {
+        procedureSource->load(*this);
+        proceduresLoaded = true;
+    });
+}
+
+void Airport::prefetchProcedures() const {
+    if (procedureSource && !proceduresLoaded) {
+        procedureSource->prefetch(*this);
+    }
+}
+
+std::vector<std::shared_ptr<SID>> Airport::getSIDs() {
+    loadProcedures();
     std::vector<std::shared_ptr<SID>> res;
     for (auto &it: sids) {
         res.push_back(it.second);
@@ -256,10 +277,11 @@ std::vector<std::shared_ptr<SID>> Airport::getSIDs() const {
     return res;
 }
 
-std::shared_ptr<SID> Airport::getSIDByName(std::string sidName) const {
+std::shared_ptr<SID> Airport::getSIDByName(std::string sidName) {
     if (sidName.empty()) {
         return nullptr;
     }
+    loadProcedures();
     auto sid = sids.find(sidName);
     if (sid == sids.end()) {
         std::stringstream ss;
@@ -273,7 +295,8 @@ std::shared_ptr<SID> Airport::getSIDByName(std::string sidName) const {
     return sid->second;
 }
 
-std::vector<std::shared_ptr<STAR>> Airport::getSTARs() const {
+std::vector<std::shared_ptr<STAR>> Airport::getSTARs() {
+    loadProcedures();
     std::vector<std::shared_ptr<STAR>> res;
     for (auto &it: stars) {
         res.push_back(it.second);
@@ -281,10 +304,11 @@ std::vector<std::shared_ptr<STAR>> Airport::getSTARs() const {
     return res;
 }
 
-std::shared_ptr<STAR> Airport::getSTARByName(std::string starName) const {
+std::shared_ptr<STAR> Airport::getSTARByName(std::string starName) {
     if (starName.empty()) {
         return nullptr;
     }
+    loadProcedures();
     auto star = stars.find(starName);
     if (star == stars.end()) {
         std::stringstream ss;
@@ -298,7 +322,8 @@ std::shared_ptr<STAR> Airport::getSTARByName(std::string starName) const {
     return star->second;
 }
 
-std::vector<std::shared_ptr<Approach>> Airport::getApproaches() const {
+std::vector<std::shared_ptr<Approach>> Airport::getApproaches() {
+    loadProcedures();
     std::vector<std::shared_ptr<Approach>> res;
     for (auto &it: approaches) {
         res.push_back(it.second);
@@ -306,10 +331,11 @@ std::vector<std::shared_ptr<Approach>> Airport::getApproaches() const {
     return res;
 }
 
-std::shared_ptr<Approach> Airport::getApproachByName(std::string appName) const {
+std::shared_ptr<Approach> Airport::getApproachByName(std::string appName) {
     if (appName.empty()) {
         return nullptr;
     }
+    loadProcedures();
     auto approach = approaches.find(appName);
     if (approach == approaches.end()) {
         std::stringstream ss;
@@ -24,6 +24,8 @@
 #include <vector>
 #include <set>
 #include <functional>
+#include <mutex>
+#include <atomic>
 #include "src/world/models/Location.h"
 #include "src/world/graph/NavNode.h"
 #include "src/world/models/Region.h"
@@ -53,6 +55,15 @@ public:
         CTR
     };
 
+    // Worlds that load the procedures on demand give their airports a source,
+    // which is asked for the procedures of each airport once, before their first use
+    class ProcedureSource {
+    public:
+        virtual void load(Airport &airport) = 0;
+        virtual void prefetch(const Airport &airport) = 0;
+        virtual ~ProcedureSource() = default;
+    };
+
     Airport(const std::string &airportId);
     void setName(const std::string &name);
     void setElevation(int elevation);
@@ -97,12 +108,19 @@ public:
     void addSTAR(std::shared_ptr<STAR> star);
     void addApproach(std::shared_ptr<Approach> approach);
 
-    std::vector<std::shared_ptr<SID>> getSIDs() const;
-    std::vector<std::shared_ptr<STAR>> getSTARs() const;
-    std::vector<std::shared_ptr<Approach>> getApproaches() const;
-    std::shared_ptr<SID> getSIDByName(std::string sidName) const;
-    std::shared_ptr<STAR> getSTARByName(std::string starName) const;
-    std::shared_ptr<Approach> getApproachByName(std::string appName) const;
+    void setProcedureSource(std::shared_ptr<ProcedureSource> source);
+    // makes sure the procedures are loaded, e.g. before routing from or to this airport
+    void loadProcedures();
+    // hint that the procedures will be needed soon, so they can be prepared in the background
+    void prefetchProcedures() const;
+
+    // these load the procedures first if needed
+    std::vector<std::shared_ptr<SID>> getSIDs();
+    std::vector<std::shared_ptr<STAR>> getSTARs();
+    std::vector<std::shared_ptr<Approach>> getApproaches();
+    std::shared_ptr<SID> getSIDByName(std::string sidName);
+    std::shared_ptr<STAR> getSTARByName(std::string starName);
+    std::shared_ptr<Approach> getApproachByName(std::string appName);
     std::string getInitialATCContactInfo() const;
 
     Airport(const Airport &other) = delete;
@@ -129,6 +147,10 @@ private:
     std::map<std::string, std::shared_ptr<STAR>> stars;
     std::map<std::string, std::shared_ptr<Approach>> approaches;
 
+    std::shared_ptr<ProcedureSource> procedureSource;
+    std::once_flag proceduresRequested;
+    std::atomic_bool proceduresLoaded { false };
+
     std::string metarTimestamp, metarString;
 
     std::shared_ptr<Runway> getRunwayAndFixName(const std::string &name);
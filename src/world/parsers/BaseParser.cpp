@@ -16,114 +16,194 @@
  *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include "BaseParser.h"
-#include <iostream>
+#include <algorithm>
+#include <climits>
+#include <cstring>
 #include <stdexcept>
-#include <limits>
 #include "src/Logger.h"
 #include "src/platform/strtod.h"
 
 namespace world {
 
+namespace {
+
+// same set of characters as std::isspace in the C locale
+inline bool isSpace(char c) {
+    return c == ' ' || (unsigned char) (c - '\t') <= '\r' - '\t';
+}
+
+inline bool isDigit(char c) {
+    return (unsigned char) (c - '0') <= 9;
+}
+
+}
+
 BaseParser::BaseParser(const std::string& file) {
-    stream.open(fs::u8path(file));
+    auto path = fs::u8path(file);
+    stream.open(path, std::ios::in | std::ios::binary);
 
     if (!stream) {
         throw std::runtime_error("Couldn't open file: " + file);
     }
+
+    // small files like the CIFP procedures are read in one go without a large allocation
+    std::error_code ec;
+    size_t fileSize = (size_t) fs::file_size(path, ec);
+    if (ec) {
+        fileSize = BUFFER_SIZE;
+    }
+    size_t initialSize = std::min(fileSize, BUFFER_SIZE) + 1;
+
+    // one extra byte for a terminating zero so that numbers can be converted in place
+    buffer.reset(new char[initialSize + 1]);
+    bufferSize = initialSize;
 }
 
 std::string BaseParser::parseHeader() {
-    std::string line;
+    std::string_view l;
 
-    getLine(line);
-    if (line != "A" && line != "I") {
-        throw std::runtime_error("Unknown file format: " + line);
+    if (!nextLine(l) || (l != "A" && l != "I")) {
+        throw std::runtime_error("Unknown file format: " + std::string(l));
     }
 
-    getLine(line);
-
-    std::istringstream lineStr(line);
-    char origin;
-    std::string header;
+    if (!nextLine(l)) {
+        l = {};
+    }
+    setLine(l);
 
-    lineStr >> origin >> version;
-    getline(lineStr, header);
-    return header;
+    version = parseInt();
+    if (lineFailed) {
+        return "";
+    }
+    return std::string(line.substr(linePos));
 }
 
 void BaseParser::eachLine(LineFunctor f) {
-    std::string line;
-    while (getline(stream, line)) {
-        lineStream.str(line);
-        lineStream.seekg(0);
-        lineStream.clear();
+    std::string_view l;
+    while (nextLine(l)) {
+        setLine(l);
         f();
     }
 }
 
 bool BaseParser::isEOL() {
-    return lineStream.peek() <= '\0';
+    return lineFailed || linePos >= line.size() || line[linePos] == '\0';
 }
 
 std::string BaseParser::restOfLine() {
     skipWhiteSpace();
+    if (lineFailed) {
+        return "";
+    }
 
-    std::string rest;
-    std::getline(lineStream, rest);
+    std::string rest(line.substr(linePos));
+    linePos = line.size();
     return rest;
 }
 
 std::string BaseParser::consumeLine() {
-    std::string line;
-    std::getline(stream, line);
-    return line;
+    std::string_view l;
+    if (!nextLine(l)) {
+        return "";
+    }
+    std::string res(l);
+
+    // reading can move the buffer, so the current line is no longer valid
+    setLine({});
+    return res;
 }
 
 int BaseParser::parseInt() {
     skipWhiteSpace();
+    if (lineFailed) {
+        return 0;
+    }
+
+    size_t pos = linePos;
+    bool negative = false;
+    if (pos < line.size() && (line[pos] == '-' || line[pos] == '+')) {
+        negative = (line[pos] == '-');
+        pos++;
+    }
 
-    int res;
-    if (lineStream >> res) {
-        return res;
-    } else {
+    if (pos >= line.size() || !isDigit(line[pos])) {
+        lineFailed = true;
         return 0;
     }
+
+    long long res = 0;
+    bool overflow = false;
+    while (pos < line.size() && isDigit(line[pos])) {
+        res = res * 10 + (line[pos] - '0');
+        if (res > (long long) INT_MAX + 1) {
+            overflow = true;
+            res = (long long) INT_MAX + 1;
+        }
+        pos++;
+    }
+    linePos = pos;
+
+    if (negative) {
+        res = -res;
+    }
+
+    if (overflow || res > INT_MAX || res < INT_MIN) {
+        lineFailed = true;
+        return 0;
+    }
+
+    return (int) res;
 }
 
 std::string BaseParser::parseWord() {
-    skipWhiteSpace();
-
-    std::string word;
-    lineStream >> word;
-    return word;
+    return std::string(nextWord());
 }
 
 std::string BaseParser::nextDelimitedWord(char delim) {
-    std::stringstream word;
+    if (lineFailed) {
+        return "";
+    }
 
-    char c = '\0';
+    size_t end = line.find(delim, linePos);
+    if (end == std::string_view::npos) {
+        end = line.size();
+    }
 
-    while (lineStream >> c) {
-        if (c == delim) {
-            break;
-        }
+    std::string_view token = line.substr(linePos, end - linePos);
+    linePos = std::min(end + 1, line.size());
 
-        if (!std::isspace(c)) {
-            word << c;
+    // whitespace is not part of delimited words
+    std::string word;
+    word.reserve(token.size());
+    for (char c: token) {
+        if (!isSpace(c)) {
+            word += c;
         }
     }
-
-    return word.str();
+    return word;
 }
 
 std::string BaseParser::nextCSVValue() {
-    std::stringstream value;
-    lineStream >> std::noskipws; // Keep whitespace inside CSV values
+    if (lineFailed) {
+        return "";
+    }
 
+    // fast path: no quotes before the next separator, whitespace is kept inside CSV values
+    size_t end = line.find_first_of(",\"", linePos);
+    if (end == std::string_view::npos || line[end] == ',') {
+        if (end == std::string_view::npos) {
+            end = line.size();
+        }
+        std::string value(line.substr(linePos, end - linePos));
+        linePos = std::min(end + 1, line.size());
+        return value;
+    }
+
+    std::string value;
     bool inQuotes = false; // Ensure commas inside quoted fields are not separators
-    char c = '\0';
 
-    while (lineStream >> c) {
+    while (linePos < line.size()) {
+        char c = line[linePos++];
         if (c == '"') {
             inQuotes = !inQuotes;
             continue;
@@ -131,69 +211,124 @@ std::string BaseParser::nextCSVValue() {
         if (c == ',' && !inQuotes) {
             break;
         }
-        value << c;
+        value += c;
     }
 
-    lineStream >> std::skipws;
-    return value.str();
+    return value;
 }
 
 double BaseParser::parseDouble() {
-    skipWhiteSpace();
-
-    std::string doubleStr;
-    lineStream >> doubleStr;
-
-    try {
-        return platform::locale_independent_strtod(doubleStr.c_str(), NULL);
-    } catch (...) {
-        return std::numeric_limits<double>::quiet_NaN();
+    std::string_view word = nextWord();
+    if (word.empty()) {
+        return 0;
     }
+
+    // the word is always followed by whitespace or the terminating zero of the buffer
+    return platform::locale_independent_strtod(word.data(), nullptr);
 }
 
 void BaseParser::skip(char c) {
-    char is;
-    lineStream >> is;
-    if (is != c) {
+    skipWhiteSpace();
+    if (lineFailed || linePos >= line.size()) {
+        lineFailed = true;
+        throw std::runtime_error("Unexpected char in data");
+    }
+
+    // the char is consumed even if it doesn't match
+    if (line[linePos++] != c) {
         throw std::runtime_error("Unexpected char in data");
     }
 }
 
 void BaseParser::skipWhiteSpace() {
-    char c;
-    do {
-        if (!(lineStream >> c)) {
-            return;
-        }
-    } while (std::isspace(c));
-    lineStream.putback(c);
+    while (linePos < line.size() && isSpace(line[linePos])) {
+        linePos++;
+    }
+}
+
+std::string_view BaseParser::nextWord() {
+    skipWhiteSpace();
+    if (lineFailed) {
+        return {};
+    }
+
+    size_t start = linePos;
+    while (linePos < line.size() && !isSpace(line[linePos])) {
+        linePos++;
+    }
+    return line.substr(start, linePos - start);
 }
 
-std::istream& BaseParser::getLine(std::string& str) {
-    stream.clear();
+void BaseParser::setLine(std::string_view l) {
+    line = l;
+    linePos = 0;
+    lineFailed = false;
+}
 
-    std::istream::sentry se(stream, true);
-    std::streambuf *sbuf = stream.rdbuf();
+bool BaseParser::nextLine(std::string_view& out) {
+    size_t searchFrom = bufferPos;
 
     while (true) {
-        int c = sbuf->sbumpc();
-        switch (c) {
-        case '\n':
-            return stream;
-        case '\r':
-            if (sbuf->sgetc() == '\n') {
-                sbuf->sbumpc();
-            }
-            return stream;
-        case std::streambuf::traits_type::eof():
-            if (str.empty()) {
-                stream.setstate(std::ios::eofbit);
+        const char *start = buffer.get() + searchFrom;
+        auto newLine = reinterpret_cast<const char *>(std::memchr(start, '\n', bufferEnd - searchFrom));
+        if (newLine) {
+            size_t end = newLine - buffer.get();
+            out = std::string_view(buffer.get() + bufferPos, end - bufferPos);
+            bufferPos = end + 1;
+            break;
+        }
+
+        size_t scanned = bufferEnd - bufferPos;
+        if (!fillBuffer()) {
+            if (bufferPos == bufferEnd) {
+                return false;
             }
-            return stream;
-        default:
-            str += static_cast<char>(c);
+            // last line without line break
+            out = std::string_view(buffer.get() + bufferPos, bufferEnd - bufferPos);
+            bufferPos = bufferEnd;
+            break;
         }
+        searchFrom = bufferPos + scanned;
+    }
+
+    // handle files with Windows line endings
+    if (!out.empty() && out.back() == '\r') {
+        out.remove_suffix(1);
+    }
+    return true;
+}
+
+bool BaseParser::fillBuffer() {
+    if (endOfFile) {
+        return false;
+    }
+
+    // keep the incomplete line at the front of the buffer
+    size_t rest = bufferEnd - bufferPos;
+    if (bufferPos > 0) {
+        std::memmove(buffer.get(), buffer.get() + bufferPos, rest);
+        bufferPos = 0;
+        bufferEnd = rest;
+    }
+
+    if (bufferEnd == bufferSize) {
+        // a single line is larger than the buffer
+        size_t newSize = bufferSize * 2;
+        std::unique_ptr<char[]> newBuffer(new char[newSize + 1]);
+        std::memcpy(newBuffer.get(), buffer.get(), bufferEnd);
+        buffer = std::move(newBuffer);
+        bufferSize = newSize;
     }
+
+    stream.read(buffer.get() + bufferEnd, bufferSize - bufferEnd);
+    size_t got = (size_t) stream.gcount();
+    if (!stream) {
+        endOfFile = true;
+    }
+    bufferEnd += got;
+    buffer[bufferEnd] = '\0';
+
+    return got > 0;
 }
 
 int BaseParser::getVersion() {
@@ -19,13 +19,20 @@
 #define SRC_WORLD_PARSERS_BASEPARSER_H_
 
 #include <string>
+#include <string_view>
 #include <functional>
-#include <sstream>
-#include <iosfwd>
+#include <memory>
 #include "src/platform/Platform.h"
 
 namespace world {
 
+/*
+ * Line based tokenizer for the X-Plane data files.
+ *
+ * The file is streamed through a large buffer and each line is scanned
+ * in place, so no stream objects or temporary strings are involved
+ * until a token is returned to the caller.
+ */
 class BaseParser {
 public:
     using LineFunctor = std::function<void()>;
@@ -47,10 +54,29 @@ public:
     void skipWhiteSpace();
     int getVersion();
 private:
+    static constexpr const size_t BUFFER_SIZE = 4 * 1024 * 1024;
+
     fs::ifstream stream;
-    std::istringstream lineStream;
-    std::istream &getLine(std::string &str);
-    int version;
+    int version = 0;
+
+    // buffer holds the unparsed part of the file in [bufferPos, bufferEnd)
+    std::unique_ptr<char[]> buffer;
+    size_t bufferSize = 0;
+    size_t bufferPos = 0;
+    size_t bufferEnd = 0;
+    bool endOfFile = false;
+
+    // the current line, valid until the next line is read
+    std::string_view line;
+    size_t linePos = 0;
+
+    // set when a number couldn't be parsed, the rest of the line is ignored then
+    bool lineFailed = false;
+
+    bool nextLine(std::string_view &out);
+    bool fillBuffer();
+    void setLine(std::string_view l);
+    std::string_view nextWord();
 };
 
 } /* namespace world */
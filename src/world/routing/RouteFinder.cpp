@@ -48,60 +48,76 @@ std::shared_ptr<Route> RouteFinder::find() {
     logger::verbose("Searching route from %s to %s", departure->getID().c_str(), arrival->getID().c_str());
     directDistance = departure->getLocation().distanceTo(arrival->getLocation());
 
-    auto from = departure;
-    auto goal = arrival;
+    // the procedures of the departure and arrival are the only ones used by the search
+    for (auto &node: {departure, arrival}) {
+        if (node->isAirport()) {
+            std::dynamic_pointer_cast<Airport>(node)->loadProcedures();
+        }
+    }
 
     // Init
-    closedSet.clear();
-    openSet.clear();
-    openSet.insert(from);
-    cameFrom.clear();
-    gScore.clear();
+    nodes.clear();
+    nodeIndex.clear();
+    openHeap.clear();
 
     // The cost from start to start is zero
-    gScore[from] = 0;
-    fScore[from] = minCostHeuristic(from, goal);
+    uint32_t start = addNode(departure);
+    nodes[start].gScore = 0;
+    pushOpen(start);
+
+    const NavNode *goal = arrival.get();
 
-    while (!openSet.empty()) {
-        Route::NodePtr current = getLowestOpen();
-        if (current == goal) {
-            logger::verbose("Route found");
+    while (!openHeap.empty()) {
+        uint32_t current = popOpen();
+        if (nodes[current].node.get() == goal) {
+            logger::verbose("Route found after visiting %d nodes", (int) nodes.size());
             std::shared_ptr<world::Route> route = std::make_shared<world::Route>(world, departure, arrival);
-            route->loadRoute(reconstructPath(goal));
+            route->loadRoute(reconstructPath(current));
             return route;
         }
 
-        openSet.erase(current);
-        closedSet.insert(current);
+        nodes[current].closed = true;
 
-        auto &neighbors = world->getConnections(current);
-        for (auto neighborConn: neighbors) {
+        // nodes may grow while iterating, so only indices are kept
+        auto neighbors = world->getConnections(nodes[current].node);
+        for (auto &neighborConn: neighbors) {
             auto &edge = std::get<0>(neighborConn);
             auto &neighbor = std::get<1>(neighborConn);
             if (!edge || !neighbor) {
                 continue;
             }
 
-            if (!checkEdge(edge, neighbor)) {
-                continue;
+            uint32_t next;
+            auto it = nodeIndex.find(neighbor.get());
+            if (it != nodeIndex.end()) {
+                next = it->second;
+                if (nodes[next].closed) {
+                    continue;
+                }
+                if (!checkEdge(edge, neighbor)) {
+                    continue;
+                }
+            } else {
+                if (!checkEdge(edge, neighbor)) {
+                    continue;
+                }
+                next = addNode(neighbor);
             }
 
-            if (closedSet.find(neighbor) != closedSet.end()) {
+            double tentativeGScore = nodes[current].gScore + cost(current, edge, neighbor);
+            if (tentativeGScore > nodes[next].gScore) {
                 continue;
             }
 
-            if (openSet.find(neighbor) == openSet.end()) {
-                openSet.insert(neighbor);
+            auto &node = nodes[next];
+            node.parent = current;
+            node.via = edge;
+            node.gScore = tentativeGScore;
+            if (node.heapIndex == NO_NODE) {
+                pushOpen(next);
+            } else {
+                siftUp(node.heapIndex);
             }
-
-            double tentativeGScore = getGScore(current) + cost(current, Route::Leg(edge, neighbor));
-            if (tentativeGScore > getGScore(neighbor)) {
-                continue;
-            }
-
-            cameFrom[neighbor] = Route::Leg(edge, current);
-            gScore[neighbor] = tentativeGScore;
-            fScore[neighbor] = getGScore(neighbor) + minCostHeuristic(neighbor, goal);
         }
     }
 
@@ -109,36 +125,25 @@ std::shared_ptr<Route> RouteFinder::find() {
     throw std::runtime_error("No route found");
 }
 
-std::vector<Route::Leg> RouteFinder::reconstructPath(Route::NodePtr lastFix) {
+std::vector<Route::Leg> RouteFinder::reconstructPath(uint32_t lastFix) {
     logger::info("Backtracking route...");
     std::vector<Route::Leg> res;
     std::vector<std::pair<double, double>> locations;
 
     // Collate magnetic variations for the node locations used in the route
     // Getting magVar from XPlane is asynchronous and slow, so batch request
-    auto locLast = lastFix->getLocation();
-    locations.push_back(std::make_pair(locLast.latitude, locLast.longitude));
-
-    Route::Leg cur = cameFrom[lastFix];
-    decltype(cameFrom.find(nullptr)) it;
-    while ((it = cameFrom.find(cur.to)) != cameFrom.end()) {
-        cur = cameFrom[it->first];
-        auto loc = it->first->getLocation();
+    for (uint32_t idx = lastFix; nodes[idx].parent != NO_NODE; idx = nodes[idx].parent) {
+        auto &loc = nodes[idx].node->getLocation();
         locations.push_back(std::make_pair(loc.latitude, loc.longitude));
     }
     auto magVarMap = getMagneticVariations(locations);
 
-
     // Now we've got magvars, reconstruct the path
-    cur = cameFrom[lastFix];
-    double magVar = magVarMap[std::make_pair(locLast.latitude, locLast.longitude)];
-    res.push_back(Route::Leg(cur.to, cur.via, lastFix, magVar));
-
-    while ((it = cameFrom.find(cur.to)) != cameFrom.end()) {
-        cur = cameFrom[it->first];
-        auto loc = it->first->getLocation();
-        magVar = magVarMap[std::make_pair(loc.latitude, loc.longitude)];
-        res.push_back(Route::Leg(cur.to, cur.via, it->first, magVar));
+    for (uint32_t idx = lastFix; nodes[idx].parent != NO_NODE; idx = nodes[idx].parent) {
+        auto &node = nodes[idx];
+        auto &loc = node.node->getLocation();
+        double magVar = magVarMap[std::make_pair(loc.latitude, loc.longitude)];
+        res.push_back(Route::Leg(nodes[node.parent].node, node.via, node.node, magVar));
     }
 
     std::reverse(std::begin(res), std::end(res));
@@ -146,7 +151,7 @@ std::vector<Route::Leg> RouteFinder::reconstructPath(Route::NodePtr lastFix) {
     return res;
 }
 
-bool RouteFinder::checkEdge(const Route::EdgePtr via, const Route::NodePtr to) const {
+bool RouteFinder::checkEdge(const Route::EdgePtr &via, const Route::NodePtr &to) const {
     if (via->isProcedure()) {
         // We only allow SIDs, STARs etc. if they are start or end of the route.
         // This prevents routes that use SIDs and STARs of other airports as waypoints
@@ -158,46 +163,99 @@ bool RouteFinder::checkEdge(const Route::EdgePtr via, const Route::NodePtr to) c
 
 }
 
-Route::NodePtr RouteFinder::getLowestOpen() {
-    Route::NodePtr res = nullptr;
-    double best = std::numeric_limits<double>::infinity();
-
-    for (Route::NodePtr f: openSet) {
-        auto fScoreIt = fScore.find(f);
-        if (fScoreIt != fScore.end()) {
-            if (fScoreIt->second < best) {
-                res = fScoreIt->first;
-                best = fScoreIt->second;
-            }
-        }
-    }
-    return res;
+uint32_t RouteFinder::addNode(const Route::NodePtr &node) {
+    uint32_t idx = (uint32_t) nodes.size();
+    nodes.emplace_back();
+    nodes.back().node = node;
+    nodes.back().heuristic = minCostHeuristic(node, arrival);
+    nodeIndex.emplace(node.get(), idx);
+    return idx;
 }
 
-double RouteFinder::minCostHeuristic(Route::NodePtr a, Route::NodePtr b) {
+double RouteFinder::minCostHeuristic(const Route::NodePtr &a, const Route::NodePtr &b) const {
     // the minimum cost is a direct line
     return a->getLocation().distanceTo(b->getLocation());
 }
 
-double RouteFinder::cost(Route::NodePtr a, const Route::Leg& dir) {
+double RouteFinder::cost(uint32_t from, const Route::EdgePtr &via, const Route::NodePtr &to) const {
     // the actual cost can have penalties later
     double penalty = 0;
-    auto it = cameFrom.find(a);
-    if (it != cameFrom.end()) {
-        if (it->second.via != dir.via) {
+    auto &node = nodes[from];
+    if (node.parent != NO_NODE) {
+        if (node.via != via) {
             penalty += airwayChangePenalty * directDistance;
         }
     }
 
-    return minCostHeuristic(a, dir.to) + penalty;
+    return minCostHeuristic(node.node, to) + penalty;
+}
+
+double RouteFinder::getFScore(uint32_t idx) const {
+    return nodes[idx].gScore + nodes[idx].heuristic;
 }
 
-double RouteFinder::getGScore(Route::NodePtr f) {
-    auto it = gScore.find(f);
-    if (it == gScore.end()) {
-        return std::numeric_limits<double>::infinity();
+void RouteFinder::pushOpen(uint32_t idx) {
+    nodes[idx].heapIndex = (uint32_t) openHeap.size();
+    openHeap.push_back(idx);
+    siftUp(openHeap.size() - 1);
+}
+
+uint32_t RouteFinder::popOpen() {
+    uint32_t top = openHeap.front();
+    nodes[top].heapIndex = NO_NODE;
+
+    uint32_t last = openHeap.back();
+    openHeap.pop_back();
+    if (!openHeap.empty()) {
+        openHeap[0] = last;
+        nodes[last].heapIndex = 0;
+        siftDown(0);
+    }
+    return top;
+}
+
+void RouteFinder::siftUp(size_t pos) {
+    uint32_t idx = openHeap[pos];
+    double f = getFScore(idx);
+
+    while (pos > 0) {
+        size_t parentPos = (pos - 1) / 2;
+        uint32_t parent = openHeap[parentPos];
+        if (getFScore(parent) <= f) {
+            break;
+        }
+        openHeap[pos] = parent;
+        nodes[parent].heapIndex = (uint32_t) pos;
+        pos = parentPos;
+    }
+
+    openHeap[pos] = idx;
+    nodes[idx].heapIndex = (uint32_t) pos;
+}
+
+void RouteFinder::siftDown(size_t pos) {
+    uint32_t idx = openHeap[pos];
+    double f = getFScore(idx);
+    size_t count = openHeap.size();
+
+    while (true) {
+        size_t child = pos * 2 + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && getFScore(openHeap[child + 1]) < getFScore(openHeap[child])) {
+            child++;
+        }
+        if (f <= getFScore(openHeap[child])) {
+            break;
+        }
+        openHeap[pos] = openHeap[child];
+        nodes[openHeap[pos]].heapIndex = (uint32_t) pos;
+        pos = child;
     }
-    return it->second;
+
+    openHeap[pos] = idx;
+    nodes[idx].heapIndex = (uint32_t) pos;
 }
 
 } /* namespace world */
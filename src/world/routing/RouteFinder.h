@@ -20,10 +20,12 @@
 
 #include <vector>
 #include <memory>
-#include <set>
 #include <map>
+#include <unordered_map>
+#include <cstdint>
 #include <functional>
 #include <cmath>
+#include <limits>
 #include "Route.h"
 #include "../models/Airway.h"
 
@@ -56,18 +58,36 @@ private:
     AirwayLevel airwayLevel = AirwayLevel::LOWER;
     float airwayChangePenalty = 0;
 
-    std::set<Route::NodePtr> closedSet;
-    std::set<Route::NodePtr> openSet;
-    std::map<Route::NodePtr, Route::Leg> cameFrom;
-    std::map<Route::NodePtr, double> gScore;
-    std::map<Route::NodePtr, double> fScore;
-
-    bool checkEdge(const Route::EdgePtr via, const Route::NodePtr to) const;
-    Route::NodePtr getLowestOpen();
-    double minCostHeuristic(Route::NodePtr a, Route::NodePtr b);
-    double cost(Route::NodePtr a, const Route::Leg &dir);
-    double getGScore(Route::NodePtr f);
-    std::vector<Route::Leg> reconstructPath(Route::NodePtr lastFix);
+    static constexpr const uint32_t NO_NODE = UINT32_MAX;
+
+    // Every node reached by the search gets a dense index into the nodes vector
+    struct SearchNode {
+        Route::NodePtr node;
+        Route::EdgePtr via; // edge from the parent to this node
+        uint32_t parent = NO_NODE;
+        uint32_t heapIndex = NO_NODE;
+        double gScore = std::numeric_limits<double>::infinity();
+        double heuristic = 0;
+        bool closed = false;
+    };
+
+    std::vector<SearchNode> nodes;
+    std::unordered_map<const NavNode *, uint32_t> nodeIndex;
+
+    // Binary min-heap of open node indices ordered by fScore
+    std::vector<uint32_t> openHeap;
+
+    bool checkEdge(const Route::EdgePtr &via, const Route::NodePtr &to) const;
+    uint32_t addNode(const Route::NodePtr &node);
+    double minCostHeuristic(const Route::NodePtr &a, const Route::NodePtr &b) const;
+    double cost(uint32_t from, const Route::EdgePtr &via, const Route::NodePtr &to) const;
+    std::vector<Route::Leg> reconstructPath(uint32_t lastFix);
+
+    double getFScore(uint32_t idx) const;
+    void pushOpen(uint32_t idx);
+    uint32_t popOpen();
+    void siftUp(size_t pos);
+    void siftDown(size_t pos);
 };
 
 } /* namespace world */